@@ -0,0 +1,89 @@
+#include "CSR.h"
+#include "Parallel.h"
+
+#define CSR_ROW_GRAIN 64    // matrix rows handed to a thread at a time
+
+/////////////////////////////////////////////////////////////////////////////
+// CONSTRUCTION IMPLEMENTATION                                             //
+/////////////////////////////////////////////////////////////////////////////
+
+void buildCSR(const WeightedDigraph& g, CSRGraph& c) {
+	Offset n = g.getVertexCount();
+	c.offsets.assign(n + 1, 0);
+
+	// rows still pending from lazyLoad are parsed on first read, which must
+	// not happen on several threads at once
+	g.materialize();
+
+	// count every row, then fill every row, each in parallel
+	parallelFor(0, n, CSR_ROW_GRAIN, [&](size_t v, unsigned) {
+		size_t d = 0;
+		for(Offset u = 0; u < n; ++u) {
+			if(g.getWeight(v, u) != NWT)
+				++d;
+		}
+		c.offsets[v+1] = d;
+	});
+	for(Offset v = 0; v < n; ++v) {
+		c.offsets[v+1] += c.offsets[v];
+	}
+	c.targets.resize(c.offsets[n]);
+	c.weights.resize(c.offsets[n]);
+	parallelFor(0, n, CSR_ROW_GRAIN, [&](size_t v, unsigned) {
+		size_t e = c.offsets[v];
+		for(Offset u = 0; u < n; ++u) {
+			Weight w = g.getWeight(v, u);
+			if(w != NWT) {
+				c.targets[e] = u;
+				c.weights[e++] = w;
+			}
+		}
+	});
+}
+
+void buildCSR(Offset n, const std::vector<Offset>& src,
+		const std::vector<Offset>& dst, const std::vector<Weight>& w,
+		CSRGraph& c) {
+	// bucket the edges by destination, then transpose, which leaves every
+	// row in ascending target order without a comparison sort
+	CSRGraph r;
+	r.offsets.assign(n + 1, 0);
+	for(size_t i = 0; i < dst.size(); ++i) {
+		++r.offsets[dst[i]+1];
+	}
+	for(Offset v = 0; v < n; ++v) {
+		r.offsets[v+1] += r.offsets[v];
+	}
+	r.targets.resize(src.size());
+	r.weights.resize(src.size());
+	std::vector<size_t> next(r.offsets.begin(), r.offsets.end() - 1);
+	for(size_t i = 0; i < src.size(); ++i) {
+		size_t e = next[dst[i]]++;
+		r.targets[e] = src[i];
+		r.weights[e] = w.empty() ? 1 : w[i];
+	}
+	transposeCSR(r, c);
+}
+
+void transposeCSR(const CSRGraph& c, CSRGraph& t) {
+	Offset n = c.getVertexCount();
+	t.offsets.assign(n + 1, 0);
+	for(size_t e = 0; e < c.targets.size(); ++e) {
+		++t.offsets[c.targets[e]+1];
+	}
+	for(Offset v = 0; v < n; ++v) {
+		t.offsets[v+1] += t.offsets[v];
+	}
+	t.targets.resize(c.targets.size());
+	t.weights.resize(c.weights.size());
+
+	// visiting sources in order keeps every transposed row sorted
+	std::vector<size_t> next(t.offsets.begin(), t.offsets.end() - 1);
+	for(Offset v = 0; v < n; ++v) {
+		for(size_t e = c.offsets[v]; e < c.offsets[v+1]; ++e) {
+			size_t f = next[c.targets[e]]++;
+			t.targets[f] = v;
+			t.weights[f] = c.weights[e];
+		}
+	}
+}
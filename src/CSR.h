@@ -0,0 +1,75 @@
+#pragma once
+
+#include "Graph.h"
+#include <vector>
+#include <stddef.h>
+
+/////////////////////////////////////////////////////////////////////////////
+// COMPRESSED SPARSE ROW STRUCTURE                                         //
+/////////////////////////////////////////////////////////////////////////////
+
+/*
+ * Read-only snapshot of a graph's edges in compressed sparse row form.
+ *
+ * The out-edges of vertex v are targets[offsets[v]] through
+ * targets[offsets[v+1] - 1], in ascending order of target offset, and
+ * weights holds the weight of each of those edges. Vertex offsets are the
+ * same as in the graph the snapshot was built from. Whole-graph algorithms
+ * run over a snapshot rather than the adjacency matrix, so that their cost
+ * scales with the number of edges instead of the square of the vertices.
+ */
+struct CSRGraph {
+	std::vector<size_t> offsets;
+	std::vector<Offset> targets;
+	std::vector<Weight> weights;
+
+	Offset getVertexCount() const {
+		return offsets.empty() ? 0 : offsets.size() - 1;
+	}
+
+	size_t getEdgeCount() const {
+		return targets.size();
+	}
+
+	size_t getDegree(Offset v) const {
+		return offsets[v+1] - offsets[v];
+	}
+};
+
+/////////////////////////////////////////////////////////////////////////////
+// CONSTRUCTION PROCEDURES                                                 //
+/////////////////////////////////////////////////////////////////////////////
+
+/*
+ * Builds a snapshot of the edges of a graph. Rows of the adjacency matrix
+ * are scanned in parallel, once any edges pending from lazyLoad are parsed.
+ *
+ * @param g, the graph
+ * @param c, the snapshot returned by reference
+ */
+void buildCSR(const WeightedDigraph& g, CSRGraph& c);
+
+/*
+ * Builds a snapshot from an edge list, so that algorithms can run on graphs
+ * too large for an adjacency matrix. Edge i runs from src[i] to dst[i] with
+ * weight w[i]; w may be empty, in which case every weight is 1. Duplicate
+ * edges are kept.
+ *
+ * @param n, the number of vertices
+ * @param src, the source offset of every edge
+ * @param dst, the destination offset of every edge
+ * @param w, the weight of every edge, or empty
+ * @param c, the snapshot returned by reference
+ */
+void buildCSR(Offset n, const std::vector<Offset>& src,
+		const std::vector<Offset>& dst, const std::vector<Weight>& w,
+		CSRGraph& c);
+
+/*
+ * Builds the transpose of a snapshot, in which every edge is reversed.
+ * Row i of the transpose therefore lists the in-neighbors of vertex i.
+ *
+ * @param c, the snapshot
+ * @param t, the transpose returned by reference
+ */
+void transposeCSR(const CSRGraph& c, CSRGraph& t);
@@ -0,0 +1,183 @@
+#include "Centrality.h"
+#include "Parallel.h"
+#include "Stats.h"
+#include <queue>
+#include <memory>
+#include <random>
+#include <functional>
+#include <algorithm>
+#include <cmath>
+
+#define CENTRALITY_GRAIN 1         // sources handed to a thread at a time
+#define CENTRALITY_SUM_GRAIN 4096  // vertices summed by a thread at a time
+
+/////////////////////////////////////////////////////////////////////////////
+// AUXILIARY STRUCTURES                                                    //
+/////////////////////////////////////////////////////////////////////////////
+
+/*
+ * What a search knows of a vertex, kept together so that looking a
+ * neighbor up costs one cache miss rather than one per field. dist is -1
+ * until the vertex is reached, paths counts the shortest paths to it, and
+ * credit holds (1 + dependency) / paths once it is passed on the way back,
+ * the share of it owed to each path through a predecessor, so accumulating
+ * needs no division per edge.
+ */
+struct VertexState {
+	long long dist;
+	double paths;
+	double credit;
+};
+
+/*
+ * The state of one thread's searches. order lists the vertices reached by
+ * the last search in the order they were settled, which is ascending
+ * distance from its source.
+ */
+struct SourceSearch {
+	std::vector<VertexState> state;
+	std::vector<Offset> order;
+	std::vector<double> score;
+
+	explicit SourceSearch(Offset n) : score(n, 0) {
+		VertexState unreached = {-1, 0, 0};
+		state.assign(n, unreached);
+	}
+};
+
+typedef std::pair<long long, Offset> HeapEntry;
+
+/////////////////////////////////////////////////////////////////////////////
+// AUXILIARY FUNCTIONS                                                     //
+/////////////////////////////////////////////////////////////////////////////
+
+/*
+ * Counts the shortest paths from a source to every vertex it reaches.
+ */
+static void countPaths(const CSRGraph& g, Offset s, bool weighted,
+		SourceSearch& x) {
+	std::vector<VertexState>& st = x.state;
+	x.order.clear();
+	st[s].dist = 0;
+	st[s].paths = 1;
+	if(!weighted) {
+		x.order.push_back(s);
+		for(size_t i = 0; i < x.order.size(); ++i) {
+			Offset v = x.order[i];
+			long long d = st[v].dist + 1;
+			double p = st[v].paths;
+			for(size_t e = g.offsets[v]; e < g.offsets[v+1]; ++e) {
+				VertexState& w = st[g.targets[e]];
+				if(w.dist < 0) {
+					w.dist = d;
+					x.order.push_back(g.targets[e]);
+				}
+				if(w.dist == d)
+					w.paths += p;
+			}
+		}
+		return;
+	}
+
+	// with positive weights, every predecessor on a shortest path settles
+	// before the vertex it leads to, so has its count complete when relaxed
+	std::priority_queue<HeapEntry, std::vector<HeapEntry>,
+		std::greater<HeapEntry>> heap;
+	heap.push(HeapEntry(0, s));
+	while(!heap.empty()) {
+		HeapEntry top = heap.top();
+		heap.pop();
+		Offset v = top.second;
+		if(top.first != st[v].dist)
+			continue;
+		x.order.push_back(v);
+		double p = st[v].paths;
+		for(size_t e = g.offsets[v]; e < g.offsets[v+1]; ++e) {
+			if(g.weights[e] <= 0)
+				continue;
+			VertexState& w = st[g.targets[e]];
+			long long d = top.first + g.weights[e];
+			if(w.dist < 0 || d < w.dist) {
+				w.dist = d;
+				w.paths = p;
+				heap.push(HeapEntry(d, g.targets[e]));
+			}
+			else if(d == w.dist)
+				w.paths += p;
+		}
+	}
+}
+
+/*
+ * Adds the dependencies of the last search's source on every vertex to the
+ * thread's scores, scaled, walking back from the farthest vertex, then
+ * resets the vertices the search reached.
+ */
+static void accumulate(const CSRGraph& g, bool weighted, double scale,
+		SourceSearch& x) {
+	std::vector<VertexState>& st = x.state;
+	for(size_t i = x.order.size(); i-- > 1;) {
+		Offset v = x.order[i];
+		double sum = 0;
+		for(size_t e = g.offsets[v]; e < g.offsets[v+1]; ++e) {
+			const VertexState& w = st[g.targets[e]];
+			long long step = weighted ? g.weights[e] : 1;
+			if(step > 0 && w.dist == st[v].dist + step)
+				sum += w.credit;
+		}
+		double dependency = st[v].paths * sum;
+		x.score[v] += scale * dependency;
+		st[v].credit = (1 + dependency) / st[v].paths;
+	}
+	VertexState unreached = {-1, 0, 0};
+	for(size_t i = 0; i < x.order.size(); ++i) {
+		st[x.order[i]] = unreached;
+	}
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// CENTRALITY PROCEDURES                                                   //
+/////////////////////////////////////////////////////////////////////////////
+
+void betweenness(const CSRGraph& g, const BetweennessOptions& o,
+		Betweenness& b) {
+	StatTimer timer(STAT_BETWEENNESS);
+	Offset n = g.getVertexCount();
+	std::vector<Offset> sources(n);
+	for(Offset v = 0; v < n; ++v) {
+		sources[v] = v;
+	}
+	b.error = 0;
+	if(o.samples != 0 && o.samples < n) {
+		// the first samples of a partial Fisher-Yates shuffle
+		std::mt19937 rng(o.seed);
+		for(Offset i = 0; i < o.samples; ++i) {
+			std::uniform_int_distribution<Offset> pick(i, n - 1);
+			std::swap(sources[i], sources[pick(rng)]);
+		}
+		sources.resize(o.samples);
+		b.error = (double)n * (n - 2) *
+			std::sqrt(std::log(2 / (1 - o.confidence)) / (2.0 * o.samples));
+	}
+	b.sources = sources.size();
+	double scale = sources.empty() ? 1 : (double)n / sources.size();
+
+	// every thread's state is made by the thread itself, only once it is
+	// handed a source
+	std::vector<std::unique_ptr<SourceSearch>> local(parallelThreads());
+	parallelFor(0, sources.size(), CENTRALITY_GRAIN, [&](size_t i,
+			unsigned tid) {
+		if(!local[tid])
+			local[tid].reset(new SourceSearch(n));
+		countPaths(g, sources[i], o.weighted, *local[tid]);
+		accumulate(g, o.weighted, scale, *local[tid]);
+	});
+
+	b.score.assign(n, 0);
+	parallelFor(0, n, CENTRALITY_SUM_GRAIN, [&](size_t v, unsigned) {
+		for(size_t t = 0; t < local.size(); ++t) {
+			if(local[t])
+				b.score[v] += local[t]->score[v];
+		}
+	});
+}
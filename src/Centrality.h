@@ -0,0 +1,72 @@
+#pragma once
+
+#include "Graph.h"
+#include "CSR.h"
+#include <vector>
+
+/////////////////////////////////////////////////////////////////////////////
+// CENTRALITY STRUCTURES                                                   //
+/////////////////////////////////////////////////////////////////////////////
+
+/*
+ * Parameters of betweenness.
+ *
+ * When weighted is set, the length of a path is the total weight of its
+ * edges, and edges with weights of 0 or less are never followed; otherwise
+ * it is the number of its edges.
+ *
+ * When samples is 0, or at least the number of vertices, every vertex is a
+ * source and the scores are exact. Otherwise that many distinct sources are
+ * drawn at random from seed, and the scores estimated by scaling their
+ * dependencies up by vertices / samples.
+ *
+ * confidence is the probability with which each estimated score lies within
+ * the error bound returned.
+ */
+struct BetweennessOptions {
+	bool weighted = false;
+	unsigned samples = 0;
+	unsigned seed = 1;
+	double confidence = 0.95;
+};
+
+/*
+ * The betweenness of every vertex: the sum, over every pair of other
+ * vertices s and t with s reaching t, of the fraction of shortest paths from
+ * s to t passing through it. Paths follow edge directions. sources is the
+ * number of sources searched, and error bounds how far each score may lie
+ * from the exact one, 0 when every vertex was a source.
+ */
+struct Betweenness {
+	std::vector<double> score;
+	unsigned sources;
+	double error;
+};
+
+/////////////////////////////////////////////////////////////////////////////
+// CENTRALITY PROCEDURES                                                   //
+/////////////////////////////////////////////////////////////////////////////
+
+/*
+ * Computes the betweenness of every vertex with the algorithm of Brandes:
+ * a search from each source counts the shortest paths to every vertex, by
+ * breadth-first search, or by Dijkstra's algorithm over a binary heap when
+ * weighted, and the dependencies of the source on every vertex are then
+ * accumulated backwards in O(E). Predecessors are found again from the
+ * out-edges on the way back, so no list of them is kept. Sources are
+ * searched in parallel, each thread adding into scores of its own that are
+ * summed once all are done, and resetting only the vertices each search
+ * reached.
+ *
+ * When sampling, each source's dependency on a vertex lies in [0, V - 2],
+ * so by Hoeffding's inequality, which holds as well for sampling without
+ * replacement, each estimate lies within
+ * V (V - 2) sqrt(ln(2 / (1 - confidence)) / (2 samples)) of the exact score
+ * with the given confidence.
+ *
+ * @param g, the graph
+ * @param o, the centrality parameters
+ * @param b, the scores returned by reference, indexed by offset
+ */
+void betweenness(const CSRGraph& g, const BetweennessOptions& o,
+		Betweenness& b);
@@ -0,0 +1,241 @@
+#include "Compress.h"
+#include "Parallel.h"
+#include <algorithm>
+#include <string.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <tmmintrin.h>
+#define COMPRESS_SSSE3
+#endif
+
+#define COMPRESS_ROW_GRAIN 1024  // vertices handed to a thread at a time
+#define STREAM_PAD 16            // bytes past the last record that a SIMD
+                                 // load of a final group may read
+
+/////////////////////////////////////////////////////////////////////////////
+// AUXILIARY FUNCTIONS                                                     //
+/////////////////////////////////////////////////////////////////////////////
+
+/*
+ * The number of bytes a gap is stored in.
+ */
+static unsigned gapLength(uint32_t x) {
+	return x < (1u << 8) ? 1 : x < (1u << 16) ? 2 : x < (1u << 24) ? 3 : 4;
+}
+
+static size_t controlBytes(size_t d) {
+	return (d + 3) / 4;
+}
+
+/*
+ * The size of the record of vertex v: its control bytes and gap bytes.
+ */
+static size_t recordBytes(const CSRGraph& c, Offset v) {
+	size_t b = controlBytes(c.getDegree(v));
+	Offset prev = 0;
+	for(size_t e = c.offsets[v]; e < c.offsets[v+1]; ++e) {
+		b += gapLength(c.targets[e] - prev);
+		prev = c.targets[e];
+	}
+	return b;
+}
+
+static void encodeRecord(const CSRGraph& c, Offset v, uint8_t* out) {
+	size_t d = c.getDegree(v);
+	uint8_t* ctrl = out;
+	uint8_t* p = out + controlBytes(d);
+	memset(ctrl, 0, controlBytes(d));
+	Offset prev = 0;
+	for(size_t i = 0; i < d; ++i) {
+		Offset t = c.targets[c.offsets[v] + i];
+		uint32_t gap = t - prev;
+		unsigned len = gapLength(gap);
+		ctrl[i / 4] |= (len - 1) << (2 * (i % 4));
+		for(unsigned k = 0; k < len; ++k) {
+			*p++ = gap >> (8 * k);
+		}
+		prev = t;
+	}
+}
+
+/*
+ * Decodes targets first through d - 1 of a record, where p points at the gap
+ * of target first and prev is the target before it.
+ */
+static void decodeTail(const uint8_t* ctrl, const uint8_t* p, size_t first,
+		size_t d, Offset prev, Offset* out) {
+	for(size_t i = first; i < d; ++i) {
+		unsigned len = ((ctrl[i / 4] >> (2 * (i % 4))) & 3) + 1;
+		uint32_t gap = 0;
+		for(unsigned k = 0; k < len; ++k) {
+			gap |= (uint32_t)p[k] << (8 * k);
+		}
+		p += len;
+		prev += gap;
+		out[i] = prev;
+	}
+}
+
+static Weight weightAt(const CompressedGraph& z, size_t e) {
+	unsigned x = 0;
+	if(z.weightWidth >= 1)
+		x = z.weights[e * z.weightWidth];
+	if(z.weightWidth == 2)
+		x |= z.weights[e * 2 + 1] << 8;
+	return z.weightBase + x;
+}
+
+static void decodeRecord(const uint8_t* rec, size_t d, Offset* out) {
+	decodeTail(rec, rec + controlBytes(d), 0, d, 0, out);
+}
+
+#ifdef COMPRESS_SSSE3
+
+/*
+ * For every control byte, the shuffle that spreads its four gaps into 32-bit
+ * lanes, and the number of gap bytes it covers.
+ */
+struct VByteTables {
+	uint8_t shuffle[256][16];
+	uint8_t length[256];
+
+	VByteTables() {
+		for(unsigned c = 0; c < 256; ++c) {
+			unsigned pos = 0;
+			for(unsigned k = 0; k < 4; ++k) {
+				unsigned len = ((c >> (2 * k)) & 3) + 1;
+				for(unsigned b = 0; b < 4; ++b) {
+					shuffle[c][4*k + b] = b < len ? pos + b : 0x80;
+				}
+				pos += len;
+			}
+			length[c] = pos;
+		}
+	}
+};
+
+static const VByteTables& vbyteTables() {
+	static const VByteTables t;
+	return t;
+}
+
+/*
+ * Decodes four gaps per control byte with one shuffle, then turns them into
+ * targets with a prefix sum across the lanes.
+ */
+__attribute__((target("ssse3")))
+static void decodeRecordSsse3(const uint8_t* rec, size_t d, Offset* out) {
+	const VByteTables& t = vbyteTables();
+	const uint8_t* ctrl = rec;
+	const uint8_t* p = rec + controlBytes(d);
+	__m128i prev = _mm_setzero_si128();
+	size_t groups = d / 4;
+	for(size_t g = 0; g < groups; ++g) {
+		uint8_t c = ctrl[g];
+		__m128i in = _mm_loadu_si128((const __m128i*)p);
+		__m128i x = _mm_shuffle_epi8(in,
+				_mm_loadu_si128((const __m128i*)t.shuffle[c]));
+		p += t.length[c];
+		x = _mm_add_epi32(x, _mm_slli_si128(x, 4));
+		x = _mm_add_epi32(x, _mm_slli_si128(x, 8));
+		x = _mm_add_epi32(x, prev);
+		_mm_storeu_si128((__m128i*)(out + 4*g), x);
+		prev = _mm_shuffle_epi32(x, 0xFF);
+	}
+	decodeTail(ctrl, p, 4 * groups, d, _mm_cvtsi128_si32(prev), out);
+}
+
+#endif
+
+typedef void (*RecordDecoder)(const uint8_t* rec, size_t d, Offset* out);
+
+/*
+ * The fastest record decoder the processor supports, chosen once.
+ */
+static RecordDecoder recordDecoder() {
+#ifdef COMPRESS_SSSE3
+	static const RecordDecoder decoder =
+		__builtin_cpu_supports("ssse3") ? decodeRecordSsse3 : decodeRecord;
+	return decoder;
+#else
+	return decodeRecord;
+#endif
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// COMPRESSION IMPLEMENTATION                                              //
+/////////////////////////////////////////////////////////////////////////////
+
+void compressCSR(const CSRGraph& c, CompressedGraph& z) {
+	Offset n = c.getVertexCount();
+	z.edges = c.offsets;
+	if(z.edges.empty())
+		z.edges.push_back(0);
+
+	// size every record, then encode every record, each in parallel
+	z.bytes.assign(n + 1, 0);
+	parallelFor(0, n, COMPRESS_ROW_GRAIN, [&](size_t v, unsigned) {
+		z.bytes[v+1] = recordBytes(c, v);
+	});
+	for(Offset v = 0; v < n; ++v) {
+		z.bytes[v+1] += z.bytes[v];
+	}
+	z.stream.assign(z.bytes[n] + STREAM_PAD, 0);
+	parallelFor(0, n, COMPRESS_ROW_GRAIN, [&](size_t v, unsigned) {
+		encodeRecord(c, v, &z.stream[z.bytes[v]]);
+	});
+
+	// weights take the fewest bytes that cover their range
+	z.weights.clear();
+	z.weightBase = 1;
+	z.weightWidth = 0;
+	if(c.weights.empty())
+		return;
+	Weight lo = *std::min_element(c.weights.begin(), c.weights.end());
+	Weight hi = *std::max_element(c.weights.begin(), c.weights.end());
+	unsigned range = hi - lo;
+	z.weightBase = lo;
+	z.weightWidth = range == 0 ? 0 : range < 256 ? 1 : 2;
+	z.weights.resize(c.weights.size() * z.weightWidth);
+	for(size_t e = 0; e < c.weights.size() && z.weightWidth > 0; ++e) {
+		unsigned x = c.weights[e] - lo;
+		z.weights[e * z.weightWidth] = x;
+		if(z.weightWidth == 2)
+			z.weights[e * 2 + 1] = x >> 8;
+	}
+}
+
+void compressGraph(const WeightedDigraph& g, CompressedGraph& z) {
+	CSRGraph c;
+	buildCSR(g, c);
+	compressCSR(c, z);
+}
+
+void decompressCSR(const CompressedGraph& z, CSRGraph& c) {
+	Offset n = z.getVertexCount();
+	RecordDecoder decode = recordDecoder();
+	c.offsets = z.edges;
+	c.targets.resize(z.getEdgeCount());
+	parallelFor(0, n, COMPRESS_ROW_GRAIN, [&](size_t v, unsigned) {
+		if(z.getDegree(v) > 0)
+			decode(&z.stream[z.bytes[v]], z.getDegree(v), &c.targets[z.edges[v]]);
+	});
+	c.weights.resize(z.getEdgeCount());
+	for(size_t e = 0; e < c.weights.size(); ++e) {
+		c.weights[e] = weightAt(z, e);
+	}
+}
+
+void decodeNeighbors(const CompressedGraph& z, Offset v,
+		std::vector<Offset>& n) {
+	n.resize(z.getDegree(v));
+	if(!n.empty())
+		recordDecoder()(&z.stream[z.bytes[v]], n.size(), &n[0]);
+}
+
+void decodeWeights(const CompressedGraph& z, Offset v, std::vector<Weight>& w) {
+	w.resize(z.getDegree(v));
+	for(size_t i = 0; i < w.size(); ++i) {
+		w[i] = weightAt(z, z.edges[v] + i);
+	}
+}
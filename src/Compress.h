@@ -0,0 +1,106 @@
+#pragma once
+
+#include "Graph.h"
+#include "CSR.h"
+#include <vector>
+#include <stdint.h>
+#include <stddef.h>
+
+/////////////////////////////////////////////////////////////////////////////
+// COMPRESSED SPARSE ROW STRUCTURE                                         //
+/////////////////////////////////////////////////////////////////////////////
+
+/*
+ * Read-only snapshot of a graph's edges, compressed for graphs whose CSR
+ * snapshot does not fit in memory.
+ *
+ * The out-neighbors of every vertex are stored in ascending order as gaps
+ * between consecutive targets (the first target as is), encoded with
+ * stream-VByte: one control byte holds the byte lengths of four gaps, and
+ * the gaps follow in 1 to 4 bytes each. The record of vertex v, its control
+ * bytes followed by its gap bytes, starts at stream[bytes[v]], and its edges
+ * are edges[v] through edges[v+1] - 1 of the snapshot.
+ *
+ * Weights are kept in a separate stream, as the difference from the smallest
+ * weight in weightWidth bytes each, so that they can be read without decoding
+ * any targets. weightWidth is 0 when every weight is the same, such as in an
+ * unweighted graph.
+ */
+struct CompressedGraph {
+	std::vector<size_t> edges;
+	std::vector<size_t> bytes;
+	std::vector<uint8_t> stream;
+	std::vector<uint8_t> weights;
+	Weight weightBase;
+	unsigned weightWidth;
+
+	Offset getVertexCount() const {
+		return edges.empty() ? 0 : edges.size() - 1;
+	}
+
+	size_t getEdgeCount() const {
+		return edges.empty() ? 0 : edges.back();
+	}
+
+	size_t getDegree(Offset v) const {
+		return edges[v+1] - edges[v];
+	}
+
+	/*
+	 * Bytes used by the snapshot, excluding capacity beyond its size.
+	 */
+	size_t getByteCount() const {
+		return (edges.size() + bytes.size()) * sizeof(size_t) +
+			stream.size() + weights.size();
+	}
+};
+
+/////////////////////////////////////////////////////////////////////////////
+// COMPRESSION PROCEDURES                                                  //
+/////////////////////////////////////////////////////////////////////////////
+
+/*
+ * Compresses a snapshot. Rows are encoded in parallel.
+ *
+ * @param c, the snapshot, with every row in ascending target order
+ * @param z, the compressed snapshot returned by reference
+ */
+void compressCSR(const CSRGraph& c, CompressedGraph& z);
+
+/*
+ * Builds a compressed snapshot of the edges of a graph.
+ *
+ * @param g, the graph
+ * @param z, the compressed snapshot returned by reference
+ */
+void compressGraph(const WeightedDigraph& g, CompressedGraph& z);
+
+/*
+ * Expands a compressed snapshot back into a CSR snapshot.
+ *
+ * @param z, the compressed snapshot
+ * @param c, the snapshot returned by reference
+ */
+void decompressCSR(const CompressedGraph& z, CSRGraph& c);
+
+/*
+ * Decodes the out-neighbors of vertex v, in ascending order. Uses SSSE3 when
+ * the processor supports it.
+ *
+ * @param z, the compressed snapshot
+ * @param v, a valid vertex offset
+ * @param n, the neighboring offsets returned by reference, replacing its
+ * contents
+ */
+void decodeNeighbors(const CompressedGraph& z, Offset v,
+		std::vector<Offset>& n);
+
+/*
+ * Decodes the weights of the out-edges of vertex v, in the order of the
+ * neighbors returned by decodeNeighbors().
+ *
+ * @param z, the compressed snapshot
+ * @param v, a valid vertex offset
+ * @param w, the edge weights returned by reference, replacing its contents
+ */
+void decodeWeights(const CompressedGraph& z, Offset v, std::vector<Weight>& w);
@@ -0,0 +1,142 @@
+#include "DAG.h"
+#include "Parallel.h"
+#include "Stats.h"
+#include <atomic>
+#include <memory>
+#include <algorithm>
+
+#define DAG_GRAIN 256   // vertices handed to a thread at a time
+
+/////////////////////////////////////////////////////////////////////////////
+// AUXILIARY FUNCTIONS                                                     //
+/////////////////////////////////////////////////////////////////////////////
+
+/*
+ * Relaxes every edge out of the vertices reachable from s, in topological
+ * order, keeping the lower cost path, or the higher one if longest is set.
+ */
+static void dagPaths(const CSRGraph& g, const std::vector<Offset>& order,
+		Offset s, bool longest, DagPaths& d) {
+	StatTimer timer(STAT_DAG_PATHS);
+	Offset n = g.getVertexCount();
+	d.cost.assign(n, 0);
+	d.parent.assign(n, -1);
+	d.reached.assign(n, false);
+	d.reached[s] = true;
+	for(size_t i = 0; i < order.size(); ++i) {
+		Offset v = order[i];
+		if(!d.reached[v])
+			continue;
+		for(size_t e = g.offsets[v]; e < g.offsets[v+1]; ++e) {
+			Offset w = g.targets[e];
+			long long c = d.cost[v] + g.weights[e];
+			if(!d.reached[w] || (longest ? c > d.cost[w] : c < d.cost[w])) {
+				d.reached[w] = true;
+				d.cost[w] = c;
+				d.parent[w] = v;
+			}
+		}
+	}
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// ORDERING IMPLEMENTATION                                                 //
+/////////////////////////////////////////////////////////////////////////////
+
+bool topologicalOrder(const CSRGraph& g, std::vector<Offset>& order) {
+	StatTimer timer(STAT_TOPO);
+	Offset n = g.getVertexCount();
+	std::unique_ptr<std::atomic<Offset>[]> in(new std::atomic<Offset>[n]);
+	std::vector<std::vector<Offset>> local(parallelThreads());
+	std::vector<Offset> level;
+
+	parallelFor(0, n, DAG_GRAIN, [&](size_t v, unsigned) {
+		in[v].store(0, std::memory_order_relaxed);
+	});
+	parallelFor(0, n, DAG_GRAIN, [&](size_t v, unsigned) {
+		for(size_t e = g.offsets[v]; e < g.offsets[v+1]; ++e) {
+			in[g.targets[e]].fetch_add(1, std::memory_order_relaxed);
+		}
+	});
+	parallelFor(0, n, DAG_GRAIN, [&](size_t v, unsigned tid) {
+		if(in[v].load(std::memory_order_relaxed) == 0)
+			local[tid].push_back(v);
+	});
+	gather(local, level);
+
+	order.clear();
+	while(!level.empty()) {
+		std::sort(level.begin(), level.end());
+		order.insert(order.end(), level.begin(), level.end());
+		parallelFor(0, level.size(), DAG_GRAIN, [&](size_t i, unsigned tid) {
+			Offset v = level[i];
+			for(size_t e = g.offsets[v]; e < g.offsets[v+1]; ++e) {
+				Offset w = g.targets[e];
+				if(in[w].fetch_sub(1, std::memory_order_relaxed) == 1)
+					local[tid].push_back(w);
+			}
+		});
+		gather(local, level);
+	}
+	return order.size() == n;
+}
+
+bool findCycle(const CSRGraph& g, std::vector<Offset>& cycle) {
+	std::vector<Offset> order;
+	cycle.clear();
+	if(topologicalOrder(g, order))
+		return false;
+
+	// every vertex Kahn's algorithm could not place has an in-edge from
+	// another such vertex, so walking in-edges among them must revisit one
+	Offset n = g.getVertexCount();
+	std::vector<bool> placed(n, false);
+	for(size_t i = 0; i < order.size(); ++i) {
+		placed[order[i]] = true;
+	}
+	CSRGraph t;
+	transposeCSR(g, t);
+	std::vector<long> position(n, -1);
+	std::vector<Offset> walk;
+	Offset v = std::find(placed.begin(), placed.end(), false) - placed.begin();
+	while(position[v] == -1) {
+		position[v] = walk.size();
+		walk.push_back(v);
+		for(size_t e = t.offsets[v]; e < t.offsets[v+1]; ++e) {
+			if(!placed[t.targets[e]]) {
+				v = t.targets[e];
+				break;
+			}
+		}
+	}
+
+	// the walk followed edges backwards
+	cycle.assign(walk.rbegin(), walk.rend() - position[v]);
+	return true;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// DAG PATH IMPLEMENTATION                                                 //
+/////////////////////////////////////////////////////////////////////////////
+
+void dagShortestPaths(const CSRGraph& g, const std::vector<Offset>& order,
+		Offset s, DagPaths& d) {
+	dagPaths(g, order, s, false, d);
+}
+
+void dagLongestPaths(const CSRGraph& g, const std::vector<Offset>& order,
+		Offset s, DagPaths& d) {
+	dagPaths(g, order, s, true, d);
+}
+
+bool dagPath(const DagPaths& d, Offset t, Path& p) {
+	if(!d.reached[t])
+		return false;
+	p.vertices.clear();
+	p.cost = d.cost[t];
+	for(long curr = t; curr != -1; curr = d.parent[curr]) {
+		p.vertices.push_back(curr);
+	}
+	std::reverse(p.vertices.begin(), p.vertices.end());
+	return true;
+}
@@ -0,0 +1,100 @@
+#pragma once
+
+#include "Graph.h"
+#include "CSR.h"
+#include "Search.h"
+#include <vector>
+
+/////////////////////////////////////////////////////////////////////////////
+// DAG STRUCTURES                                                          //
+/////////////////////////////////////////////////////////////////////////////
+
+/*
+ * Single-source path costs found by one of the DAG procedures below.
+ *
+ * cost holds the cost of the best path from the source to every vertex
+ * offset, and parent the offset preceding it on that path, or -1 for the
+ * source itself. reached marks the vertices the source has a path to; the
+ * cost and parent of any other vertex are meaningless.
+ */
+struct DagPaths {
+	std::vector<long long> cost;
+	std::vector<long> parent;
+	std::vector<bool> reached;
+};
+
+/////////////////////////////////////////////////////////////////////////////
+// ORDERING PROCEDURES                                                     //
+/////////////////////////////////////////////////////////////////////////////
+
+/*
+ * Computes a topological order of a graph using a level-synchronous parallel
+ * Kahn's algorithm. Every vertex without in-edges forms the first level;
+ * each later level holds the vertices whose in-degree counters reach zero
+ * once the level before is removed. Counters are atomic, so every level is
+ * processed on all threads. Vertices within a level are kept in ascending
+ * offset order, so the result does not depend on the thread count.
+ *
+ * @param g, the graph
+ * @param order, the vertex offsets in topological order returned by
+ *        reference; holds only the vertices that precede every cycle if
+ *        the graph is not acyclic
+ *
+ * @return true if the graph is acyclic
+ *         false if the graph has a cycle
+ */
+bool topologicalOrder(const CSRGraph& g, std::vector<Offset>& order);
+
+/*
+ * Finds a cycle in a graph.
+ *
+ * @param g, the graph
+ * @param cycle, the offsets of the vertices along the cycle, in edge order,
+ *        returned by reference; the last vertex has an edge to the first
+ *
+ * @return true if a cycle was found
+ *         false if the graph is acyclic
+ */
+bool findCycle(const CSRGraph& g, std::vector<Offset>& cycle);
+
+/////////////////////////////////////////////////////////////////////////////
+// DAG PATH PROCEDURES                                                     //
+/////////////////////////////////////////////////////////////////////////////
+
+/*
+ * Finds the lowest cost path from a source to every vertex of an acyclic
+ * graph by relaxing edges in topological order, in time linear in the size
+ * of the graph. Negative weights are allowed.
+ *
+ * @param g, the graph, which must be acyclic
+ * @param order, a topological order of g
+ * @param s, offset of the source vertex
+ * @param d, the path costs returned by reference
+ */
+void dagShortestPaths(const CSRGraph& g, const std::vector<Offset>& order,
+		Offset s, DagPaths& d);
+
+/*
+ * Finds the highest cost path from a source to every vertex of an acyclic
+ * graph, as dagShortestPaths does for the lowest. Negative weights are
+ * allowed.
+ *
+ * @param g, the graph, which must be acyclic
+ * @param order, a topological order of g
+ * @param s, offset of the source vertex
+ * @param d, the path costs returned by reference
+ */
+void dagLongestPaths(const CSRGraph& g, const std::vector<Offset>& order,
+		Offset s, DagPaths& d);
+
+/*
+ * Rebuilds the path to a vertex from single-source path costs.
+ *
+ * @param d, the path costs
+ * @param t, offset of the destination vertex
+ * @param p, the path returned by reference
+ *
+ * @return true if the source has a path to t
+ *         false if no such path exists
+ */
+bool dagPath(const DagPaths& d, Offset t, Path& p);
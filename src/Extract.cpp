@@ -0,0 +1,151 @@
+#include "Extract.h"
+#include "Parallel.h"
+#include "Stats.h"
+#include <fstream>
+#include <algorithm>
+
+#define EXTRACT_GRAIN 256  // vertices handed to a thread at a time
+#define EXTRACT_DENSE 64   // subgraphs of over 1/64th of the snapshot are
+                           // renumbered through a table, not a search
+
+/////////////////////////////////////////////////////////////////////////////
+// AUXILIARY FUNCTIONS                                                     //
+/////////////////////////////////////////////////////////////////////////////
+
+static bool hasExtension(const std::string& file, const std::string& ext) {
+	return file.size() >= ext.size() &&
+		file.compare(file.size() - ext.size(), ext.size(), ext) == 0;
+}
+
+/*
+ * Expands the frontier level by level, claiming every vertex reached in
+ * seen, and appends each level to reached.
+ */
+static void expand(const CSRGraph& g, Offset seed, unsigned k,
+		const EdgeFilter& f, Bitset& seen, std::vector<Offset>& reached) {
+	std::vector<std::vector<Offset>> local(parallelThreads());
+	std::vector<Offset> frontier(1, seed);
+	seen.set(seed);
+	reached.assign(1, seed);
+	for(unsigned hop = 0; hop < k && !frontier.empty(); ++hop) {
+		parallelFor(0, frontier.size(), EXTRACT_GRAIN, [&](size_t i, unsigned tid) {
+			Offset v = frontier[i];
+			for(size_t e = g.offsets[v]; e < g.offsets[v+1]; ++e) {
+				if(f.accepts(g.weights[e]) && seen.testAndSet(g.targets[e]))
+					local[tid].push_back(g.targets[e]);
+			}
+		});
+		gather(local, frontier);
+		reached.insert(reached.end(), frontier.begin(), frontier.end());
+	}
+}
+
+/*
+ * Builds the subgraph induced by vertices, which are in ascending order and
+ * all set in member, so that a vertex's new offset is its position.
+ */
+static void induce(const CSRGraph& g, const std::vector<Offset>& vertices,
+		const Bitset& member, const EdgeFilter& f, Subgraph& s) {
+	Offset n = vertices.size();
+	CSRGraph& c = s.csr;
+	s.origin = vertices;
+	c.offsets.assign(n + 1, 0);
+
+	// count every row, then fill every row, each in parallel. Small subgraphs
+	// renumber targets by a binary search, so their cost follows the
+	// subgraph rather than the snapshot; large ones by a table
+	std::vector<Offset> index;
+	if((size_t)n * EXTRACT_DENSE > g.getVertexCount()) {
+		index.resize(g.getVertexCount());
+		for(Offset i = 0; i < n; ++i) {
+			index[vertices[i]] = i;
+		}
+	}
+	auto renumber = [&](Offset v) -> Offset {
+		if(!index.empty())
+			return index[v];
+		return std::lower_bound(vertices.begin(), vertices.end(), v) -
+			vertices.begin();
+	};
+	auto keep = [&](size_t e) {
+		return member.test(g.targets[e]) && f.accepts(g.weights[e]);
+	};
+	parallelFor(0, n, EXTRACT_GRAIN, [&](size_t i, unsigned) {
+		Offset v = vertices[i];
+		size_t d = 0;
+		for(size_t e = g.offsets[v]; e < g.offsets[v+1]; ++e) {
+			d += keep(e);
+		}
+		c.offsets[i+1] = d;
+	});
+	for(Offset i = 0; i < n; ++i) {
+		c.offsets[i+1] += c.offsets[i];
+	}
+	c.targets.resize(c.offsets[n]);
+	c.weights.resize(c.offsets[n]);
+	parallelFor(0, n, EXTRACT_GRAIN, [&](size_t i, unsigned) {
+		Offset v = vertices[i];
+		size_t out = c.offsets[i];
+		for(size_t e = g.offsets[v]; e < g.offsets[v+1]; ++e) {
+			if(keep(e)) {
+				c.targets[out] = renumber(g.targets[e]);
+				c.weights[out++] = g.weights[e];
+			}
+		}
+	});
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// EXTRACTION PROCEDURES                                                   //
+/////////////////////////////////////////////////////////////////////////////
+
+void kHop(const CSRGraph& g, Offset seed, unsigned k, const EdgeFilter& f,
+		std::vector<Offset>& reached) {
+	StatTimer timer(STAT_EXTRACT);
+	Bitset seen(g.getVertexCount());
+	expand(g, seed, k, f, seen, reached);
+	std::sort(reached.begin(), reached.end());
+}
+
+void induceSubgraph(const CSRGraph& g, const std::vector<Offset>& vertices,
+		const EdgeFilter& f, Subgraph& s) {
+	StatTimer timer(STAT_EXTRACT);
+	Bitset member(g.getVertexCount());
+	std::vector<Offset> sorted(vertices);
+	std::sort(sorted.begin(), sorted.end());
+	for(size_t i = 0; i < sorted.size(); ++i) {
+		member.set(sorted[i]);
+	}
+	induce(g, sorted, member, f, s);
+}
+
+void extractKHop(const CSRGraph& g, Offset seed, unsigned k,
+		const EdgeFilter& f, Subgraph& s) {
+	StatTimer timer(STAT_EXTRACT);
+	// the visited bitset of the expansion doubles as the membership test
+	Bitset seen(g.getVertexCount());
+	std::vector<Offset> reached;
+	expand(g, seed, k, f, seen, reached);
+	std::sort(reached.begin(), reached.end());
+	induce(g, reached, seen, f, s);
+}
+
+int writeSubgraph(const WeightedDigraph& g, const Subgraph& s,
+		const std::string& file) {
+	if(!hasExtension(file, graphExt))
+		return -2;
+	std::ofstream outFile(file);
+	if(!outFile.is_open())
+		return -1;
+	const CSRGraph& c = s.csr;
+	for(Offset v = 0; v < c.getVertexCount(); ++v) {
+		outFile << g.getKey(s.origin[v]) << " | ";
+		for(size_t e = c.offsets[v]; e < c.offsets[v+1]; ++e) {
+			outFile << g.getKey(s.origin[c.targets[e]]) << "[" << c.weights[e]
+				<< "] ";
+		}
+		outFile << '\n';
+	}
+	outFile.close();
+	return outFile.fail() ? -1 : 0;
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+#include "Graph.h"
+#include "CSR.h"
+#include <string>
+#include <vector>
+#include <climits>
+
+/////////////////////////////////////////////////////////////////////////////
+// EXTRACTION STRUCTURES                                                   //
+/////////////////////////////////////////////////////////////////////////////
+
+/*
+ * The edges an extraction follows and keeps: those whose weight lies in
+ * [minWeight, maxWeight]. Every edge is accepted by default.
+ */
+struct EdgeFilter {
+	Weight minWeight = SHRT_MIN + 1;
+	Weight maxWeight = SHRT_MAX;
+
+	bool accepts(Weight w) const {
+		return w >= minWeight && w <= maxWeight;
+	}
+};
+
+/*
+ * A subgraph extracted from a snapshot. Its vertices are renumbered from 0
+ * in ascending order of their offsets in the snapshot, so the rows of csr
+ * stay in ascending target order, and origin holds the snapshot offset of
+ * every vertex of csr.
+ */
+struct Subgraph {
+	CSRGraph csr;
+	std::vector<Offset> origin;
+};
+
+/////////////////////////////////////////////////////////////////////////////
+// EXTRACTION PROCEDURES                                                   //
+/////////////////////////////////////////////////////////////////////////////
+
+/*
+ * Finds every vertex within k hops of a seed along out-edges accepted by a
+ * filter. Each level's frontier is expanded in parallel, with threads
+ * claiming vertices in a shared visited bitset so none is reached twice.
+ *
+ * @param g, the snapshot
+ * @param seed, the offset of the seed
+ * @param k, the number of hops; 0 reaches the seed alone
+ * @param f, the edges to follow
+ * @param reached, the offsets of the vertices reached, seed included, in
+ * ascending order, returned by reference
+ */
+void kHop(const CSRGraph& g, Offset seed, unsigned k, const EdgeFilter& f,
+		std::vector<Offset>& reached);
+
+/*
+ * Builds the subgraph induced by a set of vertices: every edge accepted by a
+ * filter between two of them. Rows are counted and then filled in parallel,
+ * straight into the subgraph's own storage.
+ *
+ * @param g, the snapshot
+ * @param vertices, the offsets of the vertices to keep, without repeats, in
+ * any order
+ * @param f, the edges to keep
+ * @param s, the subgraph returned by reference
+ */
+void induceSubgraph(const CSRGraph& g, const std::vector<Offset>& vertices,
+		const EdgeFilter& f, Subgraph& s);
+
+/*
+ * Extracts the subgraph induced by the k-hop neighborhood of a seed; kHop
+ * followed by induceSubgraph with the same filter.
+ */
+void extractKHop(const CSRGraph& g, Offset seed, unsigned k,
+		const EdgeFilter& f, Subgraph& s);
+
+/*
+ * Writes a subgraph as a .graph file, looking up the key of each vertex in
+ * the graph it was extracted from as it is written, so no key is copied.
+ * Will overwrite a file with the same name.
+ *
+ * @param g, the graph the subgraph's snapshot was built from
+ * @param s, the subgraph
+ * @param file, the name of the file to write
+ *
+ * @return 0 upon successful write
+ *        -1 upon inability to create file
+ *        -2 upon improper extension
+ */
+int writeSubgraph(const WeightedDigraph& g, const Subgraph& s,
+		const std::string& file);
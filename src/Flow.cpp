@@ -0,0 +1,365 @@
+#include "Flow.h"
+#include "Parallel.h"
+#include "Stats.h"
+#include <algorithm>
+#include <limits>
+#include <stdint.h>
+
+#define FLOW_GRAIN 256       // vertices handed to a thread at a time
+#define FLOW_ALPHA 6         // work charged per relabel, beyond its arcs
+#define FLOW_GLOBAL_FREQ 2   // global relabel once the work done since the
+                             // last reaches this many times 6V + E
+#define FLOW_NIL std::numeric_limits<Offset>::max()
+
+/////////////////////////////////////////////////////////////////////////////
+// AUXILIARY STRUCTURES                                                    //
+/////////////////////////////////////////////////////////////////////////////
+
+/*
+ * Residual graph in compressed sparse row form. The arcs of vertex v are
+ * heads[offsets[v]] through heads[offsets[v+1] - 1]: first one for each of
+ * its out-edges, holding the capacity left, then one for each of its
+ * in-edges, holding the flow that may be pushed back. rev holds the position
+ * of every arc's partner in the row of its head.
+ */
+struct Residual {
+	std::vector<size_t> offsets;
+	std::vector<Offset> heads;
+	std::vector<int32_t> caps;
+	std::vector<size_t> rev;
+};
+
+/*
+ * State of the first phase of highest-label push-relabel. Vertices labeled
+ * below n are threaded onto a doubly linked list per label, so a gap can be
+ * found and cleared in time proportional to the vertices above it. Active
+ * vertices wait on a stack per label; entries left behind by a relabel are
+ * skipped when popped.
+ */
+class PushRelabel {
+	private:
+		Residual& r;
+		const Offset n;
+		const Offset s;
+		const Offset t;
+		const bool parallel;
+		std::vector<Offset> label;
+		std::vector<long long> excess;
+		std::vector<size_t> current;
+		std::vector<std::vector<Offset>> active;
+		std::vector<Offset> head;
+		std::vector<Offset> next;
+		std::vector<Offset> prev;
+		Offset highest;     // highest label that may hold an active vertex
+		Offset highestAll;  // highest label that may hold any vertex
+		size_t work;
+
+		void link(Offset v) {
+			Offset d = label[v];
+			prev[v] = FLOW_NIL;
+			next[v] = head[d];
+			if(head[d] != FLOW_NIL)
+				prev[head[d]] = v;
+			head[d] = v;
+			highestAll = std::max(highestAll, d);
+		}
+
+		void unlink(Offset v) {
+			Offset d = label[v];
+			if(prev[v] != FLOW_NIL)
+				next[prev[v]] = next[v];
+			else
+				head[d] = next[v];
+			if(next[v] != FLOW_NIL)
+				prev[next[v]] = prev[v];
+		}
+
+		void activate(Offset v) {
+			active[label[v]].push_back(v);
+			highest = std::max(highest, label[v]);
+		}
+
+		void distances();
+		void globalRelabel();
+		void gap(Offset d);
+		void discharge(Offset v);
+	public:
+		PushRelabel(Residual& res, Offset source, Offset sink, bool p) :
+			r(res), n(res.offsets.size() - 1), s(source), t(sink), parallel(p),
+			label(n), excess(n, 0), current(n), active(n), head(n),
+			next(n), prev(n), highest(0), highestAll(0), work(0) {}
+
+		/*
+		 * Runs the first phase.
+		 *
+		 * @return the flow reaching the sink
+		 */
+		long long run();
+
+		/*
+		 * Whether a vertex can still reach the sink in the residual graph;
+		 * meaningful after run().
+		 */
+		bool reachesSink(Offset v) const {
+			return label[v] < n;
+		}
+};
+
+/////////////////////////////////////////////////////////////////////////////
+// AUXILIARY FUNCTIONS                                                     //
+/////////////////////////////////////////////////////////////////////////////
+
+/*
+ * Builds the residual graph of a snapshot before any flow.
+ */
+static void buildResidual(const CSRGraph& g, Residual& r) {
+	Offset n = g.getVertexCount();
+	std::vector<size_t> in(n, 0);
+	for(size_t e = 0; e < g.getEdgeCount(); ++e) {
+		++in[g.targets[e]];
+	}
+	r.offsets.assign(n + 1, 0);
+	for(Offset v = 0; v < n; ++v) {
+		r.offsets[v+1] = r.offsets[v] + g.getDegree(v) + in[v];
+	}
+	r.heads.resize(r.offsets[n]);
+	r.caps.resize(r.offsets[n]);
+	r.rev.resize(r.offsets[n]);
+
+	// in is reused as the next free reverse arc of every row
+	for(Offset v = 0; v < n; ++v) {
+		in[v] = r.offsets[v] + g.getDegree(v);
+	}
+	for(Offset u = 0; u < n; ++u) {
+		for(size_t e = g.offsets[u]; e < g.offsets[u+1]; ++e) {
+			Offset v = g.targets[e];
+			size_t f = r.offsets[u] + (e - g.offsets[u]);
+			size_t b = in[v]++;
+			r.heads[f] = v;
+			r.caps[f] = u != v ? std::max<int32_t>(g.weights[e], 0) : 0;
+			r.rev[f] = b;
+			r.heads[b] = u;
+			r.caps[b] = 0;
+			r.rev[b] = f;
+		}
+	}
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// PUSH-RELABEL IMPLEMENTATION                                             //
+/////////////////////////////////////////////////////////////////////////////
+
+/*
+ * Labels every vertex with its residual distance to the sink, searching
+ * backwards from it; the source and every vertex that cannot reach the sink
+ * are labeled n.
+ */
+void PushRelabel::distances() {
+	std::fill(label.begin(), label.end(), n);
+	label[t] = 0;
+	std::vector<Offset> frontier(1, t);
+	if(!parallel || parallelThreads() == 1) {
+		for(size_t i = 0; i < frontier.size(); ++i) {
+			Offset w = frontier[i];
+			for(size_t a = r.offsets[w]; a < r.offsets[w+1]; ++a) {
+				Offset v = r.heads[a];
+				if(label[v] == n && v != s && r.caps[r.rev[a]] > 0) {
+					label[v] = label[w] + 1;
+					frontier.push_back(v);
+				}
+			}
+		}
+		return;
+	}
+	std::vector<std::vector<Offset>> local(parallelThreads());
+	Bitset seen(n);
+	seen.set(t);
+	seen.set(s);
+	for(Offset d = 1; !frontier.empty(); ++d) {
+		parallelFor(0, frontier.size(), FLOW_GRAIN, [&](size_t i, unsigned tid) {
+			Offset w = frontier[i];
+			for(size_t a = r.offsets[w]; a < r.offsets[w+1]; ++a) {
+				Offset v = r.heads[a];
+				if(r.caps[r.rev[a]] > 0 && seen.testAndSet(v)) {
+					label[v] = d;
+					local[tid].push_back(v);
+				}
+			}
+		});
+		gather(local, frontier);
+	}
+}
+
+void PushRelabel::globalRelabel() {
+	distances();
+	std::fill(head.begin(), head.end(), FLOW_NIL);
+	for(Offset d = 0; d < n; ++d) {
+		active[d].clear();
+	}
+	highest = highestAll = 0;
+	for(Offset v = 0; v < n; ++v) {
+		current[v] = r.offsets[v];
+		if(label[v] < n) {
+			link(v);
+			if(excess[v] > 0 && v != t)
+				activate(v);
+		}
+	}
+	work = 0;
+}
+
+/*
+ * Gives up every vertex labeled above d, none of which can reach the sink
+ * once no vertex is labeled d.
+ */
+void PushRelabel::gap(Offset d) {
+	for(Offset k = d + 1; k <= highestAll; ++k) {
+		for(Offset v = head[k]; v != FLOW_NIL; v = next[v]) {
+			label[v] = n;
+		}
+		head[k] = FLOW_NIL;
+	}
+	highestAll = d > 0 ? d - 1 : 0;
+}
+
+/*
+ * Pushes the excess of an active vertex along admissible arcs, relabeling it
+ * whenever it runs out of them, until none is left or it is given up.
+ */
+void PushRelabel::discharge(Offset v) {
+	long long ex = excess[v];
+	while(true) {
+		Offset d = label[v];
+		size_t a = current[v];
+		size_t end = r.offsets[v+1];
+		for(; a < end; ++a) {
+			Offset w = r.heads[a];
+			if(r.caps[a] > 0 && label[w] + 1 == d) {
+				long long delta = std::min<long long>(ex, r.caps[a]);
+				r.caps[a] -= delta;
+				r.caps[r.rev[a]] += delta;
+				if(excess[w] == 0 && w != t)
+					activate(w);
+				excess[w] += delta;
+				ex -= delta;
+				if(ex == 0)
+					break;
+			}
+		}
+		work += a - current[v];
+		current[v] = a;
+		if(ex == 0)
+			break;
+
+		// relabel to one above the lowest neighbor still reachable
+		Offset low = n;
+		for(a = r.offsets[v]; a < end; ++a) {
+			if(r.caps[a] > 0)
+				low = std::min(low, label[r.heads[a]]);
+		}
+		work += end - r.offsets[v] + FLOW_ALPHA;
+		unlink(v);
+		if(head[d] == FLOW_NIL) {
+			gap(d);
+			label[v] = n;
+			break;
+		}
+		if(low + 1 >= n) {
+			label[v] = n;
+			break;
+		}
+		label[v] = low + 1;
+		current[v] = r.offsets[v];
+		link(v);
+	}
+	excess[v] = ex;
+}
+
+long long PushRelabel::run() {
+	if(s == t)
+		return 0;
+	for(size_t a = r.offsets[s]; a < r.offsets[s+1]; ++a) {
+		int32_t c = r.caps[a];
+		if(c > 0) {
+			r.caps[a] = 0;
+			r.caps[r.rev[a]] += c;
+			excess[r.heads[a]] += c;
+			excess[s] -= c;
+		}
+	}
+	globalRelabel();
+	size_t limit = FLOW_GLOBAL_FREQ * (FLOW_ALPHA * (size_t)n + r.heads.size());
+	while(true) {
+		while(highest > 0 && active[highest].empty()) {
+			--highest;
+		}
+		if(highest == 0)
+			break;
+		Offset v = active[highest].back();
+		active[highest].pop_back();
+		if(label[v] != highest || excess[v] == 0)
+			continue;
+		discharge(v);
+		if(work > limit)
+			globalRelabel();
+	}
+	// exact distances, so every vertex cut off from the sink is labeled n
+	distances();
+	return excess[t];
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// FLOW PROCEDURES                                                         //
+/////////////////////////////////////////////////////////////////////////////
+
+long long maxFlow(const CSRGraph& g, Offset s, Offset t, const FlowOptions& o,
+		MinCut& cut) {
+	StatTimer timer(STAT_MAX_FLOW);
+	cut.flow = 0;
+	cut.sourceSide.clear();
+	cut.edges.clear();
+	if(s == t)
+		return 0;
+	Residual r;
+	buildResidual(g, r);
+	PushRelabel p(r, s, t, o.parallel);
+	cut.flow = p.run();
+	for(Offset u = 0; u < g.getVertexCount(); ++u) {
+		if(p.reachesSink(u))
+			continue;
+		cut.sourceSide.push_back(u);
+		for(size_t e = g.offsets[u]; e < g.offsets[u+1]; ++e) {
+			if(p.reachesSink(g.targets[e]) && g.weights[e] > 0) {
+				FlowEdge x = {u, g.targets[e], g.weights[e]};
+				cut.edges.push_back(x);
+			}
+		}
+	}
+	return cut.flow;
+}
+
+int maxFlow(const WeightedDigraph& g, const Key& s, const Key& t,
+		const FlowOptions& o, KeyCut& cut) {
+	int source = g.getOffset(s);
+	int sink = g.getOffset(t);
+	if(source == -1 || sink == -1)
+		return -1;
+	if(source == sink)
+		return -2;
+	CSRGraph c;
+	MinCut m;
+	buildCSR(g, c);
+	maxFlow(c, source, sink, o, m);
+	cut.flow = m.flow;
+	cut.sourceSide.clear();
+	cut.edges.clear();
+	for(size_t i = 0; i < m.sourceSide.size(); ++i) {
+		cut.sourceSide.push_back(g.getKey(m.sourceSide[i]));
+	}
+	for(size_t i = 0; i < m.edges.size(); ++i) {
+		KeyCut::Edge e = {g.getKey(m.edges[i].from), g.getKey(m.edges[i].to),
+			m.edges[i].capacity};
+		cut.edges.push_back(e);
+	}
+	return 0;
+}
@@ -0,0 +1,99 @@
+#pragma once
+
+#include "Graph.h"
+#include "CSR.h"
+#include <vector>
+
+/////////////////////////////////////////////////////////////////////////////
+// FLOW STRUCTURES                                                         //
+/////////////////////////////////////////////////////////////////////////////
+
+/*
+ * Parameters of the flow procedures below. When parallel is set, the global
+ * relabeling passes, which find the residual distance of every vertex to the
+ * sink and take up much of the running time on large graphs, search
+ * level by level on every thread.
+ */
+struct FlowOptions {
+	bool parallel = false;
+};
+
+/*
+ * An edge crossing a minimum cut, whose weight is its capacity.
+ */
+struct FlowEdge {
+	Offset from;
+	Offset to;
+	Weight capacity;
+};
+
+/*
+ * A maximum flow value and a minimum cut of the same capacity. sourceSide
+ * holds the offsets of the vertices on the source's side of the cut, in
+ * ascending order, and edges the edges from those vertices to the others,
+ * in snapshot order.
+ */
+struct MinCut {
+	long long flow;
+	std::vector<Offset> sourceSide;
+	std::vector<FlowEdge> edges;
+};
+
+/*
+ * A minimum cut as keys; see MinCut.
+ */
+struct KeyCut {
+	struct Edge {
+		Key from;
+		Key to;
+		Weight capacity;
+	};
+
+	long long flow;
+	std::vector<Key> sourceSide;
+	std::vector<Edge> edges;
+};
+
+/////////////////////////////////////////////////////////////////////////////
+// FLOW PROCEDURES                                                         //
+/////////////////////////////////////////////////////////////////////////////
+
+/*
+ * Computes the maximum flow from a source to a sink, and a minimum cut,
+ * treating edge weights as capacities; edges with weights of 0 or less carry
+ * no flow. Uses highest-label push-relabel over a residual graph holding
+ * every edge and its reverse together in the rows of both ends. Labels are
+ * reset to exact residual distances by periodic global relabeling, and
+ * whenever a relabel empties a label, every vertex above it is given up as
+ * unable to reach the sink (the gap heuristic). Only the first phase is run,
+ * which settles the flow value and the cut but leaves excess at vertices cut
+ * off from the sink, so the flow on individual edges is not returned.
+ *
+ * @param g, the graph
+ * @param s, the offset of the source
+ * @param t, the offset of the sink
+ * @param o, the flow parameters
+ * @param cut, the flow value and a minimum cut returned by reference; empty
+ * with no flow if s and t are the same
+ *
+ * @return the maximum flow value
+ */
+long long maxFlow(const CSRGraph& g, Offset s, Offset t, const FlowOptions& o,
+		MinCut& cut);
+
+/*
+ * Computes the maximum flow between two vertices of a graph, and a minimum
+ * cut as keys.
+ *
+ * @param g, the graph
+ * @param s, the key of the source
+ * @param t, the key of the sink
+ * @param o, the flow parameters
+ * @param cut, the flow value and a minimum cut returned by reference
+ *
+ * @return 0 upon success
+ *        -1 if either vertex does not exist
+ *        -2 if the source and sink are the same vertex
+ */
+int maxFlow(const WeightedDigraph& g, const Key& s, const Key& t,
+		const FlowOptions& o, KeyCut& cut);
@@ -1,6 +1,18 @@
 #include "Graph.h"
+#include "Stats.h"
 #include <iostream>
 #include <fstream>
+#include <algorithm>
+#include <cstdlib>
+#include <cctype>
+#include <cerrno>
+#include <cmath>
+#include <iterator>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
 /////////////////////////////////////////////////////////////////////////////
 // AUXILIARY FUNCTION IMPLEMENTATIONS                                      //
@@ -30,32 +42,273 @@ int findGraphSlot(const std::vector<Key>& v, const Key& k) {
 	return -1;
 }
 
+/*
+ * Reads the lines of a .graph file, split into vertex keys and the text of
+ * their outgoing edges.
+ *
+ * @return 0 upon successful read
+ *        -1 upon inability to open file
+ *        -2 upon improper extension
+ */
+static int readGraphFile(const std::string& file, std::vector<Key>& vertex,
+		std::vector<Key>& edges) {
+	if(file.find(graphExt) != file.size() - 6)
+		return -2;
+	std::ifstream inFile(file);
+	if(!inFile.is_open())
+		return -1;
+	std::string line;
+	while(std::getline(inFile, line)) {
+		size_t splitPos = line.find_first_of('|');
+		vertex.push_back(trim(line.substr(0,splitPos)));
+		edges.push_back(trim(line.substr(splitPos+1,line.size())));
+	}
+	inFile.close();
+	return 0;
+}
+
+void splitEdges(const std::string& line,
+		std::vector<std::pair<Key, std::string>>& e) {
+	char curr;
+	Key nbr;
+	size_t start = 0;
+	bool acceptIn = false;
+	for(size_t j = 0; j < line.size(); ++j) {
+		curr = line[j];
+		if(curr == '[') {
+			nbr = line.substr(start,j-start);
+			start = j+1;
+		}
+		else if(curr == ']') {
+			e.push_back(std::make_pair(nbr, line.substr(start,j-start)));
+			start = j+1;
+			acceptIn = false;
+		}
+		else if((curr == ' ' || curr == '\t') && !acceptIn)
+			start++;
+		else
+			acceptIn = true;
+	}
+}
+
+/*
+ * Parses an integer written in base 10, allowing surrounding whitespace.
+ *
+ * @return true if s holds only an integer within [lo, hi]
+ */
+static bool parseInteger(const std::string& s, long long lo, long long hi,
+		long long& v) {
+	const char* first = s.c_str();
+	char* last;
+	errno = 0;
+	v = std::strtoll(first, &last, 10);
+	if(last == first || errno == ERANGE)
+		return false;
+	while(std::isspace((unsigned char)*last))
+		++last;
+	return *last == '\0' && v >= lo && v <= hi;
+}
+
+/*
+ * Parses a real number, allowing surrounding whitespace.
+ *
+ * @return true if s holds only a finite number
+ */
+static bool parseReal(const std::string& s, double& v) {
+	const char* first = s.c_str();
+	char* last;
+	v = std::strtod(first, &last);
+	if(last == first)
+		return false;
+	while(std::isspace((unsigned char)*last))
+		++last;
+	return *last == '\0' && std::isfinite(v);
+}
+
+/*
+ * The header at the start of a snapshot. The key of every vertex follows,
+ * each preceded by its length, then the out-degree of every vertex followed
+ * by the targets and weights of its edges.
+ */
+struct SnapshotHeader {
+	char magic[8];
+	uint32_t weightType;
+	uint32_t weightBytes;
+	uint64_t vertices;
+};
+
+#define SNAPSHOT_MAGIC "QGSNAP1"  // identifies a snapshot file
+
+static bool hasExtension(const std::string& file, const std::string& ext) {
+	return file.size() >= ext.size() &&
+		file.compare(file.size() - ext.size(), ext.size(), ext) == 0;
+}
+
+/*
+ * Copies the next bytes of a snapshot into v, advancing p past them.
+ *
+ * @return false if the snapshot ends first
+ */
+static bool readBytes(const std::string& s, size_t& p, void* v, size_t len) {
+	if(s.size() - p < len)
+		return false;
+	memcpy(v, &s[p], len);
+	p += len;
+	return true;
+}
+
+struct LazyFile {
+	const char* data;
+	size_t size;
+
+	LazyFile() : data(NULL), size(0) {}
+	~LazyFile() {
+		if(size > 0)
+			munmap((void*)data, size);
+	}
+};
+
+/*
+ * Moves a vertex from one bucket of a degree histogram to another, keeping
+ * the histogram no longer than the highest degree.
+ */
+static void moveDegree(std::vector<Offset>& hist, Offset from, Offset to) {
+	--hist[from];
+	if(to >= hist.size())
+		hist.resize(to + 1, 0);
+	++hist[to];
+	while(!hist.empty() && hist.back() == 0)
+		hist.pop_back();
+}
+
+/*
+ * Bytes used by a matrix row holding n weights of type W.
+ */
+template<typename W>
+static size_t rowBytes(size_t n) {
+	return n * sizeof(W);
+}
+
+// std::vector<bool> packs its rows into words of bits
+template<>
+size_t rowBytes<bool>(size_t n) {
+	return (n + 63) / 64 * sizeof(uint64_t);
+}
+
+bool WeightTraits<bool>::parse(const std::string& s, bool& w) {
+	double v;
+	w = true;
+	return parseReal(s, v);
+}
+
+bool WeightTraits<uint8_t>::parse(const std::string& s, uint8_t& w) {
+	long long v;
+	if(!parseInteger(s, 0, UINT8_MAX - 1, v))
+		return false;
+	w = v;
+	return true;
+}
+
+bool WeightTraits<int16_t>::parse(const std::string& s, int16_t& w) {
+	long long v;
+	if(!parseInteger(s, INT16_MIN + 1, INT16_MAX, v))
+		return false;
+	w = v;
+	return true;
+}
+
+bool WeightTraits<int32_t>::parse(const std::string& s, int32_t& w) {
+	long long v;
+	if(!parseInteger(s, INT32_MIN + 1LL, INT32_MAX, v))
+		return false;
+	w = v;
+	return true;
+}
+
+bool WeightTraits<float>::parse(const std::string& s, float& w) {
+	double v;
+	if(!parseReal(s, v) || std::fabs(v) > std::numeric_limits<float>::max())
+		return false;
+	w = v;
+	return true;
+}
+
+int scanWeightType(const std::string& file, WeightType& t) {
+	std::vector<Key> vertex;
+	std::vector<Key> edges;
+	int status = readGraphFile(file, vertex, edges);
+	if(status != 0)
+		return status;
+	bool unweighted = true;
+	bool integral = true;
+	long long lo = LLONG_MAX;
+	long long hi = LLONG_MIN;
+	std::vector<std::pair<Key, std::string>> e;
+	for(size_t i = 0; i < edges.size(); ++i) {
+		e.clear();
+		splitEdges(edges[i], e);
+		for(size_t j = 0; j < e.size(); ++j) {
+			long long v;
+			double r;
+			if(parseInteger(e[j].second, LLONG_MIN, LLONG_MAX, v)) {
+				lo = std::min(lo, v);
+				hi = std::max(hi, v);
+				unweighted = unweighted && v == 1;
+			}
+			else if(parseReal(e[j].second, r)) {
+				integral = false;
+				unweighted = false;
+			}
+			else
+				return -3;
+		}
+	}
+	if(unweighted)
+		t = WEIGHT_NONE;
+	else if(!integral)
+		t = WEIGHT_FLOAT;
+	else if(lo >= 0 && hi < UINT8_MAX)
+		t = WEIGHT_UINT8;
+	else if(lo > INT16_MIN && hi <= INT16_MAX)
+		t = WEIGHT_INT16;
+	else if(lo > INT32_MIN && hi <= INT32_MAX)
+		t = WEIGHT_INT32;
+	else
+		t = WEIGHT_FLOAT;
+	return 0;
+}
+
 /////////////////////////////////////////////////////////////////////////////
 // ADJACENCY MATRIX IMPLEMENTATION                                         //
 /////////////////////////////////////////////////////////////////////////////
 
-AdjMatrix::AdjMatrix() {
+template<typename W>
+BasicAdjMatrix<W>::BasicAdjMatrix() {
   size = 0;
 }
 
-Matrix AdjMatrix::accessMatrix() const{
+template<typename W>
+typename BasicAdjMatrix<W>::Rows BasicAdjMatrix<W>::accessMatrix() const{
   return data;
 }
 
-Offset AdjMatrix::getSize() const{
+template<typename W>
+Offset BasicAdjMatrix<W>::getSize() const{
   return size;
 }
 
-Offset AdjMatrix::addVertex() {
-  std::vector<Weight> v(++size, NWT);
+template<typename W>
+Offset BasicAdjMatrix<W>::addVertex() {
+  std::vector<W> v(++size, WeightTraits<W>::none());
   data.push_back(v);
   for(Offset i = 0; i < size-1; ++i) {
-    data[i].push_back(NWT);
+    data[i].push_back(WeightTraits<W>::none());
   }
   return size-1;
 }
 
-void AdjMatrix::removeVertex(Offset s) {
+template<typename W>
+void BasicAdjMatrix<W>::removeVertex(Offset s) {
   data.erase(data.begin() + s);
   --size;
   for(Offset i = 0; i < size; ++i) {
@@ -63,102 +316,365 @@ void AdjMatrix::removeVertex(Offset s) {
   }
 }
 
-void AdjMatrix::clear() {
+template<typename W>
+void BasicAdjMatrix<W>::clear() {
   data.clear();
   size = 0;
 }
 
-void AdjMatrix::addEdge(Offset s1, Offset s2, Weight w) {
+template<typename W>
+void BasicAdjMatrix<W>::addEdge(Offset s1, Offset s2, W w) {
   data[s1][s2] = w;
 }
 
-void AdjMatrix::removeEdge(Offset s1, Offset s2) {
-  data[s1][s2] = NWT;
+template<typename W>
+void BasicAdjMatrix<W>::removeEdge(Offset s1, Offset s2) {
+  data[s1][s2] = WeightTraits<W>::none();
 }
 
-bool AdjMatrix::isEdge(Offset s1, Offset s2) const{
-  return data[s1][s2] != NWT;
+template<typename W>
+bool BasicAdjMatrix<W>::isEdge(Offset s1, Offset s2) const{
+  return WeightTraits<W>::isEdge(data[s1][s2]);
 }
 
-Weight AdjMatrix::getWeight(Offset s1, Offset s2) const{
+template<typename W>
+W BasicAdjMatrix<W>::getWeight(Offset s1, Offset s2) const{
   return data[s1][s2];
 }
 
-void AdjMatrix::getNeighbors(Offset s, std::vector<Offset>& n) const{
+template<typename W>
+void BasicAdjMatrix<W>::getNeighbors(Offset s, std::vector<Offset>& n) const{
+  // write every offset and advance past the edges only, so that the scan
+  // does not branch on how dense the row is
+  const std::vector<W>& row = data[s];
+  size_t k = n.size();
+  n.resize(k + size);
   for(Offset i = 0; i < size; ++i) {
-  	if(data[s][i] != NWT)
-      n.push_back(i);
+    n[k] = i;
+    k += WeightTraits<W>::isEdge(row[i]);
   }
+  n.resize(k);
 }
 
-void AdjMatrix::print() const{
+template<typename W>
+void BasicAdjMatrix<W>::print() const{
   for(Offset i = 0; i < size; ++i) {
     for(Offset j = 0; j < size; ++j) {
-			if(data[i][j] == NWT)
+			if(!WeightTraits<W>::isEdge(data[i][j]))
 				std::cout << "NWT" << " ";
 			else
-        std::cout << data[i][j] << " ";
+        std::cout << (typename WeightTraits<W>::Printable)data[i][j] << " ";
     }
     std::cout << std::endl;
   }
 }
 
+template<typename W>
+void BasicAdjMatrix<W>::memoryUsage(MemComponent& rows, MemComponent& headers) const{
+  rows.live = rows.slack = 0;
+  for(Offset i = 0; i < size; ++i) {
+    rows.live += rowBytes<W>(data[i].size());
+    rows.slack += rowBytes<W>(data[i].capacity()) - rowBytes<W>(data[i].size());
+  }
+  headers.live = data.size() * sizeof(std::vector<W>);
+  headers.slack = (data.capacity() - data.size()) * sizeof(std::vector<W>);
+}
+
+template<typename W>
+void BasicAdjMatrix<W>::shrinkToFit() {
+  for(Offset i = 0; i < size; ++i) {
+    data[i].shrink_to_fit();
+  }
+  data.shrink_to_fit();
+}
+
+template<typename W>
+void BasicAdjMatrix<W>::permute(const std::vector<Offset>& order) {
+  Rows p(size);
+  for(Offset i = 0; i < size; ++i) {
+    const std::vector<W>& row = data[order[i]];
+    p[i].resize(size);
+    for(Offset j = 0; j < size; ++j) {
+      p[i][j] = row[order[j]];
+    }
+  }
+  data.swap(p);
+}
+
+template<typename W>
+void BasicAdjMatrix<W>::reset(Offset n) {
+  Rows(n, std::vector<W>(n, WeightTraits<W>::none())).swap(data);
+  size = n;
+}
+
 /////////////////////////////////////////////////////////////////////////////
 // GRAPH IMPLEMENTATION                                                    //
 /////////////////////////////////////////////////////////////////////////////
 
-WeightedDigraph::WeightedDigraph() {}
+template<typename W>
+BasicWeightedDigraph<W>::BasicWeightedDigraph() : reverseOn(false),
+		edgeCount(0), pendingCount(0), pendingSkipped(0) {}
+
+template<typename W>
+void BasicWeightedDigraph<W>::linkEdge(Offset s1, Offset s2, W w) const{
+	matrix.addEdge(s1, s2, w);
+	if(reverseOn)
+		reverse.addEdge(s2, s1, true);
+	countEdge(s1, s2, true);
+}
+
+template<typename W>
+void BasicWeightedDigraph<W>::unlinkEdge(Offset s1, Offset s2) {
+	matrix.removeEdge(s1, s2);
+	if(reverseOn)
+		reverse.removeEdge(s2, s1);
+	countEdge(s1, s2, false);
+}
+
+template<typename W>
+void BasicWeightedDigraph<W>::countEdge(Offset s1, Offset s2, bool added) const{
+	Offset out = outDegree[s1];
+	Offset in = inDegree[s2];
+	outDegree[s1] = added ? out + 1 : out - 1;
+	inDegree[s2] = added ? in + 1 : in - 1;
+	moveDegree(outHistogram, out, outDegree[s1]);
+	moveDegree(inHistogram, in, inDegree[s2]);
+	edgeCount = added ? edgeCount + 1 : edgeCount - 1;
+}
+
+template<typename W>
+void BasicWeightedDigraph<W>::resetDegrees(Offset n) const{
+	outDegree.assign(n, 0);
+	inDegree.assign(n, 0);
+	outHistogram.assign(n > 0 ? 1 : 0, n);
+	inHistogram.assign(n > 0 ? 1 : 0, n);
+	edgeCount = 0;
+}
 
-bool WeightedDigraph::addVertex(const Key& k) {
-  if(contains(vertices, k))
+template<typename W>
+bool BasicWeightedDigraph<W>::addVertex(const Key& k) {
+  StatTimer timer(STAT_ADD_VERTEX);
+  if(index.count(k))
   	return false;
+  index[k] = vertices.size();
   vertices.push_back(k); 
   matrix.addVertex();
+  if(reverseOn)
+    reverse.addVertex();
+  outDegree.push_back(0);
+  inDegree.push_back(0);
+  if(outHistogram.empty())
+    outHistogram.push_back(0);
+  if(inHistogram.empty())
+    inHistogram.push_back(0);
+  ++outHistogram[0];
+  ++inHistogram[0];
+  if(pendingCount > 0) {
+    Span none = {0, 0};
+    pending.push_back(none);
+  }
   return true;
 }
 
-bool WeightedDigraph::removeVertex(const Key& k) {
-  int p = findGraphSlot(vertices, k);
+template<typename W>
+bool BasicWeightedDigraph<W>::removeVertex(const Key& k) {
+  StatTimer timer(STAT_REMOVE_VERTEX);
+  int p = getOffset(k);
   if(p == -1)
   	return false;
+  parseAll();
+
+  // uncount the edges of p, then p itself
+  std::vector<Offset> nbrs;
+  matrix.getNeighbors(p, nbrs);
+  for(size_t i = 0; i < nbrs.size(); ++i) {
+    countEdge(p, nbrs[i], false);
+  }
+  for(Offset i = 0; i < vertices.size(); ++i) {
+    if(matrix.isEdge(i, p) && i != (Offset)p)
+      countEdge(i, p, false);
+  }
+  --outHistogram[0];
+  --inHistogram[0];
+  while(!outHistogram.empty() && outHistogram.back() == 0)
+    outHistogram.pop_back();
+  while(!inHistogram.empty() && inHistogram.back() == 0)
+    inHistogram.pop_back();
+  outDegree.erase(outDegree.begin() + p);
+  inDegree.erase(inDegree.begin() + p);
+  index.erase(k);
+  for(auto itr = index.begin(); itr != index.end(); ++itr) {
+    if(itr->second > (Offset)p)
+      --itr->second;
+  }
   vertices.erase(vertices.begin() + p);
   matrix.removeVertex(p);
+  if(reverseOn)
+    reverse.removeVertex(p);
   return true;
 }
 
-void WeightedDigraph::clear() {
+template<typename W>
+void BasicWeightedDigraph<W>::clear() {
   vertices.clear();
+  index.clear();
   matrix.clear();
+  reverse.clear();
+  resetDegrees(0);
+  source.reset();
+  pending.clear();
+  pendingCount = 0;
+  pendingSkipped = 0;
 }
 
-int WeightedDigraph::fileLoad(const std::string& file) {
-  if(file.find(graphExt) != file.size() - 6)
-	  return -2;
+template<typename W>
+int BasicWeightedDigraph<W>::fileLoad(const std::string& file) {
+  StatTimer timer(STAT_FILE_LOAD);
   std::vector<Key> vertex;
   std::vector<Key> neighbor;
-  std::string line;
-  std::ifstream inFile(file);
-  if(inFile.is_open()) {
-    this->clear();
-    while(std::getline(inFile, line)) {
-      size_t splitPos = line.find_first_of('|');
-      vertex.push_back(trim(line.substr(0,splitPos)));
-      neighbor.push_back(trim(line.substr(splitPos+1,line.size())));
-    }
-    inFile.close();
-  }
-  else
-  	return -1;
+  int status = readGraphFile(file, vertex, neighbor);
+  if(status != 0)
+    return status;
+  this->clear();
   for(size_t i = 0; i < vertex.size(); ++i) {
     this->addVertex(vertex[i]);
   }
-  this->loadEdges(vertex,neighbor);
+  if(this->loadEdges(vertex,neighbor) > 0)
+    return -3;
   return 0; 
 }
 
-int WeightedDigraph::fileWrite(const std::string& file) const{
+template<typename W>
+int BasicWeightedDigraph<W>::lazyLoad(const std::string& file) {
+	StatTimer timer(STAT_LAZY_LOAD);
+	if(file.find(graphExt) != file.size() - 6)
+		return -2;
+	int fd = open(file.c_str(), O_RDONLY);
+	if(fd == -1)
+		return -1;
+	std::shared_ptr<LazyFile> f(new LazyFile);
+	struct stat st;
+	bool ok = fstat(fd, &st) == 0;
+	if(ok && st.st_size > 0) {
+		void* p = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+		ok = p != MAP_FAILED;
+		if(ok) {
+			f->data = (const char*)p;
+			f->size = st.st_size;
+		}
+	}
+	::close(fd);
+	if(!ok)
+		return -1;
+	this->clear();
+
+	// one pass over the lines, as readGraphFile splits them, noting where
+	// each edge list lies rather than copying it
+	const char* d = f->data;
+	std::vector<std::pair<Offset, Span>> repeats;
+	size_t pos = 0;
+	while(pos < f->size) {
+		const char* nl = (const char*)memchr(d + pos, '\n', f->size - pos);
+		size_t end = nl != NULL ? nl - d : f->size;
+		const char* bar = (const char*)memchr(d + pos, '|', end - pos);
+		size_t keyEnd = bar != NULL ? bar - d : end;
+
+		// without a '|', the whole line is both key and edge list
+		Span text = {bar != NULL ? keyEnd + 1 : pos, end};
+		while(text.begin < text.end && (d[text.begin] == ' ' || d[text.begin] == '\t'))
+			++text.begin;
+		while(text.end > text.begin && (d[text.end-1] == ' ' || d[text.end-1] == '\t'))
+			--text.end;
+		Key k = trim(std::string(d + pos, keyEnd - pos));
+		auto ins = index.insert(std::make_pair(k, (Offset)vertices.size()));
+		if(ins.second) {
+			vertices.push_back(k);
+			pending.push_back(text);
+			if(text.begin < text.end)
+				++pendingCount;
+		}
+		else if(text.begin < text.end)
+			repeats.push_back(std::make_pair(ins.first->second, text));
+		pos = end + 1;
+	}
+	matrix.reset(vertices.size());
+	if(reverseOn)
+		reverse.reset(vertices.size());
+	resetDegrees(vertices.size());
+	source = f;
+
+	// a key listed twice has both edge lists applied in file order, as
+	// fileLoad does
+	for(size_t i = 0; i < repeats.size(); ++i) {
+		materializeRow(repeats[i].first);
+		parseEdges(repeats[i].first, d, repeats[i].second);
+	}
+	if(pendingCount == 0)
+		parseAll();
+	return 0;
+}
+
+template<typename W>
+void BasicWeightedDigraph<W>::parseEdges(Offset s, const char* data,
+		const Span& text) const{
+	std::string line(data + text.begin, text.end - text.begin);
+	std::vector<std::pair<Key, std::string>> e;
+	splitEdges(line, e);
+	for(size_t j = 0; j < e.size(); ++j) {
+		W wt;
+		if(!WeightTraits<W>::parse(e[j].second, wt)) {
+			++pendingSkipped;
+			continue;
+		}
+		auto itr = index.find(e[j].first);
+		if(itr == index.end())
+			continue;
+		if(matrix.isEdge(s, itr->second))
+			matrix.addEdge(s, itr->second, wt);
+		else
+			linkEdge(s, itr->second, wt);
+	}
+}
+
+template<typename W>
+void BasicWeightedDigraph<W>::parsePending(Offset s) const{
+	Span text = pending[s];
+	if(text.begin == text.end)
+		return;
+	pending[s].end = text.begin;
+	parseEdges(s, source->data, text);
+	if(--pendingCount == 0) {
+		source.reset();
+		std::vector<Span>().swap(pending);
+	}
+}
+
+template<typename W>
+void BasicWeightedDigraph<W>::parseAll() const{
+	for(Offset i = 0; pendingCount > 0 && i < vertices.size(); ++i) {
+		parsePending(i);
+	}
+	source.reset();
+	std::vector<Span>().swap(pending);
+}
+
+template<typename W>
+size_t BasicWeightedDigraph<W>::materialize() const{
+	parseAll();
+	return pendingSkipped;
+}
+
+template<typename W>
+Offset BasicWeightedDigraph<W>::getPendingCount() const{
+	return pendingCount;
+}
+
+template<typename W>
+int BasicWeightedDigraph<W>::fileWrite(const std::string& file) const{
+  StatTimer timer(STAT_FILE_WRITE);
   if(file.find(graphExt) != file.size() - 6)
 	  return -2;
+  parseAll();
   std::ofstream outFile(file);
   if(outFile.is_open()) {
     std::vector<Offset> nbrs;
@@ -166,7 +682,8 @@ int WeightedDigraph::fileWrite(const std::string& file) const{
       matrix.getNeighbors(i,nbrs); 
       outFile << vertices[i] << " | ";
       for(Offset j = 0; j < nbrs.size(); ++j) {
-        outFile << vertices[nbrs[j]] << "[" << matrix.getWeight(i,nbrs[j])
+        outFile << vertices[nbrs[j]] << "["
+        << (typename WeightTraits<W>::Printable)matrix.getWeight(i,nbrs[j])
         << "] ";
       }
       outFile << std::endl;
@@ -180,50 +697,170 @@ int WeightedDigraph::fileWrite(const std::string& file) const{
 }
 
 
-int WeightedDigraph::setEdge(const Key& k1, const Key& k2, Weight w) {
-	int p1 = findGraphSlot(vertices, k1);
-	int p2 = findGraphSlot(vertices, k2);
+template<typename W>
+int BasicWeightedDigraph<W>::snapshotWrite(const std::string& file) const{
+	StatTimer timer(STAT_SNAPSHOT_WRITE);
+	if(!hasExtension(file, snapshotExt))
+		return -2;
+	parseAll();
+	std::ofstream out(file, std::ios::binary);
+	if(!out.is_open())
+		return -1;
+	SnapshotHeader h;
+	memcpy(h.magic, SNAPSHOT_MAGIC, sizeof(h.magic));
+	h.weightType = WeightTraits<W>::type();
+	h.weightBytes = sizeof(W);
+	h.vertices = vertices.size();
+	out.write((const char*)&h, sizeof(h));
+	for(Offset i = 0; i < vertices.size(); ++i) {
+		uint32_t len = vertices[i].size();
+		out.write((const char*)&len, sizeof(len));
+		out.write(vertices[i].data(), len);
+	}
+	// weights are copied out one at a time, since rows of bool are packed
+	std::vector<Offset> nbrs;
+	std::string w;
+	for(Offset i = 0; i < vertices.size(); ++i) {
+		nbrs.clear();
+		w.clear();
+		matrix.getNeighbors(i, nbrs);
+		for(size_t j = 0; j < nbrs.size(); ++j) {
+			W x = matrix.getWeight(i, nbrs[j]);
+			w.append((const char*)&x, sizeof(W));
+		}
+		uint32_t degree = nbrs.size();
+		out.write((const char*)&degree, sizeof(degree));
+		if(degree > 0) {
+			out.write((const char*)&nbrs[0], degree * sizeof(Offset));
+			out.write(w.data(), w.size());
+		}
+	}
+	out.close();
+	return out.fail() ? -1 : 0;
+}
+
+template<typename W>
+int BasicWeightedDigraph<W>::snapshotLoad(const std::string& file) {
+	StatTimer timer(STAT_SNAPSHOT_LOAD);
+	if(!hasExtension(file, snapshotExt))
+		return -2;
+	std::ifstream in(file, std::ios::binary);
+	if(!in.is_open())
+		return -1;
+	std::string s((std::istreambuf_iterator<char>(in)),
+			std::istreambuf_iterator<char>());
+	size_t p = 0;
+	SnapshotHeader h;
+	this->clear();
+	if(!readBytes(s, p, &h, sizeof(h)) || memcmp(h.magic, SNAPSHOT_MAGIC,
+			sizeof(h.magic)) || h.weightType != (uint32_t)WeightTraits<W>::type()
+			|| h.weightBytes != sizeof(W) || h.vertices > s.size())
+		return -3;
+
+	// every key takes at least its length, so h.vertices is bounded by the
+	// file size before anything is allocated for it
+	vertices.resize(h.vertices);
+	for(Offset i = 0; i < h.vertices; ++i) {
+		uint32_t len;
+		if(!readBytes(s, p, &len, sizeof(len)) || s.size() - p < len) {
+			this->clear();
+			return -3;
+		}
+		vertices[i].assign(s, p, len);
+		p += len;
+		if(!index.insert(std::make_pair(vertices[i], i)).second) {
+			this->clear();
+			return -3;
+		}
+	}
+	matrix.reset(h.vertices);
+	if(reverseOn)
+		reverse.reset(h.vertices);
+	resetDegrees(h.vertices);
+	std::vector<Offset> nbrs;
+	for(Offset i = 0; i < h.vertices; ++i) {
+		uint32_t degree;
+		bool ok = readBytes(s, p, &degree, sizeof(degree)) && degree <= h.vertices;
+		if(ok) {
+			nbrs.resize(degree);
+			ok = (degree == 0 || readBytes(s, p, &nbrs[0], degree * sizeof(Offset)))
+				&& s.size() - p >= degree * sizeof(W);
+		}
+		for(size_t j = 0; ok && j < degree; ++j) {
+			W x;
+			readBytes(s, p, &x, sizeof(W));
+			ok = nbrs[j] < h.vertices && WeightTraits<W>::isEdge(x);
+			if(ok && matrix.isEdge(i, nbrs[j]))
+				matrix.addEdge(i, nbrs[j], x);
+			else if(ok)
+				linkEdge(i, nbrs[j], x);
+		}
+		if(!ok) {
+			this->clear();
+			return -3;
+		}
+	}
+	return 0;
+}
+
+template<typename W>
+int BasicWeightedDigraph<W>::setEdge(const Key& k1, const Key& k2, W w) {
+	StatTimer timer(STAT_SET_EDGE);
+	int p1 = getOffset(k1);
+	int p2 = getOffset(k2);
 	if(p1 == -1 || p2 == -1)
 		return -1;
-	int retVal = 0;
-	if(matrix.isEdge(p1,p2))
-		retVal = 1;
-	matrix.addEdge(p1,p2,w);
-	return retVal;
+	materializeRow(p1);
+	if(matrix.isEdge(p1,p2)) {
+		matrix.addEdge(p1,p2,w);
+		return 1;
+	}
+	linkEdge(p1,p2,w);
+	return 0;
 }
 
-int WeightedDigraph::removeEdge(const Key& k1, const Key& k2) {
-	int p1 = findGraphSlot(vertices, k1);
-	int p2 = findGraphSlot(vertices, k2);
+template<typename W>
+int BasicWeightedDigraph<W>::removeEdge(const Key& k1, const Key& k2) {
+	StatTimer timer(STAT_REMOVE_EDGE);
+	int p1 = getOffset(k1);
+	int p2 = getOffset(k2);
 	if(p1 == -1 || p2 == -1)
 		return -1;
+	materializeRow(p1);
 	if(!matrix.isEdge(p1,p2))
 		return -2;
-	matrix.removeEdge(p1,p2);
+	unlinkEdge(p1,p2);
 	return 0;
 }
 
-bool WeightedDigraph::isEdge(const Key& k1, const Key& k2) const{
-	int p1 = findGraphSlot(vertices, k1);
-	int p2 = findGraphSlot(vertices, k2);
+template<typename W>
+bool BasicWeightedDigraph<W>::isEdge(const Key& k1, const Key& k2) const{
+	int p1 = getOffset(k1);
+	int p2 = getOffset(k2);
 	if(p1 == -1 || p2 == -1) 
 		return false;
+	materializeRow(p1);
 	return matrix.isEdge(p1,p2);
 }
 
-bool WeightedDigraph::getWeight(const Key& k1, const Key& k2, Weight& w) const{
-	int p1 = findGraphSlot(vertices, k1);
-	int p2 = findGraphSlot(vertices, k2);
+template<typename W>
+bool BasicWeightedDigraph<W>::getWeight(const Key& k1, const Key& k2, W& w) const{
+	int p1 = getOffset(k1);
+	int p2 = getOffset(k2);
 	if(p1 == -1 || p2 == -1) 
 		return false;
+	materializeRow(p1);
 	w = matrix.getWeight(p1,p2); 
-	return w == NWT ? false : true;
+	return WeightTraits<W>::isEdge(w);
 }
 
-bool WeightedDigraph::getNeighbors(const Key& k, std::vector<Key>& n) const{
-	int p = findGraphSlot(vertices, k);
+template<typename W>
+bool BasicWeightedDigraph<W>::getNeighbors(const Key& k, std::vector<Key>& n) const{
+	StatTimer timer(STAT_GET_NEIGHBORS);
+	int p = getOffset(k);
 	if(p == -1)
 		return false;
+	materializeRow(p);
 	std::vector<Offset> nbr;
 	matrix.getNeighbors(p,nbr);
 	for(auto itr = nbr.begin(); itr != nbr.end(); ++itr) {
@@ -232,54 +869,300 @@ bool WeightedDigraph::getNeighbors(const Key& k, std::vector<Key>& n) const{
 	return true;
 }
 
-void WeightedDigraph::printAdjList() const{
+template<typename W>
+void BasicWeightedDigraph<W>::printAdjList() const{
+	parseAll();
 	std::vector<Offset> nbrs;
 	for(Offset i = 0; i < vertices.size(); ++i) {
 		matrix.getNeighbors(i,nbrs);
 		std::cout << vertices[i] << " | ";
 		for(Offset j = 0; j < nbrs.size(); ++j) {
-			std::cout << vertices[nbrs[j]] << "[" << matrix.getWeight(i,nbrs[j]) << "] ";
+			std::cout << vertices[nbrs[j]] << "["
+				<< (typename WeightTraits<W>::Printable)matrix.getWeight(i,nbrs[j])
+				<< "] ";
 		}
 		std::cout << std::endl;
 		nbrs.clear();
 	}
 }
 
-void WeightedDigraph::printAdjMatrix() const {
+template<typename W>
+void BasicWeightedDigraph<W>::printAdjMatrix() const {
+	parseAll();
 	matrix.print();
 }
 
-void WeightedDigraph::loadEdges(std::vector<Key>& vertex, 
+template<typename W>
+size_t BasicWeightedDigraph<W>::loadEdges(std::vector<Key>& vertex, 
         std::vector<Key>& edges) {
-	std::string line;
+	size_t skipped = 0;
+	std::vector<std::pair<Key, std::string>> e;
 	for(size_t i = 0; i < vertex.size(); ++i) {
-		line = edges[i];
-		char curr;
-		Key nbr;
-		Weight wt;
-		size_t start = 0;
-		bool acceptIn = false;
-		for(size_t j = 0; j < line.size(); ++j) {
-			curr = line[j];
-			if(curr == '[') {
-				nbr = line.substr(start,j-start);
-				start = j+1;
-			}
-			else if(curr == ']') {
-				wt = std::stoi(line.substr(start,j-start));
-				start = j+1;
-				acceptIn = false;
-				// TODO: provide error messages for setEdge
-				this->setEdge(vertex[i],nbr,wt);
+		e.clear();
+		splitEdges(edges[i], e);
+		for(size_t j = 0; j < e.size(); ++j) {
+			W wt;
+			if(!WeightTraits<W>::parse(e[j].second, wt)) {
+				++skipped;
+				continue;
 			}
-			else if((curr == ' ' || curr == '\t') && !acceptIn)
-				start++;
-			else
-				acceptIn = true;
+			// TODO: provide error messages for setEdge
+			this->setEdge(vertex[i],e[j].first,wt);
 		}
 	}
+	return skipped;
+}
+
+template<typename W>
+Offset BasicWeightedDigraph<W>::getVertexCount() const{
+	return vertices.size();
 }
 
-bool WeightedDigraph::isEmpty() const{
+template<typename W>
+int BasicWeightedDigraph<W>::getOffset(const Key& k) const{
+	auto itr = index.find(k);
+	if(itr == index.end())
+		return -1;
+	return itr->second;
+}
+
+template<typename W>
+const Key& BasicWeightedDigraph<W>::getKey(Offset s) const{
+	return vertices[s];
+}
+
+template<typename W>
+void BasicWeightedDigraph<W>::getNeighbors(Offset s, std::vector<Offset>& n) const{
+	StatTimer timer(STAT_GET_NEIGHBORS);
+	materializeRow(s);
+	matrix.getNeighbors(s,n);
+}
+
+template<typename W>
+W BasicWeightedDigraph<W>::getWeight(Offset s1, Offset s2) const{
+	materializeRow(s1);
+	return matrix.getWeight(s1,s2);
+}
+
+template<typename W>
+Offset BasicWeightedDigraph<W>::getOutDegree(Offset s) const{
+	materializeRow(s);
+	return outDegree[s];
+}
+
+template<typename W>
+Offset BasicWeightedDigraph<W>::getInDegree(Offset s) const{
+	if(pendingCount > 0)
+		parseAll();
+	return inDegree[s];
+}
+
+template<typename W>
+size_t BasicWeightedDigraph<W>::getEdgeCount() const{
+	if(pendingCount > 0)
+		parseAll();
+	return edgeCount;
+}
+
+template<typename W>
+const std::vector<Offset>& BasicWeightedDigraph<W>::getDegreeHistogram(bool in) const{
+	if(pendingCount > 0)
+		parseAll();
+	return in ? inHistogram : outHistogram;
+}
+
+template<typename W>
+void BasicWeightedDigraph<W>::getPredecessors(Offset s, std::vector<Offset>& n) const{
+	StatTimer timer(STAT_GET_PREDECESSORS);
+	if(pendingCount > 0)
+		parseAll();
+	if(reverseOn) {
+		reverse.getNeighbors(s, n);
+		return;
+	}
+	for(Offset i = 0; i < vertices.size(); ++i) {
+		if(matrix.isEdge(i, s))
+			n.push_back(i);
+	}
+}
+
+template<typename W>
+bool BasicWeightedDigraph<W>::getPredecessors(const Key& k, std::vector<Key>& n) const{
+	int p = getOffset(k);
+	if(p == -1)
+		return false;
+	std::vector<Offset> pred;
+	getPredecessors(p, pred);
+	for(size_t i = 0; i < pred.size(); ++i) {
+		n.push_back(vertices[pred[i]]);
+	}
+	return true;
+}
+
+template<typename W>
+void BasicWeightedDigraph<W>::setReverseIndex(bool on) {
+	reverseOn = on;
+	if(!on) {
+		reverse = BasicAdjMatrix<bool>();
+		return;
+	}
+
+	// built from rows already parsed; lazily loaded rows add their own
+	reverse.reset(vertices.size());
+	std::vector<Offset> nbrs;
+	for(Offset i = 0; i < vertices.size(); ++i) {
+		nbrs.clear();
+		matrix.getNeighbors(i, nbrs);
+		for(size_t j = 0; j < nbrs.size(); ++j) {
+			reverse.addEdge(nbrs[j], i, true);
+		}
+	}
+}
+
+template<typename W>
+bool BasicWeightedDigraph<W>::hasReverseIndex() const{
+	return reverseOn;
+}
+
+template<typename W>
+void BasicWeightedDigraph<W>::prefetch(Offset) const{
+}
+
+template<typename W>
+void BasicWeightedDigraph<W>::memoryUsage(std::vector<MemComponent>& m) const{
+	MemComponent rows = {"adjacency", 0, 0};
+	MemComponent headers = {"adjacency rows", 0, 0};
+	matrix.memoryUsage(rows, headers);
+	m.push_back(rows);
+	m.push_back(headers);
+
+	// keys short enough for the small-string buffer live inside the Key object
+	size_t inlineCap = Key().capacity();
+	MemComponent keys = {"keys", vertices.size() * sizeof(Key),
+			(vertices.capacity() - vertices.size()) * sizeof(Key)};
+	for(size_t i = 0; i < vertices.size(); ++i) {
+		if(vertices[i].capacity() > inlineCap) {
+			keys.live += vertices[i].size() + 1;
+			keys.slack += vertices[i].capacity() - vertices[i].size();
+		}
+	}
+	m.push_back(keys);
+
+	// index nodes hold a next pointer, the key/offset pair and a cached hash
+	size_t node = sizeof(void*) + sizeof(std::pair<const Key, Offset>) +
+		sizeof(size_t);
+	MemComponent idx = {"key index", index.size() * node, 0};
+	if(index.bucket_count() > index.size())
+		idx.slack = (index.bucket_count() - index.size()) * sizeof(void*);
+	idx.live += std::min(index.size(), index.bucket_count()) * sizeof(void*);
+	for(auto itr = index.begin(); itr != index.end(); ++itr) {
+		if(itr->first.capacity() > inlineCap)
+			idx.live += itr->first.capacity() + 1;
+	}
+	m.push_back(idx);
+
+	const std::vector<Offset>* counters[] = {&outDegree, &inDegree,
+		&outHistogram, &inHistogram};
+	MemComponent degrees = {"degrees", 0, 0};
+	for(size_t i = 0; i < 4; ++i) {
+		degrees.live += counters[i]->size() * sizeof(Offset);
+		degrees.slack += (counters[i]->capacity() - counters[i]->size()) *
+			sizeof(Offset);
+	}
+	m.push_back(degrees);
+
+	if(reverseOn) {
+		MemComponent rev = {"reverse index", 0, 0};
+		MemComponent revHeaders = {"", 0, 0};
+		reverse.memoryUsage(rev, revHeaders);
+		rev.live += revHeaders.live;
+		rev.slack += revHeaders.slack;
+		m.push_back(rev);
+	}
+
+	// the mapped file counts while edges are pending from lazyLoad
+	if(source) {
+		MemComponent lazy = {"pending edges", source->size +
+			pending.size() * sizeof(Span),
+			(pending.capacity() - pending.size()) * sizeof(Span)};
+		m.push_back(lazy);
+	}
+}
+
+template<typename W>
+size_t BasicWeightedDigraph<W>::compact() {
+	std::vector<MemComponent> before;
+	std::vector<MemComponent> after;
+	memoryUsage(before);
+	matrix.shrinkToFit();
+	reverse.shrinkToFit();
+	outDegree.shrink_to_fit();
+	inDegree.shrink_to_fit();
+	outHistogram.shrink_to_fit();
+	inHistogram.shrink_to_fit();
+	for(size_t i = 0; i < vertices.size(); ++i) {
+		vertices[i].shrink_to_fit();
+	}
+	vertices.shrink_to_fit();
+	index.rehash(0);
+	memoryUsage(after);
+	size_t freed = 0;
+	for(size_t i = 0; i < before.size(); ++i) {
+		size_t b = before[i].live + before[i].slack;
+		size_t a = after[i].live + after[i].slack;
+		if(b > a)
+			freed += b - a;
+	}
+	return freed;
+}
+
+template<typename W>
+int BasicWeightedDigraph<W>::permute(const std::vector<Offset>& order) {
+	if(order.size() != vertices.size())
+		return -1;
+	parseAll();
+	std::vector<bool> seen(order.size(), false);
+	for(size_t i = 0; i < order.size(); ++i) {
+		if(order[i] >= order.size() || seen[order[i]])
+			return -1;
+		seen[order[i]] = true;
+	}
+	matrix.permute(order);
+	if(reverseOn)
+		reverse.permute(order);
+	std::vector<Offset> out(order.size()), in(order.size());
+	for(Offset i = 0; i < order.size(); ++i) {
+		out[i] = outDegree[order[i]];
+		in[i] = inDegree[order[i]];
+	}
+	outDegree.swap(out);
+	inDegree.swap(in);
+	std::vector<Key> keys(order.size());
+	for(Offset i = 0; i < order.size(); ++i) {
+		keys[i].swap(vertices[order[i]]);
+		index[keys[i]] = i;
+	}
+	vertices.swap(keys);
+	return 0;
+}
+
+template<typename W>
+bool BasicWeightedDigraph<W>::isEmpty() const{
 	return vertices.empty();
 }
+
+/////////////////////////////////////////////////////////////////////////////
+// WEIGHT TYPE INSTANTIATIONS                                              //
+/////////////////////////////////////////////////////////////////////////////
+
+template class BasicAdjMatrix<bool>;
+template class BasicAdjMatrix<uint8_t>;
+template class BasicAdjMatrix<int16_t>;
+template class BasicAdjMatrix<int32_t>;
+template class BasicAdjMatrix<float>;
+
+template class BasicWeightedDigraph<bool>;
+template class BasicWeightedDigraph<uint8_t>;
+template class BasicWeightedDigraph<int16_t>;
+template class BasicWeightedDigraph<int32_t>;
+template class BasicWeightedDigraph<float>;
@@ -2,7 +2,11 @@
 
 #include <string>
 #include <vector>
+#include <unordered_map>
+#include <memory>
 #include <climits>
+#include <limits>
+#include <stdint.h>
 
 /////////////////////////////////////////////////////////////////////////////
 // CUSTOM DATATYPES AND CONSTANTS                                          //
@@ -18,6 +22,107 @@ typedef std::vector<std::vector<Weight>> Matrix;
 
 const std::string graphExt(".graph"); 	// file extension for reading/writing
                                             // graphs
+const std::string snapshotExt(".qgsnap");   // file extension for binary
+                                            // snapshots of graphs
+
+/*
+ * The weight types a .graph file can be loaded with, narrowest first.
+ */
+enum WeightType {
+	WEIGHT_NONE,	// bool; the file is unweighted or every weight is 1
+	WEIGHT_UINT8,
+	WEIGHT_INT16,
+	WEIGHT_INT32,
+	WEIGHT_FLOAT
+};
+
+/*
+ * Per-type properties of an edge weight, used to specialize the graph
+ * classes at compile time. none() is the sentinel stored in the adjacency
+ * matrix where there is no edge, so it cannot be used as a weight itself.
+ * isEdge() tests a stored value against it. parse() converts a weight read
+ * from a .graph file, failing if it is malformed or does not fit the type.
+ * Weights are widened to Printable when written, so that 8-bit weights are
+ * printed as numbers rather than characters. type() names the type in
+ * snapshots.
+ */
+template<typename W> struct WeightTraits;
+
+/*
+ * Unweighted edges. Every edge has weight 1 (true); weights in a file are
+ * accepted and discarded. Rows are stored as packed bits.
+ */
+template<> struct WeightTraits<bool> {
+	typedef int Printable;
+	static bool none() { return false; }
+	static bool isEdge(bool w) { return w; }
+	static bool parse(const std::string& s, bool& w);
+	static WeightType type() { return WEIGHT_NONE; }
+};
+
+/*
+ * Weights in the range [0, 254].
+ */
+template<> struct WeightTraits<uint8_t> {
+	typedef unsigned Printable;
+	static uint8_t none() { return UINT8_MAX; }
+	static bool isEdge(uint8_t w) { return w != UINT8_MAX; }
+	static bool parse(const std::string& s, uint8_t& w);
+	static WeightType type() { return WEIGHT_UINT8; }
+};
+
+/*
+ * Weights in the range [SHRT_MIN + 1, SHRT_MAX]. Weight is this type, and
+ * NWT its sentinel.
+ */
+template<> struct WeightTraits<int16_t> {
+	typedef int Printable;
+	static int16_t none() { return INT16_MIN; }
+	static bool isEdge(int16_t w) { return w != INT16_MIN; }
+	static bool parse(const std::string& s, int16_t& w);
+	static WeightType type() { return WEIGHT_INT16; }
+};
+
+/*
+ * Weights in the range [INT_MIN + 1, INT_MAX].
+ */
+template<> struct WeightTraits<int32_t> {
+	typedef int32_t Printable;
+	static int32_t none() { return INT32_MIN; }
+	static bool isEdge(int32_t w) { return w != INT32_MIN; }
+	static bool parse(const std::string& s, int32_t& w);
+	static WeightType type() { return WEIGHT_INT32; }
+};
+
+/*
+ * Finite single-precision weights. The sentinel is NaN, which compares
+ * unequal to itself.
+ */
+template<> struct WeightTraits<float> {
+	typedef float Printable;
+	static float none() { return std::numeric_limits<float>::quiet_NaN(); }
+	static bool isEdge(float w) { return w == w; }
+	static bool parse(const std::string& s, float& w);
+	static WeightType type() { return WEIGHT_FLOAT; }
+};
+
+/*
+ * Memory used by one component of a graph's storage, in bytes. Live bytes
+ * hold data in use; slack bytes are allocated capacity beyond it, which
+ * compact() can give back to the allocator. Allocator bookkeeping overhead
+ * is not counted.
+ */
+struct MemComponent {
+	std::string name;
+	size_t live;
+	size_t slack;
+};
+
+/*
+ * A .graph file mapped into memory by lazyLoad, shared by the copies of a
+ * graph whose edge lists it still holds.
+ */
+struct LazyFile;
 
 /////////////////////////////////////////////////////////////////////////////
 // AUXILIARY FUNCTION DEFINITIONS                                          //
@@ -53,6 +158,33 @@ bool contains(const std::vector<Key>& v, const Key& k);
  */
 int findGraphSlot(const std::vector<Key>& v, const Key& k);
 
+/*
+ * Splits the text of a vertex's outgoing edges in a .graph file, formatted
+ * as <neighbor1>[weight1] <neighbor2>[weight2] ..., into neighbor keys and
+ * the unparsed text of their weights.
+ *
+ * @param line, the text following the '|' of a line
+ * @param e, the neighbor and weight text of every edge appended to by
+ * reference
+ */
+void splitEdges(const std::string& line,
+		std::vector<std::pair<Key, std::string>>& e);
+
+/*
+ * Scans the weights of a .graph file, without loading it, to determine the
+ * narrowest weight type that holds all of them. Integral weights too wide for
+ * WEIGHT_INT32 are reported as WEIGHT_FLOAT, which holds them approximately.
+ *
+ * @param file, name of the file to scan
+ * @param t, the narrowest fitting weight type returned by reference
+ *
+ * @return 0 upon successful scan
+ *        -1 upon unsuccessful scan due to inability to open file
+ *        -2 upon unsuccessful scan due to improper extension
+ *        -3 upon unsuccessful scan due to a malformed weight
+ */
+int scanWeightType(const std::string& file, WeightType& t);
+
 /////////////////////////////////////////////////////////////////////////////
 // GRAPH STRUCTURES AND CLASSES                                            //
 /////////////////////////////////////////////////////////////////////////////
@@ -66,20 +198,24 @@ int findGraphSlot(const std::vector<Key>& v, const Key& k);
  * Convention dictates that for adjacency matrix A, the value stored in A[i][j] 
  * denotes the weight of the edge starting at i and going to j. This value is
  * equal to the defined NWT if there is no edge starting at i and going
- * to j. Weights are signed, and can be within the range of [SHRT_MIN, SHRT_MAX].
+ * to j. The matrix is templated on the weight type W, whose WeightTraits give
+ * the sentinel; AdjMatrix stores Weight, where the sentinel is NWT.
  */
-class AdjMatrix {
+template<typename W>
+class BasicAdjMatrix {
+  public:
+    typedef std::vector<std::vector<W>> Rows;
   private:
     Offset size;
-    Matrix data;
+    Rows data;
   public:
     /* Constructor */
-    AdjMatrix();
+    BasicAdjMatrix();
 
 		/*
 		 * TESTING PURPOSES ONLY
 		 */
-		Matrix accessMatrix() const;
+		Rows accessMatrix() const;
 
 		/*
 		 * TESTING PURPOSES ONLY
@@ -115,7 +251,7 @@ class AdjMatrix {
 		 * @param s2, the second slot in the array
 		 * @param w, the weight to assign to the edge
 		 */
-		void addEdge(Offset s1, Offset s2, Weight w);
+		void addEdge(Offset s1, Offset s2, W w);
 		
 		/*
 		 * Sets data[s1][s2] to value NWT, denoting the lack of an edge
@@ -147,7 +283,7 @@ class AdjMatrix {
 		 *
 		 * @return the weight associated with edge from s1 to s2; data[s1][s2]
 		 */
-		Weight getWeight(Offset s1, Offset s2) const;
+		W getWeight(Offset s1, Offset s2) const;
 
 		/*
 		 * Retrieves the neighboring offsets of s that are not equal to
@@ -165,17 +301,129 @@ class AdjMatrix {
 		 * ...
 		 */
 		void print() const;
+
+		/*
+		 * Determines the bytes used by the weights in the matrix rows, and by
+		 * the row headers themselves.
+		 *
+		 * @param rows, memory used by row weights returned by reference
+		 * @param headers, memory used by row headers returned by reference
+		 */
+		void memoryUsage(MemComponent& rows, MemComponent& headers) const;
+
+		/*
+		 * Releases capacity held by the matrix beyond its current size.
+		 */
+		void shrinkToFit();
+
+		/*
+		 * Rearranges the slots of the matrix, so that slot i takes the row and
+		 * column of slot order[i]. Builds one new copy of the matrix.
+		 *
+		 * @param order, a permutation of the slots
+		 */
+		void permute(const std::vector<Offset>& order);
+
+		/*
+		 * Replaces the matrix with one of n slots and no edges, allocating
+		 * every row once.
+		 *
+		 * @param n, the number of slots
+		 */
+		void reset(Offset n);
 };
 
+typedef BasicAdjMatrix<Weight> AdjMatrix;
+
 /*
  * Weighted directed graph structure implemented using an adjacency matrix to
  * keep track of edges and their respective weights, and a dynamic array of
  * vertices in order to maintain a string-key association with vertices.
+ *
+ * The graph is templated on the weight type W, one of those with
+ * WeightTraits. WeightedDigraph uses Weight, and is what the algorithms take.
+ *
+ * Const access is not thread-safe while edges are pending from lazyLoad:
+ * reading a row parses it, updating the degree counters and the reverse
+ * matrix, and parsing the last row releases the file. Call materialize()
+ * before sharing a lazily loaded graph between threads.
  */
-class WeightedDigraph {
+template<typename W>
+class BasicWeightedDigraph {
 	private:
-		AdjMatrix matrix;
+		// rows pending from lazyLoad are filled in by const accessors
+		mutable BasicAdjMatrix<W> matrix;
 		std::vector<Key> vertices;
+		std::unordered_map<Key, Offset> index;	// key -> offset in vertices
+
+		// transpose of matrix while reverseOn: row s marks the predecessors
+		// of s; filled in alongside matrix, lazily loaded rows included
+		mutable BasicAdjMatrix<bool> reverse;
+		bool reverseOn;
+
+		// degree of every vertex, and the number of vertices of each degree;
+		// mutable, since lazily loaded rows are counted as they are parsed
+		mutable std::vector<Offset> outDegree;
+		mutable std::vector<Offset> inDegree;
+		mutable std::vector<Offset> outHistogram;
+		mutable std::vector<Offset> inHistogram;
+		mutable size_t edgeCount;
+
+		/*
+		 * Adds an edge from s1 to s2, which must not already exist, to the
+		 * matrices and counters.
+		 */
+		void linkEdge(Offset s1, Offset s2, W w) const;
+
+		/*
+		 * Removes the edge from s1 to s2 from the matrices and counters.
+		 */
+		void unlinkEdge(Offset s1, Offset s2);
+
+		/*
+		 * Counts an edge from s1 to s2 as added or removed in the degree
+		 * counters alone.
+		 */
+		void countEdge(Offset s1, Offset s2, bool added) const;
+
+		/*
+		 * Resets the degree counters to n vertices and no edges.
+		 */
+		void resetDegrees(Offset n) const;
+
+		/*
+		 * Edge lists of a lazily loaded graph not yet parsed. pending holds,
+		 * for each vertex, the span of source text listing its edges, empty
+		 * once parsed. Both are released once no edges are pending.
+		 */
+		struct Span {
+			size_t begin;
+			size_t end;
+		};
+		mutable std::shared_ptr<const LazyFile> source;
+		mutable std::vector<Span> pending;
+		mutable Offset pendingCount;    // vertices whose edges are pending
+		mutable size_t pendingSkipped;  // edges skipped while parsing them
+
+		/*
+		 * Parses the pending edges of the vertex at offset s, if any.
+		 */
+		void materializeRow(Offset s) const {
+			if(pendingCount > 0)
+				parsePending(s);
+		}
+		void parsePending(Offset s) const;
+
+		/*
+		 * Parses every pending edge list, then releases the source.
+		 */
+		void parseAll() const;
+
+		/*
+		 * Adds the edges listed in a span of source text to the vertex at
+		 * offset s, counting those skipped in pendingSkipped.
+		 */
+		void parseEdges(Offset s, const char* data, const Span& text) const;
 
 		/*
 		 * Auxiliary function for fileLoad(const std::string& file).
@@ -185,11 +433,14 @@ class WeightedDigraph {
 		 * @param vertex, the vertex keys
 		 * @param edges, the outgoing edges in 1-to-1 correspondence with
 		 * the vertex keys
+		 *
+		 * @return the number of edges skipped due to a weight that does not
+		 *         fit W
 		 */
-		void loadEdges(std::vector<Key>& vertex, std::vector<Key>& edges);
+		size_t loadEdges(std::vector<Key>& vertex, std::vector<Key>& edges);
 	public:
 		/* Constructor */
-		WeightedDigraph();
+		BasicWeightedDigraph();
 			
 		/*
 		 * Adds a vertex to the graph.
@@ -233,11 +484,52 @@ class WeightedDigraph {
 		 *
 		 * @param file, name of the file to load graph from
 		 *
+		 * Edges whose weight is malformed or does not fit W are skipped; use
+		 * scanWeightType() to pick a W that fits the file.
+		 *
 		 * @return 0 upon successful load
 		 *        -1 upon unsuccessful load due to inability to open file
  *        -2 upon unsuccessful load due to improper extension
+		 *        -3 upon a load that skipped edges due to their weights
 		 */
 		 int fileLoad(const std::string& file);
+
+		/*
+		 * Clears current graph. Then loads a .graph file lazily: a single
+		 * pass over the file, which is mapped into memory, adds every vertex
+		 * and notes where its edges are listed, and each vertex's edges are
+		 * parsed the first time anything reads or edits them. Removing a
+		 * vertex, renumbering or writing the graph parses every edge first.
+		 *
+		 * Const accessors then modify the graph, so it must not be read
+		 * concurrently until materialize() has been called.
+		 *
+		 * @param file, name of the file to load graph from
+		 *
+		 * @return 0 upon successful load
+		 *        -1 upon unsuccessful load due to inability to open file
+		 *        -2 upon unsuccessful load due to improper extension
+		 */
+		int lazyLoad(const std::string& file);
+
+		/*
+		 * Parses every edge still pending from lazyLoad, and releases the
+		 * file. Const, like the accessors that parse rows as they go, so that
+		 * procedures taking a const graph can parse it before reading it from
+		 * several threads.
+		 *
+		 * @return the number of edges skipped since lazyLoad due to a weight
+		 *         that does not fit W, as fileLoad reports with -3
+		 */
+		size_t materialize() const;
+
+		/*
+		 * Retrieves the number of vertices whose edges are pending from
+		 * lazyLoad.
+		 *
+		 * @return the number of vertices not yet parsed
+		 */
+		Offset getPendingCount() const;
 	
 		/*
 		 * Writes the current graph to the disk using the file name specified.
@@ -250,6 +542,33 @@ class WeightedDigraph {
  *        -2 upon unsuccessful write due to improper extension
 		 */ 
 		int fileWrite(const std::string& file) const;
+
+		/*
+		 * Writes the graph as a binary snapshot: its keys, then the edges of
+		 * every vertex. Much faster to write and load than a .graph file,
+		 * but tied to W and to the byte order of the machine.
+		 *
+		 * @param file, the name of the file to write
+		 *
+		 * @return 0 upon successful write
+		 *        -1 upon inability to write file
+		 *        -2 upon improper extension
+		 */
+		int snapshotWrite(const std::string& file) const;
+
+		/*
+		 * Replaces the graph with one read from a binary snapshot. Offsets are
+		 * those of the graph the snapshot was written from.
+		 *
+		 * @param file, the name of the file to load
+		 *
+		 * @return 0 upon successful load
+		 *        -1 upon inability to open file
+		 *        -2 upon improper extension
+		 *        -3 upon a file that is not a snapshot of a graph of W, or is
+		 *         truncated; the graph is left empty
+		 */
+		int snapshotLoad(const std::string& file);
 		 
 		/*
 		 * Sets the weight associated with the edge going from k1 to k2 to
@@ -270,7 +589,7 @@ class WeightedDigraph {
 		 *         1 if edge was successfully created, but overwrote an
 		 *         existing edge weight between k1 and k2
 		 */ 
-		int setEdge(const Key& k1, const Key& k2, Weight w);
+		int setEdge(const Key& k1, const Key& k2, W w);
 		
 		/*
 		 * Remove an existing edge between k1 and k2.
@@ -326,7 +645,7 @@ class WeightedDigraph {
 		 *         false if there is not an edge between k1 and k2, or if k1
 		 *         or k2 does not exist
 		 */
-		bool getWeight(const Key& k1, const Key& k2, Weight& w) const;
+		bool getWeight(const Key& k1, const Key& k2, W& w) const;
 		
 		/*
 		 * Retrieves the neighbors of vertex k in graph.
@@ -364,8 +683,166 @@ class WeightedDigraph {
 		 */
 		void printAdjMatrix() const;
 
+		/*
+		 * Retrieves the number of vertices in the graph. Valid offsets for the
+		 * offset-based functions below are in the range [0, getVertexCount()).
+		 *
+		 * @return the number of vertices
+		 */
+		Offset getVertexCount() const;
+
+		/*
+		 * Determines the offset at which vertex k is stored. Offsets are
+		 * stable until the next removeVertex, clear or fileLoad.
+		 *
+		 * @param k, the vertex key
+		 *
+		 * @return the offset of k
+		 *         -1 if k does not exist
+		 */
+		int getOffset(const Key& k) const;
+
+		/*
+		 * Retrieves the key of the vertex stored at offset s.
+		 *
+		 * @param s, a valid vertex offset
+		 *
+		 * @return the key of the vertex at s
+		 */
+		const Key& getKey(Offset s) const;
+
+		/*
+		 * Retrieves the offsets of the neighbors of the vertex at offset s.
+		 *
+		 * @param s, a valid vertex offset
+		 * @param n, list of neighboring offsets appended to by reference
+		 */
+		void getNeighbors(Offset s, std::vector<Offset>& n) const;
+
+		/*
+		 * Retrieves the weight of the edge going from offset s1 to offset s2.
+		 *
+		 * @param s1, offset where edge starts
+		 * @param s2, offset where edge ends
+		 *
+		 * @return the weight of the edge; WeightTraits<W>::none() if there is
+		 *         no such edge
+		 */
+		W getWeight(Offset s1, Offset s2) const;
+
+		/*
+		 * Retrieves the number of edges leaving the vertex at offset s, in
+		 * constant time.
+		 *
+		 * @param s, a valid vertex offset
+		 *
+		 * @return the out-degree of s
+		 */
+		Offset getOutDegree(Offset s) const;
+
+		/*
+		 * Retrieves the number of edges entering the vertex at offset s, in
+		 * constant time once every edge pending from lazyLoad is parsed.
+		 *
+		 * @param s, a valid vertex offset
+		 *
+		 * @return the in-degree of s
+		 */
+		Offset getInDegree(Offset s) const;
+
+		/*
+		 * Retrieves the number of edges in the graph, self connections
+		 * included.
+		 *
+		 * @return the number of edges
+		 */
+		size_t getEdgeCount() const;
+
+		/*
+		 * Retrieves the number of vertices of each out-degree or in-degree,
+		 * kept up to date by every edit.
+		 *
+		 * @param in, whether to count in-degrees rather than out-degrees
+		 *
+		 * @return h, where h[d] is the number of vertices of degree d, up to
+		 *         the highest degree; empty if the graph is
+		 */
+		const std::vector<Offset>& getDegreeHistogram(bool in) const;
+
+		/*
+		 * Retrieves the offsets of the vertices with an edge to the vertex at
+		 * offset s. With the reverse index this scans a row, as
+		 * getNeighbors does; without it, a column of the adjacency matrix.
+		 * Parses every edge pending from lazyLoad first.
+		 *
+		 * @param s, a valid vertex offset
+		 * @param n, list of predecessor offsets appended to by reference
+		 */
+		void getPredecessors(Offset s, std::vector<Offset>& n) const;
+
+		/*
+		 * Retrieves the predecessors of vertex k in graph.
+		 *
+		 * @param k, vertex to get the predecessors of
+		 * @param n, list of predecessors returned by reference
+		 *
+		 * @return true upon successful retreival of predecessors of k
+		 *         false if k does not exist
+		 */
+		bool getPredecessors(const Key& k, std::vector<Key>& n) const;
+
+		/*
+		 * Starts or stops maintaining the reverse index, a transposed
+		 * adjacency matrix of one bit per vertex pair that every edit keeps
+		 * up to date. Starting builds it from the graph; stopping releases it.
+		 * The setting survives clear and every load.
+		 *
+		 * @param on, whether to maintain the reverse index
+		 */
+		void setReverseIndex(bool on);
+
+		bool hasReverseIndex() const;
+
+		/*
+		 * Does nothing; the graph is always resident. Lets the searching
+		 * procedures treat it like a MappedGraph.
+		 */
+		void prefetch(Offset s) const;
+
+		/*
+		 * Determines the memory used by the graph, broken down into adjacency
+		 * storage, vertex keys, the key index and the degree counters, then
+		 * the reverse index and the file of a lazy load if present.
+		 *
+		 * @param m, one entry per storage component appended to by reference
+		 */
+		void memoryUsage(std::vector<MemComponent>& m) const;
+
+		/*
+		 * Releases slack capacity in every storage component back to the
+		 * allocator, such as the capacity left behind after removing many
+		 * vertices. Offsets and contents are unchanged.
+		 *
+		 * @return the number of slack bytes released
+		 */
+		size_t compact();
+
+		/*
+		 * Renumbers the vertices, so that the vertex at offset order[i] moves
+		 * to offset i. Keys, edges and weights are unchanged, and fileWrite
+		 * writes vertices in their new order, which persists it.
+		 *
+		 * @param order, a permutation of the vertex offsets
+		 *
+		 * @return 0 if the vertices were renumbered
+		 *        -1 if order is not a permutation of the vertex offsets
+		 */
+		int permute(const std::vector<Offset>& order);
+
 		/*
 		 * TESTING PURPOSES ONLY
 		 */
 		bool isEmpty() const;
 };
+
+typedef BasicWeightedDigraph<Weight> WeightedDigraph;
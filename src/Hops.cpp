@@ -0,0 +1,328 @@
+#include "Hops.h"
+#include "Parallel.h"
+#include "Stats.h"
+#include <memory>
+#include <fstream>
+#include <algorithm>
+#include <stdint.h>
+
+#define HOPS_LANE_BITS 64     // sources packed into each word
+#define HOPS_MAX_LANES 512    // widest batch searched together
+#define HOPS_DENSE_RATIO 32   // levels reaching over 1/32nd of the vertices
+                              // scan every vertex rather than a list
+
+/////////////////////////////////////////////////////////////////////////////
+// AUXILIARY STRUCTURES                                                    //
+/////////////////////////////////////////////////////////////////////////////
+
+/*
+ * A query waiting at its target for the search of its source, by lane.
+ */
+struct Waiting {
+	Offset target;
+	unsigned lane;
+	size_t query;
+
+	bool operator<(const Waiting& w) const {
+		return target < w.target;
+	}
+};
+
+/*
+ * The queries of one batch, sorted by target, and its sources, lane i
+ * searching from sources[i].
+ */
+struct Batch {
+	std::vector<Offset> sources;
+	std::vector<Waiting> waiting;
+};
+
+/*
+ * One thread's searches, W words of lanes to a vertex. seen holds the
+ * searches that have reached each vertex, visit those that reached it in
+ * the last level, and next those reaching it in the level being expanded.
+ * frontier lists the vertices with any lane of visit set, in ascending
+ * order. Between batches every lane and bit is clear.
+ */
+template<unsigned W>
+struct LaneSearch {
+	std::vector<uint64_t> seen;
+	std::vector<uint64_t> visit;
+	std::vector<uint64_t> next;
+	std::vector<Offset> frontier;
+	std::vector<Offset> touched;
+	std::vector<Offset> reached;
+	std::vector<size_t> unanswered;
+	Bitset isTarget;
+
+	explicit LaneSearch(Offset n) : seen((size_t)n * W, 0),
+			visit((size_t)n * W, 0), next((size_t)n * W, 0), isTarget(n) {}
+};
+
+/////////////////////////////////////////////////////////////////////////////
+// AUXILIARY FUNCTIONS                                                     //
+/////////////////////////////////////////////////////////////////////////////
+
+/*
+ * Moves the searches that reached a vertex in the level just expanded from
+ * next into seen and visit, answering the queries waiting there for any of
+ * them.
+ *
+ * @return true if any search reached the vertex for the first time
+ */
+template<unsigned W>
+static bool settle(LaneSearch<W>& x, const Batch& b, const uint64_t* active,
+		Offset v, Offset level, std::vector<Offset>& hops) {
+	uint64_t* seen = &x.seen[(size_t)v * W];
+	uint64_t* visit = &x.visit[(size_t)v * W];
+	uint64_t* next = &x.next[(size_t)v * W];
+	uint64_t any = 0;
+	for(unsigned w = 0; w < W; ++w) {
+		visit[w] = next[w] & active[w] & ~seen[w];
+		seen[w] |= visit[w];
+		next[w] = 0;
+		any |= visit[w];
+	}
+	if(any != 0 && x.isTarget.test(v)) {
+		Waiting key = {v, 0, 0};
+		auto range = std::equal_range(b.waiting.begin(), b.waiting.end(), key);
+		for(auto itr = range.first; itr != range.second; ++itr) {
+			unsigned l = itr->lane;
+			if(visit[l / HOPS_LANE_BITS] >> (l % HOPS_LANE_BITS) & 1) {
+				hops[itr->query] = level;
+				--x.unanswered[l];
+			}
+		}
+	}
+	return any != 0;
+}
+
+/*
+ * Runs the searches of one batch until all of its queries are answered,
+ * the frontier empties or maxHops levels are expanded. While the frontier
+ * is small its list is expanded; once it reaches a large share of the
+ * vertices, every vertex is scanned in order instead, which reads visit and
+ * the rows of the graph straight through and ors each frontier vertex's
+ * lanes into its neighbors without a branch.
+ *
+ * @param g, the graph
+ * @param b, the batch, at most W * 64 sources
+ * @param o, the search parameters
+ * @param x, the thread's searches, clear on entry and on return
+ * @param hops, the answers returned by reference, for the queries waiting
+ */
+template<unsigned W>
+static void searchBatch(const CSRGraph& g, const Batch& b, const HopOptions& o,
+		LaneSearch<W>& x, std::vector<Offset>& hops) {
+	Offset n = g.getVertexCount();
+	uint64_t active[W] = {};
+	x.unanswered.assign(b.sources.size(), 0);
+	for(size_t i = 0; i < b.waiting.size(); ++i) {
+		x.isTarget.set(b.waiting[i].target);
+		++x.unanswered[b.waiting[i].lane];
+	}
+
+	// sources are distinct and ascending, so form a frontier as they are
+	x.frontier.clear();
+	for(unsigned l = 0; l < b.sources.size(); ++l) {
+		uint64_t bit = (uint64_t)1 << (l % HOPS_LANE_BITS);
+		x.next[(size_t)b.sources[l] * W + l / HOPS_LANE_BITS] = bit;
+		active[l / HOPS_LANE_BITS] |= bit;
+	}
+	for(unsigned l = 0; l < b.sources.size(); ++l) {
+		settle(x, b, active, b.sources[l], 0, hops);
+		x.frontier.push_back(b.sources[l]);
+	}
+	x.reached = x.frontier;
+	bool dense = false;
+
+	for(Offset level = 1; level <= o.maxHops && !x.frontier.empty(); ++level) {
+		// lanes with nothing left to answer stop spreading
+		uint64_t any = 0;
+		for(unsigned l = 0; l < b.sources.size(); ++l) {
+			if(x.unanswered[l] == 0)
+				active[l / HOPS_LANE_BITS] &= ~((uint64_t)1 << (l % HOPS_LANE_BITS));
+		}
+		for(unsigned w = 0; w < W; ++w) {
+			any |= active[w];
+		}
+		if(any == 0)
+			break;
+
+		if(x.frontier.size() > n / HOPS_DENSE_RATIO) {
+			dense = true;
+			for(Offset v = 0; v < n; ++v) {
+				const uint64_t* visit = &x.visit[(size_t)v * W];
+				uint64_t lanes = 0;
+				for(unsigned w = 0; w < W; ++w) {
+					lanes |= visit[w];
+				}
+				if(lanes == 0)
+					continue;
+				for(size_t e = g.offsets[v]; e < g.offsets[v+1]; ++e) {
+					uint64_t* next = &x.next[(size_t)g.targets[e] * W];
+					for(unsigned w = 0; w < W; ++w) {
+						next[w] |= visit[w];
+					}
+				}
+			}
+			x.frontier.clear();
+			for(Offset v = 0; v < n; ++v) {
+				if(settle(x, b, active, v, level, hops))
+					x.frontier.push_back(v);
+			}
+			continue;
+		}
+
+		// only the neighbors new to some search are listed, each once
+		x.touched.clear();
+		for(size_t i = 0; i < x.frontier.size(); ++i) {
+			Offset v = x.frontier[i];
+			const uint64_t* visit = &x.visit[(size_t)v * W];
+			for(size_t e = g.offsets[v]; e < g.offsets[v+1]; ++e) {
+				Offset t = g.targets[e];
+				const uint64_t* seen = &x.seen[(size_t)t * W];
+				uint64_t* next = &x.next[(size_t)t * W];
+				uint64_t was = 0, lanes = 0;
+				for(unsigned w = 0; w < W; ++w) {
+					uint64_t d = visit[w] & ~seen[w];
+					was |= next[w];
+					lanes |= d;
+					next[w] |= d;
+				}
+				if(was == 0 && lanes != 0)
+					x.touched.push_back(t);
+			}
+		}
+		for(size_t i = 0; i < x.frontier.size(); ++i) {
+			std::fill_n(&x.visit[(size_t)x.frontier[i] * W], W, 0);
+		}
+		std::sort(x.touched.begin(), x.touched.end());
+		x.frontier.clear();
+		for(size_t i = 0; i < x.touched.size(); ++i) {
+			if(settle(x, b, active, x.touched[i], level, hops))
+				x.frontier.push_back(x.touched[i]);
+		}
+		if(!dense)
+			x.reached.insert(x.reached.end(), x.frontier.begin(),
+					x.frontier.end());
+	}
+
+	// a scan of every vertex may have set lanes anywhere
+	if(dense) {
+		std::fill(x.seen.begin(), x.seen.end(), 0);
+		std::fill(x.visit.begin(), x.visit.end(), 0);
+	}
+	else {
+		for(size_t i = 0; i < x.reached.size(); ++i) {
+			std::fill_n(&x.seen[(size_t)x.reached[i] * W], W, 0);
+			std::fill_n(&x.visit[(size_t)x.reached[i] * W], W, 0);
+		}
+	}
+	for(size_t i = 0; i < b.waiting.size(); ++i) {
+		x.isTarget.reset(b.waiting[i].target);
+	}
+}
+
+/*
+ * Answers every query, with W words of lanes at every vertex. Each thread
+ * searches whole batches with state of its own, made only once it is handed
+ * a batch.
+ */
+template<unsigned W>
+static void searchAll(const CSRGraph& g, const std::vector<Batch>& batches,
+		const HopOptions& o, std::vector<Offset>& hops) {
+	std::vector<std::unique_ptr<LaneSearch<W>>> local(parallelThreads());
+	parallelFor(0, batches.size(), 1, [&](size_t i, unsigned tid) {
+		if(!local[tid])
+			local[tid].reset(new LaneSearch<W>(g.getVertexCount()));
+		searchBatch(g, batches[i], o, *local[tid], hops);
+	});
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// HOP PROCEDURES                                                          //
+/////////////////////////////////////////////////////////////////////////////
+
+void hopDistances(const CSRGraph& g, const std::vector<HopQuery>& q,
+		const HopOptions& o, std::vector<Offset>& hops) {
+	StatTimer timer(STAT_HOPS);
+	hops.assign(q.size(), unreachedHops);
+	std::vector<size_t> order(q.size());
+	for(size_t i = 0; i < q.size(); ++i) {
+		order[i] = i;
+	}
+	std::sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+		return q[a].source < q[b].source;
+	});
+	size_t sources = 0;
+	for(size_t i = 0; i < order.size(); ++i) {
+		sources += i == 0 || q[order[i]].source != q[order[i-1]].source;
+	}
+
+	// narrower batches when there are too few sources to keep every thread
+	// busy, though never narrower than a word
+	size_t lanes = std::min(std::max(o.batch, 1u), (unsigned)HOPS_MAX_LANES);
+	size_t share = (sources + parallelThreads() - 1) / parallelThreads();
+	share = (share + HOPS_LANE_BITS - 1) / HOPS_LANE_BITS * HOPS_LANE_BITS;
+	lanes = std::min(lanes, std::max(share, (size_t)HOPS_LANE_BITS));
+
+	std::vector<Batch> batches;
+	for(size_t i = 0; i < order.size(); ++i) {
+		Offset s = q[order[i]].source;
+		if(i == 0 || s != q[order[i-1]].source) {
+			if(batches.empty() || batches.back().sources.size() == lanes)
+				batches.push_back(Batch());
+			batches.back().sources.push_back(s);
+		}
+		Batch& b = batches.back();
+		Waiting w = {q[order[i]].target, (unsigned)b.sources.size() - 1,
+			order[i]};
+		b.waiting.push_back(w);
+	}
+	for(size_t i = 0; i < batches.size(); ++i) {
+		std::sort(batches[i].waiting.begin(), batches[i].waiting.end());
+	}
+
+	// the word count is fixed at compile time, so the loops over a vertex's
+	// words unroll
+	if(lanes <= HOPS_LANE_BITS)
+		searchAll<1>(g, batches, o, hops);
+	else if(lanes <= 2 * HOPS_LANE_BITS)
+		searchAll<2>(g, batches, o, hops);
+	else if(lanes <= 4 * HOPS_LANE_BITS)
+		searchAll<4>(g, batches, o, hops);
+	else
+		searchAll<8>(g, batches, o, hops);
+}
+
+int readHopQueries(const WeightedDigraph& g, const std::string& file,
+		std::vector<HopQuery>& q) {
+	std::ifstream inFile(file);
+	if(!inFile.is_open())
+		return -1;
+	const char* space = " \t\r";
+	std::string line;
+	q.clear();
+	while(std::getline(inFile, line)) {
+		if(line.find_first_not_of(space) == std::string::npos)
+			continue;
+		size_t comma = line.find(',');
+		if(comma == std::string::npos)
+			return -2;
+		std::string keys[2] = {line.substr(0, comma), line.substr(comma + 1)};
+		int offsets[2];
+		for(int k = 0; k < 2; ++k) {
+			size_t begin = keys[k].find_first_not_of(space);
+			size_t end = keys[k].find_last_not_of(space);
+			keys[k] = begin == std::string::npos ? "" :
+				keys[k].substr(begin, end - begin + 1);
+			offsets[k] = g.getOffset(keys[k]);
+			if(offsets[k] == -1)
+				return -2;
+		}
+		HopQuery h = {(Offset)offsets[0], (Offset)offsets[1]};
+		q.push_back(h);
+	}
+	return 0;
+}
@@ -0,0 +1,84 @@
+#pragma once
+
+#include "Graph.h"
+#include "CSR.h"
+#include <string>
+#include <vector>
+#include <limits>
+
+const Offset unreachedHops = std::numeric_limits<Offset>::max();
+
+/////////////////////////////////////////////////////////////////////////////
+// HOP STRUCTURES                                                          //
+/////////////////////////////////////////////////////////////////////////////
+
+/*
+ * A query for the number of edges on the shortest path from one vertex to
+ * another, following edge directions.
+ */
+struct HopQuery {
+	Offset source;
+	Offset target;
+};
+
+/*
+ * Parameters of hopDistances.
+ *
+ * batch is the most distinct sources searched together, clamped to
+ * [1, 512]; lanes are packed 64 to a word, so multiples of 64 waste none.
+ * Wider batches share more scans, but read more words for every edge, and
+ * on graphs too large for the cache 64 is usually fastest.
+ * Batches are narrowed, to no fewer than 64 sources, when there are too few
+ * sources to hand every thread one. Searches stop after maxHops levels,
+ * leaving every target farther away unreached.
+ */
+struct HopOptions {
+	unsigned batch = 64;
+	Offset maxHops = unreachedHops;
+};
+
+/////////////////////////////////////////////////////////////////////////////
+// HOP PROCEDURES                                                          //
+/////////////////////////////////////////////////////////////////////////////
+
+/*
+ * Answers hop queries with a multi-source breadth-first search (Then et
+ * al., 2014). Queries are grouped by source into batches, and the sources
+ * of a batch searched together, each owning one bit lane of every vertex's
+ * seen, frontier and next-frontier words. A single scan of a frontier
+ * vertex's edges then advances every search that reached it in the same
+ * level, with a few word operations per edge; where searches overlap, as
+ * they do in most graphs within a few hops, the scans of every search but
+ * one are saved. Levels reaching a large share of the vertices scan every
+ * vertex in order rather than a list of them. A search stops spreading once
+ * its queries are answered, and a batch once all of them are. Each thread
+ * searches whole batches with words of its own, so no lane is ever shared,
+ * at the cost of 3 * 8 * ceil(batch / 64) bytes per vertex for every
+ * thread.
+ *
+ * @param g, the graph
+ * @param q, the queries
+ * @param o, the search parameters
+ * @param hops, the number of edges from source to target of every query,
+ * 0 when they are the same vertex and unreachedHops when no path of at most
+ * maxHops edges exists, returned by reference
+ */
+void hopDistances(const CSRGraph& g, const std::vector<HopQuery>& q,
+		const HopOptions& o, std::vector<Offset>& hops);
+
+/*
+ * Reads hop queries from a file holding one query per line in the following
+ * form, skipping blank lines:
+ *
+ * <vertex 1>,<vertex 2>
+ *
+ * @param g, the graph the queries name vertices of
+ * @param file, the name of the file to read
+ * @param q, the queries returned by reference, in the order of the file
+ *
+ * @return 0 upon successful read
+ *        -1 upon inability to open file
+ *        -2 upon a line not naming two vertices of the graph
+ */
+int readHopQueries(const WeightedDigraph& g, const std::string& file,
+		std::vector<HopQuery>& q);
@@ -0,0 +1,441 @@
+#include "Journal.h"
+#include "Stats.h"
+#include <fstream>
+#include <iterator>
+#include <cstdio>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#define JOURNAL_MAGIC "QGWAL01"  // identifies a journal file
+
+/*
+ * The header at the start of a journal, identifying the base it applies to.
+ * Records follow it, each a payload length, a checksum of the payload and the
+ * payload: an operation, then its keys, each preceded by its length, then its
+ * weight.
+ */
+struct JournalHeader {
+	char magic[8];
+	uint64_t baseBytes;
+	uint64_t baseHash;
+};
+
+enum JournalOp {
+	JOURNAL_ADD_VERTEX,
+	JOURNAL_REMOVE_VERTEX,
+	JOURNAL_SET_EDGE,
+	JOURNAL_REMOVE_EDGE
+};
+
+/////////////////////////////////////////////////////////////////////////////
+// AUXILIARY FUNCTIONS                                                     //
+/////////////////////////////////////////////////////////////////////////////
+
+static std::string journalName(const std::string& file) {
+	return file + journalExt;
+}
+
+static bool hasGraphExt(const std::string& file) {
+	return file.size() >= graphExt.size() && file.compare(file.size() -
+			graphExt.size(), graphExt.size(), graphExt) == 0;
+}
+
+static uint32_t checksum(const char* p, size_t len) {
+	uint32_t h = 2166136261u;
+	for(size_t i = 0; i < len; ++i) {
+		h = (h ^ (unsigned char)p[i]) * 16777619u;
+	}
+	return h;
+}
+
+static bool readFile(const std::string& file, std::string& bytes) {
+	std::ifstream in(file, std::ios::binary);
+	if(!in.is_open())
+		return false;
+	bytes.assign(std::istreambuf_iterator<char>(in),
+			std::istreambuf_iterator<char>());
+	return true;
+}
+
+/*
+ * Reads the header identifying a base: its size and the hash of its contents.
+ *
+ * @return false if the base could not be read
+ */
+static bool baseHeader(const std::string& file, JournalHeader& h) {
+	std::string bytes;
+	if(!readFile(file, bytes))
+		return false;
+	uint64_t hash = 14695981039346656037ULL;
+	for(size_t i = 0; i < bytes.size(); ++i) {
+		hash = (hash ^ (unsigned char)bytes[i]) * 1099511628211ULL;
+	}
+	memcpy(h.magic, JOURNAL_MAGIC, sizeof(h.magic));
+	h.baseBytes = bytes.size();
+	h.baseHash = hash;
+	return true;
+}
+
+static bool writeAll(int fd, const char* p, size_t len) {
+	while(len > 0) {
+		ssize_t n = write(fd, p, len);
+		if(n < 0)
+			return false;
+		p += n;
+		len -= n;
+	}
+	return true;
+}
+
+/*
+ * Flushes a file, or the directory entries of a directory, to the disk.
+ */
+static bool syncPath(const std::string& path) {
+	int fd = ::open(path.c_str(), O_RDONLY);
+	if(fd == -1)
+		return false;
+	bool ok = fsync(fd) == 0;
+	::close(fd);
+	return ok;
+}
+
+static std::string directoryOf(const std::string& file) {
+	size_t slash = file.find_last_of('/');
+	return slash == std::string::npos ? "." : file.substr(0, slash + 1);
+}
+
+/*
+ * Reads the key at position p of a record, advancing p past it.
+ *
+ * @return false if the key runs past the end of the record
+ */
+static bool readKey(const std::string& r, size_t& p, size_t end, Key& k) {
+	uint32_t len;
+	if(end - p < sizeof(len))
+		return false;
+	memcpy(&len, &r[p], sizeof(len));
+	p += sizeof(len);
+	if(end - p < len)
+		return false;
+	k.assign(r, p, len);
+	p += len;
+	return true;
+}
+
+/*
+ * Decodes one record payload and applies it to g.
+ *
+ * @return false if the payload is malformed
+ */
+static bool replayRecord(const std::string& r, size_t p, size_t end,
+		WeightedDigraph& g) {
+	uint8_t op = r[p++];
+	Key k1, k2;
+	Weight w;
+	if(!readKey(r, p, end, k1))
+		return false;
+	switch(op) {
+		case JOURNAL_ADD_VERTEX:
+			g.addVertex(k1);
+			break;
+		case JOURNAL_REMOVE_VERTEX:
+			g.removeVertex(k1);
+			break;
+		case JOURNAL_SET_EDGE:
+			if(!readKey(r, p, end, k2) || end - p < sizeof(w))
+				return false;
+			memcpy(&w, &r[p], sizeof(w));
+			p += sizeof(w);
+			g.setEdge(k1, k2, w);
+			break;
+		case JOURNAL_REMOVE_EDGE:
+			if(!readKey(r, p, end, k2))
+				return false;
+			g.removeEdge(k1, k2);
+			break;
+		default:
+			return false;
+	}
+	return p == end;
+}
+
+/*
+ * Reads the journal of a base, replaying its records over g if g is given.
+ *
+ * @param file, the journal
+ * @param base, the header of the base as it is on disk
+ * @param g, the graph to replay over, or NULL
+ * @param records, the number of intact records returned by reference
+ * @param valid, the length of the journal up to the end of the last intact
+ * record returned by reference
+ *
+ * @return 0 if the journal applies to the base
+ *        -1 if there is no journal
+ *        -3 if the journal is not one, or belongs to another base
+ */
+static int readJournal(const std::string& file, const JournalHeader& base,
+		WeightedDigraph* g, size_t& records, size_t& valid) {
+	std::string bytes;
+	JournalHeader h;
+	records = 0;
+	valid = 0;
+	if(!readFile(file, bytes))
+		return -1;
+	if(bytes.size() < sizeof(h))
+		return -3;
+	memcpy(&h, bytes.data(), sizeof(h));
+	if(memcmp(h.magic, base.magic, sizeof(h.magic)) ||
+			h.baseBytes != base.baseBytes || h.baseHash != base.baseHash)
+		return -3;
+	size_t p = sizeof(h);
+	valid = p;
+	uint32_t len, sum;
+	while(bytes.size() - p >= sizeof(len) + sizeof(sum)) {
+		memcpy(&len, &bytes[p], sizeof(len));
+		memcpy(&sum, &bytes[p + sizeof(len)], sizeof(sum));
+		p += sizeof(len) + sizeof(sum);
+		if(len == 0 || bytes.size() - p < len ||
+				checksum(&bytes[p], len) != sum)
+			break;
+		if(g != NULL && !replayRecord(bytes, p, p + len, *g))
+			break;
+		p += len;
+		valid = p;
+		++records;
+	}
+	return 0;
+}
+
+/*
+ * Creates an empty journal for a base, flushed to the disk.
+ *
+ * @return the descriptor of the journal, open for appending; -1 upon failure
+ */
+static int createJournal(const std::string& file, const JournalHeader& h) {
+	int fd = ::open(file.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_APPEND, 0644);
+	if(fd == -1)
+		return -1;
+	if(!writeAll(fd, (const char*)&h, sizeof(h)) || fdatasync(fd) != 0) {
+		::close(fd);
+		return -1;
+	}
+	return fd;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// JOURNAL IMPLEMENTATION                                                  //
+/////////////////////////////////////////////////////////////////////////////
+
+int parseSyncPolicy(const std::string& name, SyncPolicy& p) {
+	if(name == "always")
+		p = SYNC_ALWAYS;
+	else if(name == "interval")
+		p = SYNC_INTERVAL;
+	else if(name == "never")
+		p = SYNC_NEVER;
+	else
+		return -1;
+	return 0;
+}
+
+Journal::Journal() : fd(-1), policy(SYNC_ALWAYS), records(0), bytes(0),
+		baseBytes(0) {
+}
+
+Journal::~Journal() {
+	close();
+}
+
+int Journal::open(const std::string& file, SyncPolicy p) {
+	if(!hasGraphExt(file))
+		return -2;
+	close();
+	JournalHeader h;
+	size_t valid;
+	if(!baseHeader(file, h))
+		return -1;
+	std::string journal = journalName(file);
+	if(readJournal(journal, h, NULL, records, valid) == 0) {
+		fd = ::open(journal.c_str(), O_WRONLY | O_APPEND);
+		if(fd != -1 && ftruncate(fd, valid) != 0) {
+			::close(fd);
+			fd = -1;
+		}
+	}
+	else {
+		records = 0;
+		valid = sizeof(h);
+		fd = createJournal(journal, h);
+	}
+	if(fd == -1)
+		return -1;
+	graphFile = file;
+	policy = p;
+	bytes = valid;
+	baseBytes = h.baseBytes;
+	lastSync = std::chrono::steady_clock::now();
+	return 0;
+}
+
+bool Journal::isOpen() const {
+	return fd != -1;
+}
+
+void Journal::close() {
+	if(fd == -1)
+		return;
+	commit();
+	fdatasync(fd);
+	::close(fd);
+	fd = -1;
+	pending.clear();
+}
+
+void Journal::log(uint8_t op, const Key& k1, const Key* k2, const Weight* w) {
+	uint32_t len = 1 + sizeof(uint32_t) + k1.size();
+	if(k2 != NULL)
+		len += sizeof(uint32_t) + k2->size();
+	if(w != NULL)
+		len += sizeof(Weight);
+	size_t start = pending.size();
+	pending.append((const char*)&len, sizeof(len));
+	pending.append(sizeof(uint32_t), '\0');
+	pending.push_back(op);
+	uint32_t klen = k1.size();
+	pending.append((const char*)&klen, sizeof(klen));
+	pending.append(k1);
+	if(k2 != NULL) {
+		klen = k2->size();
+		pending.append((const char*)&klen, sizeof(klen));
+		pending.append(*k2);
+	}
+	if(w != NULL)
+		pending.append((const char*)w, sizeof(Weight));
+	uint32_t sum = checksum(&pending[start + 2 * sizeof(uint32_t)], len);
+	memcpy(&pending[start + sizeof(uint32_t)], &sum, sizeof(sum));
+}
+
+void Journal::logAddVertex(const Key& k) {
+	log(JOURNAL_ADD_VERTEX, k, NULL, NULL);
+}
+
+void Journal::logRemoveVertex(const Key& k) {
+	log(JOURNAL_REMOVE_VERTEX, k, NULL, NULL);
+}
+
+void Journal::logSetEdge(const Key& k1, const Key& k2, Weight w) {
+	log(JOURNAL_SET_EDGE, k1, &k2, &w);
+}
+
+void Journal::logRemoveEdge(const Key& k1, const Key& k2) {
+	log(JOURNAL_REMOVE_EDGE, k1, &k2, NULL);
+}
+
+int Journal::commit() {
+	if(fd == -1 || pending.empty())
+		return 0;
+	StatTimer timer(STAT_JOURNAL_COMMIT);
+
+	// a failed write may leave part of the batch behind, which replay will
+	// stop at; cut it off so the retry follows the last whole record
+	if(!writeAll(fd, pending.data(), pending.size())) {
+		int truncated = ftruncate(fd, bytes);
+		(void)truncated;
+		return -1;
+	}
+	for(size_t p = 0; p < pending.size(); ++records) {
+		uint32_t len;
+		memcpy(&len, &pending[p], sizeof(len));
+		p += 2 * sizeof(uint32_t) + len;
+	}
+	bytes += pending.size();
+	pending.clear();
+	std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+	if(policy == SYNC_ALWAYS || (policy == SYNC_INTERVAL && now - lastSync >=
+			std::chrono::milliseconds(SYNC_INTERVAL_MS))) {
+		if(fdatasync(fd) != 0)
+			return -1;
+		lastSync = now;
+	}
+	return 0;
+}
+
+bool Journal::needsCheckpoint() const {
+	size_t logged = bytes + pending.size();
+	return fd != -1 && logged > baseBytes && logged > CHECKPOINT_MIN_BYTES;
+}
+
+int Journal::checkpoint(const WeightedDigraph& g) {
+	if(fd == -1)
+		return -1;
+	StatTimer timer(STAT_CHECKPOINT);
+	if(commit() != 0)
+		return -1;
+
+	// the new base and its empty journal are both in place on the disk
+	// before either replaces the old
+	std::string base = graphFile.substr(0, graphFile.size() - graphExt.size()) +
+		".ckpt" + graphExt;
+	std::string journal = journalName(graphFile);
+	std::string nextJournal = journal + ".tmp";
+	JournalHeader h;
+	if(g.fileWrite(base) != 0 || !syncPath(base) || !baseHeader(base, h)) {
+		std::remove(base.c_str());
+		return -1;
+	}
+	int next = createJournal(nextJournal, h);
+	if(next == -1) {
+		std::remove(base.c_str());
+		return -1;
+	}
+
+	// once the base is renamed the old journal is stale, so a crash between
+	// the renames loses nothing
+	if(std::rename(base.c_str(), graphFile.c_str()) != 0) {
+		::close(next);
+		std::remove(base.c_str());
+		std::remove(nextJournal.c_str());
+		return -1;
+	}
+	std::rename(nextJournal.c_str(), journal.c_str());
+	syncPath(directoryOf(graphFile));
+	::close(fd);
+	fd = next;
+	records = 0;
+	bytes = sizeof(h);
+	baseBytes = h.baseBytes;
+	return 0;
+}
+
+size_t Journal::getRecordCount() const {
+	return records;
+}
+
+size_t Journal::getByteCount() const {
+	return bytes;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// JOURNALED LOADING IMPLEMENTATION                                        //
+/////////////////////////////////////////////////////////////////////////////
+
+int loadJournaled(const std::string& file, WeightedDigraph& g,
+		size_t& replayed, bool lazy) {
+	replayed = 0;
+	int status = lazy ? g.lazyLoad(file) : g.fileLoad(file);
+
+	// edges skipped for weights out of range would be lost on the next save
+	WeightType t;
+	if(status == -3 && scanWeightType(file, t) == 0 &&
+			t > WeightTraits<Weight>::type()) {
+		g.clear();
+		return -4;
+	}
+	JournalHeader h;
+	size_t valid;
+	if(status == -1 || status == -2 || !baseHeader(file, h))
+		return status;
+	readJournal(journalName(file), h, &g, replayed, valid);
+	return status;
+}
@@ -0,0 +1,173 @@
+#pragma once
+
+#include "Graph.h"
+#include <string>
+#include <chrono>
+#include <stdint.h>
+
+const std::string journalExt(".wal");  // appended to the name of the graph
+                                       // file a journal belongs to
+
+#define SYNC_INTERVAL_MS 1000           // most time SYNC_INTERVAL lets pass
+                                        // between flushes to the disk
+#define CHECKPOINT_MIN_BYTES (1 << 20)  // journal size below which a
+                                        // checkpoint is never due
+
+/////////////////////////////////////////////////////////////////////////////
+// WRITE-AHEAD JOURNAL                                                     //
+/////////////////////////////////////////////////////////////////////////////
+
+/*
+ * How often a journal forces committed records to the disk.
+ *
+ * SYNC_ALWAYS, on every commit, so that a committed edit survives a crash.
+ * SYNC_INTERVAL, on the first commit after SYNC_INTERVAL_MS have passed, so
+ *     that a crash loses at most that long of edits.
+ * SYNC_NEVER, only at checkpoints and on close, leaving the rest to the
+ *     operating system.
+ */
+enum SyncPolicy {
+	SYNC_ALWAYS,
+	SYNC_INTERVAL,
+	SYNC_NEVER
+};
+
+/*
+ * Determines the sync policy named by one of "always", "interval" or "never".
+ *
+ * @param name, the name of the policy
+ * @param p, the policy returned by reference
+ *
+ * @return 0 if name is a policy
+ *        -1 if it is not
+ */
+int parseSyncPolicy(const std::string& name, SyncPolicy& p);
+
+/*
+ * Append-only log of the edits made to a graph since it was last written,
+ * kept next to its .graph file (Boston.graph is journaled to
+ * Boston.graph.wal). Saving appends the records of the latest edits rather
+ * than rewriting the whole file, and loadJournaled() replays them over the
+ * .graph file, the base.
+ *
+ * Edits are logged after they succeed, and buffered until commit(), which
+ * hands them to the disk in a single write: committing once per batch of
+ * edits groups them under one flush. checkpoint() folds the journal into a
+ * new base and starts it afresh.
+ *
+ * The journal records the size and hash of the base it applies to, so a
+ * journal left behind by a checkpoint interrupted after its new base was in
+ * place is recognized as stale and discarded. Records carry a checksum;
+ * replay stops at the first torn or corrupt record.
+ */
+class Journal {
+	private:
+		int fd;
+		std::string graphFile;
+		std::string pending;  // records logged since the last commit
+		SyncPolicy policy;
+		std::chrono::steady_clock::time_point lastSync;
+		size_t records;       // committed records
+		size_t bytes;         // committed bytes, including the header
+		size_t baseBytes;     // size of the base
+
+		/*
+		 * Buffers one record. Keys and the weight are logged as the edit
+		 * requires.
+		 */
+		void log(uint8_t op, const Key& k1, const Key* k2, const Weight* w);
+
+		Journal(const Journal&) = delete;
+		Journal& operator=(const Journal&) = delete;
+	public:
+		/* Constructor */
+		Journal();
+
+		/* Destructor; closes the journal */
+		~Journal();
+
+		/*
+		 * Opens the journal of a graph file for appending. A journal of the
+		 * base as it is on disk is kept, less any torn record at its end;
+		 * any other is replaced by an empty one. The graph in memory should
+		 * be the base with the journal replayed, as loadJournaled() leaves
+		 * it, or be checkpointed before further edits are logged.
+		 *
+		 * @param file, the .graph file to journal
+		 * @param p, how often to force commits to the disk
+		 *
+		 * @return 0 upon success
+		 *        -1 upon inability to read the base or open the journal
+		 *        -2 upon improper extension
+		 */
+		int open(const std::string& file, SyncPolicy p);
+
+		bool isOpen() const;
+
+		/*
+		 * Commits any logged records and closes the journal.
+		 */
+		void close();
+
+		/* Log a successful edit of the graph */
+		void logAddVertex(const Key& k);
+		void logRemoveVertex(const Key& k);
+		void logSetEdge(const Key& k1, const Key& k2, Weight w);
+		void logRemoveEdge(const Key& k1, const Key& k2);
+
+		/*
+		 * Appends every record logged since the last commit to the journal,
+		 * and flushes it to the disk as the sync policy requires.
+		 *
+		 * @return 0 upon success
+		 *        -1 upon a failed write, in which case the records stay
+		 *         pending
+		 */
+		int commit();
+
+		/*
+		 * Determines whether the journal has grown past both the size of its
+		 * base and CHECKPOINT_MIN_BYTES, so that replaying it would cost more
+		 * than loading a new base.
+		 */
+		bool needsCheckpoint() const;
+
+		/*
+		 * Writes the graph as a new base and empties the journal. The base is
+		 * written beside the old one and renamed over it, so a crash leaves
+		 * either the old base and journal or the new base.
+		 *
+		 * @param g, the graph, which must hold every logged edit
+		 *
+		 * @return 0 upon success
+		 *        -1 upon a failed write, leaving the journal as it was
+		 */
+		int checkpoint(const WeightedDigraph& g);
+
+		/* Committed records and bytes in the journal since its base */
+		size_t getRecordCount() const;
+		size_t getByteCount() const;
+};
+
+/////////////////////////////////////////////////////////////////////////////
+// JOURNALED LOADING                                                       //
+/////////////////////////////////////////////////////////////////////////////
+
+/*
+ * Loads a graph file, then replays its journal if it has one that applies to
+ * it.
+ *
+ * @param file, the .graph file to load
+ * @param g, the graph loaded into
+ * @param replayed, the number of journal records replayed returned by
+ * reference
+ * @param lazy, whether to load the graph with lazyLoad; the records replayed
+ * then parse the edges of the vertices they touch
+ *
+ * @return as fileLoad, or lazyLoad if lazy, except that
+ *        -4 upon a file with weights too wide for Weight, which is refused
+ *           rather than loaded without those edges, leaving g empty; a lazy
+ *           load does not parse the weights, so skips them at materialize()
+ */
+int loadJournaled(const std::string& file, WeightedDigraph& g,
+		size_t& replayed, bool lazy = false);
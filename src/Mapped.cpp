@@ -0,0 +1,477 @@
+#include "Mapped.h"
+#include "Stats.h"
+#include <fstream>
+#include <algorithm>
+#include <unordered_map>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#define MAPPED_MAGIC "QGMAP01"   // identifies a mapped graph file
+
+/*
+ * The header at the start of a mapped graph file. The sections follow it in
+ * order, each starting at a multiple of 8 bytes.
+ */
+struct MappedHeader {
+	char magic[8];
+	uint64_t vertices;
+	uint64_t edges;
+	uint64_t keyBytes;
+};
+
+/*
+ * Positions of the sections of a mapped graph file, and its total length.
+ */
+struct MappedLayout {
+	size_t offsets;
+	size_t targets;
+	size_t weights;
+	size_t keyOffsets;
+	size_t keys;
+	size_t length;
+};
+
+/////////////////////////////////////////////////////////////////////////////
+// AUXILIARY FUNCTIONS                                                     //
+/////////////////////////////////////////////////////////////////////////////
+
+static size_t align8(size_t x) {
+	return (x + 7) & ~(size_t)7;
+}
+
+static MappedLayout layout(const MappedHeader& h) {
+	MappedLayout l;
+	l.offsets = align8(sizeof(MappedHeader));
+	l.targets = align8(l.offsets + (h.vertices + 1) * sizeof(uint64_t));
+	l.weights = align8(l.targets + h.edges * sizeof(Offset));
+	l.keyOffsets = align8(l.weights + h.edges * sizeof(Weight));
+	l.keys = l.keyOffsets + (h.vertices + 1) * sizeof(uint64_t);
+	l.length = l.keys + h.keyBytes;
+	return l;
+}
+
+static bool hasExtension(const std::string& file, const std::string& ext) {
+	return file.size() >= ext.size() &&
+		file.compare(file.size() - ext.size(), ext.size(), ext) == 0;
+}
+
+/*
+ * FNV-1a hash of a key, computed the same way over mapped bytes and Keys.
+ */
+static uint64_t keyHash(const char* k, size_t len) {
+	uint64_t h = 14695981039346656037ULL;
+	for(size_t i = 0; i < len; ++i) {
+		h = (h ^ (unsigned char)k[i]) * 1099511628211ULL;
+	}
+	return h;
+}
+
+/*
+ * Creates a mapped graph file sized for h and maps it for writing, with the
+ * header filled in.
+ *
+ * @return 0 upon success
+ *        -1 upon inability to create or map the file
+ */
+static int createMapped(const std::string& file, MappedHeader& h,
+		char*& base, MappedLayout& l) {
+	memcpy(h.magic, MAPPED_MAGIC, sizeof(h.magic));
+	l = layout(h);
+	int fd = ::open(file.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+	if(fd == -1)
+		return -1;
+	if(ftruncate(fd, l.length) != 0) {
+		::close(fd);
+		return -1;
+	}
+	void* p = mmap(NULL, l.length, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	::close(fd);
+	if(p == MAP_FAILED)
+		return -1;
+	base = (char*)p;
+	memcpy(base, &h, sizeof(h));
+	return 0;
+}
+
+/*
+ * Flushes and unmaps a file created by createMapped.
+ *
+ * @return 0 upon success
+ *        -1 if the file could not be written back
+ */
+static int finishMapped(char* base, const MappedLayout& l) {
+	int status = msync(base, l.length, MS_SYNC) == 0 ? 0 : -1;
+	munmap(base, l.length);
+	return status;
+}
+
+/*
+ * Resolves the edges of one line of a .graph file against the key index,
+ * skipping edges that fileLoad would skip. The row is left in ascending
+ * target order, keeping the last of several edges to the same target.
+ */
+static void resolveRow(const std::string& text,
+		const std::unordered_map<Key, Offset>& index,
+		std::vector<std::pair<Key, std::string>>& e,
+		std::vector<std::pair<Offset, Weight>>& row) {
+	e.clear();
+	row.clear();
+	splitEdges(text, e);
+	for(size_t j = 0; j < e.size(); ++j) {
+		auto itr = index.find(e[j].first);
+		Weight w;
+		if(itr == index.end() || !WeightTraits<Weight>::parse(e[j].second, w))
+			continue;
+		row.push_back(std::make_pair(itr->second, w));
+	}
+	std::stable_sort(row.begin(), row.end(),
+			[](const std::pair<Offset, Weight>& a, const std::pair<Offset, Weight>& b) {
+		return a.first < b.first;
+	});
+	size_t k = 0;
+	for(size_t j = 0; j < row.size(); ++j) {
+		if(j + 1 < row.size() && row[j+1].first == row[j].first)
+			continue;
+		row[k++] = row[j];
+	}
+	row.resize(k);
+}
+
+/*
+ * Splits a line of a .graph file into its key and the text of its edges.
+ */
+static void splitLine(const std::string& line, Key& k, std::string& text) {
+	size_t splitPos = line.find_first_of('|');
+	k = trim(line.substr(0, splitPos));
+	text = splitPos == std::string::npos ? "" : line.substr(splitPos + 1);
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// MAPPED GRAPH IMPLEMENTATION                                             //
+/////////////////////////////////////////////////////////////////////////////
+
+MappedGraph::MappedGraph() : fd(-1), base(NULL), length(0) {
+	pageShift = 0;
+	while((1L << pageShift) < sysconf(_SC_PAGESIZE)) {
+		++pageShift;
+	}
+	close();
+}
+
+MappedGraph::~MappedGraph() {
+	close();
+}
+
+int MappedGraph::open(const std::string& file) {
+	if(!hasExtension(file, mappedExt))
+		return -2;
+	close();
+	int f = ::open(file.c_str(), O_RDONLY);
+	if(f == -1)
+		return -1;
+	struct stat st;
+	if(fstat(f, &st) != 0) {
+		::close(f);
+		return -1;
+	}
+	MappedHeader h;
+	if((size_t)st.st_size < sizeof(h) || pread(f, &h, sizeof(h), 0) !=
+			(ssize_t)sizeof(h) || memcmp(h.magic, MAPPED_MAGIC, sizeof(h.magic))) {
+		::close(f);
+		return -3;
+	}
+	MappedLayout l = layout(h);
+	if(l.length != (size_t)st.st_size) {
+		::close(f);
+		return -3;
+	}
+	void* p = mmap(NULL, l.length, PROT_READ, MAP_SHARED, f, 0);
+	if(p == MAP_FAILED) {
+		::close(f);
+		return -1;
+	}
+	fd = f;
+	base = (char*)p;
+	length = l.length;
+	vertexCount = h.vertices;
+	edgeCount = h.edges;
+	offsets = (const uint64_t*)(base + l.offsets);
+	targets = (const Offset*)(base + l.targets);
+	weights = (const Weight*)(base + l.weights);
+	keyOffsets = (const uint64_t*)(base + l.keyOffsets);
+	keys = base + l.keys;
+	if(offsets[vertexCount] != edgeCount || keyOffsets[vertexCount] != h.keyBytes) {
+		close();
+		return -3;
+	}
+
+	// traversals jump between rows, so read-ahead would mostly fetch pages
+	// that are never used; prefetch() asks for the pages that will be
+	advise(base + l.offsets, l.keyOffsets - l.offsets, MADV_RANDOM);
+
+	// index every key by hash, in a table at most half full
+	size_t size = 1;
+	while(size < 2 * (size_t)vertexCount) {
+		size <<= 1;
+	}
+	slots.assign(size, vertexCount);
+	advise(keyOffsets, length - l.keyOffsets, MADV_SEQUENTIAL);
+	for(Offset s = 0; s < vertexCount; ++s) {
+		const char* k = keys + keyOffsets[s];
+		size_t len = keyOffsets[s+1] - keyOffsets[s];
+		size_t i = keyHash(k, len) & (size - 1);
+		while(slots[i] != vertexCount) {
+			i = (i + 1) & (size - 1);
+		}
+		slots[i] = s;
+	}
+	advise(keyOffsets, length - l.keyOffsets, MADV_RANDOM);
+	hinted.resize(((length - 1) >> pageShift) + 1);
+	return 0;
+}
+
+void MappedGraph::close() {
+	if(base != NULL)
+		munmap(base, length);
+	if(fd != -1)
+		::close(fd);
+	fd = -1;
+	base = NULL;
+	length = 0;
+	vertexCount = 0;
+	edgeCount = 0;
+	offsets = NULL;
+	targets = NULL;
+	weights = NULL;
+	keyOffsets = NULL;
+	keys = NULL;
+	slots.clear();
+	hinted.resize(0);
+}
+
+bool MappedGraph::isEmpty() const {
+	return vertexCount == 0;
+}
+
+Offset MappedGraph::getVertexCount() const {
+	return vertexCount;
+}
+
+size_t MappedGraph::getEdgeCount() const {
+	return edgeCount;
+}
+
+bool MappedGraph::keyEquals(Offset s, const char* k, size_t len) const {
+	return keyOffsets[s+1] - keyOffsets[s] == len &&
+		memcmp(keys + keyOffsets[s], k, len) == 0;
+}
+
+int MappedGraph::getOffset(const Key& k) const {
+	if(slots.empty())
+		return -1;
+	size_t mask = slots.size() - 1;
+	for(size_t i = keyHash(k.data(), k.size()) & mask; slots[i] != vertexCount;
+			i = (i + 1) & mask) {
+		if(keyEquals(slots[i], k.data(), k.size()))
+			return slots[i];
+	}
+	return -1;
+}
+
+Key MappedGraph::getKey(Offset s) const {
+	return Key(keys + keyOffsets[s], keyOffsets[s+1] - keyOffsets[s]);
+}
+
+void MappedGraph::getNeighbors(Offset s, std::vector<Offset>& n) const {
+	StatTimer timer(STAT_GET_NEIGHBORS);
+	n.insert(n.end(), targets + offsets[s], targets + offsets[s+1]);
+}
+
+bool MappedGraph::getNeighbors(const Key& k, std::vector<Key>& n) const {
+	int p = getOffset(k);
+	if(p == -1)
+		return false;
+	std::vector<Offset> nbr;
+	getNeighbors(p, nbr);
+	for(size_t i = 0; i < nbr.size(); ++i) {
+		n.push_back(getKey(nbr[i]));
+	}
+	return true;
+}
+
+Weight MappedGraph::getWeight(Offset s1, Offset s2) const {
+	const Offset* first = targets + offsets[s1];
+	const Offset* last = targets + offsets[s1+1];
+	const Offset* e = std::lower_bound(first, last, s2);
+	if(e == last || *e != s2)
+		return NWT;
+	return weights[e - targets];
+}
+
+bool MappedGraph::getWeight(const Key& k1, const Key& k2, Weight& w) const {
+	int p1 = getOffset(k1);
+	int p2 = getOffset(k2);
+	if(p1 == -1 || p2 == -1)
+		return false;
+	w = getWeight(p1, p2);
+	return w != NWT;
+}
+
+bool MappedGraph::isEdge(const Key& k1, const Key& k2) const {
+	Weight w;
+	return getWeight(k1, k2, w);
+}
+
+void MappedGraph::advise(const void* first, size_t bytes, int advice) const {
+	uintptr_t begin = (uintptr_t)first & ~(((uintptr_t)1 << pageShift) - 1);
+	uintptr_t end = (uintptr_t)first + bytes;
+	if(end > begin)
+		madvise((void*)begin, end - begin, advice);
+}
+
+void MappedGraph::hint(const void* first, size_t bytes) const {
+	size_t begin = ((const char*)first - base) >> pageShift;
+	size_t end = ((const char*)first - base + bytes - 1) >> pageShift;
+	bool fresh = false;
+	for(size_t p = begin; p <= end; ++p) {
+		fresh |= hinted.testAndSet(p);
+	}
+	if(fresh)
+		advise(first, bytes, MADV_WILLNEED);
+}
+
+void MappedGraph::prefetch(Offset s) const {
+	size_t d = offsets[s+1] - offsets[s];
+	if(d == 0)
+		return;
+	hint(targets + offsets[s], d * sizeof(Offset));
+	hint(weights + offsets[s], d * sizeof(Weight));
+}
+
+void MappedGraph::memoryUsage(std::vector<MemComponent>& m) const {
+	MemComponent idx = {"key index", slots.size() * sizeof(Offset),
+			(slots.capacity() - slots.size()) * sizeof(Offset)};
+	MemComponent mapped = {"mapped file", length, 0};
+	m.push_back(idx);
+	m.push_back(mapped);
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// MAPPED FILE IMPLEMENTATION                                              //
+/////////////////////////////////////////////////////////////////////////////
+
+int writeMapped(const CSRGraph& c, const std::vector<Key>& keys,
+		const std::string& file) {
+	if(!hasExtension(file, mappedExt))
+		return -2;
+	MappedHeader h;
+	h.vertices = c.getVertexCount();
+	h.edges = c.getEdgeCount();
+	h.keyBytes = 0;
+	for(size_t i = 0; i < keys.size(); ++i) {
+		h.keyBytes += keys[i].size();
+	}
+	char* base;
+	MappedLayout l;
+	if(createMapped(file, h, base, l) != 0)
+		return -1;
+	uint64_t* offsets = (uint64_t*)(base + l.offsets);
+	uint64_t* keyOffsets = (uint64_t*)(base + l.keyOffsets);
+	offsets[0] = 0;
+	keyOffsets[0] = 0;
+	for(Offset v = 0; v < h.vertices; ++v) {
+		offsets[v+1] = c.offsets[v+1];
+		keyOffsets[v+1] = keyOffsets[v] + keys[v].size();
+		memcpy(base + l.keys + keyOffsets[v], keys[v].data(), keys[v].size());
+	}
+	if(h.edges > 0) {
+		memcpy(base + l.targets, &c.targets[0], h.edges * sizeof(Offset));
+		memcpy(base + l.weights, &c.weights[0], h.edges * sizeof(Weight));
+	}
+	return finishMapped(base, l);
+}
+
+int writeMapped(const WeightedDigraph& g, const std::string& file) {
+	CSRGraph c;
+	std::vector<Key> keys;
+	buildCSR(g, c);
+	for(Offset v = 0; v < g.getVertexCount(); ++v) {
+		keys.push_back(g.getKey(v));
+	}
+	return writeMapped(c, keys, file);
+}
+
+int convertToMapped(const std::string& graphFile, const std::string& file) {
+	if(!hasExtension(graphFile, graphExt) || !hasExtension(file, mappedExt))
+		return -2;
+	std::unordered_map<Key, Offset> index;
+	std::vector<uint64_t> degree;
+	std::vector<std::pair<Key, std::string>> e;
+	std::vector<std::pair<Offset, Weight>> row;
+	std::string line, text;
+	Key k;
+	MappedHeader h;
+	h.keyBytes = 0;
+	h.edges = 0;
+
+	// the first pass numbers the vertices, the second sizes their rows
+	std::ifstream in(graphFile);
+	if(!in.is_open())
+		return -1;
+	while(std::getline(in, line)) {
+		splitLine(line, k, text);
+		if(k.empty())
+			continue;
+		if(index.count(k))
+			return -3;
+		Offset v = index.size();
+		index[k] = v;
+		h.keyBytes += k.size();
+	}
+	in.clear();
+	in.seekg(0);
+	while(std::getline(in, line)) {
+		splitLine(line, k, text);
+		if(k.empty())
+			continue;
+		resolveRow(text, index, e, row);
+		degree.push_back(row.size());
+		h.edges += row.size();
+	}
+	h.vertices = index.size();
+
+	// the third fills in the file, one row at a time
+	char* base;
+	MappedLayout l;
+	if(createMapped(file, h, base, l) != 0)
+		return -1;
+	uint64_t* offsets = (uint64_t*)(base + l.offsets);
+	uint64_t* keyOffsets = (uint64_t*)(base + l.keyOffsets);
+	Offset* targets = (Offset*)(base + l.targets);
+	Weight* weights = (Weight*)(base + l.weights);
+	offsets[0] = 0;
+	keyOffsets[0] = 0;
+	for(Offset v = 0; v < h.vertices; ++v) {
+		offsets[v+1] = offsets[v] + degree[v];
+	}
+	in.clear();
+	in.seekg(0);
+	Offset v = 0;
+	while(std::getline(in, line)) {
+		splitLine(line, k, text);
+		if(k.empty())
+			continue;
+		keyOffsets[v+1] = keyOffsets[v] + k.size();
+		memcpy(base + l.keys + keyOffsets[v], k.data(), k.size());
+		resolveRow(text, index, e, row);
+		for(size_t j = 0; j < row.size(); ++j) {
+			targets[offsets[v] + j] = row[j].first;
+			weights[offsets[v] + j] = row[j].second;
+		}
+		++v;
+	}
+	return finishMapped(base, l);
+}
@@ -0,0 +1,208 @@
+#pragma once
+
+#include "Graph.h"
+#include "CSR.h"
+#include "Parallel.h"
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+const std::string mappedExt(".mgraph");  // file extension for memory-mapped
+                                         // graphs
+
+/////////////////////////////////////////////////////////////////////////////
+// MEMORY-MAPPED GRAPH                                                     //
+/////////////////////////////////////////////////////////////////////////////
+
+/*
+ * Read-only graph whose adjacency and keys stay in a memory-mapped file, for
+ * graphs too large to load. Only a table of offsets used to find keys is
+ * held in memory, so pages of the file are read as traversals touch them
+ * and the kernel may evict them under memory pressure.
+ *
+ * The query functions match those of WeightedDigraph, and the searching
+ * procedures accept either. Offsets are those of the graph the file was
+ * written from.
+ *
+ * The file holds a header, then the graph in compressed sparse row form
+ * (row offsets, targets in ascending order and weights), then the key of
+ * every vertex, located by a table of key offsets.
+ */
+class MappedGraph {
+	private:
+		int fd;
+		char* base;
+		size_t length;
+		Offset vertexCount;
+		size_t edgeCount;
+		const uint64_t* offsets;
+		const Offset* targets;
+		const Weight* weights;
+		const uint64_t* keyOffsets;
+		const char* keys;
+		std::vector<Offset> slots;  // open-addressed key index; vertexCount
+		                            // marks an empty slot
+		unsigned pageShift;         // log2 of the page size
+		mutable Bitset hinted;      // pages of the file already prefetched
+
+		/*
+		 * Determines if the key of the vertex at offset s equals k.
+		 */
+		bool keyEquals(Offset s, const char* k, size_t len) const;
+
+		/*
+		 * Applies madvise advice to the pages spanning [first, first + bytes).
+		 */
+		void advise(const void* first, size_t bytes, int advice) const;
+
+		/*
+		 * Asks the kernel to read in the pages spanning [first, first + bytes),
+		 * unless every one was asked for before.
+		 */
+		void hint(const void* first, size_t bytes) const;
+
+		MappedGraph(const MappedGraph&) = delete;
+		MappedGraph& operator=(const MappedGraph&) = delete;
+	public:
+		/* Constructor */
+		MappedGraph();
+
+		/* Destructor; unmaps any open file */
+		~MappedGraph();
+
+		/*
+		 * Maps a graph file written by writeMapped or convertToMapped,
+		 * replacing any file already open. Builds the key index, which reads
+		 * every key once.
+		 *
+		 * @param file, name of the file to map
+		 *
+		 * @return 0 upon successful mapping
+		 *        -1 upon inability to open or map file
+		 *        -2 upon improper extension
+		 *        -3 upon a file that is not a mapped graph, or is truncated
+		 */
+		int open(const std::string& file);
+
+		/*
+		 * Unmaps the open file, leaving an empty graph.
+		 */
+		void close();
+
+		bool isEmpty() const;
+
+		Offset getVertexCount() const;
+
+		size_t getEdgeCount() const;
+
+		/*
+		 * Determines the offset at which vertex k is stored.
+		 *
+		 * @return the offset of k
+		 *         -1 if k does not exist
+		 */
+		int getOffset(const Key& k) const;
+
+		/*
+		 * Retrieves the key of the vertex stored at offset s, copied out of
+		 * the file.
+		 */
+		Key getKey(Offset s) const;
+
+		/*
+		 * Retrieves the offsets of the neighbors of the vertex at offset s, in
+		 * ascending order.
+		 *
+		 * @param s, a valid vertex offset
+		 * @param n, list of neighboring offsets appended to by reference
+		 */
+		void getNeighbors(Offset s, std::vector<Offset>& n) const;
+
+		/*
+		 * Retrieves the neighbors of vertex k.
+		 *
+		 * @return true upon successful retrieval
+		 *         false if k does not exist
+		 */
+		bool getNeighbors(const Key& k, std::vector<Key>& n) const;
+
+		/*
+		 * Retrieves the weight of the edge going from offset s1 to offset s2.
+		 *
+		 * @return the weight of the edge; NWT if there is no such edge
+		 */
+		Weight getWeight(Offset s1, Offset s2) const;
+
+		/*
+		 * Retrieves the weight of the edge going from k1 to k2.
+		 *
+		 * @return true if there is an edge from k1 to k2
+		 *         false if there is not, or if k1 or k2 does not exist
+		 */
+		bool getWeight(const Key& k1, const Key& k2, Weight& w) const;
+
+		bool isEdge(const Key& k1, const Key& k2) const;
+
+		/*
+		 * Hints that the edges of the vertex at offset s will be read soon, so
+		 * that the kernel can start reading their pages in. Searches call this
+		 * as vertices join their frontier. Each page is asked for once per
+		 * open, since the system call costs more than reading a cached page.
+		 *
+		 * @param s, a valid vertex offset
+		 */
+		void prefetch(Offset s) const;
+
+		/*
+		 * Determines the memory held by the graph: the resident key index, and
+		 * the mapped file, of which only recently used pages are resident.
+		 *
+		 * @param m, one entry per component appended to by reference
+		 */
+		void memoryUsage(std::vector<MemComponent>& m) const;
+};
+
+/////////////////////////////////////////////////////////////////////////////
+// MAPPED FILE PROCEDURES                                                  //
+/////////////////////////////////////////////////////////////////////////////
+
+/*
+ * Writes a snapshot and the keys of its vertices as a mapped graph file.
+ * Will overwrite a file with the same name.
+ *
+ * @param c, the snapshot, with every row in ascending target order
+ * @param keys, the key of every vertex of c
+ * @param file, the name of the file to write
+ *
+ * @return 0 upon successful write
+ *        -1 upon inability to create file
+ *        -2 upon improper extension
+ */
+int writeMapped(const CSRGraph& c, const std::vector<Key>& keys,
+		const std::string& file);
+
+/*
+ * Writes a graph as a mapped graph file.
+ *
+ * @return as writeMapped(const CSRGraph&, ...)
+ */
+int writeMapped(const WeightedDigraph& g, const std::string& file);
+
+/*
+ * Converts a .graph file into a mapped graph file without loading the graph,
+ * so that graphs larger than memory can be converted. The .graph file is
+ * streamed three times; only the key index and a count per vertex are kept
+ * in memory. Edges are kept under the same rules as fileLoad: edges to
+ * vertices that do not exist, and weights that are malformed or out of
+ * range, are skipped, and the last of several edges between the same pair of
+ * vertices wins.
+ *
+ * @param graphFile, name of the .graph file to convert
+ * @param file, the name of the mapped graph file to write
+ *
+ * @return 0 upon successful conversion
+ *        -1 upon inability to open either file
+ *        -2 upon improper extension of either file
+ *        -3 upon a vertex key that appears on more than one line
+ */
+int convertToMapped(const std::string& graphFile, const std::string& file);
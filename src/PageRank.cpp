@@ -0,0 +1,187 @@
+#include "PageRank.h"
+#include "Parallel.h"
+#include "Stats.h"
+#include <fstream>
+#include <iomanip>
+#include <algorithm>
+#include <deque>
+#include <unordered_map>
+#include <unordered_set>
+#include <cmath>
+
+#define RANK_BLOCK 4096          // vertices handed to a thread at a time
+#define PPR_MIN_TOLERANCE 1e-12  // smallest residual bound pushed to, since
+                                 // with none the pushes never end
+
+/////////////////////////////////////////////////////////////////////////////
+// AUXILIARY FUNCTIONS                                                     //
+/////////////////////////////////////////////////////////////////////////////
+
+/*
+ * The weight with which an edge is followed.
+ */
+static inline double transition(Weight w, bool weighted) {
+	return weighted ? (w > 0 ? w : 0) : 1;
+}
+
+/*
+ * Sums the transition weights of the out-edges of a vertex.
+ */
+static double outWeight(const CSRGraph& g, Offset v, bool weighted) {
+	double total = 0;
+	for(size_t e = g.offsets[v]; e < g.offsets[v+1]; ++e) {
+		total += transition(g.weights[e], weighted);
+	}
+	return total;
+}
+
+/*
+ * Sums per-block partial results in block order, so that totals do not
+ * depend on how blocks were shared out between threads.
+ */
+static double sumBlocks(const std::vector<double>& partial) {
+	double total = 0;
+	for(size_t b = 0; b < partial.size(); ++b) {
+		total += partial[b];
+	}
+	return total;
+}
+
+static bool higherRank(const Score& a, const Score& b) {
+	return a.second > b.second || (a.second == b.second && a.first < b.first);
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// RANKING IMPLEMENTATION                                                  //
+/////////////////////////////////////////////////////////////////////////////
+
+unsigned pageRank(const CSRGraph& g, const RankOptions& o,
+		std::vector<double>& rank) {
+	StatTimer timer(STAT_PAGERANK);
+	Offset n = g.getVertexCount();
+	rank.assign(n, n ? 1.0 / n : 0);
+	if(n == 0)
+		return 0;
+	CSRGraph t;
+	transposeCSR(g, t);
+	size_t blocks = (n + RANK_BLOCK - 1) / RANK_BLOCK;
+	std::vector<double> share(n), dangling(n), contrib(n), next(n);
+	std::vector<double> partial(blocks);
+
+	// share is the fraction of a vertex's rank sent per unit of transition
+	// weight; dangling vertices send theirs everywhere instead
+	parallelFor(0, n, RANK_BLOCK, [&](size_t v, unsigned) {
+		double w = outWeight(g, v, o.weighted);
+		share[v] = w > 0 ? 1 / w : 0;
+		dangling[v] = w > 0 ? 0 : 1;
+	});
+
+	unsigned iterations = 0;
+	while(iterations < o.maxIterations) {
+		++iterations;
+
+		// the loops over contiguous blocks are kept branch-free, so that
+		// the compiler can vectorize them
+		parallelFor(0, blocks, 1, [&](size_t b, unsigned) {
+			size_t lo = b * RANK_BLOCK, hi = std::min<size_t>(n, lo + RANK_BLOCK);
+			double lost = 0;
+			for(size_t v = lo; v < hi; ++v) {
+				contrib[v] = rank[v] * share[v];
+				lost += rank[v] * dangling[v];
+			}
+			partial[b] = lost;
+		});
+		double base = (1 - o.damping) / n + o.damping * sumBlocks(partial) / n;
+
+		parallelFor(0, blocks, 1, [&](size_t b, unsigned) {
+			size_t lo = b * RANK_BLOCK, hi = std::min<size_t>(n, lo + RANK_BLOCK);
+			double delta = 0;
+			for(size_t v = lo; v < hi; ++v) {
+				double sum = 0;
+				if(o.weighted) {
+					for(size_t e = t.offsets[v]; e < t.offsets[v+1]; ++e) {
+						sum += contrib[t.targets[e]] * transition(t.weights[e], true);
+					}
+				} else {
+					for(size_t e = t.offsets[v]; e < t.offsets[v+1]; ++e) {
+						sum += contrib[t.targets[e]];
+					}
+				}
+				next[v] = base + o.damping * sum;
+				delta += std::fabs(next[v] - rank[v]);
+			}
+			partial[b] = delta;
+		});
+		rank.swap(next);
+		if(sumBlocks(partial) < o.tolerance)
+			break;
+	}
+	return iterations;
+}
+
+void personalizedPageRank(const CSRGraph& g, Offset seed, const RankOptions& o,
+		std::vector<Score>& rank) {
+	StatTimer timer(STAT_PPR);
+	std::unordered_map<Offset, double> settled, residual;
+	std::unordered_set<Offset> queued;
+	std::deque<Offset> queue;
+	double tolerance = std::max(o.tolerance, PPR_MIN_TOLERANCE);
+
+	// a vertex is pushed once its residual is large for its out-degree
+	auto enqueue = [&](Offset v) {
+		double limit = tolerance * std::max<size_t>(g.getDegree(v), 1);
+		if(residual[v] >= limit && queued.insert(v).second)
+			queue.push_back(v);
+	};
+	residual[seed] = 1;
+	enqueue(seed);
+	while(!queue.empty()) {
+		Offset u = queue.front();
+		queue.pop_front();
+		queued.erase(u);
+		double r = residual[u];
+		residual[u] = 0;
+		settled[u] += (1 - o.damping) * r;
+
+		double mass = o.damping * r;
+		double w = outWeight(g, u, o.weighted);
+		if(w <= 0) {
+			residual[seed] += mass;
+			enqueue(seed);
+			continue;
+		}
+		for(size_t e = g.offsets[u]; e < g.offsets[u+1]; ++e) {
+			double f = transition(g.weights[e], o.weighted);
+			if(f > 0) {
+				residual[g.targets[e]] += mass * f / w;
+				enqueue(g.targets[e]);
+			}
+		}
+	}
+	rank.assign(settled.begin(), settled.end());
+}
+
+void sortRanks(const std::vector<double>& rank, std::vector<Score>& s) {
+	s.resize(rank.size());
+	for(size_t v = 0; v < rank.size(); ++v) {
+		s[v] = Score(v, rank[v]);
+	}
+	sortRanks(s);
+}
+
+void sortRanks(std::vector<Score>& s) {
+	std::sort(s.begin(), s.end(), higherRank);
+}
+
+int writeRanks(const WeightedDigraph& g, const std::vector<Score>& s,
+		const std::string& file) {
+	std::ofstream outFile(file);
+	if(!outFile.is_open())
+		return -1;
+	outFile << std::setprecision(10);
+	for(size_t i = 0; i < s.size(); ++i) {
+		outFile << g.getKey(s[i].first) << '\t' << s[i].second << '\n';
+	}
+	outFile.close();
+	return 0;
+}
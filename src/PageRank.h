@@ -0,0 +1,100 @@
+#pragma once
+
+#include "Graph.h"
+#include "CSR.h"
+#include <string>
+#include <vector>
+#include <utility>
+
+/////////////////////////////////////////////////////////////////////////////
+// RANKING STRUCTURES                                                      //
+/////////////////////////////////////////////////////////////////////////////
+
+/*
+ * Parameters of the ranking procedures below.
+ *
+ * damping is the probability of following an edge rather than jumping to a
+ * random vertex (or back to the seed, for personalized ranks). When weighted
+ * is set, an edge is followed with probability proportional to its weight
+ * among the vertex's out-edges, and edges with weights of 0 or less are
+ * never followed; otherwise every out-edge is equally likely.
+ *
+ * For pageRank, iteration stops once the ranks change by less than
+ * tolerance in total, or after maxIterations. For personalizedPageRank,
+ * tolerance bounds the residual left at each vertex per unit of out-degree,
+ * and is raised to 1e-12 when smaller so that the pushes end.
+ */
+struct RankOptions {
+	double damping = 0.85;
+	double tolerance = 1e-6;
+	unsigned maxIterations = 100;
+	bool weighted = false;
+};
+
+/*
+ * A vertex offset and its rank.
+ */
+typedef std::pair<Offset, double> Score;
+
+/////////////////////////////////////////////////////////////////////////////
+// RANKING PROCEDURES                                                      //
+/////////////////////////////////////////////////////////////////////////////
+
+/*
+ * Computes the PageRank of every vertex by power iteration. Each iteration
+ * pulls rank along the in-edges of every vertex, so threads write only to
+ * the vertices they own and need no synchronization. The rank of dangling
+ * vertices, which have no edge to follow, is spread evenly over every
+ * vertex, so ranks always sum to 1.
+ *
+ * @param g, the graph
+ * @param o, the ranking parameters
+ * @param rank, the rank of every vertex offset returned by reference
+ *
+ * @return the number of iterations run
+ */
+unsigned pageRank(const CSRGraph& g, const RankOptions& o,
+		std::vector<double>& rank);
+
+/*
+ * Approximates the PageRank of vertices personalized to a seed vertex, in
+ * which every random jump returns to the seed, using the push algorithm of
+ * Andersen, Chung and Lang. Only vertices the walk reaches with significant
+ * probability are ever touched, so the cost depends on the neighborhood of
+ * the seed rather than the size of the graph. Dangling vertices return
+ * their rank to the seed.
+ *
+ * @param g, the graph
+ * @param seed, offset of the seed vertex
+ * @param o, the ranking parameters
+ * @param rank, the vertices with non-zero rank, in no particular order,
+ *        returned by reference
+ */
+void personalizedPageRank(const CSRGraph& g, Offset seed, const RankOptions& o,
+		std::vector<Score>& rank);
+
+/*
+ * Sorts vertices by descending rank, breaking ties by ascending offset.
+ *
+ * @param rank, the rank of every vertex offset
+ * @param s, the sorted scores returned by reference
+ */
+void sortRanks(const std::vector<double>& rank, std::vector<Score>& s);
+void sortRanks(std::vector<Score>& s);
+
+/*
+ * Writes scores to a file, one vertex per line, in the following format:
+ *
+ * <vertex key>\t<rank>
+ *
+ * Will overwrite a file with the same name with new contents.
+ *
+ * @param g, the graph the vertex offsets refer to
+ * @param s, the scores, in the order to write them
+ * @param file, the name of the file to write
+ *
+ * @return 0 upon successful write
+ *        -1 upon unsuccessful write due to inability to open file
+ */
+int writeRanks(const WeightedDigraph& g, const std::vector<Score>& s,
+		const std::string& file);
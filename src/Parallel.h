@@ -0,0 +1,269 @@
+#pragma once
+
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <memory>
+#include <algorithm>
+#include <stdint.h>
+
+/////////////////////////////////////////////////////////////////////////////
+// THREADING                                                               //
+/////////////////////////////////////////////////////////////////////////////
+
+/*
+ * Number of threads used by parallel algorithms. Defaults to the hardware
+ * concurrency; 0 restores the default.
+ */
+inline std::atomic<unsigned>& parallelThreadSetting() {
+	static std::atomic<unsigned> threads(0);
+	return threads;
+}
+
+inline unsigned parallelThreads() {
+	// querying the hardware is a system call, so it is only done once
+	static const unsigned hardware = std::max(1u,
+			std::thread::hardware_concurrency());
+	unsigned n = parallelThreadSetting().load(std::memory_order_relaxed);
+	return n == 0 ? hardware : n;
+}
+
+inline void setParallelThreads(unsigned n) {
+	parallelThreadSetting().store(n, std::memory_order_relaxed);
+}
+
+/*
+ * Calls fn(i, t) for every i in [begin, end), where t in [0, threads) is the
+ * index of the calling thread, suitable for indexing thread-local buffers.
+ * Indices are handed out dynamically in blocks of grain, so skewed per-index
+ * costs still balance across threads. Runs inline when the range fits in a
+ * single block or only one thread is available.
+ *
+ * @param begin, the first index
+ * @param end, one past the last index
+ * @param grain, the number of indices handed out at a time
+ * @param fn, the function to call for every index
+ * @param threads, the number of threads to use; parallelThreads() if 0
+ */
+template<typename F>
+void parallelFor(size_t begin, size_t end, size_t grain, F fn,
+		unsigned threads = 0) {
+	if(begin >= end)
+		return;
+	if(grain == 0)
+		grain = 1;
+	if(threads == 0)
+		threads = parallelThreads();
+	size_t blocks = (end - begin + grain - 1) / grain;
+	if(threads > blocks)
+		threads = blocks;
+	if(threads <= 1) {
+		for(size_t i = begin; i < end; ++i) {
+			fn(i, 0u);
+		}
+		return;
+	}
+	std::atomic<size_t> next(begin);
+	auto run = [&](unsigned t) {
+		while(true) {
+			size_t first = next.fetch_add(grain);
+			if(first >= end)
+				return;
+			size_t last = std::min(end, first + grain);
+			for(size_t i = first; i < last; ++i) {
+				fn(i, t);
+			}
+		}
+	};
+	std::vector<std::thread> pool;
+	for(unsigned t = 1; t < threads; ++t) {
+		pool.push_back(std::thread(run, t));
+	}
+	run(0);
+	for(size_t t = 0; t < pool.size(); ++t) {
+		pool[t].join();
+	}
+}
+
+/*
+ * Concatenates the per-thread output of a parallel loop into out, leaving
+ * the per-thread buffers empty for reuse.
+ *
+ * @param local, the per-thread buffers
+ * @param out, the concatenation returned by reference
+ */
+template<typename T>
+void gather(std::vector<std::vector<T>>& local, std::vector<T>& out) {
+	out.clear();
+	for(size_t i = 0; i < local.size(); ++i) {
+		out.insert(out.end(), local[i].begin(), local[i].end());
+		local[i].clear();
+	}
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// BITSET                                                                  //
+/////////////////////////////////////////////////////////////////////////////
+
+/*
+ * Fixed-size set of bits indexed by vertex offset. Individual bits may be set,
+ * reset and tested concurrently from several threads.
+ */
+class Bitset {
+	private:
+		size_t bits;
+		std::unique_ptr<std::atomic<uint64_t>[]> words;
+
+		static size_t wordCount(size_t n) {
+			return (n + 63) / 64;
+		}
+	public:
+		/* Constructor; all bits start out reset */
+		explicit Bitset(size_t n = 0) {
+			resize(n);
+		}
+
+		/*
+		 * Resizes the set to n bits, resetting every bit.
+		 */
+		void resize(size_t n) {
+			bits = n;
+			words.reset(new std::atomic<uint64_t>[wordCount(n)]);
+			clear();
+		}
+
+		/*
+		 * Resets every bit.
+		 */
+		void clear() {
+			for(size_t i = 0; i < wordCount(bits); ++i) {
+				words[i].store(0, std::memory_order_relaxed);
+			}
+		}
+
+		size_t size() const {
+			return bits;
+		}
+
+		bool test(size_t i) const {
+			return (words[i / 64].load(std::memory_order_relaxed) >> (i % 64)) & 1;
+		}
+
+		void set(size_t i) {
+			words[i / 64].fetch_or(1ULL << (i % 64), std::memory_order_relaxed);
+		}
+
+		void reset(size_t i) {
+			words[i / 64].fetch_and(~(1ULL << (i % 64)), std::memory_order_relaxed);
+		}
+
+		/*
+		 * Sets bit i.
+		 *
+		 * @return true if this call set the bit
+		 *         false if it was already set
+		 */
+		bool testAndSet(size_t i) {
+			uint64_t mask = 1ULL << (i % 64);
+			if(words[i / 64].load(std::memory_order_relaxed) & mask)
+				return false;
+			return !(words[i / 64].fetch_or(mask, std::memory_order_relaxed) & mask);
+		}
+
+		/*
+		 * Counts the bits that are set.
+		 */
+		size_t count() const {
+			size_t c = 0;
+			for(size_t i = 0; i < wordCount(bits); ++i) {
+				c += __builtin_popcountll(words[i].load(std::memory_order_relaxed));
+			}
+			return c;
+		}
+};
+
+/////////////////////////////////////////////////////////////////////////////
+// UNION-FIND                                                              //
+/////////////////////////////////////////////////////////////////////////////
+
+/*
+ * Disjoint sets of the integers [0, n), which may be found and united
+ * concurrently from several threads without locks. Every set is a tree whose
+ * root is its lowest member: unite() links the higher of two roots under the
+ * lower with a compare-and-swap, retrying if another thread relinked it
+ * first, and find() splits the path it climbs as it goes, pointing every
+ * element on it at its grandparent.
+ */
+class UnionFind {
+	private:
+		size_t elements;
+		std::unique_ptr<std::atomic<uint32_t>[]> parent;
+	public:
+		/* Constructor; every element starts out in a set of its own */
+		explicit UnionFind(size_t n = 0) {
+			resize(n);
+		}
+
+		/*
+		 * Resizes to n elements, each in a set of its own.
+		 */
+		void resize(size_t n) {
+			elements = n;
+			parent.reset(new std::atomic<uint32_t>[n]);
+			for(size_t i = 0; i < n; ++i) {
+				parent[i].store(i, std::memory_order_relaxed);
+			}
+		}
+
+		size_t size() const {
+			return elements;
+		}
+
+		/*
+		 * Finds the root of the set holding i.
+		 */
+		uint32_t find(uint32_t i) {
+			while(true) {
+				uint32_t p = parent[i].load(std::memory_order_relaxed);
+				uint32_t gp = parent[p].load(std::memory_order_relaxed);
+				if(p == gp)
+					return p;
+				// a lost race only skips the shortcut
+				parent[i].compare_exchange_weak(p, gp, std::memory_order_relaxed);
+				i = p;
+			}
+		}
+
+		/*
+		 * Points i straight at the root of its set. Safe to run on every
+		 * element at once, but not alongside unite().
+		 */
+		void compress(uint32_t i) {
+			parent[i].store(find(i), std::memory_order_relaxed);
+		}
+
+		/*
+		 * Unites the sets holding i and j.
+		 *
+		 * @return true if this call united two sets
+		 *         false if i and j were already in the same set
+		 */
+		bool unite(uint32_t i, uint32_t j) {
+			while(true) {
+				i = find(i);
+				j = find(j);
+				if(i == j)
+					return false;
+				if(i < j)
+					std::swap(i, j);
+				uint32_t root = i;
+				if(parent[i].compare_exchange_strong(root, j,
+						std::memory_order_relaxed))
+					return true;
+			}
+		}
+
+		bool same(uint32_t i, uint32_t j) {
+			return find(i) == find(j);
+		}
+};
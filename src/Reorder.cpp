@@ -0,0 +1,222 @@
+#include "Reorder.h"
+#include "Parallel.h"
+#include "Stats.h"
+#include <algorithm>
+
+#define REORDER_ROW_GRAIN 1024  // rows handed to a thread at a time
+#define PERIPHERAL_ROUNDS 4     // breadth-first searches spent looking for a
+                                // peripheral vertex per component
+
+/*
+ * State shared by the orderings: the snapshot and its transpose, so that
+ * both the out-neighbors and in-neighbors of a vertex can be visited, and
+ * every vertex's degree.
+ */
+struct OrderState {
+	const CSRGraph& c;
+	CSRGraph t;
+	std::vector<size_t> degree;
+	std::vector<bool> placed;
+
+	explicit OrderState(const CSRGraph& g) : c(g) {
+		transposeCSR(c, t);
+		degree.resize(c.getVertexCount());
+		placed.assign(c.getVertexCount(), false);
+		for(Offset v = 0; v < c.getVertexCount(); ++v) {
+			degree[v] = c.getDegree(v) + t.getDegree(v);
+		}
+	}
+
+	/*
+	 * Calls fn(u) for every out-neighbor and in-neighbor u of v.
+	 */
+	template<typename F>
+	void forNeighbors(Offset v, F fn) const {
+		for(size_t e = c.offsets[v]; e < c.offsets[v+1]; ++e) {
+			fn(c.targets[e]);
+		}
+		for(size_t e = t.offsets[v]; e < t.offsets[v+1]; ++e) {
+			fn(t.targets[e]);
+		}
+	}
+};
+
+/////////////////////////////////////////////////////////////////////////////
+// AUXILIARY FUNCTIONS                                                     //
+/////////////////////////////////////////////////////////////////////////////
+
+/*
+ * Offsets sorted by degree, ascending or descending, with ties in offset
+ * order.
+ */
+static void sortByDegree(const OrderState& s, bool ascending,
+		std::vector<Offset>& order) {
+	order.resize(s.degree.size());
+	for(Offset v = 0; v < order.size(); ++v) {
+		order[v] = v;
+	}
+	std::stable_sort(order.begin(), order.end(), [&](Offset a, Offset b) {
+		return ascending ? s.degree[a] < s.degree[b] : s.degree[a] > s.degree[b];
+	});
+}
+
+/*
+ * Appends the unplaced vertices reachable from root to order in breadth-first
+ * order, placing them. When byDegree is set, the newly found neighbors of
+ * every vertex are appended by ascending degree, as Cuthill-McKee requires.
+ */
+static void breadthFirst(OrderState& s, Offset root, bool byDegree,
+		std::vector<Offset>& order) {
+	size_t head = order.size();
+	order.push_back(root);
+	s.placed[root] = true;
+	while(head < order.size()) {
+		Offset v = order[head++];
+		size_t first = order.size();
+		s.forNeighbors(v, [&](Offset u) {
+			if(!s.placed[u]) {
+				s.placed[u] = true;
+				order.push_back(u);
+			}
+		});
+		if(byDegree) {
+			std::stable_sort(order.begin() + first, order.end(),
+					[&](Offset a, Offset b) { return s.degree[a] < s.degree[b]; });
+		}
+	}
+}
+
+/*
+ * Finds a vertex of high eccentricity in the component of root, by
+ * repeatedly moving to the lowest degree vertex of the last breadth-first
+ * level while the number of levels grows. Leaves placement unchanged.
+ */
+static Offset peripheral(OrderState& s, Offset root,
+		std::vector<Offset>& level, std::vector<Offset>& queue) {
+	size_t depth = 0;
+	for(unsigned round = 0; round < PERIPHERAL_ROUNDS; ++round) {
+		queue.clear();
+		queue.push_back(root);
+		level[root] = 0;
+		s.placed[root] = true;
+		for(size_t head = 0; head < queue.size(); ++head) {
+			Offset v = queue[head];
+			s.forNeighbors(v, [&](Offset u) {
+				if(!s.placed[u]) {
+					s.placed[u] = true;
+					level[u] = level[v] + 1;
+					queue.push_back(u);
+				}
+			});
+		}
+		for(size_t i = 0; i < queue.size(); ++i) {
+			s.placed[queue[i]] = false;
+		}
+		Offset last = level[queue.back()];
+		if(round > 0 && last <= depth)
+			break;
+		depth = last;
+		Offset next = queue.back();
+		for(size_t i = queue.size(); i-- > 0 && level[queue[i]] == last; ) {
+			if(s.degree[queue[i]] < s.degree[next])
+				next = queue[i];
+		}
+		root = next;
+	}
+	return root;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// REORDERING IMPLEMENTATION                                               //
+/////////////////////////////////////////////////////////////////////////////
+
+int parseOrdering(const std::string& name, Ordering& o) {
+	if(name == "degree")
+		o = ORDER_DEGREE;
+	else if(name == "bfs")
+		o = ORDER_BFS;
+	else if(name == "rcm")
+		o = ORDER_RCM;
+	else
+		return -1;
+	return 0;
+}
+
+void computeOrdering(const CSRGraph& c, Ordering o, std::vector<Offset>& order) {
+	OrderState s(c);
+	std::vector<Offset> roots;
+	order.clear();
+	if(o == ORDER_DEGREE) {
+		sortByDegree(s, false, order);
+		return;
+	}
+	if(o == ORDER_BFS) {
+		sortByDegree(s, false, roots);
+		for(size_t i = 0; i < roots.size(); ++i) {
+			if(!s.placed[roots[i]])
+				breadthFirst(s, roots[i], false, order);
+		}
+		return;
+	}
+
+	// reverse Cuthill-McKee, starting every component from the far side of
+	// its lowest degree vertex
+	std::vector<Offset> level(c.getVertexCount());
+	std::vector<Offset> queue;
+	sortByDegree(s, true, roots);
+	for(size_t i = 0; i < roots.size(); ++i) {
+		if(!s.placed[roots[i]])
+			breadthFirst(s, peripheral(s, roots[i], level, queue), true, order);
+	}
+	std::reverse(order.begin(), order.end());
+}
+
+void permuteCSR(const CSRGraph& c, const std::vector<Offset>& order,
+		CSRGraph& p) {
+	Offset n = c.getVertexCount();
+	std::vector<Offset> rank(n);
+	for(Offset i = 0; i < n; ++i) {
+		rank[order[i]] = i;
+	}
+	p.offsets.assign(n + 1, 0);
+	for(Offset i = 0; i < n; ++i) {
+		p.offsets[i+1] = p.offsets[i] + c.getDegree(order[i]);
+	}
+	p.targets.resize(c.targets.size());
+	p.weights.resize(c.weights.size());
+
+	// relabel every row, then restore ascending target order
+	parallelFor(0, n, REORDER_ROW_GRAIN, [&](size_t i, unsigned) {
+		Offset v = order[i];
+		size_t first = p.offsets[i];
+		std::vector<std::pair<Offset, Weight>> row;
+		for(size_t e = c.offsets[v]; e < c.offsets[v+1]; ++e) {
+			row.push_back(std::make_pair(rank[c.targets[e]], c.weights[e]));
+		}
+		std::sort(row.begin(), row.end());
+		for(size_t k = 0; k < row.size(); ++k) {
+			p.targets[first + k] = row[k].first;
+			p.weights[first + k] = row[k].second;
+		}
+	});
+}
+
+void reorderGraph(WeightedDigraph& g, Ordering o) {
+	StatTimer timer(STAT_REORDER);
+	CSRGraph c;
+	std::vector<Offset> order;
+	buildCSR(g, c);
+	computeOrdering(c, o, order);
+	g.permute(order);
+}
+
+Offset bandwidth(const CSRGraph& c) {
+	Offset b = 0;
+	for(Offset v = 0; v < c.getVertexCount(); ++v) {
+		for(size_t e = c.offsets[v]; e < c.offsets[v+1]; ++e) {
+			Offset u = c.targets[e];
+			b = std::max(b, u > v ? u - v : v - u);
+		}
+	}
+	return b;
+}
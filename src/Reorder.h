@@ -0,0 +1,85 @@
+#pragma once
+
+#include "Graph.h"
+#include "CSR.h"
+#include <string>
+#include <vector>
+
+/////////////////////////////////////////////////////////////////////////////
+// VERTEX ORDERINGS                                                        //
+/////////////////////////////////////////////////////////////////////////////
+
+/*
+ * Orderings that place related vertices at nearby offsets, so that
+ * traversals touch fewer cache lines. Edge direction is ignored throughout;
+ * a vertex's degree counts its in-edges and out-edges.
+ *
+ * ORDER_DEGREE, by descending degree, which packs the hubs most traversals
+ *     pass through together.
+ * ORDER_BFS, in breadth-first order from the highest degree vertex of every
+ *     component, which keeps neighbors within a few levels of each other.
+ * ORDER_RCM, reverse Cuthill-McKee, a breadth-first order from a peripheral
+ *     vertex that visits neighbors by ascending degree and is then reversed.
+ *     Minimizes the bandwidth, the largest offset distance spanned by an
+ *     edge.
+ */
+enum Ordering {
+	ORDER_DEGREE,
+	ORDER_BFS,
+	ORDER_RCM
+};
+
+/*
+ * Determines the ordering named by one of "degree", "bfs" or "rcm".
+ *
+ * @param name, the name of the ordering
+ * @param o, the ordering returned by reference
+ *
+ * @return 0 if name is an ordering
+ *        -1 if it is not
+ */
+int parseOrdering(const std::string& name, Ordering& o);
+
+/////////////////////////////////////////////////////////////////////////////
+// REORDERING PROCEDURES                                                   //
+/////////////////////////////////////////////////////////////////////////////
+
+/*
+ * Computes an ordering of the vertices of a snapshot.
+ *
+ * @param c, the snapshot
+ * @param o, the ordering to compute
+ * @param order, the offset of the vertex to place at every position returned
+ * by reference; order[i] moves to offset i
+ */
+void computeOrdering(const CSRGraph& c, Ordering o, std::vector<Offset>& order);
+
+/*
+ * Renumbers the vertices of a snapshot, building a copy in which the vertex
+ * at offset order[i] is at offset i. Rows stay in ascending target order.
+ *
+ * @param c, the snapshot
+ * @param order, a permutation of the vertex offsets
+ * @param p, the renumbered snapshot returned by reference
+ */
+void permuteCSR(const CSRGraph& c, const std::vector<Offset>& order,
+		CSRGraph& p);
+
+/*
+ * Renumbers the vertices of a graph by an ordering. Write the graph to
+ * persist the new order.
+ *
+ * @param g, the graph
+ * @param o, the ordering to apply
+ */
+void reorderGraph(WeightedDigraph& g, Ordering o);
+
+/*
+ * Determines the bandwidth of a snapshot: the largest distance between the
+ * offsets of the two ends of an edge.
+ *
+ * @param c, the snapshot
+ *
+ * @return the bandwidth; 0 if there are no edges
+ */
+Offset bandwidth(const CSRGraph& c);
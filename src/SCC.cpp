@@ -0,0 +1,524 @@
+#include "SCC.h"
+#include "Parallel.h"
+#include "Stats.h"
+#include <atomic>
+#include <memory>
+#include <limits>
+#include <random>
+#include <algorithm>
+
+#define SCC_UNSEEN std::numeric_limits<Offset>::max()
+#define SCC_DONE std::numeric_limits<Offset>::max()
+#define SCC_GRAIN 256           // vertices handed to a thread at a time
+#define SCC_PARALLEL_MIN 32768  // fewest vertices worth a parallel round
+#define SCC_MIN_PROGRESS 64     // coloring stops below 1/64th per round
+#define WCC_NEIGHBOR_ROUNDS 2   // out-edges of every vertex united up front
+#define WCC_SAMPLES 1024        // vertices sampled to find the giant set
+
+/////////////////////////////////////////////////////////////////////////////
+// AUXILIARY STRUCTURES                                                    //
+/////////////////////////////////////////////////////////////////////////////
+
+/*
+ * State shared by the threads of the parallel algorithm. Every vertex still
+ * to be assigned a component has the color of the partition it is in, and
+ * searches only follow edges within a partition.
+ */
+struct SccState {
+	const CSRGraph& g;
+	const CSRGraph& t;
+	std::vector<Offset>& raw;
+	std::unique_ptr<std::atomic<Offset>[]> color;
+	std::unique_ptr<std::atomic<Offset>[]> label;
+	Bitset fw;
+	Bitset bw;
+	std::atomic<Offset> nextComponent;
+
+	SccState(const CSRGraph& graph, const CSRGraph& transpose,
+			std::vector<Offset>& r) : g(graph), t(transpose), raw(r),
+			color(new std::atomic<Offset>[graph.getVertexCount()]),
+			label(new std::atomic<Offset>[graph.getVertexCount()]),
+			fw(graph.getVertexCount()), bw(graph.getVertexCount()),
+			nextComponent(0) {}
+};
+
+/////////////////////////////////////////////////////////////////////////////
+// AUXILIARY FUNCTIONS                                                     //
+/////////////////////////////////////////////////////////////////////////////
+
+/*
+ * Renumbers arbitrary component labels in order of their lowest vertex.
+ */
+static void numberComponents(const std::vector<Offset>& raw, Offset labels,
+		Components& c) {
+	std::vector<Offset> id(labels, SCC_UNSEEN);
+	c.component.resize(raw.size());
+	c.count = 0;
+	for(size_t v = 0; v < raw.size(); ++v) {
+		if(id[raw[v]] == SCC_UNSEEN)
+			id[raw[v]] = c.count++;
+		c.component[v] = id[raw[v]];
+	}
+}
+
+/*
+ * Repeatedly removes vertices with no remaining in-edges or out-edges, each
+ * of which is a component on its own. Self loops are not counted, since they
+ * cannot join a vertex to any other. Every vertex left over is colored 0.
+ */
+static void trim(SccState& s, std::vector<Offset>& live) {
+	const CSRGraph& g = s.g;
+	const CSRGraph& t = s.t;
+	Offset n = g.getVertexCount();
+	unsigned threads = parallelThreads();
+	std::unique_ptr<std::atomic<Offset>[]> in(new std::atomic<Offset>[n]);
+	std::unique_ptr<std::atomic<Offset>[]> out(new std::atomic<Offset>[n]);
+	std::vector<std::vector<Offset>> local(threads);
+	std::vector<Offset> frontier;
+	Bitset removed(n);
+
+	parallelFor(0, n, SCC_GRAIN, [&](size_t v, unsigned tid) {
+		Offset o = 0, i = 0;
+		for(size_t e = g.offsets[v]; e < g.offsets[v+1]; ++e) {
+			o += g.targets[e] != v;
+		}
+		for(size_t e = t.offsets[v]; e < t.offsets[v+1]; ++e) {
+			i += t.targets[e] != v;
+		}
+		out[v].store(o, std::memory_order_relaxed);
+		in[v].store(i, std::memory_order_relaxed);
+		s.color[v].store(0, std::memory_order_relaxed);
+		if(o == 0 || i == 0) {
+			removed.set(v);
+			local[tid].push_back(v);
+		}
+	});
+	gather(local, frontier);
+
+	while(!frontier.empty()) {
+		parallelFor(0, frontier.size(), SCC_GRAIN, [&](size_t i, unsigned tid) {
+			Offset v = frontier[i];
+			s.raw[v] = s.nextComponent.fetch_add(1, std::memory_order_relaxed);
+			s.color[v].store(SCC_DONE, std::memory_order_relaxed);
+			for(size_t e = g.offsets[v]; e < g.offsets[v+1]; ++e) {
+				Offset w = g.targets[e];
+				if(w != v && in[w].fetch_sub(1, std::memory_order_relaxed) == 1
+						&& removed.testAndSet(w))
+					local[tid].push_back(w);
+			}
+			for(size_t e = t.offsets[v]; e < t.offsets[v+1]; ++e) {
+				Offset w = t.targets[e];
+				if(w != v && out[w].fetch_sub(1, std::memory_order_relaxed) == 1
+						&& removed.testAndSet(w))
+					local[tid].push_back(w);
+			}
+		});
+		gather(local, frontier);
+	}
+
+	live.clear();
+	for(Offset v = 0; v < n; ++v) {
+		if(!removed.test(v))
+			live.push_back(v);
+	}
+}
+
+/*
+ * Marks in seen every vertex of a partition reachable from the pivot,
+ * following the rows of g, using a level-synchronous parallel BFS.
+ */
+static void reach(const CSRGraph& g, const SccState& s, Offset pivot,
+		Offset color, Bitset& seen) {
+	std::vector<std::vector<Offset>> local(parallelThreads());
+	std::vector<Offset> frontier(1, pivot);
+	seen.set(pivot);
+	while(!frontier.empty()) {
+		parallelFor(0, frontier.size(), SCC_GRAIN, [&](size_t i, unsigned tid) {
+			Offset v = frontier[i];
+			for(size_t e = g.offsets[v]; e < g.offsets[v+1]; ++e) {
+				Offset w = g.targets[e];
+				if(s.color[w].load(std::memory_order_relaxed) == color
+						&& seen.testAndSet(w))
+					local[tid].push_back(w);
+			}
+		});
+		gather(local, frontier);
+	}
+}
+
+/*
+ * Finds the component of a pivot among the remaining vertices, and splits
+ * what is left into the vertices reached only forwards, only backwards, or
+ * not at all, each of which becomes a partition of its own.
+ */
+static void split(SccState& s, std::vector<Offset>& live) {
+	// a pivot of high in and out degree is likely to sit in a large component
+	Offset pivot = live[0];
+	size_t best = 0;
+	for(size_t i = 0; i < live.size(); ++i) {
+		Offset v = live[i];
+		size_t score = (s.g.getDegree(v) + 1) * (s.t.getDegree(v) + 1);
+		if(score > best) {
+			best = score;
+			pivot = v;
+		}
+	}
+	reach(s.g, s, pivot, 0, s.fw);
+	reach(s.t, s, pivot, 0, s.bw);
+
+	Offset component = s.nextComponent.fetch_add(1);
+	Offset fwColor = 1, bwColor = 2;
+	std::vector<std::vector<Offset>> local(parallelThreads());
+	parallelFor(0, live.size(), SCC_GRAIN, [&](size_t i, unsigned tid) {
+		Offset v = live[i];
+		bool inFw = s.fw.test(v), inBw = s.bw.test(v);
+		if(inFw && inBw) {
+			s.raw[v] = component;
+			s.color[v].store(SCC_DONE, std::memory_order_relaxed);
+			return;
+		}
+		if(inFw)
+			s.color[v].store(fwColor, std::memory_order_relaxed);
+		else if(inBw)
+			s.color[v].store(bwColor, std::memory_order_relaxed);
+		local[tid].push_back(v);
+	});
+	gather(local, live);
+}
+
+/*
+ * Runs one round of the coloring algorithm over the remaining vertices.
+ * The highest vertex offset that reaches each vertex within its partition
+ * is propagated forwards as its label. Every vertex whose label is its own
+ * offset roots a component, made up of the vertices with its label that
+ * reach it. What is left is partitioned by label for the next round.
+ *
+ * @return the number of vertices assigned a component
+ */
+static size_t colorRound(SccState& s, std::vector<Offset>& live) {
+	const CSRGraph& g = s.g;
+	unsigned threads = parallelThreads();
+	std::vector<std::vector<Offset>> local(threads);
+	std::vector<Offset> active(live), roots;
+	Bitset queued(g.getVertexCount());
+	size_t before = live.size();
+
+	parallelFor(0, live.size(), SCC_GRAIN, [&](size_t i, unsigned) {
+		s.label[live[i]].store(live[i], std::memory_order_relaxed);
+	});
+	while(!active.empty()) {
+		parallelFor(0, active.size(), SCC_GRAIN, [&](size_t i, unsigned tid) {
+			Offset v = active[i];
+			queued.reset(v);
+			Offset l = s.label[v].load(std::memory_order_relaxed);
+			Offset c = s.color[v].load(std::memory_order_relaxed);
+			for(size_t e = g.offsets[v]; e < g.offsets[v+1]; ++e) {
+				Offset w = g.targets[e];
+				if(s.color[w].load(std::memory_order_relaxed) != c)
+					continue;
+				Offset old = s.label[w].load(std::memory_order_relaxed);
+				while(old < l && !s.label[w].compare_exchange_weak(old, l,
+						std::memory_order_relaxed)) {}
+				if(old < l && queued.testAndSet(w))
+					local[tid].push_back(w);
+			}
+		});
+		gather(local, active);
+	}
+
+	parallelFor(0, live.size(), SCC_GRAIN, [&](size_t i, unsigned tid) {
+		if(s.label[live[i]].load(std::memory_order_relaxed) == live[i])
+			local[tid].push_back(live[i]);
+	});
+	gather(local, roots);
+
+	// only the vertices labeled with a root are searched from it, so the
+	// searches are independent of one another
+	parallelFor(0, roots.size(), 1, [&](size_t i, unsigned) {
+		Offset r = roots[i];
+		Offset component = s.nextComponent.fetch_add(1);
+		std::vector<Offset> stack(1, r);
+		s.raw[r] = component;
+		s.color[r].store(SCC_DONE, std::memory_order_relaxed);
+		while(!stack.empty()) {
+			Offset v = stack.back();
+			stack.pop_back();
+			for(size_t e = s.t.offsets[v]; e < s.t.offsets[v+1]; ++e) {
+				Offset w = s.t.targets[e];
+				if(s.label[w].load(std::memory_order_relaxed) == r
+						&& s.color[w].load(std::memory_order_relaxed) != SCC_DONE) {
+					s.raw[w] = component;
+					s.color[w].store(SCC_DONE, std::memory_order_relaxed);
+					stack.push_back(w);
+				}
+			}
+		}
+	});
+
+	parallelFor(0, live.size(), SCC_GRAIN, [&](size_t i, unsigned tid) {
+		Offset v = live[i];
+		if(s.color[v].load(std::memory_order_relaxed) != SCC_DONE) {
+			s.color[v].store(s.label[v].load(std::memory_order_relaxed),
+					std::memory_order_relaxed);
+			local[tid].push_back(v);
+		}
+	});
+	gather(local, live);
+	return before - live.size();
+}
+
+/*
+ * Tarjan's algorithm over the vertices for which live(v) holds, searching
+ * from each root in turn. Components are labeled from first onwards.
+ *
+ * @return one past the last label used
+ */
+template<typename Live>
+static Offset tarjan(const CSRGraph& g, const std::vector<Offset>& roots,
+		Live live, std::vector<Offset>& raw, Offset first) {
+	struct Frame {
+		Offset vertex;
+		size_t edge;
+	};
+	Offset n = g.getVertexCount();
+	std::vector<Offset> index(n, SCC_UNSEEN);
+	std::vector<Offset> low(n);
+	std::vector<Offset> stack;
+	std::vector<Frame> calls;
+	Bitset onStack(n);
+	Offset counter = 0, label = first;
+
+	for(size_t i = 0; i < roots.size(); ++i) {
+		Offset root = roots[i];
+		if(index[root] != SCC_UNSEEN)
+			continue;
+		index[root] = low[root] = counter++;
+		stack.push_back(root);
+		onStack.set(root);
+		calls.push_back(Frame{root, g.offsets[root]});
+		while(!calls.empty()) {
+			Frame& top = calls.back();
+			Offset v = top.vertex;
+			if(top.edge < g.offsets[v+1]) {
+				Offset w = g.targets[top.edge++];
+				if(!live(w))
+					continue;
+				if(index[w] == SCC_UNSEEN) {
+					index[w] = low[w] = counter++;
+					stack.push_back(w);
+					onStack.set(w);
+					calls.push_back(Frame{w, g.offsets[w]});
+				} else if(onStack.test(w) && index[w] < low[v]) {
+					low[v] = index[w];
+				}
+				continue;
+			}
+
+			// v is finished; it roots a component if nothing below it
+			// reached a vertex above it
+			if(low[v] == index[v]) {
+				Offset w;
+				do {
+					w = stack.back();
+					stack.pop_back();
+					onStack.reset(w);
+					raw[w] = label;
+				} while(w != v);
+				++label;
+			}
+			calls.pop_back();
+			if(!calls.empty() && low[v] < low[calls.back().vertex])
+				low[calls.back().vertex] = low[v];
+		}
+	}
+	return label;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// STRONGLY CONNECTED COMPONENT IMPLEMENTATION                             //
+/////////////////////////////////////////////////////////////////////////////
+
+void sccTarjan(const CSRGraph& g, Components& c) {
+	StatTimer timer(STAT_SCC);
+	std::vector<Offset> roots(g.getVertexCount());
+	std::vector<Offset> raw(g.getVertexCount());
+	for(Offset v = 0; v < g.getVertexCount(); ++v) {
+		roots[v] = v;
+	}
+	Offset labels = tarjan(g, roots, [](Offset) { return true; }, raw, 0);
+	numberComponents(raw, labels, c);
+}
+
+void sccParallel(const CSRGraph& g, Components& c) {
+	StatTimer timer(STAT_SCC);
+	CSRGraph t;
+	transposeCSR(g, t);
+	std::vector<Offset> raw(g.getVertexCount());
+	std::vector<Offset> live;
+	SccState s(g, t, raw);
+
+	// trimming and a single forward-backward split take care of the
+	// singletons and the giant component found in most real graphs;
+	// coloring then takes apart the many small components left over,
+	// until too few remain to be worth the parallel rounds
+	trim(s, live);
+	if(live.size() >= SCC_PARALLEL_MIN)
+		split(s, live);
+	while(live.size() >= SCC_PARALLEL_MIN) {
+		size_t before = live.size();
+		if(colorRound(s, live) < before / SCC_MIN_PROGRESS)
+			break;
+	}
+	if(!live.empty()) {
+		s.nextComponent = tarjan(g, live, [&](Offset v) {
+			return s.color[v].load(std::memory_order_relaxed) != SCC_DONE;
+		}, raw, s.nextComponent);
+	}
+	numberComponents(raw, s.nextComponent.load(), c);
+}
+
+void condense(const CSRGraph& g, const Components& c, CSRGraph& dag) {
+	std::vector<Offset> src, dst;
+	std::vector<Weight> w;
+	for(Offset v = 0; v < g.getVertexCount(); ++v) {
+		for(size_t e = g.offsets[v]; e < g.offsets[v+1]; ++e) {
+			Offset a = c.component[v], b = c.component[g.targets[e]];
+			if(a != b) {
+				src.push_back(a);
+				dst.push_back(b);
+				w.push_back(g.weights[e]);
+			}
+		}
+	}
+	buildCSR(c.count, src, dst, w, dag);
+
+	// rows are sorted, so parallel edges are adjacent; keep the lightest
+	size_t out = 0;
+	for(Offset a = 0; a < c.count; ++a) {
+		size_t begin = out;
+		for(size_t e = dag.offsets[a]; e < dag.offsets[a+1]; ++e) {
+			if(out > begin && dag.targets[out-1] == dag.targets[e]) {
+				if(dag.weights[e] < dag.weights[out-1])
+					dag.weights[out-1] = dag.weights[e];
+				continue;
+			}
+			dag.targets[out] = dag.targets[e];
+			dag.weights[out++] = dag.weights[e];
+		}
+		dag.offsets[a] = begin;
+	}
+	dag.offsets[c.count] = out;
+	dag.targets.resize(out);
+	dag.weights.resize(out);
+}
+
+void stronglyConnected(const WeightedDigraph& g, Components& c, CSRGraph& dag) {
+	CSRGraph csr;
+	buildCSR(g, csr);
+	if(parallelThreads() > 1 && csr.getVertexCount() >= SCC_PARALLEL_MIN)
+		sccParallel(csr, c);
+	else
+		sccTarjan(csr, c);
+	condense(csr, c, dag);
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// WEAKLY CONNECTED COMPONENT IMPLEMENTATION                               //
+/////////////////////////////////////////////////////////////////////////////
+
+void wccAfforest(const CSRGraph& g, Components& c) {
+	StatTimer timer(STAT_WCC);
+	Offset n = g.getVertexCount();
+	UnionFind sets(n);
+
+	// linking a few neighbors of every vertex joins most of a giant
+	// component, and compressing after each round keeps the trees flat
+	for(unsigned r = 0; r < WCC_NEIGHBOR_ROUNDS; ++r) {
+		parallelFor(0, n, SCC_GRAIN, [&](size_t v, unsigned) {
+			if(g.offsets[v] + r < g.offsets[v+1])
+				sets.unite(v, g.targets[g.offsets[v] + r]);
+		});
+		parallelFor(0, n, SCC_GRAIN, [&](size_t v, unsigned) {
+			sets.compress(v);
+		});
+	}
+
+	// the most frequent root in a sample is very likely the giant's
+	Offset giant = 0;
+	if(n > 0) {
+		std::mt19937 rng(n);
+		std::vector<Offset> sample(WCC_SAMPLES);
+		for(size_t i = 0; i < sample.size(); ++i) {
+			sample[i] = sets.find(rng() % n);
+		}
+		std::sort(sample.begin(), sample.end());
+		size_t best = 0;
+		for(size_t i = 0, j; i < sample.size(); i = j) {
+			for(j = i; j < sample.size() && sample[j] == sample[i]; ++j) {}
+			if(j - i > best) {
+				best = j - i;
+				giant = sample[i];
+			}
+		}
+	}
+
+	// rows hold out-edges alone, so the giant's vertices cannot be skipped
+	// outright as they could in an undirected graph; the edges from them
+	// into it are instead dropped after a glance at the far end
+	parallelFor(0, n, SCC_GRAIN, [&](size_t v, unsigned) {
+		size_t e = g.offsets[v] + WCC_NEIGHBOR_ROUNDS;
+		if(sets.find(v) != giant) {
+			for(; e < g.offsets[v+1]; ++e) {
+				sets.unite(v, g.targets[e]);
+			}
+			return;
+		}
+		for(; e < g.offsets[v+1]; ++e) {
+			if(sets.find(g.targets[e]) != giant)
+				sets.unite(v, g.targets[e]);
+		}
+	});
+	parallelFor(0, n, SCC_GRAIN, [&](size_t v, unsigned) {
+		sets.compress(v);
+	});
+
+	// every root is the lowest vertex of its set, so is numbered before
+	// the rest of it
+	c.component.resize(n);
+	c.count = 0;
+	for(Offset v = 0; v < n; ++v) {
+		Offset root = sets.find(v);
+		c.component[v] = root == v ? c.count++ : c.component[root];
+	}
+}
+
+void weaklyConnected(const WeightedDigraph& g, Components& c) {
+	CSRGraph csr;
+	buildCSR(g, csr);
+	wccAfforest(csr, c);
+}
+
+void componentSizes(const Components& c, std::vector<Offset>& sizes) {
+	sizes.assign(c.count, 0);
+	for(size_t v = 0; v < c.component.size(); ++v) {
+		++sizes[c.component[v]];
+	}
+}
+
+Offset largestComponent(const Components& c) {
+	std::vector<Offset> sizes;
+	componentSizes(c, sizes);
+	if(sizes.empty())
+		return 0;
+	return std::max_element(sizes.begin(), sizes.end()) - sizes.begin();
+}
+
+void extractComponent(const CSRGraph& g, const Components& c, Offset id,
+		Subgraph& s) {
+	std::vector<Offset> vertices;
+	for(Offset v = 0; v < c.component.size(); ++v) {
+		if(c.component[v] == id)
+			vertices.push_back(v);
+	}
+	induceSubgraph(g, vertices, EdgeFilter(), s);
+}
@@ -0,0 +1,131 @@
+#pragma once
+
+#include "Graph.h"
+#include "CSR.h"
+#include "Extract.h"
+#include <vector>
+
+/////////////////////////////////////////////////////////////////////////////
+// COMPONENT STRUCTURES                                                    //
+/////////////////////////////////////////////////////////////////////////////
+
+/*
+ * A partition of the vertices of a graph into components.
+ *
+ * component holds the component id of every vertex offset, and ids run from
+ * 0 to count - 1. Components are numbered in order of their lowest vertex
+ * offset, so every procedure below numbers the same partition identically.
+ */
+struct Components {
+	std::vector<Offset> component;
+	Offset count;
+};
+
+/////////////////////////////////////////////////////////////////////////////
+// STRONGLY CONNECTED COMPONENT PROCEDURES                                 //
+/////////////////////////////////////////////////////////////////////////////
+
+/*
+ * Finds the strongly connected components of a graph using Tarjan's
+ * algorithm on a single thread. The depth-first search is kept on an
+ * explicit stack, so arbitrarily long paths cannot overflow the call stack.
+ *
+ * @param g, the graph
+ * @param c, the components returned by reference
+ */
+void sccTarjan(const CSRGraph& g, Components& c);
+
+/*
+ * Finds the strongly connected components of a graph on every thread.
+ * Vertices without in-edges or out-edges are first trimmed away as singleton
+ * components. The component of a well-connected pivot is then found as the
+ * intersection of its forward and backward reachable sets, searched with a
+ * level-synchronous parallel BFS, which splits off the giant component most
+ * graphs have. The many small components left over are taken apart by rounds
+ * of the coloring algorithm, and a final few by Tarjan's algorithm.
+ *
+ * @param g, the graph
+ * @param c, the components returned by reference
+ */
+void sccParallel(const CSRGraph& g, Components& c);
+
+/*
+ * Builds the condensation of a graph, which has a vertex for every
+ * component and an edge between two components wherever an edge joins a
+ * vertex of the first to a vertex of the second. Each edge carries the
+ * lowest weight among the edges it stands for. The condensation of strongly
+ * connected components is always acyclic.
+ *
+ * @param g, the graph
+ * @param c, the components of the graph
+ * @param dag, the condensation returned by reference
+ */
+void condense(const CSRGraph& g, const Components& c, CSRGraph& dag);
+
+/*
+ * Finds the strongly connected components of a graph and their condensation,
+ * using the parallel algorithm when the graph is large enough and more than
+ * one thread is available.
+ *
+ * @param g, the graph
+ * @param c, the components returned by reference
+ * @param dag, the condensation returned by reference
+ */
+void stronglyConnected(const WeightedDigraph& g, Components& c, CSRGraph& dag);
+
+/////////////////////////////////////////////////////////////////////////////
+// WEAKLY CONNECTED COMPONENT PROCEDURES                                   //
+/////////////////////////////////////////////////////////////////////////////
+
+/*
+ * Finds the weakly connected components of a graph, in which edges join
+ * vertices either way, with the Afforest algorithm over a concurrent
+ * union-find. Every vertex is first united with its first two out-neighbors
+ * in parallel, which in most graphs already gathers the giant component
+ * into one set. The largest set in a random sample of vertices is then
+ * taken to be the giant, and the single parallel pass over the remaining
+ * edges skips every edge whose ends both already lie in it, so the bulk of
+ * the edges cost two reads and no write. No transpose is built.
+ *
+ * @param g, the graph
+ * @param c, the components returned by reference
+ */
+void wccAfforest(const CSRGraph& g, Components& c);
+
+/*
+ * Finds the weakly connected components of a graph.
+ *
+ * @param g, the graph
+ * @param c, the components returned by reference
+ */
+void weaklyConnected(const WeightedDigraph& g, Components& c);
+
+/*
+ * Counts the vertices of every component.
+ *
+ * @param c, the components
+ * @param sizes, the number of vertices of every component returned by
+ * reference, indexed by component id
+ */
+void componentSizes(const Components& c, std::vector<Offset>& sizes);
+
+/*
+ * Finds the component with the most vertices, the lowest numbered one among
+ * ties.
+ *
+ * @param c, the components
+ *
+ * @return the id of the largest component, 0 when there are none
+ */
+Offset largestComponent(const Components& c);
+
+/*
+ * Extracts the subgraph induced by the vertices of one component.
+ *
+ * @param g, the graph
+ * @param c, the components of the graph
+ * @param id, the id of the component to extract
+ * @param s, the subgraph returned by reference
+ */
+void extractComponent(const CSRGraph& g, const Components& c, Offset id,
+		Subgraph& s);
@@ -0,0 +1,123 @@
+#include "Save.h"
+#include "Stats.h"
+#include <cstdio>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+/////////////////////////////////////////////////////////////////////////////
+// AUXILIARY FUNCTIONS                                                     //
+/////////////////////////////////////////////////////////////////////////////
+
+static bool hasGraphExt(const std::string& file) {
+	return file.size() >= graphExt.size() &&
+		file.compare(file.size() - graphExt.size(), graphExt.size(), graphExt) == 0;
+}
+
+/*
+ * Flushes a file, or the directory entries of a directory, to the disk.
+ */
+static bool syncPath(const std::string& path) {
+	int fd = ::open(path.c_str(), O_RDONLY);
+	if(fd == -1)
+		return false;
+	bool ok = fsync(fd) == 0;
+	::close(fd);
+	return ok;
+}
+
+static std::string directoryOf(const std::string& file) {
+	size_t slash = file.find_last_of('/');
+	return slash == std::string::npos ? "." : file.substr(0, slash + 1);
+}
+
+/*
+ * Writes a graph to a temporary file, then renames it over the target. Run
+ * by the child of a background save.
+ *
+ * @return true if the target was replaced
+ */
+static bool writeSave(const WeightedDigraph& g, const std::string& file) {
+	std::string tmp = file.substr(0, file.size() - graphExt.size()) + ".save" +
+		graphExt;
+	if(g.fileWrite(tmp) != 0 || !syncPath(tmp) ||
+			std::rename(tmp.c_str(), file.c_str()) != 0) {
+		std::remove(tmp.c_str());
+		return false;
+	}
+	syncPath(directoryOf(file));
+	return true;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// BACKGROUND SAVE IMPLEMENTATION                                          //
+/////////////////////////////////////////////////////////////////////////////
+
+BackgroundSave::BackgroundSave() : pid(-1), state(SAVE_IDLE), seconds(0) {}
+
+BackgroundSave::~BackgroundSave() {
+	wait();
+}
+
+void BackgroundSave::finish(int status) {
+	pid = -1;
+	state = WIFEXITED(status) && WEXITSTATUS(status) == 0 ? SAVE_DONE :
+		SAVE_FAILED;
+	seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() -
+			started).count();
+}
+
+int BackgroundSave::start(const WeightedDigraph& g, const std::string& file) {
+	if(!hasGraphExt(file))
+		return -2;
+	if(pid != -1)
+		return -4;
+	StatTimer timer(STAT_SAVE_START);
+	std::fflush(NULL);
+	pid_t child = fork();
+	if(child == -1)
+		return -1;
+
+	// the child skips exit handlers and static destructors, which belong to
+	// the parent
+	if(child == 0)
+		_exit(writeSave(g, file) ? 0 : 1);
+	pid = child;
+	state = SAVE_RUNNING;
+	this->file = file;
+	started = std::chrono::steady_clock::now();
+	return 0;
+}
+
+bool BackgroundSave::poll() {
+	int status;
+	if(pid == -1 || waitpid(pid, &status, WNOHANG) != pid)
+		return false;
+	finish(status);
+	return true;
+}
+
+SaveState BackgroundSave::wait() {
+	int status = -1;  // not a normal exit, should the child be lost
+	if(pid != -1) {
+		while(waitpid(pid, &status, 0) == -1 && errno == EINTR) {}
+		finish(status);
+	}
+	return state;
+}
+
+SaveState BackgroundSave::getState() const {
+	return state;
+}
+
+const std::string& BackgroundSave::getFile() const {
+	return file;
+}
+
+double BackgroundSave::getSeconds() const {
+	if(pid != -1)
+		return std::chrono::duration<double>(std::chrono::steady_clock::now() -
+				started).count();
+	return seconds;
+}
@@ -0,0 +1,101 @@
+#pragma once
+
+#include "Graph.h"
+#include <string>
+#include <chrono>
+#include <sys/types.h>
+
+/////////////////////////////////////////////////////////////////////////////
+// BACKGROUND SAVES                                                        //
+/////////////////////////////////////////////////////////////////////////////
+
+/*
+ * The state of a background save.
+ *
+ * SAVE_IDLE, no save has been started.
+ * SAVE_RUNNING, a save is being written.
+ * SAVE_DONE, the last save was written and renamed into place.
+ * SAVE_FAILED, the last save could not be written; the file is untouched.
+ */
+enum SaveState {
+	SAVE_IDLE,
+	SAVE_RUNNING,
+	SAVE_DONE,
+	SAVE_FAILED
+};
+
+/*
+ * Writes a graph to its .graph file in the background, without blocking
+ * edits. start() forks the process, which gives the child a point-in-time
+ * copy of the graph at the cost of copying page tables; pages are then
+ * copied only as the parent edits them. The child writes the graph to a
+ * temporary file next to the target (Boston.graph is written to
+ * Boston.save.graph), flushes it to the disk and renames it over the target,
+ * so that the target always holds either the old graph or the new one.
+ *
+ * One save runs at a time. The caller polls for its completion.
+ */
+class BackgroundSave {
+	private:
+		pid_t pid;                 // the child writing the save, or -1
+		SaveState state;
+		std::string file;          // target of the running or last save
+		std::chrono::steady_clock::time_point started;
+		double seconds;            // duration of the last save
+
+		/*
+		 * Records the exit status of the child.
+		 */
+		void finish(int status);
+
+		BackgroundSave(const BackgroundSave&) = delete;
+		BackgroundSave& operator=(const BackgroundSave&) = delete;
+	public:
+		/* Constructor */
+		BackgroundSave();
+
+		/* Destructor; waits for a running save to finish */
+		~BackgroundSave();
+
+		/*
+		 * Starts writing a graph as it is now to a file in the background.
+		 *
+		 * @param g, the graph to write
+		 * @param file, the .graph file to write, replaced once the save is
+		 * complete
+		 *
+		 * @return 0 upon a save started
+		 *        -1 upon inability to start the save
+		 *        -2 upon improper extension
+		 *        -4 if a save is already running
+		 */
+		int start(const WeightedDigraph& g, const std::string& file);
+
+		/*
+		 * Checks whether the running save has finished, without blocking.
+		 *
+		 * @return true if the save finished since the last call; its outcome
+		 *         is then given by getState()
+		 */
+		bool poll();
+
+		/*
+		 * Blocks until the running save, if any, finishes.
+		 *
+		 * @return the state of the last save
+		 */
+		SaveState wait();
+
+		SaveState getState() const;
+
+		/*
+		 * Retrieves the target of the running or last save.
+		 */
+		const std::string& getFile() const;
+
+		/*
+		 * Retrieves the time the running save has taken so far, or the last
+		 * save took, in seconds.
+		 */
+		double getSeconds() const;
+};
@@ -0,0 +1,203 @@
+#include "Search.h"
+#include "Mapped.h"
+#include "Stats.h"
+#include <queue>
+#include <functional>
+#include <utility>
+
+/////////////////////////////////////////////////////////////////////////////
+// AUXILIARY FUNCTION IMPLEMENTATIONS                                      //
+/////////////////////////////////////////////////////////////////////////////
+
+/*
+ * Rebuilds the path ending at s2 by following parent offsets back to the
+ * source, and totals its cost.
+ */
+template<typename G>
+static void tracePath(const G& g, const std::vector<long>& parent,
+		Offset s2, Path& p) {
+	p.vertices.clear();
+	p.cost = 0;
+	long curr = s2;
+	while(curr != -1) {
+		p.vertices.push_back(curr);
+		curr = parent[curr];
+	}
+	for(size_t i = 0, j = p.vertices.size() - 1; i < j; ++i, --j) {
+		std::swap(p.vertices[i], p.vertices[j]);
+	}
+	for(size_t i = 1; i < p.vertices.size(); ++i) {
+		p.cost += g.getWeight(p.vertices[i-1], p.vertices[i]);
+	}
+}
+
+/*
+ * Depth-limited search with prefix path cycle prevention. The recursion is
+ * kept on an explicit stack so deep limits cannot overflow the call stack.
+ */
+template<typename G>
+static bool depthLimited(const G& g, Offset s1, Offset s2,
+		Offset depth, Path& p) {
+	struct Frame {
+		Offset vertex;
+		std::vector<Offset> nbrs;
+		size_t next;
+	};
+	std::vector<bool> onPath(g.getVertexCount(), false);
+	std::vector<Frame> stack;
+	stack.push_back(Frame{s1, std::vector<Offset>(), 0});
+	onPath[s1] = true;
+	if(s1 == s2) {
+		p.vertices.assign(1, s1);
+		p.cost = 0;
+		return true;
+	}
+	if(depth > 0)
+		g.getNeighbors(s1, stack.back().nbrs);
+	while(!stack.empty()) {
+		Frame& top = stack.back();
+		if(top.next == top.nbrs.size()) {
+			onPath[top.vertex] = false;
+			stack.pop_back();
+			continue;
+		}
+		Offset nbr = top.nbrs[top.next++];
+		if(onPath[nbr])
+			continue;
+		if(nbr == s2) {
+			p.vertices.clear();
+			p.cost = 0;
+			for(size_t i = 0; i < stack.size(); ++i) {
+				p.vertices.push_back(stack[i].vertex);
+			}
+			p.vertices.push_back(nbr);
+			for(size_t i = 1; i < p.vertices.size(); ++i) {
+				p.cost += g.getWeight(p.vertices[i-1], p.vertices[i]);
+			}
+			return true;
+		}
+		onPath[nbr] = true;
+		stack.push_back(Frame{nbr, std::vector<Offset>(), 0});
+		if(stack.size() <= depth)
+			g.getNeighbors(nbr, stack.back().nbrs);
+	}
+	return false;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// SEARCH IMPLEMENTATION                                                   //
+/////////////////////////////////////////////////////////////////////////////
+
+template<typename G>
+bool bfs(const G& g, Offset s1, Offset s2, Path& p) {
+	StatTimer timer(STAT_BFS);
+	std::vector<long> parent(g.getVertexCount(), -1);
+	std::vector<bool> seen(g.getVertexCount(), false);
+	std::queue<Offset> frontier;
+	std::vector<Offset> nbrs;
+	frontier.push(s1);
+	seen[s1] = true;
+	while(!frontier.empty()) {
+		Offset curr = frontier.front();
+		frontier.pop();
+		if(curr == s2) {
+			tracePath(g, parent, s2, p);
+			return true;
+		}
+		nbrs.clear();
+		g.getNeighbors(curr, nbrs);
+		for(size_t i = 0; i < nbrs.size(); ++i) {
+			if(!seen[nbrs[i]]) {
+				seen[nbrs[i]] = true;
+				parent[nbrs[i]] = curr;
+				g.prefetch(nbrs[i]);
+				frontier.push(nbrs[i]);
+			}
+		}
+	}
+	return false;
+}
+
+template<typename G>
+bool ucs(const G& g, Offset s1, Offset s2, Path& p) {
+	StatTimer timer(STAT_UCS);
+	typedef std::pair<long long, Offset> Entry;
+	std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> frontier;
+	std::vector<long> parent(g.getVertexCount(), -1);
+	std::vector<bool> closed(g.getVertexCount(), false);
+	std::vector<long long> cost(g.getVertexCount(), 0);
+	std::vector<bool> reached(g.getVertexCount(), false);
+	std::vector<Offset> nbrs;
+	frontier.push(Entry(0, s1));
+	reached[s1] = true;
+	while(!frontier.empty()) {
+		Entry top = frontier.top();
+		frontier.pop();
+		Offset curr = top.second;
+		if(closed[curr] || top.first != cost[curr])
+			continue;
+		closed[curr] = true;
+		if(curr == s2) {
+			tracePath(g, parent, s2, p);
+			return true;
+		}
+		nbrs.clear();
+		g.getNeighbors(curr, nbrs);
+		for(size_t i = 0; i < nbrs.size(); ++i) {
+			Offset nbr = nbrs[i];
+			if(closed[nbr])
+				continue;
+			long long c = top.first + g.getWeight(curr, nbr);
+			if(!reached[nbr] || c < cost[nbr]) {
+				cost[nbr] = c;
+				parent[nbr] = curr;
+				if(!reached[nbr])
+					g.prefetch(nbr);
+				reached[nbr] = true;
+				frontier.push(Entry(c, nbr));
+			}
+		}
+	}
+	return false;
+}
+
+template<typename G>
+bool dfs(const G& g, Offset s1, Offset s2, Offset depth,
+		Path& p) {
+	StatTimer timer(STAT_DFS);
+	return depthLimited(g, s1, s2, depth, p);
+}
+
+template<typename G>
+bool iddfs(const G& g, Offset s1, Offset s2, Path& p) {
+	StatTimer timer(STAT_IDDFS);
+	Offset n = g.getVertexCount();
+	for(Offset depth = 0; depth < n; ++depth) {
+		if(depthLimited(g, s1, s2, depth, p))
+			return true;
+	}
+	return false;
+}
+
+template<typename G>
+void pathKeys(const G& g, const Path& p, std::vector<Key>& k) {
+	for(size_t i = 0; i < p.vertices.size(); ++i) {
+		k.push_back(g.getKey(p.vertices[i]));
+	}
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// GRAPH TYPE INSTANTIATIONS                                               //
+/////////////////////////////////////////////////////////////////////////////
+
+template bool bfs(const WeightedDigraph&, Offset, Offset, Path&);
+template bool ucs(const WeightedDigraph&, Offset, Offset, Path&);
+template bool dfs(const WeightedDigraph&, Offset, Offset, Offset, Path&);
+template bool iddfs(const WeightedDigraph&, Offset, Offset, Path&);
+template void pathKeys(const WeightedDigraph&, const Path&, std::vector<Key>&);
+
+template bool bfs(const MappedGraph&, Offset, Offset, Path&);
+template bool ucs(const MappedGraph&, Offset, Offset, Path&);
+template bool dfs(const MappedGraph&, Offset, Offset, Offset, Path&);
+template bool iddfs(const MappedGraph&, Offset, Offset, Path&);
+template void pathKeys(const MappedGraph&, const Path&, std::vector<Key>&);
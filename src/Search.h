@@ -0,0 +1,105 @@
+#pragma once
+
+#include "Graph.h"
+#include <string>
+#include <vector>
+
+/////////////////////////////////////////////////////////////////////////////
+// SEARCH STRUCTURES                                                       //
+/////////////////////////////////////////////////////////////////////////////
+
+/*
+ * A path found by one of the searching procedures below.
+ *
+ * vertices holds the offsets visited from the source to the destination,
+ * inclusive, and cost holds the sum of the edge weights along the path.
+ * The cost is kept wider than Weight so that long paths cannot overflow.
+ */
+struct Path {
+	std::vector<Offset> vertices;
+	long long cost;
+};
+
+/////////////////////////////////////////////////////////////////////////////
+// UNINFORMED SEARCHING PROCEDURES                                         //
+/////////////////////////////////////////////////////////////////////////////
+
+/*
+ * The procedures below search either a WeightedDigraph or a MappedGraph; G is
+ * instantiated for both. Searches of a MappedGraph prefetch the edges of
+ * every vertex as it joins the frontier.
+ */
+
+/*
+ * Finds the path from s1 to s2 with the least number of "hops" using a
+ * breadth-first search. Weights do not play a role in selecting the path.
+ *
+ * @param g, the graph to search
+ * @param s1, offset of the source vertex
+ * @param s2, offset of the destination vertex
+ * @param p, the path found returned by reference
+ *
+ * @return true if a path from s1 to s2 was found
+ *         false if no such path exists
+ */
+template<typename G>
+bool bfs(const G& g, Offset s1, Offset s2, Path& p);
+
+/*
+ * Finds the path from s1 to s2 with the lowest cost using a uniform-cost
+ * search. Expanded vertices are closed, so the path is only guaranteed to be
+ * optimal when the weights along it are non-negative.
+ *
+ * @param g, the graph to search
+ * @param s1, offset of the source vertex
+ * @param s2, offset of the destination vertex
+ * @param p, the path found returned by reference
+ *
+ * @return true if a path from s1 to s2 was found
+ *         false if no such path exists
+ */
+template<typename G>
+bool ucs(const G& g, Offset s1, Offset s2, Path& p);
+
+/*
+ * Finds a path from s1 to s2 using a depth-limited depth-first search with
+ * prefix path cycle prevention. Does not guarantee any sort of optimality.
+ *
+ * @param g, the graph to search
+ * @param s1, offset of the source vertex
+ * @param s2, offset of the destination vertex
+ * @param depth, the most number of "hops" the search may take
+ * @param p, the path found returned by reference
+ *
+ * @return true if a path from s1 to s2 was found within the depth limit
+ *         false if no such path exists
+ */
+template<typename G>
+bool dfs(const G& g, Offset s1, Offset s2, Offset depth,
+		Path& p);
+
+/*
+ * Finds the path from s1 to s2 with the least number of "hops" using a
+ * depth-first search with iterative deepening and prefix path cycle
+ * prevention.
+ *
+ * @param g, the graph to search
+ * @param s1, offset of the source vertex
+ * @param s2, offset of the destination vertex
+ * @param p, the path found returned by reference
+ *
+ * @return true if a path from s1 to s2 was found
+ *         false if no such path exists
+ */
+template<typename G>
+bool iddfs(const G& g, Offset s1, Offset s2, Path& p);
+
+/*
+ * Converts the offsets of a path into the keys of the vertices along it.
+ *
+ * @param g, the graph the path was found in
+ * @param p, the path
+ * @param k, the keys along the path appended to by reference
+ */
+template<typename G>
+void pathKeys(const G& g, const Path& p, std::vector<Key>& k);
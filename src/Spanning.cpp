@@ -0,0 +1,359 @@
+#include "Spanning.h"
+#include "Parallel.h"
+#include "Stats.h"
+#include <atomic>
+#include <memory>
+#include <algorithm>
+#include <climits>
+#include <limits>
+#include <stdint.h>
+
+#define SPAN_GRAIN 1024                   // vertices or edges handed to a
+                                          // thread at a time
+#define SPAN_INDEX_BITS 47                // bits of an edge key holding the
+                                          // edge's position
+#define SPAN_NONE UINT64_MAX              // edge key of no edge
+#define SPAN_NIL std::numeric_limits<size_t>::max()
+
+/////////////////////////////////////////////////////////////////////////////
+// AUXILIARY STRUCTURES                                                    //
+/////////////////////////////////////////////////////////////////////////////
+
+/*
+ * A node of a leftist heap of in-edges. Keys are the weights of the edges,
+ * less everything taken off the heap since; delta is taken off this node's
+ * key and every key below it when the node is next touched.
+ */
+struct HeapNode {
+	long long key;
+	long long delta;
+	Offset from;
+	Offset to;
+	size_t left;
+	size_t right;
+	unsigned rank;  // length of the path down the right children
+	Weight weight;
+};
+
+/*
+ * Union-find over vertices whose unions can be undone in reverse order.
+ * Unions are by size without path compression, so finds stay O(log V).
+ */
+class RollbackSets {
+	private:
+		std::vector<Offset> parent;
+		std::vector<Offset> size;
+		std::vector<Offset> history;  // the root linked by each union
+	public:
+		explicit RollbackSets(Offset n) : parent(n), size(n, 1) {
+			for(Offset v = 0; v < n; ++v) {
+				parent[v] = v;
+			}
+		}
+
+		Offset find(Offset v) const {
+			while(parent[v] != v) {
+				v = parent[v];
+			}
+			return v;
+		}
+
+		/*
+		 * @return true if the sets of u and v were united
+		 *         false if they were already the same
+		 */
+		bool unite(Offset u, Offset v) {
+			u = find(u);
+			v = find(v);
+			if(u == v)
+				return false;
+			if(size[u] < size[v])
+				std::swap(u, v);
+			parent[v] = u;
+			size[u] += size[v];
+			history.push_back(v);
+			return true;
+		}
+
+		size_t time() const {
+			return history.size();
+		}
+
+		/*
+		 * Undoes every union after the given time.
+		 */
+		void rollback(size_t t) {
+			while(history.size() > t) {
+				Offset v = history.back();
+				size[parent[v]] -= size[v];
+				parent[v] = v;
+				history.pop_back();
+			}
+		}
+};
+
+/*
+ * A cycle contracted into vertex u after the given union-find time, and the
+ * heap nodes of its edges.
+ */
+struct Contraction {
+	Offset u;
+	size_t time;
+	std::vector<size_t> edges;
+};
+
+/////////////////////////////////////////////////////////////////////////////
+// AUXILIARY FUNCTIONS                                                     //
+/////////////////////////////////////////////////////////////////////////////
+
+/*
+ * Orders edges by weight, then by position in the snapshot.
+ */
+static uint64_t edgeKey(Weight w, size_t e) {
+	return ((uint64_t)(w - SHRT_MIN) << SPAN_INDEX_BITS) | e;
+}
+
+static void lowerTo(std::atomic<uint64_t>& a, uint64_t k) {
+	uint64_t cur = a.load(std::memory_order_relaxed);
+	while(k < cur && !a.compare_exchange_weak(cur, k,
+			std::memory_order_relaxed)) {}
+}
+
+static unsigned rankOf(const std::vector<HeapNode>& h, size_t a) {
+	return a == SPAN_NIL ? 0 : h[a].rank;
+}
+
+/*
+ * Applies a node's delta to its key and hands it down to its children.
+ */
+static void settle(std::vector<HeapNode>& h, size_t a) {
+	HeapNode& x = h[a];
+	if(x.delta != 0) {
+		x.key += x.delta;
+		if(x.left != SPAN_NIL)
+			h[x.left].delta += x.delta;
+		if(x.right != SPAN_NIL)
+			h[x.right].delta += x.delta;
+		x.delta = 0;
+	}
+}
+
+/*
+ * Merges two leftist heaps. Recurses only down right paths, which are
+ * O(log E) long.
+ *
+ * @return the root of the merged heap
+ */
+static size_t merge(std::vector<HeapNode>& h, size_t a, size_t b) {
+	if(a == SPAN_NIL)
+		return b;
+	if(b == SPAN_NIL)
+		return a;
+	settle(h, a);
+	settle(h, b);
+	if(h[b].key < h[a].key)
+		std::swap(a, b);
+	h[a].right = merge(h, h[a].right, b);
+	if(rankOf(h, h[a].left) < rankOf(h, h[a].right))
+		std::swap(h[a].left, h[a].right);
+	h[a].rank = rankOf(h, h[a].right) + 1;
+	return a;
+}
+
+/*
+ * Marks the vertices reachable from the root.
+ *
+ * @return the number of vertices reached
+ */
+static Offset reachable(const CSRGraph& g, Offset root,
+		std::vector<bool>& reached) {
+	reached.assign(g.getVertexCount(), false);
+	std::vector<Offset> stack(1, root);
+	reached[root] = true;
+	Offset count = 1;
+	while(!stack.empty()) {
+		Offset v = stack.back();
+		stack.pop_back();
+		for(size_t e = g.offsets[v]; e < g.offsets[v+1]; ++e) {
+			if(!reached[g.targets[e]]) {
+				reached[g.targets[e]] = true;
+				stack.push_back(g.targets[e]);
+				++count;
+			}
+		}
+	}
+	return count;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// SPANNING PROCEDURES                                                     //
+/////////////////////////////////////////////////////////////////////////////
+
+void minimumSpanningForest(const CSRGraph& g, SpanningTree& t) {
+	StatTimer timer(STAT_MST);
+	Offset n = g.getVertexCount();
+	std::vector<Offset> source(g.getEdgeCount());
+	std::vector<std::vector<size_t>> local(parallelThreads());
+	std::vector<size_t> live, picked, forest;
+	parallelFor(0, n, SPAN_GRAIN, [&](size_t v, unsigned tid) {
+		for(size_t e = g.offsets[v]; e < g.offsets[v+1]; ++e) {
+			source[e] = v;
+			if(g.targets[e] != v)
+				local[tid].push_back(e);
+		}
+	});
+	gather(local, live);
+
+	UnionFind sets(n);
+	std::unique_ptr<std::atomic<uint64_t>[]> best(new std::atomic<uint64_t>[n]);
+	while(!live.empty()) {
+		parallelFor(0, n, SPAN_GRAIN, [&](size_t v, unsigned) {
+			best[v].store(SPAN_NONE, std::memory_order_relaxed);
+		});
+
+		// every edge offers itself to the components at both of its ends, and
+		// those left within a component by the last round are dropped
+		parallelFor(0, live.size(), SPAN_GRAIN, [&](size_t i, unsigned tid) {
+			size_t e = live[i];
+			Offset a = sets.find(source[e]);
+			Offset b = sets.find(g.targets[e]);
+			if(a != b) {
+				uint64_t k = edgeKey(g.weights[e], e);
+				lowerTo(best[a], k);
+				lowerTo(best[b], k);
+				local[tid].push_back(e);
+			}
+		});
+		gather(local, live);
+		if(live.empty())
+			break;
+
+		// the lightest edges form a forest, so every union but the second of
+		// an edge picked from both ends succeeds
+		parallelFor(0, n, SPAN_GRAIN, [&](size_t v, unsigned tid) {
+			uint64_t k = best[v].load(std::memory_order_relaxed);
+			if(k != SPAN_NONE) {
+				size_t e = k & (((uint64_t)1 << SPAN_INDEX_BITS) - 1);
+				if(sets.unite(source[e], g.targets[e]))
+					local[tid].push_back(e);
+			}
+		});
+		gather(local, picked);
+		forest.insert(forest.end(), picked.begin(), picked.end());
+	}
+
+	std::sort(forest.begin(), forest.end());
+	t.edges.clear();
+	t.weight = 0;
+	for(size_t i = 0; i < forest.size(); ++i) {
+		size_t e = forest[i];
+		SpanningEdge s = {source[e], g.targets[e], g.weights[e]};
+		t.edges.push_back(s);
+		t.weight += s.weight;
+	}
+}
+
+bool minimumArborescence(const CSRGraph& g, Offset root, SpanningTree& t) {
+	StatTimer timer(STAT_ARBORESCENCE);
+	Offset n = g.getVertexCount();
+	std::vector<bool> reached;
+	Offset count = reachable(g, root, reached);
+
+	// a heap of the in-edges of every vertex reached, built from the
+	// transpose so that the nodes of each heap start out together
+	CSRGraph r;
+	transposeCSR(g, r);
+	std::vector<HeapNode> h;
+	std::vector<size_t> heap(n, SPAN_NIL);
+	h.reserve(r.getEdgeCount());
+	for(Offset w = 0; w < n; ++w) {
+		if(!reached[w] || w == root)
+			continue;
+		for(size_t e = r.offsets[w]; e < r.offsets[w+1]; ++e) {
+			Offset v = r.targets[e];
+			if(v != w && reached[v]) {
+				HeapNode x = {r.weights[e], 0, v, w, SPAN_NIL, SPAN_NIL, 1,
+					r.weights[e]};
+				h.push_back(x);
+				heap[w] = merge(h, heap[w], h.size() - 1);
+			}
+		}
+	}
+
+	// from every vertex, follow the lightest in-edges back until reaching a
+	// vertex already settled; a vertex met twice closes a cycle, which is
+	// contracted into one vertex whose in-edges are reweighed by the edge
+	// of the cycle they would replace
+	RollbackSets sets(n);
+	std::vector<long> seen(n, -1);
+	std::vector<Offset> path(n);
+	std::vector<size_t> taken(n);
+	std::vector<size_t> in(n, SPAN_NIL);
+	std::vector<Contraction> cycles;
+	seen[root] = root;
+	for(Offset s = 0; s < n; ++s) {
+		if(!reached[s])
+			continue;
+		Offset u = s;
+		size_t depth = 0;
+		while(seen[u] < 0) {
+			size_t top = heap[u];
+			settle(h, top);
+			if(sets.find(h[top].from) == u) {
+				// left inside u by a contraction, so never chosen
+				heap[u] = merge(h, h[top].left, h[top].right);
+				continue;
+			}
+			h[top].delta -= h[top].key;
+			settle(h, top);
+			heap[u] = merge(h, h[top].left, h[top].right);
+			taken[depth] = top;
+			path[depth++] = u;
+			seen[u] = s;
+			u = sets.find(h[top].from);
+			if(seen[u] == (long)s) {
+				Contraction c;
+				c.time = sets.time();
+				size_t end = depth;
+				size_t cyc = SPAN_NIL;
+				Offset w;
+				do {
+					w = path[--depth];
+					cyc = merge(h, cyc, heap[w]);
+				} while(sets.unite(u, w));
+				u = sets.find(u);
+				heap[u] = cyc;
+				seen[u] = -1;
+				c.u = u;
+				c.edges.assign(taken.begin() + depth, taken.begin() + end);
+				cycles.push_back(c);
+			}
+		}
+		for(size_t i = 0; i < depth; ++i) {
+			in[sets.find(h[taken[i]].to)] = taken[i];
+		}
+	}
+
+	// expand the cycles, latest first; each keeps all of its edges but the
+	// one into the vertex its chosen in-edge enters
+	for(size_t i = cycles.size(); i-- > 0;) {
+		const Contraction& c = cycles[i];
+		sets.rollback(c.time);
+		size_t entering = in[c.u];
+		for(size_t j = 0; j < c.edges.size(); ++j) {
+			in[sets.find(h[c.edges[j]].to)] = c.edges[j];
+		}
+		in[sets.find(h[entering].to)] = entering;
+	}
+
+	t.edges.clear();
+	t.weight = 0;
+	for(Offset v = 0; v < n; ++v) {
+		if(reached[v] && v != root) {
+			SpanningEdge s = {h[in[v]].from, v, h[in[v]].weight};
+			t.edges.push_back(s);
+			t.weight += s.weight;
+		}
+	}
+	return count == n;
+}
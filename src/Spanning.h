@@ -0,0 +1,64 @@
+#pragma once
+
+#include "Graph.h"
+#include "CSR.h"
+#include <vector>
+
+/////////////////////////////////////////////////////////////////////////////
+// SPANNING STRUCTURES                                                     //
+/////////////////////////////////////////////////////////////////////////////
+
+/*
+ * An edge of a snapshot chosen by one of the procedures below, in the
+ * direction it is stored.
+ */
+struct SpanningEdge {
+	Offset from;
+	Offset to;
+	Weight weight;
+};
+
+/*
+ * A spanning forest or arborescence, and the total weight of its edges.
+ */
+struct SpanningTree {
+	std::vector<SpanningEdge> edges;
+	long long weight;
+};
+
+/////////////////////////////////////////////////////////////////////////////
+// SPANNING PROCEDURES                                                     //
+/////////////////////////////////////////////////////////////////////////////
+
+/*
+ * Finds a minimum spanning forest of the undirected view of a graph, in
+ * which an edge joins its two ends whichever way it points, using parallel
+ * Boruvka. Every round, each component picks its lightest edge to another
+ * component, racing through atomic minimums, and the picked edges are
+ * contracted through a lock-free union-find; edges left within a component
+ * are then dropped. Ties are broken by position in the snapshot, so the
+ * forest does not depend on the thread count. Self loops are ignored.
+ *
+ * @param g, the graph
+ * @param t, the forest returned by reference, with its edges in snapshot
+ * order; one tree per connected component of the undirected view
+ */
+void minimumSpanningForest(const CSRGraph& g, SpanningTree& t);
+
+/*
+ * Finds a minimum spanning arborescence of the vertices reachable from a
+ * root: the lightest set of edges giving each of them but the root exactly
+ * one in-edge, on a path from the root. Uses the Edmonds algorithm as
+ * improved by Tarjan, in O(E log V): the in-edges of every vertex are held in
+ * a leftist heap, the heaps of a cycle are merged in O(log E) when it is
+ * contracted, and lazy offsets reweigh a whole heap at once.
+ *
+ * @param g, the graph
+ * @param root, the offset of the root
+ * @param t, the arborescence returned by reference, with one edge into
+ * every vertex reached but the root, in ascending order of that vertex
+ *
+ * @return true if every vertex is reachable from the root
+ *         false if the arborescence spans only some of them
+ */
+bool minimumArborescence(const CSRGraph& g, Offset root, SpanningTree& t);
@@ -0,0 +1,268 @@
+#include "Stats.h"
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <mutex>
+#include <vector>
+#include <algorithm>
+
+/////////////////////////////////////////////////////////////////////////////
+// INSTRUMENTATION STRUCTURES AND VARIABLES                                //
+/////////////////////////////////////////////////////////////////////////////
+
+static const char* statNames[STAT_OP_COUNT] = {
+	"addVertex",
+	"removeVertex",
+	"setEdge",
+	"removeEdge",
+	"getNeighbors",
+	"fileLoad",
+	"fileWrite",
+	"bfs",
+	"ucs",
+	"dfs",
+	"iddfs",
+	"scc",
+	"topo",
+	"dagPaths",
+	"pageRank",
+	"ppr",
+	"reorder",
+	"journalCommit",
+	"checkpoint",
+	"snapshotWrite",
+	"snapshotLoad",
+	"lazyLoad",
+	"saveStart",
+	"getPredecessors",
+	"extract",
+	"mst",
+	"arborescence",
+	"maxFlow",
+	"triangles",
+	"betweenness",
+	"wcc",
+	"hops"
+};
+
+/*
+ * Counters owned by a single thread. Only the owning thread writes them, so
+ * a relaxed load and store is enough; they are atomic only so that readers
+ * on other threads see untorn values.
+ */
+struct OpCounters {
+	std::atomic<uint64_t> count;
+	std::atomic<uint64_t> totalNs;
+	std::atomic<uint64_t> buckets[STAT_BUCKETS];
+};
+
+/*
+ * Plain sums of counters, used for reporting and for retired threads.
+ */
+struct OpTotals {
+	uint64_t count;
+	uint64_t totalNs;
+	uint64_t buckets[STAT_BUCKETS];
+};
+
+struct ThreadStats {
+	OpCounters ops[STAT_OP_COUNT];
+	ThreadStats();
+	~ThreadStats();
+};
+
+std::atomic<bool> statsOn(false);
+
+static std::mutex registryMutex;
+static std::vector<ThreadStats*> liveThreads;
+static OpTotals retired[STAT_OP_COUNT];   // samples of threads that exited
+static OpTotals baseline[STAT_OP_COUNT];  // samples discarded by resetStats
+
+/////////////////////////////////////////////////////////////////////////////
+// AUXILIARY FUNCTIONS                                                     //
+/////////////////////////////////////////////////////////////////////////////
+
+static inline void bump(std::atomic<uint64_t>& c, uint64_t v) {
+	c.store(c.load(std::memory_order_relaxed) + v, std::memory_order_relaxed);
+}
+
+/*
+ * Sums the counters of every thread, live or retired. Caller must hold the
+ * registry mutex.
+ */
+static void sumAll(StatOp op, OpTotals& t) {
+	t = retired[op];
+	for(size_t i = 0; i < liveThreads.size(); ++i) {
+		const OpCounters& c = liveThreads[i]->ops[op];
+		t.count += c.count.load(std::memory_order_relaxed);
+		t.totalNs += c.totalNs.load(std::memory_order_relaxed);
+		for(unsigned b = 0; b < STAT_BUCKETS; ++b) {
+			t.buckets[b] += c.buckets[b].load(std::memory_order_relaxed);
+		}
+	}
+}
+
+/*
+ * Sums the counters of every thread recorded since the last reset.
+ */
+static void sumSinceReset(StatOp op, OpTotals& t) {
+	std::lock_guard<std::mutex> guard(registryMutex);
+	sumAll(op, t);
+	t.count -= baseline[op].count;
+	t.totalNs -= baseline[op].totalNs;
+	for(unsigned b = 0; b < STAT_BUCKETS; ++b) {
+		t.buckets[b] -= baseline[op].buckets[b];
+	}
+}
+
+static uint64_t percentile(const OpTotals& t, double p) {
+	uint64_t rank = (uint64_t)(p * t.count);
+	if(rank >= t.count)
+		rank = t.count - 1;
+	uint64_t seen = 0;
+	for(unsigned b = 0; b < STAT_BUCKETS; ++b) {
+		seen += t.buckets[b];
+		if(seen > rank)
+			return statBucketMax(b);
+	}
+	return 0;
+}
+
+static void summarize(const OpTotals& t, StatSummary& s) {
+	s.count = t.count;
+	s.totalNs = t.totalNs;
+	s.p50Ns = s.p90Ns = s.p99Ns = s.maxNs = 0;
+	if(t.count == 0)
+		return;
+	s.p50Ns = percentile(t, 0.50);
+	s.p90Ns = percentile(t, 0.90);
+	s.p99Ns = percentile(t, 0.99);
+	for(unsigned b = STAT_BUCKETS; b > 0; --b) {
+		if(t.buckets[b-1]) {
+			s.maxNs = statBucketMax(b-1);
+			break;
+		}
+	}
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// INSTRUMENTATION IMPLEMENTATION                                          //
+/////////////////////////////////////////////////////////////////////////////
+
+ThreadStats::ThreadStats() {
+	std::lock_guard<std::mutex> guard(registryMutex);
+	liveThreads.push_back(this);
+}
+
+ThreadStats::~ThreadStats() {
+	std::lock_guard<std::mutex> guard(registryMutex);
+	for(unsigned op = 0; op < STAT_OP_COUNT; ++op) {
+		retired[op].count += ops[op].count.load(std::memory_order_relaxed);
+		retired[op].totalNs += ops[op].totalNs.load(std::memory_order_relaxed);
+		for(unsigned b = 0; b < STAT_BUCKETS; ++b) {
+			retired[op].buckets[b] += ops[op].buckets[b].load(std::memory_order_relaxed);
+		}
+	}
+	liveThreads.erase(std::find(liveThreads.begin(), liveThreads.end(), this));
+}
+
+void setStatsEnabled(bool on) {
+	statsOn.store(on, std::memory_order_relaxed);
+}
+
+unsigned statBucket(uint64_t ns) {
+	if(ns < 2 * STAT_SUB_BUCKETS)
+		return ns;
+	unsigned shift = 63 - __builtin_clzll(ns) - 4;
+	return STAT_SUB_BUCKETS * shift + (ns >> shift);
+}
+
+uint64_t statBucketMax(unsigned bucket) {
+	if(bucket < 2 * STAT_SUB_BUCKETS)
+		return bucket;
+	unsigned shift = bucket / STAT_SUB_BUCKETS - 1;
+	uint64_t sub = bucket % STAT_SUB_BUCKETS + STAT_SUB_BUCKETS;
+	return ((sub + 1) << shift) - 1;
+}
+
+void recordStat(StatOp op, uint64_t ns) {
+	// zero-initialized before construction, as thread storage always is
+	static thread_local ThreadStats local;
+	OpCounters& c = local.ops[op];
+	bump(c.count, 1);
+	bump(c.totalNs, ns);
+	bump(c.buckets[statBucket(ns)], 1);
+}
+
+void getStats(StatOp op, StatSummary& s) {
+	OpTotals t;
+	sumSinceReset(op, t);
+	summarize(t, s);
+}
+
+void resetStats() {
+	std::lock_guard<std::mutex> guard(registryMutex);
+	for(unsigned op = 0; op < STAT_OP_COUNT; ++op) {
+		sumAll((StatOp)op, baseline[op]);
+	}
+}
+
+const char* statName(StatOp op) {
+	return statNames[op];
+}
+
+void printStats() {
+	std::cout << std::left << std::setw(14) << "operation" << std::right
+		<< std::setw(10) << "count" << std::setw(12) << "total ms"
+		<< std::setw(10) << "mean us" << std::setw(10) << "p50 us"
+		<< std::setw(10) << "p90 us" << std::setw(10) << "p99 us"
+		<< std::setw(10) << "max us" << std::endl;
+	std::cout << std::fixed << std::setprecision(2);
+	for(unsigned op = 0; op < STAT_OP_COUNT; ++op) {
+		StatSummary s;
+		getStats((StatOp)op, s);
+		if(s.count == 0)
+			continue;
+		std::cout << std::left << std::setw(14) << statNames[op] << std::right
+			<< std::setw(10) << s.count
+			<< std::setw(12) << s.totalNs / 1e6
+			<< std::setw(10) << s.totalNs / 1e3 / s.count
+			<< std::setw(10) << s.p50Ns / 1e3
+			<< std::setw(10) << s.p90Ns / 1e3
+			<< std::setw(10) << s.p99Ns / 1e3
+			<< std::setw(10) << s.maxNs / 1e3 << std::endl;
+	}
+	std::cout.unsetf(std::ios::floatfield);
+	std::cout << std::setprecision(6);
+}
+
+int writeStats(const std::string& file) {
+	std::ofstream outFile(file);
+	if(!outFile.is_open())
+		return -1;
+	outFile << "{\n  \"enabled\": " << (statsEnabled() ? "true" : "false")
+		<< ",\n  \"operations\": [";
+	for(unsigned op = 0; op < STAT_OP_COUNT; ++op) {
+		OpTotals t;
+		StatSummary s;
+		sumSinceReset((StatOp)op, t);
+		summarize(t, s);
+		outFile << (op ? "," : "") << "\n    {\"name\": \"" << statNames[op]
+			<< "\", \"count\": " << s.count << ", \"total_ns\": " << s.totalNs
+			<< ", \"p50_ns\": " << s.p50Ns << ", \"p90_ns\": " << s.p90Ns
+			<< ", \"p99_ns\": " << s.p99Ns << ", \"max_ns\": " << s.maxNs
+			<< ", \"histogram\": [";
+		bool first = true;
+		for(unsigned b = 0; b < STAT_BUCKETS; ++b) {
+			if(t.buckets[b]) {
+				outFile << (first ? "" : ", ") << "[" << statBucketMax(b) << ", "
+					<< t.buckets[b] << "]";
+				first = false;
+			}
+		}
+		outFile << "]}";
+	}
+	outFile << "\n  ]\n}\n";
+	outFile.close();
+	return 0;
+}
@@ -0,0 +1,181 @@
+#pragma once
+
+#include <string>
+#include <atomic>
+#include <chrono>
+#include <stdint.h>
+
+/////////////////////////////////////////////////////////////////////////////
+// INSTRUMENTATION                                                         //
+/////////////////////////////////////////////////////////////////////////////
+
+/*
+ * Per-operation instrumentation.
+ *
+ * Every instrumented operation records a call count, its cumulative time and
+ * a log-linear (HDR-style) latency histogram with 16 sub-buckets per power of
+ * two, giving roughly 6% precision on reported percentiles. Counters live in
+ * thread-local storage, so recording never contends between threads; they
+ * are only summed when read.
+ *
+ * Instrumentation is off until enabled at run time with setStatsEnabled.
+ * While off, an instrumented call costs a single relaxed atomic load.
+ * Building with -DQG_NO_STATS compiles instrumentation out entirely.
+ */
+
+enum StatOp {
+	STAT_ADD_VERTEX,
+	STAT_REMOVE_VERTEX,
+	STAT_SET_EDGE,
+	STAT_REMOVE_EDGE,
+	STAT_GET_NEIGHBORS,
+	STAT_FILE_LOAD,
+	STAT_FILE_WRITE,
+	STAT_BFS,
+	STAT_UCS,
+	STAT_DFS,
+	STAT_IDDFS,
+	STAT_SCC,
+	STAT_TOPO,
+	STAT_DAG_PATHS,
+	STAT_PAGERANK,
+	STAT_PPR,
+	STAT_REORDER,
+	STAT_JOURNAL_COMMIT,
+	STAT_CHECKPOINT,
+	STAT_SNAPSHOT_WRITE,
+	STAT_SNAPSHOT_LOAD,
+	STAT_LAZY_LOAD,
+	STAT_SAVE_START,
+	STAT_GET_PREDECESSORS,
+	STAT_EXTRACT,
+	STAT_MST,
+	STAT_ARBORESCENCE,
+	STAT_MAX_FLOW,
+	STAT_TRIANGLES,
+	STAT_BETWEENNESS,
+	STAT_WCC,
+	STAT_HOPS,
+	STAT_OP_COUNT
+};
+
+#define STAT_SUB_BUCKETS 16     // histogram sub-buckets per power of two
+#define STAT_BUCKETS 976        // enough buckets to cover 64-bit latencies
+
+/*
+ * Summary of the samples recorded for a single operation. Latencies are in
+ * nanoseconds; percentiles and the maximum are reported as the upper bound
+ * of the histogram bucket they fall in.
+ */
+struct StatSummary {
+	uint64_t count;
+	uint64_t totalNs;
+	uint64_t p50Ns;
+	uint64_t p90Ns;
+	uint64_t p99Ns;
+	uint64_t maxNs;
+};
+
+extern std::atomic<bool> statsOn;
+
+/*
+ * Determines whether instrumentation is currently recording.
+ */
+inline bool statsEnabled() {
+#ifdef QG_NO_STATS
+	return false;
+#else
+	return statsOn.load(std::memory_order_relaxed);
+#endif
+}
+
+/*
+ * Turns recording on or off at run time. Has no effect when built with
+ * QG_NO_STATS.
+ *
+ * @param on, true to start recording, false to stop
+ */
+void setStatsEnabled(bool on);
+
+/*
+ * Records a single sample for an operation on the calling thread.
+ *
+ * @param op, the operation
+ * @param ns, the latency of the operation in nanoseconds
+ */
+void recordStat(StatOp op, uint64_t ns);
+
+/*
+ * Sums the samples recorded by every thread since the last reset.
+ *
+ * @param op, the operation
+ * @param s, the summary returned by reference
+ */
+void getStats(StatOp op, StatSummary& s);
+
+/*
+ * Discards every sample recorded so far.
+ */
+void resetStats();
+
+/*
+ * Retrieves the name of an operation as shown by printStats and writeStats.
+ *
+ * @param op, the operation
+ * @return the name of the operation
+ */
+const char* statName(StatOp op);
+
+/*
+ * Maps a latency to its histogram bucket, and a bucket to the largest
+ * latency it holds.
+ */
+unsigned statBucket(uint64_t ns);
+uint64_t statBucketMax(unsigned bucket);
+
+/*
+ * Prints a table of every operation with recorded samples to the console in
+ * the following format:
+ *
+ * <operation> <count> <total ms> <mean us> <p50 us> <p90 us> <p99 us> <max us>
+ */
+void printStats();
+
+/*
+ * Writes every operation's summary and non-empty histogram buckets to a
+ * JSON file. Will overwrite a file with the same name with new contents.
+ *
+ * @param file, the name of the file to write
+ *
+ * @return 0 upon successful write
+ *        -1 upon unsuccessful write due to inability to open file
+ */
+int writeStats(const std::string& file);
+
+/*
+ * Times the enclosing scope and records it against an operation, if
+ * instrumentation was enabled when the scope was entered.
+ */
+class StatTimer {
+#ifndef QG_NO_STATS
+	private:
+		typedef std::chrono::steady_clock Clock;
+		StatOp op;
+		bool on;
+		Clock::time_point start;
+	public:
+		explicit StatTimer(StatOp o) : op(o), on(statsEnabled()) {
+			if(on)
+				start = Clock::now();
+		}
+
+		~StatTimer() {
+			if(on)
+				recordStat(op, std::chrono::duration_cast<std::chrono::nanoseconds>(
+						Clock::now() - start).count());
+		}
+#else
+	public:
+		explicit StatTimer(StatOp) {}
+#endif
+};
@@ -0,0 +1,259 @@
+#include "Triangles.h"
+#include "Parallel.h"
+#include "Stats.h"
+#include <atomic>
+#include <memory>
+#include <algorithm>
+#include <limits>
+#include <stdint.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define TRIANGLES_SSE2
+#endif
+
+#define TRI_GRAIN 64     // vertices handed to a thread at a time; small, as
+                         // the work per vertex is very uneven
+#define TRI_LANES 4      // offsets compared at once by the SSE2 intersection
+#define TRI_NONE std::numeric_limits<Offset>::max()
+
+/////////////////////////////////////////////////////////////////////////////
+// AUXILIARY STRUCTURES                                                    //
+/////////////////////////////////////////////////////////////////////////////
+
+/*
+ * The undirected view of a graph oriented from lower to higher degree, with
+ * vertices renumbered by rank: ascending degree, ties broken by offset. The
+ * row of rank u lists the ranks of its neighbors above it in ascending
+ * order, and both marks those joined to it both ways in the graph.
+ */
+struct Oriented {
+	std::vector<size_t> offsets;
+	std::vector<Offset> targets;
+	std::vector<uint8_t> both;
+};
+
+/////////////////////////////////////////////////////////////////////////////
+// AUXILIARY FUNCTIONS                                                     //
+/////////////////////////////////////////////////////////////////////////////
+
+/*
+ * Calls fn(w, both) once for every neighbor w of v in the undirected view,
+ * in ascending order, merging its row in the graph and in the transpose.
+ */
+template<typename F>
+static void neighbors(const CSRGraph& g, const CSRGraph& r, Offset v, F fn) {
+	size_t i = g.offsets[v], iEnd = g.offsets[v+1];
+	size_t j = r.offsets[v], jEnd = r.offsets[v+1];
+	while(i < iEnd || j < jEnd) {
+		Offset a = i < iEnd ? g.targets[i] : TRI_NONE;
+		Offset b = j < jEnd ? r.targets[j] : TRI_NONE;
+		Offset w = std::min(a, b);
+
+		// skip repeated edges either way
+		while(i < iEnd && g.targets[i] == w) {
+			++i;
+		}
+		while(j < jEnd && r.targets[j] == w) {
+			++j;
+		}
+		if(w != v)
+			fn(w, a == b);
+	}
+}
+
+/*
+ * Calls fn(i, j) for every a[i] equal to some b[j]. Both arrays must be
+ * ascending without repeats. Blocks of four are compared against each other
+ * and each rotation of the other, so a match is found wherever it sits in
+ * the blocks; the block ending lower is then passed, or both if they end
+ * together, and the rest is merged one at a time.
+ */
+template<typename F>
+static inline void intersect(const Offset* a, size_t na, const Offset* b,
+		size_t nb, F fn) {
+	size_t i = 0, j = 0;
+#ifdef TRIANGLES_SSE2
+	while(i + TRI_LANES <= na && j + TRI_LANES <= nb) {
+		__m128i x = _mm_loadu_si128((const __m128i*)(a + i));
+		__m128i y = _mm_loadu_si128((const __m128i*)(b + j));
+		int m[TRI_LANES];
+		for(int r = 0; r < TRI_LANES; ++r) {
+			// lane k of y holds b[j + (k + r) % 4]
+			m[r] = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(x, y)));
+			y = _mm_shuffle_epi32(y, _MM_SHUFFLE(0, 3, 2, 1));
+		}
+		if(m[0] | m[1] | m[2] | m[3]) {
+			for(int r = 0; r < TRI_LANES; ++r) {
+				for(int k = 0; k < TRI_LANES; ++k) {
+					if(m[r] >> k & 1)
+						fn(i + k, j + ((k + r) & 3));
+				}
+			}
+		}
+		Offset aLast = a[i + TRI_LANES - 1];
+		Offset bLast = b[j + TRI_LANES - 1];
+		if(aLast <= bLast)
+			i += TRI_LANES;
+		if(bLast <= aLast)
+			j += TRI_LANES;
+	}
+#endif
+	while(i < na && j < nb) {
+		if(a[i] < b[j])
+			++i;
+		else if(b[j] < a[i])
+			++j;
+		else
+			fn(i++, j++);
+	}
+}
+
+/*
+ * Orients the undirected view of a graph by rank.
+ *
+ * @param g, the graph
+ * @param degree, the number of neighbors of every vertex, returned by
+ * reference
+ * @param both, the number of neighbors of every vertex joined to it both
+ * ways, returned by reference
+ * @param order, the vertex at every rank, returned by reference
+ * @param o, the oriented view returned by reference
+ */
+static void orient(const CSRGraph& g, std::vector<Offset>& degree,
+		std::vector<Offset>& both, std::vector<Offset>& order, Oriented& o) {
+	Offset n = g.getVertexCount();
+	CSRGraph r;
+	transposeCSR(g, r);
+	degree.assign(n, 0);
+	both.assign(n, 0);
+	parallelFor(0, n, TRI_GRAIN, [&](size_t v, unsigned) {
+		neighbors(g, r, v, [&](Offset, bool b) {
+			++degree[v];
+			both[v] += b;
+		});
+	});
+
+	// counting sort by degree, which keeps ties in offset order
+	Offset maxDegree = n == 0 ? 0 :
+		*std::max_element(degree.begin(), degree.end());
+	std::vector<Offset> start(maxDegree + 2, 0);
+	std::vector<Offset> rank(n);
+	for(Offset v = 0; v < n; ++v) {
+		++start[degree[v] + 1];
+	}
+	for(Offset d = 0; d <= maxDegree; ++d) {
+		start[d+1] += start[d];
+	}
+	order.resize(n);
+	for(Offset v = 0; v < n; ++v) {
+		rank[v] = start[degree[v]]++;
+		order[rank[v]] = v;
+	}
+
+	o.offsets.assign(n + 1, 0);
+	parallelFor(0, n, TRI_GRAIN, [&](size_t v, unsigned) {
+		neighbors(g, r, v, [&](Offset w, bool) {
+			o.offsets[rank[v] + 1] += rank[w] > rank[v];
+		});
+	});
+	for(Offset u = 0; u < n; ++u) {
+		o.offsets[u+1] += o.offsets[u];
+	}
+
+	// each row is sorted as keys holding both in the lowest bit
+	std::vector<uint64_t> keys(o.offsets[n]);
+	o.targets.resize(o.offsets[n]);
+	o.both.resize(o.offsets[n]);
+	parallelFor(0, n, TRI_GRAIN, [&](size_t v, unsigned) {
+		Offset u = rank[v];
+		size_t next = o.offsets[u];
+		neighbors(g, r, v, [&](Offset w, bool b) {
+			if(rank[w] > u)
+				keys[next++] = (uint64_t)rank[w] << 1 | b;
+		});
+		std::sort(keys.begin() + o.offsets[u], keys.begin() + next);
+		for(size_t e = o.offsets[u]; e < next; ++e) {
+			o.targets[e] = keys[e] >> 1;
+			o.both[e] = keys[e] & 1;
+		}
+	});
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// TRIANGLE PROCEDURES                                                     //
+/////////////////////////////////////////////////////////////////////////////
+
+void countTriangles(const CSRGraph& g, const TriangleOptions& o,
+		TriangleCount& t) {
+	StatTimer timer(STAT_TRIANGLES);
+	Offset n = g.getVertexCount();
+	std::vector<Offset> degree, both, order;
+	Oriented d;
+	orient(g, degree, both, order, d);
+
+	// the triangles at every rank; each is found from its lowest ranked
+	// corner u, through the edge to its middle corner v
+	std::unique_ptr<std::atomic<unsigned long long>[]> count(
+			new std::atomic<unsigned long long>[n]);
+	std::vector<unsigned long long> totals(parallelThreads(), 0);
+	parallelFor(0, n, TRI_GRAIN, [&](size_t u, unsigned) {
+		count[u].store(0, std::memory_order_relaxed);
+	});
+	parallelFor(0, n, TRI_GRAIN, [&](size_t u, unsigned tid) {
+		const Offset* a = d.targets.data() + d.offsets[u];
+		const uint8_t* aBoth = d.both.data() + d.offsets[u];
+		size_t na = d.offsets[u+1] - d.offsets[u];
+		unsigned long long here = 0;
+		for(size_t i = 0; i + 1 < na; ++i) {
+			Offset v = a[i];
+
+			// the rows met next are anywhere, so fetch them ahead
+			if(i + 2 < na)
+				__builtin_prefetch(&d.offsets[a[i+2]]);
+			__builtin_prefetch(d.targets.data() + d.offsets[a[i+1]]);
+			const Offset* b = d.targets.data() + d.offsets[v];
+			const uint8_t* bBoth = d.both.data() + d.offsets[v];
+			unsigned long long atV = 0;
+			intersect(a + i + 1, na - i - 1, b, d.offsets[v+1] - d.offsets[v],
+					[&](size_t x, size_t y) {
+				// one way of picking each side per direction it is joined
+				unsigned long long p = o.directed ?
+					(unsigned long long)(1 + aBoth[i]) * (1 + aBoth[i+1+x]) *
+					(1 + bBoth[y]) : 1;
+				atV += p;
+				count[b[y]].fetch_add(p, std::memory_order_relaxed);
+			});
+			if(atV != 0)
+				count[v].fetch_add(atV, std::memory_order_relaxed);
+			here += atV;
+		}
+		if(here != 0)
+			count[u].fetch_add(here, std::memory_order_relaxed);
+		totals[tid] += here;
+	});
+
+	t.total = 0;
+	for(size_t i = 0; i < totals.size(); ++i) {
+		t.total += totals[i];
+	}
+	t.triangles.resize(n);
+	t.clustering.resize(n);
+	double found = 0, possible = 0, sum = 0;
+	for(Offset u = 0; u < n; ++u) {
+		Offset v = order[u];
+		double k = degree[v];
+		double pairs = k * (k - 1) / 2;
+		if(o.directed) {
+			k += both[v];
+			pairs = k * (k - 1) - 2.0 * both[v];
+		}
+		t.triangles[v] = count[u].load(std::memory_order_relaxed);
+		t.clustering[v] = pairs > 0 ? t.triangles[v] / pairs : 0;
+		found += t.triangles[v];
+		possible += pairs;
+		sum += t.clustering[v];
+	}
+	t.globalClustering = possible > 0 ? found / possible : 0;
+	t.averageClustering = n > 0 ? sum / n : 0;
+}
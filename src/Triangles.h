@@ -0,0 +1,65 @@
+#pragma once
+
+#include "Graph.h"
+#include "CSR.h"
+#include <vector>
+
+/////////////////////////////////////////////////////////////////////////////
+// TRIANGLE STRUCTURES                                                     //
+/////////////////////////////////////////////////////////////////////////////
+
+/*
+ * Parameters of countTriangles. Triangles are always found in the undirected
+ * view of a graph, where two vertices are neighbors if an edge joins them
+ * either way; self loops and repeated edges are ignored.
+ *
+ * Undirected, each triangle counts once, and the local clustering of a
+ * vertex with d neighbors is its triangles over the d(d-1)/2 pairs of them.
+ *
+ * Directed, each triangle counts once for every way of picking one edge on
+ * each of its sides, so a triangle of reciprocated edges counts 8 times.
+ * The local clustering of a vertex is then the directed clustering of
+ * Fagiolo (2007): its triangles over d(d-1) - 2b, where d is its in-degree
+ * plus its out-degree and b the number of its neighbors joined to it both
+ * ways.
+ */
+struct TriangleOptions {
+	bool directed = false;
+};
+
+/*
+ * The triangles of a graph. triangles holds the count at every vertex, each
+ * triangle counting at all three of its corners, and clustering the local
+ * clustering of every vertex, 0 for those with fewer than 2 neighbors.
+ * globalClustering is the triangles at every vertex over the pairs of
+ * neighbors of every vertex, the transitivity of the graph when undirected,
+ * and averageClustering the mean local clustering.
+ */
+struct TriangleCount {
+	unsigned long long total;
+	std::vector<unsigned long long> triangles;
+	std::vector<double> clustering;
+	double globalClustering;
+	double averageClustering;
+};
+
+/////////////////////////////////////////////////////////////////////////////
+// TRIANGLE PROCEDURES                                                     //
+/////////////////////////////////////////////////////////////////////////////
+
+/*
+ * Counts the triangles of a graph and the local clustering of every vertex.
+ * The undirected view is oriented from lower to higher degree, which leaves
+ * every vertex at most O(sqrt(E)) out-neighbors, and its rows are renumbered
+ * by degree and sorted. Each triangle is then found once, as the
+ * intersection of the rows at both ends of its lowest edge, comparing four
+ * neighbors against four at a time with SSE2 where available. Vertices are
+ * handed out to threads dynamically in small blocks, so hubs do not hold up
+ * a thread's whole share.
+ *
+ * @param g, the graph
+ * @param o, the interpretation of the edges
+ * @param t, the counts returned by reference, indexed by offset
+ */
+void countTriangles(const CSRGraph& g, const TriangleOptions& o,
+		TriangleCount& t);
@@ -0,0 +1,213 @@
+#include "Workspace.h"
+#include <cstdio>
+#include <cstdlib>
+#include <unistd.h>
+
+/////////////////////////////////////////////////////////////////////////////
+// AUXILIARY FUNCTIONS                                                     //
+/////////////////////////////////////////////////////////////////////////////
+
+/*
+ * Memory used by a graph, slack included.
+ */
+static size_t graphBytes(const WeightedDigraph& g) {
+	std::vector<MemComponent> m;
+	size_t bytes = 0;
+	g.memoryUsage(m);
+	for(size_t i = 0; i < m.size(); ++i) {
+		bytes += m[i].live + m[i].slack;
+	}
+	return bytes;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// WORKSPACE IMPLEMENTATION                                                //
+/////////////////////////////////////////////////////////////////////////////
+
+Workspace::Workspace(size_t bytes) : budget(bytes), clock(0), nextId(0) {}
+
+Workspace::~Workspace() {
+	for(size_t i = 0; i < entries.size(); ++i) {
+		if(!entries[i].graph)
+			std::remove(snapshotFile(entries[i]).c_str());
+	}
+	if(!dir.empty())
+		rmdir(dir.c_str());
+}
+
+Workspace::Entry* Workspace::find(const std::string& name) {
+	for(size_t i = 0; i < entries.size(); ++i) {
+		if(entries[i].name == name)
+			return &entries[i];
+	}
+	return NULL;
+}
+
+std::string Workspace::snapshotFile(const Entry& e) const {
+	return dir + "/" + std::to_string(e.id) + snapshotExt;
+}
+
+bool Workspace::use(Entry& e) {
+	if(!e.graph) {
+		std::unique_ptr<WeightedDigraph> g(new WeightedDigraph);
+		if(g->snapshotLoad(snapshotFile(e)) != 0)
+			return false;
+		std::remove(snapshotFile(e).c_str());
+		e.graph.swap(g);
+	}
+	e.lastUse = ++clock;
+	return true;
+}
+
+bool Workspace::evict(Entry& e) {
+	if(dir.empty()) {
+		const char* tmp = std::getenv("TMPDIR");
+		std::string pattern = std::string(tmp != NULL ? tmp : "/tmp") +
+			"/quickgraphs.XXXXXX";
+		if(mkdtemp(&pattern[0]) == NULL)
+			return false;
+		dir = pattern;
+	}
+	if(e.graph->snapshotWrite(snapshotFile(e)) != 0) {
+		std::remove(snapshotFile(e).c_str());
+		return false;
+	}
+	e.graph.reset();
+	return true;
+}
+
+Workspace::Entry& Workspace::add(const std::string& name) {
+	entries.push_back(Entry());
+	Entry& e = entries.back();
+	e.name = name;
+	e.graph.reset(new WeightedDigraph);
+	e.bytes = 0;
+	e.lastUse = ++clock;
+	e.id = nextId++;
+	return e;
+}
+
+WeightedDigraph* Workspace::create(const std::string& name) {
+	if(find(name) != NULL)
+		return NULL;
+	WeightedDigraph* g = add(name).graph.get();
+	rebalance();
+	return g;
+}
+
+WeightedDigraph* Workspace::get(const std::string& name) {
+	Entry* e = find(name);
+	if(e == NULL || !use(*e))
+		return NULL;
+	WeightedDigraph* g = e->graph.get();
+	rebalance();
+	return g;
+}
+
+WeightedDigraph* Workspace::copy(const std::string& from, const std::string& to) {
+	Entry* e = find(from);
+	if(e == NULL || find(to) != NULL || !use(*e))
+		return NULL;
+	// copied before adding, which may move the source entry
+	std::unique_ptr<WeightedDigraph> c(new WeightedDigraph(*e->graph));
+	WeightedDigraph* g = c.get();
+	add(to).graph.swap(c);
+	rebalance();
+	return g;
+}
+
+bool Workspace::close(const std::string& name) {
+	for(size_t i = 0; i < entries.size(); ++i) {
+		if(entries[i].name == name) {
+			if(!entries[i].graph)
+				std::remove(snapshotFile(entries[i]).c_str());
+			if(pinned == name)
+				pinned.clear();
+			entries.erase(entries.begin() + i);
+			return true;
+		}
+	}
+	return false;
+}
+
+bool Workspace::rename(const std::string& from, const std::string& to) {
+	Entry* e = find(from);
+	if(e == NULL || find(to) != NULL)
+		return false;
+	e->name = to;
+	if(pinned == from)
+		pinned = to;
+	return true;
+}
+
+bool Workspace::contains(const std::string& name) const {
+	for(size_t i = 0; i < entries.size(); ++i) {
+		if(entries[i].name == name)
+			return true;
+	}
+	return false;
+}
+
+void Workspace::setFile(const std::string& name, const std::string& file) {
+	Entry* e = find(name);
+	if(e != NULL)
+		e->file = file;
+}
+
+std::string Workspace::getFile(const std::string& name) const {
+	for(size_t i = 0; i < entries.size(); ++i) {
+		if(entries[i].name == name)
+			return entries[i].file;
+	}
+	return "";
+}
+
+void Workspace::pin(const std::string& name) {
+	pinned = name;
+}
+
+void Workspace::setBudget(size_t bytes) {
+	budget = bytes;
+	rebalance();
+}
+
+size_t Workspace::getBudget() const {
+	return budget;
+}
+
+size_t Workspace::rebalance() {
+	size_t resident = 0;
+	for(size_t i = 0; i < entries.size(); ++i) {
+		if(entries[i].graph) {
+			entries[i].bytes = graphBytes(*entries[i].graph);
+			resident += entries[i].bytes;
+		}
+	}
+	while(resident > budget) {
+		Entry* lru = NULL;
+		Entry* mru = NULL;
+		for(size_t i = 0; i < entries.size(); ++i) {
+			Entry& e = entries[i];
+			if(mru == NULL || e.lastUse > mru->lastUse)
+				mru = &e;
+		}
+		for(size_t i = 0; i < entries.size(); ++i) {
+			Entry& e = entries[i];
+			if(e.graph && &e != mru && e.name != pinned &&
+					(lru == NULL || e.lastUse < lru->lastUse))
+				lru = &e;
+		}
+		if(lru == NULL || !evict(*lru))
+			break;
+		resident -= lru->bytes;
+	}
+	return resident;
+}
+
+void Workspace::list(std::vector<GraphInfo>& g) const {
+	for(size_t i = 0; i < entries.size(); ++i) {
+		GraphInfo info = {entries[i].name, entries[i].file,
+				(bool)entries[i].graph, entries[i].bytes};
+		g.push_back(info);
+	}
+}
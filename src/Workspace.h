@@ -0,0 +1,177 @@
+#pragma once
+
+#include "Graph.h"
+#include <string>
+#include <vector>
+#include <memory>
+#include <stdint.h>
+
+#define WORKSPACE_BUDGET ((size_t)512 << 20)  // default bytes of graphs kept
+                                              // resident
+
+/////////////////////////////////////////////////////////////////////////////
+// WORKSPACE                                                               //
+/////////////////////////////////////////////////////////////////////////////
+
+/*
+ * A graph held by a workspace, as listed by Workspace::list.
+ */
+struct GraphInfo {
+	std::string name;
+	std::string file;  // .graph file loaded from or written to; empty if none
+	bool resident;
+	size_t bytes;      // memory used when last resident
+};
+
+/*
+ * A set of named graphs held at once under a memory budget. When the
+ * resident graphs outgrow the budget, the least recently used are evicted to
+ * binary snapshots in a private temporary directory, and loaded back from
+ * them when next used, which is far quicker than parsing a .graph file.
+ *
+ * The most recently used graph is never evicted, so a pointer returned by
+ * create(), get() or copy() stays valid until another graph is used; a
+ * graph that must outlive that, such as the one being edited, is pinned.
+ * Resident sizes are measured when a graph is used and by rebalance(); call
+ * rebalance() after editing a graph to account for its growth.
+ */
+class Workspace {
+	private:
+		struct Entry {
+			std::string name;
+			std::string file;
+			std::unique_ptr<WeightedDigraph> graph;  // NULL while evicted
+			size_t bytes;
+			uint64_t lastUse;
+			unsigned id;                             // names its snapshot
+		};
+
+		std::vector<Entry> entries;
+		std::string dir;     // snapshot directory, created on first eviction
+		std::string pinned;  // name of the graph never evicted; empty if none
+		size_t budget;
+		uint64_t clock;
+		unsigned nextId;
+
+		Entry* find(const std::string& name);
+		std::string snapshotFile(const Entry& e) const;
+
+		/*
+		 * Marks an entry most recently used, loading it back if evicted.
+		 *
+		 * @return false if its snapshot could not be loaded
+		 */
+		bool use(Entry& e);
+
+		/*
+		 * Snapshots an entry and releases its graph.
+		 *
+		 * @return false if the snapshot could not be written, in which case
+		 *         the graph stays resident
+		 */
+		bool evict(Entry& e);
+
+		/*
+		 * Adds a resident entry, most recently used.
+		 */
+		Entry& add(const std::string& name);
+
+		Workspace(const Workspace&) = delete;
+		Workspace& operator=(const Workspace&) = delete;
+	public:
+		/*
+		 * Constructor
+		 *
+		 * @param bytes, the memory budget of the resident graphs
+		 */
+		explicit Workspace(size_t bytes = WORKSPACE_BUDGET);
+
+		/* Destructor; removes every snapshot */
+		~Workspace();
+
+		/*
+		 * Adds an empty graph, most recently used.
+		 *
+		 * @param name, the name of the graph
+		 *
+		 * @return the graph
+		 *         NULL if the workspace already holds a graph of that name
+		 */
+		WeightedDigraph* create(const std::string& name);
+
+		/*
+		 * Retrieves a graph, loading it back if it was evicted, and marks it
+		 * most recently used. May evict other graphs.
+		 *
+		 * @return the graph
+		 *         NULL if there is no such graph, or it could not be loaded
+		 */
+		WeightedDigraph* get(const std::string& name);
+
+		/*
+		 * Adds a copy of a graph under a new name, most recently used.
+		 *
+		 * @return the copy
+		 *         NULL if there is no graph named from, a graph named to
+		 *         already exists, or from could not be loaded
+		 */
+		WeightedDigraph* copy(const std::string& from, const std::string& to);
+
+		/*
+		 * Removes a graph, and its snapshot if it was evicted.
+		 *
+		 * @return true if the graph was removed
+		 *         false if there is no such graph
+		 */
+		bool close(const std::string& name);
+
+		/*
+		 * Renames a graph, keeping it pinned if it was.
+		 *
+		 * @return true if the graph was renamed
+		 *         false if there is no graph named from, or a graph named to
+		 *         already exists
+		 */
+		bool rename(const std::string& from, const std::string& to);
+
+		bool contains(const std::string& name) const;
+
+		/*
+		 * Associates a graph with the .graph file it was loaded from or last
+		 * written to.
+		 */
+		void setFile(const std::string& name, const std::string& file);
+
+		/*
+		 * Retrieves the file associated with a graph; empty if none.
+		 */
+		std::string getFile(const std::string& name) const;
+
+		/*
+		 * Keeps a graph resident, whatever the budget, until another graph is
+		 * pinned or it is closed. Only one graph is pinned at a time.
+		 *
+		 * @param name, the name of the graph; empty to pin none
+		 */
+		void pin(const std::string& name);
+
+		void setBudget(size_t bytes);
+
+		size_t getBudget() const;
+
+		/*
+		 * Measures the resident graphs, then evicts the least recently used
+		 * until they fit the budget or only the most recently used and the
+		 * pinned graph are left.
+		 *
+		 * @return the bytes used by the resident graphs
+		 */
+		size_t rebalance();
+
+		/*
+		 * Lists the graphs in the order they were added.
+		 *
+		 * @param g, one entry per graph appended to by reference
+		 */
+		void list(std::vector<GraphInfo>& g) const;
+};
@@ -20,6 +20,10 @@
  *     weighted edge.
  * NeighborValidity
  *     -Correct notion of neighbors within a Matrix.
+ * MemoryUsage
+ *     -Correct accounting of live and slack bytes, and their release.
+ * WeightTypes
+ *     -Correct sentinels, neighbors and storage for each weight type.
  */
 
 TEST(AdjMatrixTest, InitClear) {
@@ -225,6 +229,88 @@ TEST(AdjMatrixTest, NeighborValidity) {
 	EXPECT_EQ(nbrs[0], 2);
 }
 
+TEST(AdjMatrixTest, MemoryUsage) {
+	AdjMatrix m;
+	MemComponent rows;
+	MemComponent headers;
+	for(Offset i = 0; i < VCOUNT; ++i) {
+		m.addVertex();
+	}
+
+	// live bytes cover exactly the V^2 weights and V row headers
+	m.memoryUsage(rows, headers);
+	EXPECT_EQ(rows.live, VCOUNT * VCOUNT * sizeof(Weight));
+	EXPECT_EQ(headers.live, VCOUNT * sizeof(std::vector<Weight>));
+
+	// removal leaves slack behind, which shrinkToFit releases
+	for(Offset i = 0; i < VCOUNT - SVCOUNT; ++i) {
+		m.removeVertex(0);
+	}
+	m.memoryUsage(rows, headers);
+	EXPECT_EQ(rows.live, SVCOUNT * SVCOUNT * sizeof(Weight));
+	EXPECT_GT(rows.slack, 0);
+	EXPECT_GT(headers.slack, 0);
+	m.shrinkToFit();
+	m.memoryUsage(rows, headers);
+	EXPECT_EQ(rows.live, SVCOUNT * SVCOUNT * sizeof(Weight));
+	EXPECT_EQ(rows.slack, 0);
+	EXPECT_EQ(headers.slack, 0);
+}
+
+TEST(AdjMatrixTest, WeightTypes) {
+	BasicAdjMatrix<bool> b;
+	BasicAdjMatrix<uint8_t> u;
+	BasicAdjMatrix<int32_t> l;
+	BasicAdjMatrix<float> f;
+	for(Offset i = 0; i < VCOUNT; ++i) {
+		b.addVertex();
+		u.addVertex();
+		l.addVertex();
+		f.addVertex();
+	}
+
+	// every type starts out edgeless, and zero is a valid weight
+	for(Offset i = 0; i < VCOUNT; ++i) {
+		EXPECT_FALSE(b.isEdge(0, i));
+		EXPECT_FALSE(u.isEdge(0, i));
+		EXPECT_FALSE(l.isEdge(0, i));
+		EXPECT_FALSE(f.isEdge(0, i));
+	}
+	b.addEdge(0, 3, true);
+	u.addEdge(0, 3, 0);
+	l.addEdge(0, 3, 100000);
+	f.addEdge(0, 3, 0.0f);
+	u.addEdge(0, 7, 254);
+	l.addEdge(0, 7, -100000);
+	f.addEdge(0, 7, -2.5f);
+	b.addEdge(0, 7, true);
+	EXPECT_EQ(u.getWeight(0, 3), 0);
+	EXPECT_EQ(l.getWeight(0, 3), 100000);
+	EXPECT_EQ(f.getWeight(0, 7), -2.5f);
+
+	std::vector<Offset> nbrs;
+	b.getNeighbors(0, nbrs);
+	EXPECT_EQ(nbrs, std::vector<Offset>({3, 7}));
+	nbrs.clear();
+	u.getNeighbors(0, nbrs);
+	EXPECT_EQ(nbrs, std::vector<Offset>({3, 7}));
+	nbrs.clear();
+	f.getNeighbors(0, nbrs);
+	EXPECT_EQ(nbrs, std::vector<Offset>({3, 7}));
+	f.removeEdge(0, 3);
+	EXPECT_FALSE(f.isEdge(0, 3));
+
+	// narrower types take proportionally less storage; bool packs bits
+	MemComponent rows;
+	MemComponent headers;
+	u.memoryUsage(rows, headers);
+	EXPECT_EQ(rows.live, VCOUNT * VCOUNT);
+	l.memoryUsage(rows, headers);
+	EXPECT_EQ(rows.live, VCOUNT * VCOUNT * 4);
+	b.memoryUsage(rows, headers);
+	EXPECT_EQ(rows.live, VCOUNT * sizeof(uint64_t));
+}
+
 int main(int argc, char** argv) {
 	::testing::InitGoogleTest(&argc, argv);
 	return RUN_ALL_TESTS();
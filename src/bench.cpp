@@ -0,0 +1,1088 @@
+#include <cstdio>
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include "Graph.h"
+#include "Search.h"
+#include "CSR.h"
+#include "SCC.h"
+#include "DAG.h"
+#include "PageRank.h"
+#include "Compress.h"
+#include "Reorder.h"
+#include "Mapped.h"
+#include "Journal.h"
+#include "Workspace.h"
+#include "Save.h"
+#include "Extract.h"
+#include "Spanning.h"
+#include "Flow.h"
+#include "Triangles.h"
+#include "Centrality.h"
+#include "Hops.h"
+#include "Parallel.h"
+#include "benchmark/benchmark.h"
+
+/*
+ * Microbenchmarks for the quick-graphs library.
+ *
+ * Graph sizes are given by the first argument of each benchmark, and edge
+ * densities (percentage of the V^2 possible edges present) by the second.
+ * Results can be emitted as JSON and compared across runs:
+ *
+ *     ./bench --benchmark_out=bench.json --benchmark_out_format=json
+ *
+ * Covers:
+ *     -Vertex mutation (AdjMatrix and WeightedDigraph)
+ *     -Edge mutation
+ *     -Key lookup (findGraphSlot and the key index)
+ *     -Neighbor iteration, for each weight type, and predecessor iteration
+ *     -Degree queries
+ *     -File load and write throughput, lazy loads, journaled and background
+ *      saves
+ *     -Snapshot loads, and switches between evicted workspace graphs
+ *     -Each searching procedure
+ *     -Strongly connected components, serial and parallel
+ *     -Weakly connected components
+ *     -Topological ordering and DAG paths
+ *     -PageRank and personalized PageRank
+ *     -Neighbor scans over CSR and compressed snapshots
+ *     -Vertex orderings, and traversals over each
+ *     -Searches over memory-mapped graphs
+ *     -K-hop subgraph extraction
+ *     -Minimum spanning forests and arborescences
+ *     -Maximum flows, serial and parallel
+ *     -Triangle counting and clustering coefficients
+ *     -Betweenness centrality, exact and sampled
+ *     -Batched hop queries, against one breadth-first search per query
+ */
+
+const std::string benchFile = "benchTmp.graph";
+
+/////////////////////////////////////////////////////////////////////////////
+// AUXILIARY FUNCTIONS                                                     //
+/////////////////////////////////////////////////////////////////////////////
+
+static Key vertexKey(Offset i) {
+	return "v" + std::to_string(i);
+}
+
+/*
+ * Builds a graph of n vertices in which each possible edge is present with
+ * the given percentage, with weights in [1, 100].
+ */
+static void buildGraph(WeightedDigraph& g, Offset n, int density,
+		unsigned seed = 1) {
+	std::mt19937 rng(seed);
+	std::uniform_int_distribution<int> pct(0, 99);
+	std::uniform_int_distribution<int> wt(1, 100);
+	g.clear();
+	for(Offset i = 0; i < n; ++i) {
+		g.addVertex(vertexKey(i));
+	}
+	for(Offset i = 0; i < n; ++i) {
+		for(Offset j = 0; j < n; ++j) {
+			if(pct(rng) < density)
+				g.setEdge(g.getKey(i), g.getKey(j), wt(rng));
+		}
+	}
+}
+
+/*
+ * Builds a snapshot of n vertices with the given average out-degree and
+ * uniformly random edges, for algorithms that run on graphs too large for
+ * an adjacency matrix.
+ */
+static void buildRandomCSR(CSRGraph& c, Offset n, unsigned degree,
+		unsigned seed = 1) {
+	std::mt19937 rng(seed);
+	std::uniform_int_distribution<Offset> pick(0, n - 1);
+	std::vector<Offset> src, dst;
+	for(size_t i = 0; i < (size_t)n * degree; ++i) {
+		src.push_back(pick(rng));
+		dst.push_back(pick(rng));
+	}
+	buildCSR(n, src, dst, std::vector<Weight>(), c);
+}
+
+static void sizes(benchmark::internal::Benchmark* b) {
+	b->RangeMultiplier(4)->Range(64, 1024);
+}
+
+static void sizesAndDensities(benchmark::internal::Benchmark* b) {
+	b->ArgsProduct({{64, 256, 1024}, {1, 10, 50}});
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// VERTEX AND EDGE MUTATION                                                //
+/////////////////////////////////////////////////////////////////////////////
+
+static void BM_AdjMatrixAddVertex(benchmark::State& state) {
+	for(auto _ : state) {
+		AdjMatrix m;
+		for(Offset i = 0; i < state.range(0); ++i) {
+			m.addVertex();
+		}
+		benchmark::DoNotOptimize(m.getSize());
+	}
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_AdjMatrixAddVertex)->Apply(sizes);
+
+static void BM_AddVertex(benchmark::State& state) {
+	std::vector<Key> keys;
+	for(Offset i = 0; i < state.range(0); ++i) {
+		keys.push_back(vertexKey(i));
+	}
+	for(auto _ : state) {
+		WeightedDigraph g;
+		for(size_t i = 0; i < keys.size(); ++i) {
+			g.addVertex(keys[i]);
+		}
+		benchmark::DoNotOptimize(g.getVertexCount());
+	}
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_AddVertex)->Apply(sizes);
+
+static void BM_RemoveVertex(benchmark::State& state) {
+	WeightedDigraph g;
+	buildGraph(g, state.range(0), state.range(1));
+	Key k = vertexKey(0);
+	for(auto _ : state) {
+		// remove from the front so every row and the key table shift
+		g.removeVertex(k);
+		g.addVertex(k);
+		k = g.getKey(0);
+	}
+	state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_RemoveVertex)->Apply(sizesAndDensities);
+
+static void BM_SetEdge(benchmark::State& state) {
+	WeightedDigraph g;
+	buildGraph(g, state.range(0), state.range(1));
+	std::mt19937 rng(2);
+	std::uniform_int_distribution<Offset> pick(0, state.range(0) - 1);
+	std::vector<Key> k1, k2;
+	for(int i = 0; i < 1024; ++i) {
+		k1.push_back(vertexKey(pick(rng)));
+		k2.push_back(vertexKey(pick(rng)));
+	}
+	size_t i = 0;
+	for(auto _ : state) {
+		benchmark::DoNotOptimize(g.setEdge(k1[i], k2[i], 7));
+		i = (i + 1) % k1.size();
+	}
+	state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_SetEdge)->Apply(sizesAndDensities);
+
+static void BM_RemoveEdge(benchmark::State& state) {
+	WeightedDigraph g;
+	buildGraph(g, state.range(0), state.range(1));
+	std::mt19937 rng(3);
+	std::uniform_int_distribution<Offset> pick(0, state.range(0) - 1);
+	std::vector<Key> k1, k2;
+	for(int i = 0; i < 1024; ++i) {
+		k1.push_back(vertexKey(pick(rng)));
+		k2.push_back(vertexKey(pick(rng)));
+	}
+	size_t i = 0;
+	for(auto _ : state) {
+		g.setEdge(k1[i], k2[i], 7);
+		benchmark::DoNotOptimize(g.removeEdge(k1[i], k2[i]));
+		i = (i + 1) % k1.size();
+	}
+	state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_RemoveEdge)->Apply(sizesAndDensities);
+
+/////////////////////////////////////////////////////////////////////////////
+// KEY LOOKUP                                                              //
+/////////////////////////////////////////////////////////////////////////////
+
+static void BM_FindGraphSlot(benchmark::State& state) {
+	std::vector<Key> keys;
+	for(Offset i = 0; i < state.range(0); ++i) {
+		keys.push_back(vertexKey(i));
+	}
+	std::mt19937 rng(4);
+	std::uniform_int_distribution<Offset> pick(0, state.range(0) - 1);
+	for(auto _ : state) {
+		benchmark::DoNotOptimize(findGraphSlot(keys, keys[pick(rng)]));
+	}
+	state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_FindGraphSlot)->Apply(sizes);
+
+static void BM_GetOffset(benchmark::State& state) {
+	WeightedDigraph g;
+	buildGraph(g, state.range(0), 0);
+	std::mt19937 rng(4);
+	std::uniform_int_distribution<Offset> pick(0, state.range(0) - 1);
+	for(auto _ : state) {
+		benchmark::DoNotOptimize(g.getOffset(g.getKey(pick(rng))));
+	}
+	state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_GetOffset)->Apply(sizes);
+
+/////////////////////////////////////////////////////////////////////////////
+// NEIGHBOR ITERATION                                                      //
+/////////////////////////////////////////////////////////////////////////////
+
+static void BM_GetNeighborsOffset(benchmark::State& state) {
+	WeightedDigraph g;
+	buildGraph(g, state.range(0), state.range(1));
+	std::vector<Offset> nbrs;
+	size_t edges = 0;
+	Offset s = 0;
+	for(auto _ : state) {
+		nbrs.clear();
+		g.getNeighbors(s, nbrs);
+		edges += nbrs.size();
+		s = (s + 1) % g.getVertexCount();
+	}
+	state.SetItemsProcessed(edges);
+}
+BENCHMARK(BM_GetNeighborsOffset)->Apply(sizesAndDensities);
+
+static void BM_GetNeighborsKey(benchmark::State& state) {
+	WeightedDigraph g;
+	buildGraph(g, state.range(0), state.range(1));
+	std::vector<Key> nbrs;
+	size_t edges = 0;
+	Offset s = 0;
+	for(auto _ : state) {
+		nbrs.clear();
+		g.getNeighbors(g.getKey(s), nbrs);
+		edges += nbrs.size();
+		s = (s + 1) % g.getVertexCount();
+	}
+	state.SetItemsProcessed(edges);
+}
+BENCHMARK(BM_GetNeighborsKey)->Apply(sizesAndDensities);
+
+// Predecessor scans. The third argument selects the reverse index rather
+// than a walk down a column of the matrix.
+static void BM_GetPredecessors(benchmark::State& state) {
+	WeightedDigraph g;
+	buildGraph(g, state.range(0), state.range(1));
+	g.setReverseIndex(state.range(2));
+	std::vector<Offset> pred;
+	size_t edges = 0;
+	Offset s = 0;
+	for(auto _ : state) {
+		pred.clear();
+		g.getPredecessors(s, pred);
+		edges += pred.size();
+		s = (s + 1) % g.getVertexCount();
+	}
+	state.SetItemsProcessed(edges);
+}
+BENCHMARK(BM_GetPredecessors)->ArgsProduct({{64, 256, 1024}, {1, 10, 50}, {0, 1}});
+
+// Out-degree from the counters, against the row scan it replaces.
+static void BM_GetOutDegree(benchmark::State& state) {
+	WeightedDigraph g;
+	buildGraph(g, state.range(0), state.range(1));
+	std::vector<Offset> nbrs;
+	size_t edges = 0;
+	Offset s = 0;
+	for(auto _ : state) {
+		if(state.range(2)) {
+			edges += g.getOutDegree(s);
+		}
+		else {
+			nbrs.clear();
+			g.getNeighbors(s, nbrs);
+			edges += nbrs.size();
+		}
+		s = (s + 1) % g.getVertexCount();
+	}
+	benchmark::DoNotOptimize(edges);
+}
+BENCHMARK(BM_GetOutDegree)->ArgsProduct({{64, 1024}, {10}, {0, 1}});
+
+/*
+ * Neighbor scans over a matrix of each weight type, which differ in row width
+ * and in the sentinel test.
+ */
+template<typename W>
+static void BM_GetNeighborsWeightType(benchmark::State& state) {
+	std::mt19937 rng(1);
+	std::uniform_int_distribution<int> pct(0, 99);
+	BasicAdjMatrix<W> m;
+	Offset n = state.range(0);
+	for(Offset i = 0; i < n; ++i) {
+		m.addVertex();
+	}
+	for(Offset i = 0; i < n; ++i) {
+		for(Offset j = 0; j < n; ++j) {
+			if(pct(rng) < state.range(1))
+				m.addEdge(i, j, (W)1);
+		}
+	}
+	std::vector<Offset> nbrs;
+	size_t edges = 0;
+	Offset s = 0;
+	for(auto _ : state) {
+		nbrs.clear();
+		m.getNeighbors(s, nbrs);
+		edges += nbrs.size();
+		s = (s + 1) % n;
+	}
+	state.SetItemsProcessed(edges);
+}
+BENCHMARK_TEMPLATE(BM_GetNeighborsWeightType, bool)->Apply(sizesAndDensities);
+BENCHMARK_TEMPLATE(BM_GetNeighborsWeightType, uint8_t)->Apply(sizesAndDensities);
+BENCHMARK_TEMPLATE(BM_GetNeighborsWeightType, int16_t)->Apply(sizesAndDensities);
+BENCHMARK_TEMPLATE(BM_GetNeighborsWeightType, int32_t)->Apply(sizesAndDensities);
+BENCHMARK_TEMPLATE(BM_GetNeighborsWeightType, float)->Apply(sizesAndDensities);
+
+/////////////////////////////////////////////////////////////////////////////
+// FILE LOAD AND WRITE                                                     //
+/////////////////////////////////////////////////////////////////////////////
+
+static long fileSize(const std::string& file) {
+	FILE* f = std::fopen(file.c_str(), "rb");
+	if(!f)
+		return 0;
+	std::fseek(f, 0, SEEK_END);
+	long size = std::ftell(f);
+	std::fclose(f);
+	return size;
+}
+
+static void BM_FileWrite(benchmark::State& state) {
+	WeightedDigraph g;
+	buildGraph(g, state.range(0), state.range(1));
+	for(auto _ : state) {
+		if(g.fileWrite(benchFile) != 0) {
+			state.SkipWithError("unable to write benchmark file");
+			break;
+		}
+	}
+	state.SetBytesProcessed(state.iterations() * fileSize(benchFile));
+	std::remove(benchFile.c_str());
+}
+BENCHMARK(BM_FileWrite)->Apply(sizesAndDensities);
+
+static void BM_FileLoad(benchmark::State& state) {
+	WeightedDigraph g;
+	buildGraph(g, state.range(0), state.range(1));
+	if(g.fileWrite(benchFile) != 0) {
+		state.SkipWithError("unable to write benchmark file");
+		return;
+	}
+	for(auto _ : state) {
+		if(g.fileLoad(benchFile) != 0) {
+			state.SkipWithError("unable to load benchmark file");
+			break;
+		}
+	}
+	state.SetBytesProcessed(state.iterations() * fileSize(benchFile));
+	std::remove(benchFile.c_str());
+}
+BENCHMARK(BM_FileLoad)->Apply(sizesAndDensities);
+
+// Time to first query after a lazy load: the vertices are read, then the
+// edges of a single vertex; compare with BM_FileLoad.
+static void BM_LazyLoad(benchmark::State& state) {
+	WeightedDigraph g;
+	buildGraph(g, state.range(0), state.range(1));
+	if(g.fileWrite(benchFile) != 0) {
+		state.SkipWithError("unable to write benchmark file");
+		return;
+	}
+	std::vector<Offset> n;
+	for(auto _ : state) {
+		if(g.lazyLoad(benchFile) != 0) {
+			state.SkipWithError("unable to load benchmark file");
+			break;
+		}
+		n.clear();
+		g.getNeighbors(0, n);
+		benchmark::DoNotOptimize(n.data());
+	}
+	state.SetBytesProcessed(state.iterations() * fileSize(benchFile));
+	std::remove(benchFile.c_str());
+}
+BENCHMARK(BM_LazyLoad)->Apply(sizesAndDensities);
+
+// Saves a single edge edit by committing it to the journal, the cost that
+// BM_FileWrite pays for a full rewrite. The second argument is the sync
+// policy.
+static void BM_JournalSave(benchmark::State& state) {
+	WeightedDigraph g;
+	Journal j;
+	buildGraph(g, state.range(0), 10);
+	if(g.fileWrite(benchFile) != 0 ||
+			j.open(benchFile, (SyncPolicy)state.range(1)) != 0) {
+		state.SkipWithError("unable to write benchmark file");
+		return;
+	}
+	Weight w = 1;
+	for(auto _ : state) {
+		g.setEdge(g.getKey(0), g.getKey(1), w);
+		j.logSetEdge(g.getKey(0), g.getKey(1), w);
+		j.commit();
+		w = w % 100 + 1;
+	}
+	j.close();
+	std::remove(benchFile.c_str());
+	std::remove((benchFile + journalExt).c_str());
+}
+BENCHMARK(BM_JournalSave)->ArgsProduct({{64, 1024}, {SYNC_ALWAYS, SYNC_NEVER}});
+
+// Time the shell waits to start a background save, the cost that
+// BM_FileWrite pays for writing the whole file.
+static void BM_SaveStart(benchmark::State& state) {
+	WeightedDigraph g;
+	BackgroundSave s;
+	buildGraph(g, state.range(0), state.range(1));
+	for(auto _ : state) {
+		if(s.start(g, benchFile) != 0) {
+			state.SkipWithError("unable to start save");
+			break;
+		}
+		state.PauseTiming();
+		s.wait();
+		state.ResumeTiming();
+	}
+	std::remove(benchFile.c_str());
+}
+// each iteration also waits, untimed, for the whole file to be written
+BENCHMARK(BM_SaveStart)->Apply(sizesAndDensities)->Iterations(20);
+
+// Loads a binary snapshot, the cost a workspace pays to bring back an evicted
+// graph; compare with BM_FileLoad.
+static void BM_SnapshotLoad(benchmark::State& state) {
+	const std::string snapFile = "benchTmp" + snapshotExt;
+	WeightedDigraph g;
+	buildGraph(g, state.range(0), state.range(1));
+	if(g.snapshotWrite(snapFile) != 0) {
+		state.SkipWithError("unable to write benchmark file");
+		return;
+	}
+	for(auto _ : state) {
+		if(g.snapshotLoad(snapFile) != 0) {
+			state.SkipWithError("unable to load benchmark file");
+			break;
+		}
+	}
+	state.SetBytesProcessed(state.iterations() * fileSize(snapFile));
+	std::remove(snapFile.c_str());
+}
+BENCHMARK(BM_SnapshotLoad)->Apply(sizesAndDensities);
+
+// Alternates between two graphs in a workspace with room for one, so that
+// every switch evicts one graph and loads the other back.
+static void BM_WorkspaceSwitch(benchmark::State& state) {
+	Workspace w;
+	buildGraph(*w.create("a"), state.range(0), state.range(1));
+	buildGraph(*w.create("b"), state.range(0), state.range(1), 2);
+	w.setBudget(w.rebalance() / 2);
+	bool a = true;
+	for(auto _ : state) {
+		if(w.get(a ? "a" : "b") == NULL) {
+			state.SkipWithError("unable to load evicted graph");
+			break;
+		}
+		a = !a;
+	}
+}
+BENCHMARK(BM_WorkspaceSwitch)->Apply(sizesAndDensities);
+
+/////////////////////////////////////////////////////////////////////////////
+// SEARCHING PROCEDURES                                                    //
+/////////////////////////////////////////////////////////////////////////////
+
+/*
+ * Runs a searching procedure between pseudo-random pairs of vertices. When
+ * reachable is set, only pairs joined by a path are used, since iterative
+ * deepening would otherwise enumerate every simple path in the graph.
+ */
+template<typename Search>
+static void searchPairs(benchmark::State& state, Search search,
+		bool reachable = false) {
+	WeightedDigraph g;
+	buildGraph(g, state.range(0), state.range(1));
+	std::mt19937 rng(5);
+	std::uniform_int_distribution<Offset> pick(0, state.range(0) - 1);
+	std::vector<Offset> src, dst;
+	Path p;
+	for(int tries = 0; src.size() < 256 && tries < 65536; ++tries) {
+		Offset s1 = pick(rng);
+		Offset s2 = pick(rng);
+		if(!reachable || bfs(g, s1, s2, p)) {
+			src.push_back(s1);
+			dst.push_back(s2);
+		}
+	}
+	if(src.empty()) {
+		state.SkipWithError("no reachable pairs");
+		return;
+	}
+	size_t i = 0;
+	size_t found = 0;
+	for(auto _ : state) {
+		found += search(g, src[i], dst[i], p);
+		i = (i + 1) % src.size();
+	}
+	state.counters["found"] = benchmark::Counter(found,
+			benchmark::Counter::kAvgIterations);
+}
+
+static void BM_Bfs(benchmark::State& state) {
+	searchPairs(state, [](const WeightedDigraph& g, Offset s1, Offset s2,
+			Path& p) { return bfs(g, s1, s2, p); });
+}
+BENCHMARK(BM_Bfs)->Apply(sizesAndDensities);
+
+static void BM_Ucs(benchmark::State& state) {
+	searchPairs(state, [](const WeightedDigraph& g, Offset s1, Offset s2,
+			Path& p) { return ucs(g, s1, s2, p); });
+}
+BENCHMARK(BM_Ucs)->Apply(sizesAndDensities);
+
+// depth-first searches enumerate paths, so they are kept to sparse graphs
+static void BM_Dfs(benchmark::State& state) {
+	searchPairs(state, [](const WeightedDigraph& g, Offset s1, Offset s2,
+			Path& p) { return dfs(g, s1, s2, 4, p); });
+}
+BENCHMARK(BM_Dfs)->ArgsProduct({{64, 256}, {1, 2}});
+
+static void BM_Iddfs(benchmark::State& state) {
+	searchPairs(state, [](const WeightedDigraph& g, Offset s1, Offset s2,
+			Path& p) { return iddfs(g, s1, s2, p); }, true);
+}
+BENCHMARK(BM_Iddfs)->ArgsProduct({{64, 256}, {1, 2}});
+
+/////////////////////////////////////////////////////////////////////////////
+// STRUCTURAL ANALYSIS                                                     //
+/////////////////////////////////////////////////////////////////////////////
+
+static void BM_SccTarjan(benchmark::State& state) {
+	CSRGraph g;
+	Components c;
+	buildRandomCSR(g, state.range(0), state.range(1));
+	for(auto _ : state) {
+		sccTarjan(g, c);
+	}
+	state.SetItemsProcessed(state.iterations() * g.getEdgeCount());
+}
+BENCHMARK(BM_SccTarjan)->ArgsProduct({{1 << 16, 1 << 20}, {1, 4}})
+	->Unit(benchmark::kMillisecond);
+
+// the third argument is the number of threads
+static void BM_SccParallel(benchmark::State& state) {
+	CSRGraph g;
+	Components c;
+	buildRandomCSR(g, state.range(0), state.range(1));
+	setParallelThreads(state.range(2));
+	for(auto _ : state) {
+		sccParallel(g, c);
+	}
+	setParallelThreads(0);
+	state.SetItemsProcessed(state.iterations() * g.getEdgeCount());
+}
+BENCHMARK(BM_SccParallel)->ArgsProduct({{1 << 16, 1 << 20}, {1, 4}, {1, 2, 4}})
+	->Unit(benchmark::kMillisecond)->UseRealTime();
+
+// the third argument is the number of threads
+static void BM_WeaklyConnected(benchmark::State& state) {
+	CSRGraph g;
+	Components c;
+	buildRandomCSR(g, state.range(0), state.range(1));
+	setParallelThreads(state.range(2));
+	for(auto _ : state) {
+		wccAfforest(g, c);
+	}
+	setParallelThreads(0);
+	state.SetItemsProcessed(state.iterations() * g.getEdgeCount());
+}
+BENCHMARK(BM_WeaklyConnected)->ArgsProduct({{1 << 20, 1 << 22}, {1, 8}, {1, 4}})
+	->Unit(benchmark::kMillisecond)->UseRealTime();
+
+/*
+ * Keeps only the edges of a random snapshot that lead to higher offsets,
+ * which makes it acyclic.
+ */
+static void buildRandomDAG(CSRGraph& c, Offset n, unsigned degree) {
+	CSRGraph r;
+	buildRandomCSR(r, n, degree);
+	std::vector<Offset> src, dst;
+	for(Offset v = 0; v < n; ++v) {
+		for(size_t e = r.offsets[v]; e < r.offsets[v+1]; ++e) {
+			if(r.targets[e] > v) {
+				src.push_back(v);
+				dst.push_back(r.targets[e]);
+			}
+		}
+	}
+	buildCSR(n, src, dst, std::vector<Weight>(), c);
+}
+
+// the third argument is the number of threads
+static void BM_TopologicalOrder(benchmark::State& state) {
+	CSRGraph g;
+	std::vector<Offset> order;
+	buildRandomDAG(g, state.range(0), state.range(1));
+	setParallelThreads(state.range(2));
+	for(auto _ : state) {
+		topologicalOrder(g, order);
+	}
+	setParallelThreads(0);
+	state.SetItemsProcessed(state.iterations() * g.getEdgeCount());
+}
+BENCHMARK(BM_TopologicalOrder)->ArgsProduct({{1 << 16, 1 << 20}, {8}, {1, 4}})
+	->Unit(benchmark::kMillisecond)->UseRealTime();
+
+static void BM_DagShortestPaths(benchmark::State& state) {
+	CSRGraph g;
+	std::vector<Offset> order;
+	DagPaths d;
+	buildRandomDAG(g, state.range(0), state.range(1));
+	topologicalOrder(g, order);
+	for(auto _ : state) {
+		dagShortestPaths(g, order, order[0], d);
+	}
+	state.SetItemsProcessed(state.iterations() * g.getEdgeCount());
+}
+BENCHMARK(BM_DagShortestPaths)->ArgsProduct({{1 << 16, 1 << 20}, {8}})
+	->Unit(benchmark::kMillisecond);
+
+/////////////////////////////////////////////////////////////////////////////
+// RANKING                                                                 //
+/////////////////////////////////////////////////////////////////////////////
+
+// the second argument is the number of threads, the third whether weighted
+static void BM_PageRank(benchmark::State& state) {
+	CSRGraph g;
+	std::vector<double> rank;
+	RankOptions o;
+	o.weighted = state.range(2);
+	buildRandomCSR(g, state.range(0), 8);
+	setParallelThreads(state.range(1));
+	unsigned iterations = 0;
+	for(auto _ : state) {
+		iterations = pageRank(g, o, rank);
+	}
+	setParallelThreads(0);
+	state.counters["iterations"] = iterations;
+	state.SetItemsProcessed(state.iterations() * iterations * g.getEdgeCount());
+}
+BENCHMARK(BM_PageRank)->ArgsProduct({{1 << 16, 1 << 20}, {1, 4}, {0, 1}})
+	->Unit(benchmark::kMillisecond)->UseRealTime();
+
+static void BM_PersonalizedPageRank(benchmark::State& state) {
+	CSRGraph g;
+	std::vector<Score> rank;
+	RankOptions o;
+	o.tolerance = 1e-4;
+	buildRandomCSR(g, state.range(0), 8);
+	Offset seed = 0;
+	size_t touched = 0;
+	for(auto _ : state) {
+		personalizedPageRank(g, seed, o, rank);
+		touched += rank.size();
+		seed = (seed + 7919) % g.getVertexCount();
+	}
+	state.counters["touched"] = benchmark::Counter(touched,
+			benchmark::Counter::kAvgIterations);
+}
+BENCHMARK(BM_PersonalizedPageRank)->Arg(1 << 16)->Arg(1 << 20);
+
+/////////////////////////////////////////////////////////////////////////////
+// COMPRESSED SNAPSHOTS                                                    //
+/////////////////////////////////////////////////////////////////////////////
+
+/*
+ * Builds a snapshot of n vertices with the given out-degree whose edges land
+ * within window offsets after their source, or anywhere if window is 0.
+ */
+static void buildLocalCSR(CSRGraph& c, Offset n, unsigned degree,
+		Offset window) {
+	std::mt19937 rng(1);
+	std::vector<Offset> src, dst;
+	for(Offset v = 0; v < n; ++v) {
+		for(unsigned i = 0; i < degree; ++i) {
+			src.push_back(v);
+			dst.push_back(window == 0 ? rng() % n : (v + rng() % window) % n);
+		}
+	}
+	buildCSR(n, src, dst, std::vector<Weight>(), c);
+}
+
+static size_t csrBytes(const CSRGraph& c) {
+	return c.offsets.size() * sizeof(size_t) +
+		c.targets.size() * sizeof(Offset) + c.weights.size() * sizeof(Weight);
+}
+
+// the second argument is the locality window, 0 for uniform edges
+static void BM_CsrScan(benchmark::State& state) {
+	CSRGraph c;
+	buildLocalCSR(c, state.range(0), 16, state.range(1));
+	for(auto _ : state) {
+		Offset sum = 0;
+		for(Offset v = 0; v < c.getVertexCount(); ++v) {
+			for(size_t e = c.offsets[v]; e < c.offsets[v+1]; ++e) {
+				sum += c.targets[e];
+			}
+		}
+		benchmark::DoNotOptimize(sum);
+	}
+	state.counters["bytes/edge"] = (double)csrBytes(c) / c.getEdgeCount();
+	state.SetItemsProcessed(state.iterations() * c.getEdgeCount());
+}
+BENCHMARK(BM_CsrScan)->ArgsProduct({{1 << 20}, {0, 1024}})
+	->Unit(benchmark::kMillisecond);
+
+static void BM_CompressedScan(benchmark::State& state) {
+	CSRGraph c;
+	CompressedGraph z;
+	buildLocalCSR(c, state.range(0), 16, state.range(1));
+	compressCSR(c, z);
+	std::vector<Offset> n;
+	for(auto _ : state) {
+		Offset sum = 0;
+		for(Offset v = 0; v < z.getVertexCount(); ++v) {
+			decodeNeighbors(z, v, n);
+			for(size_t i = 0; i < n.size(); ++i) {
+				sum += n[i];
+			}
+		}
+		benchmark::DoNotOptimize(sum);
+	}
+	state.counters["bytes/edge"] = (double)z.getByteCount() / z.getEdgeCount();
+	state.SetItemsProcessed(state.iterations() * z.getEdgeCount());
+}
+BENCHMARK(BM_CompressedScan)->ArgsProduct({{1 << 20}, {0, 1024}})
+	->Unit(benchmark::kMillisecond);
+
+/////////////////////////////////////////////////////////////////////////////
+// REORDERING                                                              //
+/////////////////////////////////////////////////////////////////////////////
+
+/*
+ * Builds a snapshot with good locality, then hides it behind a random
+ * relabeling, as happens when vertices are numbered in file order.
+ */
+static void buildShuffledCSR(CSRGraph& c, Offset n) {
+	CSRGraph local;
+	std::vector<Offset> label(n);
+	buildLocalCSR(local, n, 16, 1024);
+	for(Offset v = 0; v < n; ++v) {
+		label[v] = v;
+	}
+	std::shuffle(label.begin(), label.end(), std::mt19937(1));
+	permuteCSR(local, label, c);
+}
+
+// the second argument is the ordering, or -1 for none
+static void BM_ComputeOrdering(benchmark::State& state) {
+	CSRGraph c;
+	std::vector<Offset> order;
+	buildShuffledCSR(c, state.range(0));
+	for(auto _ : state) {
+		computeOrdering(c, (Ordering)state.range(1), order);
+	}
+	state.SetItemsProcessed(state.iterations() * c.getEdgeCount());
+}
+BENCHMARK(BM_ComputeOrdering)->ArgsProduct({{1 << 20},
+		{ORDER_DEGREE, ORDER_BFS, ORDER_RCM}})->Unit(benchmark::kMillisecond);
+
+static void BM_ReorderedPageRank(benchmark::State& state) {
+	CSRGraph c;
+	CSRGraph p;
+	std::vector<Offset> order;
+	std::vector<double> rank;
+	RankOptions o;
+	o.maxIterations = 10;
+	o.tolerance = 0;
+	buildShuffledCSR(c, state.range(0));
+	if(state.range(1) >= 0) {
+		computeOrdering(c, (Ordering)state.range(1), order);
+		permuteCSR(c, order, p);
+		c.offsets.swap(p.offsets);
+		c.targets.swap(p.targets);
+		c.weights.swap(p.weights);
+	}
+	setParallelThreads(1);
+	for(auto _ : state) {
+		pageRank(c, o, rank);
+	}
+	setParallelThreads(0);
+	state.counters["bandwidth"] = bandwidth(c);
+	state.SetItemsProcessed(state.iterations() * o.maxIterations *
+			c.getEdgeCount());
+}
+BENCHMARK(BM_ReorderedPageRank)->ArgsProduct({{1 << 20},
+		{-1, ORDER_DEGREE, ORDER_BFS, ORDER_RCM}})->Unit(benchmark::kMillisecond);
+
+static void BM_ReorderedSccTarjan(benchmark::State& state) {
+	CSRGraph c;
+	CSRGraph p;
+	std::vector<Offset> order;
+	Components comp;
+	buildShuffledCSR(c, state.range(0));
+	if(state.range(1) >= 0) {
+		computeOrdering(c, (Ordering)state.range(1), order);
+		permuteCSR(c, order, p);
+		c.offsets.swap(p.offsets);
+		c.targets.swap(p.targets);
+		c.weights.swap(p.weights);
+	}
+	for(auto _ : state) {
+		sccTarjan(c, comp);
+	}
+	state.SetItemsProcessed(state.iterations() * c.getEdgeCount());
+}
+BENCHMARK(BM_ReorderedSccTarjan)->ArgsProduct({{1 << 20},
+		{-1, ORDER_DEGREE, ORDER_BFS, ORDER_RCM}})->Unit(benchmark::kMillisecond);
+
+/////////////////////////////////////////////////////////////////////////////
+// EXTRACTION                                                              //
+/////////////////////////////////////////////////////////////////////////////
+
+// the second argument is the number of hops, the third the number of threads
+static void BM_ExtractKHop(benchmark::State& state) {
+	CSRGraph c;
+	Subgraph s;
+	buildRandomCSR(c, state.range(0), 8);
+	setParallelThreads(state.range(2));
+	Offset seed = 0;
+	size_t vertices = 0;
+	for(auto _ : state) {
+		extractKHop(c, seed, state.range(1), EdgeFilter(), s);
+		vertices += s.origin.size();
+		seed = (seed + 7919) % c.getVertexCount();
+	}
+	setParallelThreads(0);
+	state.counters["vertices"] = benchmark::Counter(vertices,
+			benchmark::Counter::kAvgIterations);
+	state.SetItemsProcessed(vertices);
+}
+BENCHMARK(BM_ExtractKHop)->ArgsProduct({{1 << 20}, {2, 4, 6}, {1, 4}})
+	->UseRealTime();
+
+/////////////////////////////////////////////////////////////////////////////
+// SPANNING STRUCTURES                                                     //
+/////////////////////////////////////////////////////////////////////////////
+
+static void randomWeights(CSRGraph& c) {
+	std::mt19937 rng(3);
+	for(size_t e = 0; e < c.weights.size(); ++e) {
+		c.weights[e] = 1 + rng() % 100;
+	}
+}
+
+// the second argument is the number of threads
+static void BM_MinimumSpanningForest(benchmark::State& state) {
+	CSRGraph c;
+	SpanningTree t;
+	buildRandomCSR(c, state.range(0), 8);
+	randomWeights(c);
+	setParallelThreads(state.range(1));
+	for(auto _ : state) {
+		minimumSpanningForest(c, t);
+	}
+	setParallelThreads(0);
+	state.SetItemsProcessed(state.iterations() * c.getEdgeCount());
+}
+BENCHMARK(BM_MinimumSpanningForest)->ArgsProduct({{1 << 16, 1 << 20}, {1, 4}})
+	->Unit(benchmark::kMillisecond)->UseRealTime();
+
+static void BM_MinimumArborescence(benchmark::State& state) {
+	CSRGraph c;
+	SpanningTree t;
+	buildRandomCSR(c, state.range(0), 8);
+	randomWeights(c);
+	for(auto _ : state) {
+		minimumArborescence(c, 0, t);
+	}
+	state.SetItemsProcessed(state.iterations() * c.getEdgeCount());
+}
+BENCHMARK(BM_MinimumArborescence)->Arg(1 << 16)->Arg(1 << 20)
+	->Unit(benchmark::kMillisecond);
+
+/////////////////////////////////////////////////////////////////////////////
+// FLOWS                                                                   //
+/////////////////////////////////////////////////////////////////////////////
+
+// the second argument is the number of threads, with the global relabeling
+// parallel whenever there is more than one
+static void BM_MaxFlow(benchmark::State& state) {
+	CSRGraph c;
+	MinCut cut;
+	FlowOptions o;
+	buildRandomCSR(c, state.range(0), 8);
+	randomWeights(c);
+	setParallelThreads(state.range(1));
+	o.parallel = state.range(1) > 1;
+	for(auto _ : state) {
+		maxFlow(c, 0, c.getVertexCount() - 1, o, cut);
+	}
+	setParallelThreads(0);
+	state.counters["flow"] = cut.flow;
+	state.SetItemsProcessed(state.iterations() * c.getEdgeCount());
+}
+BENCHMARK(BM_MaxFlow)->ArgsProduct({{1 << 17, 1 << 20}, {1, 4}})
+	->Unit(benchmark::kMillisecond)->UseRealTime();
+
+/////////////////////////////////////////////////////////////////////////////
+// TRIANGLES                                                               //
+/////////////////////////////////////////////////////////////////////////////
+
+// the second argument is the locality window, 0 for uniform edges, which
+// leave few triangles; the third is the number of threads
+static void BM_CountTriangles(benchmark::State& state) {
+	CSRGraph c;
+	TriangleCount t;
+	buildLocalCSR(c, state.range(0), 16, state.range(1));
+	setParallelThreads(state.range(2));
+	for(auto _ : state) {
+		countTriangles(c, TriangleOptions(), t);
+	}
+	setParallelThreads(0);
+	state.counters["triangles"] = t.total;
+	state.SetItemsProcessed(state.iterations() * c.getEdgeCount());
+}
+BENCHMARK(BM_CountTriangles)->ArgsProduct({{1 << 16, 1 << 20}, {0, 256}, {1, 4}})
+	->Unit(benchmark::kMillisecond)->UseRealTime();
+
+/////////////////////////////////////////////////////////////////////////////
+// CENTRALITY                                                              //
+/////////////////////////////////////////////////////////////////////////////
+
+// the second argument is the number of sources sampled, 0 for every vertex;
+// the third is 1 for weighted path lengths; the fourth the number of threads
+static void BM_Betweenness(benchmark::State& state) {
+	CSRGraph c;
+	Betweenness b;
+	BetweennessOptions o;
+	buildRandomCSR(c, state.range(0), 8);
+	randomWeights(c);
+	o.samples = state.range(1);
+	o.weighted = state.range(2);
+	setParallelThreads(state.range(3));
+	for(auto _ : state) {
+		betweenness(c, o, b);
+	}
+	setParallelThreads(0);
+	state.SetItemsProcessed(state.iterations() * b.sources * c.getEdgeCount());
+}
+BENCHMARK(BM_Betweenness)->Args({1 << 12, 0, 0, 1})->Args({1 << 12, 0, 1, 1})
+	->Args({1 << 12, 0, 0, 4})->Args({1 << 20, 16, 0, 1})
+	->Args({1 << 20, 16, 1, 1})->Args({1 << 20, 16, 0, 4})
+	->Unit(benchmark::kMillisecond)->UseRealTime();
+
+/////////////////////////////////////////////////////////////////////////////
+// HOP QUERIES                                                             //
+/////////////////////////////////////////////////////////////////////////////
+
+#define BENCH_HOP_QUERIES 256
+
+/*
+ * Queries from distinct random sources to random targets.
+ */
+static void randomHopQueries(std::vector<HopQuery>& q, Offset n) {
+	std::mt19937 rng(2);
+	std::vector<Offset> order(n);
+	for(Offset v = 0; v < n; ++v) {
+		order[v] = v;
+	}
+	std::shuffle(order.begin(), order.end(), rng);
+	q.clear();
+	for(size_t i = 0; i < BENCH_HOP_QUERIES; ++i) {
+		HopQuery h = {order[i], (Offset)(rng() % n)};
+		q.push_back(h);
+	}
+}
+
+// one breadth-first search per query, stopping at its target
+static void BM_SequentialHops(benchmark::State& state) {
+	CSRGraph c;
+	std::vector<HopQuery> q;
+	buildRandomCSR(c, state.range(0), 8);
+	randomHopQueries(q, c.getVertexCount());
+	std::vector<Offset> dist(c.getVertexCount(), unreachedHops), queue;
+	for(auto _ : state) {
+		for(size_t i = 0; i < q.size(); ++i) {
+			queue.assign(1, q[i].source);
+			dist[q[i].source] = 0;
+			for(size_t j = 0; j < queue.size() &&
+					dist[q[i].target] == unreachedHops; ++j) {
+				Offset v = queue[j];
+				for(size_t e = c.offsets[v]; e < c.offsets[v+1]; ++e) {
+					if(dist[c.targets[e]] == unreachedHops) {
+						dist[c.targets[e]] = dist[v] + 1;
+						queue.push_back(c.targets[e]);
+					}
+				}
+			}
+			benchmark::DoNotOptimize(dist[q[i].target]);
+			for(size_t j = 0; j < queue.size(); ++j) {
+				dist[queue[j]] = unreachedHops;
+			}
+		}
+	}
+	state.SetItemsProcessed(state.iterations() * q.size());
+}
+BENCHMARK(BM_SequentialHops)->Arg(1 << 18)->Arg(1 << 20)
+	->Unit(benchmark::kMillisecond);
+
+// the second argument is the batch width; the third the number of threads
+static void BM_HopDistances(benchmark::State& state) {
+	CSRGraph c;
+	std::vector<HopQuery> q;
+	std::vector<Offset> hops;
+	HopOptions o;
+	buildRandomCSR(c, state.range(0), 8);
+	randomHopQueries(q, c.getVertexCount());
+	o.batch = state.range(1);
+	setParallelThreads(state.range(2));
+	for(auto _ : state) {
+		hopDistances(c, q, o, hops);
+	}
+	setParallelThreads(0);
+	state.SetItemsProcessed(state.iterations() * q.size());
+}
+BENCHMARK(BM_HopDistances)->ArgsProduct({{1 << 18, 1 << 20}, {64, 256, 512}, {1}})
+	->Args({1 << 20, 64, 4})->Unit(benchmark::kMillisecond)->UseRealTime();
+
+/////////////////////////////////////////////////////////////////////////////
+// MEMORY-MAPPED GRAPHS                                                    //
+/////////////////////////////////////////////////////////////////////////////
+
+const std::string benchMappedFile = "benchTmp.mgraph";
+
+// Searches between random pairs of a mapped graph far too large for an
+// adjacency matrix. Pages stay cached between iterations, so this measures
+// the warm cost of reading through the mapping.
+static void BM_MappedBfs(benchmark::State& state) {
+	CSRGraph c;
+	std::vector<Key> keys;
+	buildRandomCSR(c, state.range(0), 8);
+	for(Offset i = 0; i < c.getVertexCount(); ++i) {
+		keys.push_back(vertexKey(i));
+	}
+	writeMapped(c, keys, benchMappedFile);
+	MappedGraph m;
+	m.open(benchMappedFile);
+	std::mt19937 rng(1);
+	Path p;
+	for(auto _ : state) {
+		Offset s1 = rng() % m.getVertexCount();
+		Offset s2 = rng() % m.getVertexCount();
+		benchmark::DoNotOptimize(bfs(m, s1, s2, p));
+	}
+	m.close();
+	std::remove(benchMappedFile.c_str());
+}
+BENCHMARK(BM_MappedBfs)->Arg(1 << 20)->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,210 @@
+#include <iostream>
+#include <random>
+#include <algorithm>
+
+#include "Graph.h"
+#include "CSR.h"
+#include "Centrality.h"
+#include "Parallel.h"
+#include "testGraphs.h"
+#include "gtest/gtest.h"
+
+#define RANDOM_VERTICES 1000
+#define TOLERANCE 1e-9
+
+/*
+ * CentralityTest
+ *
+ * Performs the following tests on the centrality procedures.
+ *     -Path
+ *     -Reference
+ *     -Weighted
+ *     -Sampled
+ *     -Threads
+ */
+
+/*
+ * Betweenness from all-pairs distances and path counts, to check against.
+ * The paths from s to t through v are those from s to v times those from v
+ * to t, when v lies at the right distance from both.
+ */
+static std::vector<double> reference(const CSRGraph& g, bool weighted) {
+	Offset n = g.getVertexCount();
+	const long long inf = -1;
+	std::vector<std::vector<long long>> d(n, std::vector<long long>(n, inf));
+	std::vector<std::vector<double>> paths(n, std::vector<double>(n, 0));
+	for(Offset s = 0; s < n; ++s) {
+		// Bellman-Ford over the positive edges, then paths by distance
+		d[s][s] = 0;
+		for(bool changed = true; changed;) {
+			changed = false;
+			for(Offset v = 0; v < n; ++v) {
+				for(size_t e = g.offsets[v]; e < g.offsets[v+1]; ++e) {
+					long long w = weighted ? g.weights[e] : 1;
+					Offset t = g.targets[e];
+					if(w > 0 && d[s][v] != inf &&
+							(d[s][t] == inf || d[s][v] + w < d[s][t])) {
+						d[s][t] = d[s][v] + w;
+						changed = true;
+					}
+				}
+			}
+		}
+		std::vector<Offset> order;
+		for(Offset v = 0; v < n; ++v) {
+			if(d[s][v] != inf)
+				order.push_back(v);
+		}
+		std::sort(order.begin(), order.end(), [&](Offset a, Offset b) {
+			return d[s][a] < d[s][b];
+		});
+		paths[s][s] = 1;
+		for(size_t i = 0; i < order.size(); ++i) {
+			Offset v = order[i];
+			for(size_t e = g.offsets[v]; e < g.offsets[v+1]; ++e) {
+				long long w = weighted ? g.weights[e] : 1;
+				if(w > 0 && d[s][g.targets[e]] == d[s][v] + w)
+					paths[s][g.targets[e]] += paths[s][v];
+			}
+		}
+	}
+	std::vector<double> score(n, 0);
+	for(Offset s = 0; s < n; ++s) {
+		for(Offset t = 0; t < n; ++t) {
+			if(s == t || d[s][t] == inf)
+				continue;
+			for(Offset v = 0; v < n; ++v) {
+				if(v != s && v != t && d[s][v] != inf && d[v][t] != inf &&
+						d[s][v] + d[v][t] == d[s][t])
+					score[v] += paths[s][v] * paths[v][t] / paths[s][t];
+			}
+		}
+	}
+	return score;
+}
+
+static void expectScores(const std::vector<double>& expected,
+		const Betweenness& b) {
+	ASSERT_EQ(b.score.size(), expected.size());
+	for(size_t v = 0; v < expected.size(); ++v) {
+		EXPECT_NEAR(b.score[v], expected[v], TOLERANCE * (1 + expected[v]));
+	}
+}
+
+TEST(CentralityTest, Path) {
+	CSRGraph c;
+	Betweenness b;
+	std::vector<Offset> src, dst;
+
+	// 0 -> 1 -> 2 -> 3 -> 4, with 2 -> 3 doubled
+	for(Offset v = 0; v < 4; ++v) {
+		src.push_back(v);
+		dst.push_back(v + 1);
+	}
+	src.push_back(2);
+	dst.push_back(3);
+	buildCSR(5, src, dst, std::vector<Weight>(), c);
+	betweenness(c, BetweennessOptions(), b);
+	EXPECT_EQ(b.sources, 5);
+	EXPECT_EQ(b.error, 0);
+	EXPECT_DOUBLE_EQ(b.score[0], 0);
+	EXPECT_DOUBLE_EQ(b.score[1], 3);
+	EXPECT_DOUBLE_EQ(b.score[2], 4);
+	EXPECT_DOUBLE_EQ(b.score[3], 3);
+	EXPECT_DOUBLE_EQ(b.score[4], 0);
+}
+
+TEST(CentralityTest, Reference) {
+	WeightedDigraph g;
+	CSRGraph c;
+	Betweenness b;
+	ASSERT_EQ(g.fileLoad(goodFile), 0);
+	buildCSR(g, c);
+
+	// every path into Hartford passes New York, and nothing leaves it
+	betweenness(c, BetweennessOptions(), b);
+	EXPECT_EQ(b.score[g.getOffset("Hartford")], 0);
+	EXPECT_GE(b.score[g.getOffset("New York")], 5);
+	expectScores(reference(c, false), b);
+
+	for(unsigned seed = 1; seed <= 10; ++seed) {
+		randomCSR(c, 30 + seed * 5, (30 + seed * 5) * 3, seed, -2, 9);
+		betweenness(c, BetweennessOptions(), b);
+		expectScores(reference(c, false), b);
+	}
+}
+
+TEST(CentralityTest, Weighted) {
+	WeightedDigraph g;
+	CSRGraph c;
+	Betweenness b;
+	BetweennessOptions o;
+	o.weighted = true;
+	ASSERT_EQ(g.fileLoad(goodFile), 0);
+	buildCSR(g, c);
+
+	betweenness(c, o, b);
+	expectScores(reference(c, true), b);
+	EXPECT_EQ(b.score[g.getOffset("Hartford")], 0);
+
+	// negative and zero weights are never followed, and ties add up
+	for(unsigned seed = 1; seed <= 10; ++seed) {
+		randomCSR(c, 30 + seed * 5, (30 + seed * 5) * 4, seed, -2, 9);
+		betweenness(c, o, b);
+		expectScores(reference(c, true), b);
+	}
+}
+
+TEST(CentralityTest, Sampled) {
+	CSRGraph c;
+	Betweenness exact, sampled;
+	BetweennessOptions o;
+	randomCSR(c, RANDOM_VERTICES, RANDOM_VERTICES * 4, 3, -2, 9);
+	betweenness(c, o, exact);
+
+	o.samples = RANDOM_VERTICES;
+	betweenness(c, o, sampled);
+	EXPECT_EQ(sampled.sources, RANDOM_VERTICES);
+	EXPECT_EQ(sampled.error, 0);
+
+	o.samples = 200;
+	o.confidence = 0.99;
+	betweenness(c, o, sampled);
+	EXPECT_EQ(sampled.sources, 200);
+	EXPECT_GT(sampled.error, 0);
+	double sum = 0, sampledSum = 0;
+	for(Offset v = 0; v < RANDOM_VERTICES; ++v) {
+		EXPECT_LE(std::abs(sampled.score[v] - exact.score[v]), sampled.error);
+		sum += exact.score[v];
+		sampledSum += sampled.score[v];
+	}
+
+	// totals average out far better than any one vertex
+	EXPECT_NEAR(sampledSum / sum, 1, 0.1);
+
+	// a seed picks the same sources every time
+	Betweenness again;
+	betweenness(c, o, again);
+	expectScores(sampled.score, again);
+}
+
+TEST(CentralityTest, Threads) {
+	CSRGraph c;
+	Betweenness one, many;
+	BetweennessOptions o;
+	randomCSR(c, RANDOM_VERTICES, RANDOM_VERTICES * 4, 5, -2, 9);
+	for(int weighted = 0; weighted < 2; ++weighted) {
+		o.weighted = weighted;
+		setParallelThreads(1);
+		betweenness(c, o, one);
+		setParallelThreads(4);
+		betweenness(c, o, many);
+		setParallelThreads(0);
+		expectScores(one.score, many);
+	}
+}
+
+int main(int argc, char** argv) {
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
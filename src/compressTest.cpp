@@ -0,0 +1,168 @@
+#include <iostream>
+#include <random>
+
+#include "Graph.h"
+#include "CSR.h"
+#include "Compress.h"
+#include "gtest/gtest.h"
+
+#define RANDOM_VERTICES 100000
+
+const std::string goodFile = "../graphFiles/test.graph";
+
+/*
+ * CompressTest
+ *
+ * Performs the following tests on compressed snapshots.
+ *     -TestGraph
+ *     -GapWidths
+ *     -RoundTrip
+ *     -WeightWidths
+ *     -Footprint
+ */
+
+/*
+ * Checks that every row and weight of z matches c.
+ */
+static void expectSameRows(const CSRGraph& c, const CompressedGraph& z) {
+	ASSERT_EQ(z.getVertexCount(), c.getVertexCount());
+	ASSERT_EQ(z.getEdgeCount(), c.getEdgeCount());
+	std::vector<Offset> n;
+	std::vector<Weight> w;
+	for(Offset v = 0; v < c.getVertexCount(); ++v) {
+		decodeNeighbors(z, v, n);
+		decodeWeights(z, v, w);
+		ASSERT_EQ(n.size(), c.getDegree(v));
+		ASSERT_EQ(w.size(), c.getDegree(v));
+		for(size_t i = 0; i < n.size(); ++i) {
+			ASSERT_EQ(n[i], c.targets[c.offsets[v] + i]);
+			ASSERT_EQ(w[i], c.weights[c.offsets[v] + i]);
+		}
+	}
+}
+
+/*
+ * Builds a random graph of n vertices whose edges land near their source, as
+ * they do in a graph with good locality, with weights in [1, maxWeight].
+ */
+static void localGraph(Offset n, unsigned degree, unsigned maxWeight,
+		unsigned seed, CSRGraph& c) {
+	std::mt19937 rng(seed);
+	std::vector<Offset> src, dst;
+	std::vector<Weight> w;
+	for(Offset v = 0; v < n; ++v) {
+		for(unsigned i = 0; i < degree; ++i) {
+			src.push_back(v);
+			dst.push_back((v + rng() % 512) % n);
+			w.push_back(1 + rng() % maxWeight);
+		}
+	}
+	buildCSR(n, src, dst, w, c);
+}
+
+TEST(CompressTest, TestGraph) {
+	WeightedDigraph a;
+	ASSERT_EQ(a.fileLoad(goodFile), 0);
+	CSRGraph c;
+	CompressedGraph z;
+	buildCSR(a, c);
+	compressGraph(a, z);
+	expectSameRows(c, z);
+
+	// Hartford has no out-edges
+	std::vector<Offset> n(3);
+	decodeNeighbors(z, a.getOffset("Hartford"), n);
+	EXPECT_TRUE(n.empty());
+}
+
+TEST(CompressTest, GapWidths) {
+	// targets need not be valid offsets for the codec, so a few vertices can
+	// exercise every gap length, in and out of full groups of four
+	CSRGraph c;
+	std::vector<Offset> row = {0, 0, 255, 256, 65791, 65792, 16843007,
+			16843008, 4000000000u};
+	c.offsets = {0, row.size(), row.size(), row.size() + 3};
+	c.targets = row;
+	c.targets.push_back(7);
+	c.targets.push_back(70000);
+	c.targets.push_back(4294967295u);
+	c.weights.assign(c.targets.size(), 1);
+	CompressedGraph z;
+	compressCSR(c, z);
+	expectSameRows(c, z);
+	EXPECT_EQ(z.weightWidth, 0);
+	EXPECT_TRUE(z.weights.empty());
+}
+
+TEST(CompressTest, RoundTrip) {
+	std::mt19937 rng(7);
+	std::vector<Offset> src, dst;
+	std::vector<Weight> w;
+	for(size_t i = 0; i < RANDOM_VERTICES * 8; ++i) {
+		// a few hubs give long rows, the rest are short or empty
+		src.push_back(i % 10 == 0 ? rng() % 16 : rng() % RANDOM_VERTICES);
+		dst.push_back(rng() % RANDOM_VERTICES);
+		w.push_back(rng() % 200);
+	}
+	CSRGraph c;
+	CSRGraph d;
+	CompressedGraph z;
+	buildCSR(RANDOM_VERTICES, src, dst, w, c);
+	compressCSR(c, z);
+	expectSameRows(c, z);
+	decompressCSR(z, d);
+	EXPECT_EQ(d.offsets, c.offsets);
+	EXPECT_EQ(d.targets, c.targets);
+	EXPECT_EQ(d.weights, c.weights);
+
+	// an empty graph compresses to an empty snapshot
+	CSRGraph e;
+	compressCSR(e, z);
+	EXPECT_EQ(z.getVertexCount(), 0);
+	EXPECT_EQ(z.getEdgeCount(), 0);
+}
+
+TEST(CompressTest, WeightWidths) {
+	CSRGraph c;
+	CompressedGraph z;
+	localGraph(1000, 4, 100, 3, c);
+
+	// weights in [1, 100] fit one byte above the smallest
+	compressCSR(c, z);
+	EXPECT_EQ(z.weightWidth, 1);
+	EXPECT_EQ(z.weightBase, 1);
+	expectSameRows(c, z);
+
+	// the full signed range takes two
+	c.weights[0] = NWT + 1;
+	c.weights[1] = SHRT_MAX;
+	c.weights[2] = -1;
+	compressCSR(c, z);
+	EXPECT_EQ(z.weightWidth, 2);
+	expectSameRows(c, z);
+}
+
+TEST(CompressTest, Footprint) {
+	CSRGraph c;
+	CompressedGraph z;
+	size_t csrBytes = 0;
+
+	// unweighted, the gaps dominate
+	localGraph(RANDOM_VERTICES, 32, 1, 11, c);
+	compressCSR(c, z);
+	expectSameRows(c, z);
+	csrBytes = c.offsets.size() * sizeof(size_t) +
+		c.targets.size() * sizeof(Offset) + c.weights.size() * sizeof(Weight);
+	EXPECT_GE(csrBytes, 3 * z.getByteCount());
+
+	// one-byte weights take about as much again
+	localGraph(RANDOM_VERTICES, 32, 100, 11, c);
+	compressCSR(c, z);
+	expectSameRows(c, z);
+	EXPECT_GE(csrBytes, 2 * z.getByteCount());
+}
+
+int main(int argc, char** argv) {
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
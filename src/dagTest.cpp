@@ -0,0 +1,195 @@
+#include <iostream>
+#include <random>
+#include <algorithm>
+
+#include "Graph.h"
+#include "CSR.h"
+#include "DAG.h"
+#include "Parallel.h"
+#include "gtest/gtest.h"
+
+#define RANDOM_VERTICES 100000
+
+const std::string dagFile = "../graphFiles/dag.graph";
+const std::string cyclicFile = "../graphFiles/test.graph";
+
+/*
+ * DAGTest
+ *
+ * Performs the following tests on the DAG procedures.
+ *     -Order
+ *     -Cycle
+ *     -ShortestPath
+ *     -LongestPath
+ *     -Levels
+ */
+
+/*
+ * Graph should look as follows after loading from dag.graph.
+ *
+ * Fetch --> Configure[2], Patch[1]
+ * Patch --> Configure[3]
+ * Configure --> Compile[10], Docs[4]
+ * Compile --> Test[6], Package[-2]
+ * Docs --> Package[1]
+ * Test --> Package[3]
+ * Package
+ */
+
+/*
+ * Determines whether every edge of g leads forwards in order.
+ */
+static bool respectsEdges(const CSRGraph& g, const std::vector<Offset>& order) {
+	std::vector<size_t> position(g.getVertexCount());
+	for(size_t i = 0; i < order.size(); ++i) {
+		position[order[i]] = i;
+	}
+	for(Offset v = 0; v < g.getVertexCount(); ++v) {
+		for(size_t e = g.offsets[v]; e < g.offsets[v+1]; ++e) {
+			if(position[g.targets[e]] <= position[v])
+				return false;
+		}
+	}
+	return true;
+}
+
+TEST(DAGTest, Order) {
+	WeightedDigraph a;
+	ASSERT_EQ(a.fileLoad(dagFile), 0);
+	CSRGraph g;
+	buildCSR(a, g);
+	std::vector<Offset> order, cycle;
+
+	ASSERT_TRUE(topologicalOrder(g, order));
+	ASSERT_EQ(order.size(), 7);
+	EXPECT_TRUE(respectsEdges(g, order));
+	EXPECT_EQ(a.getKey(order.front()), "Fetch");
+	EXPECT_EQ(a.getKey(order.back()), "Package");
+	EXPECT_FALSE(findCycle(g, cycle));
+}
+
+TEST(DAGTest, Cycle) {
+	WeightedDigraph a;
+	ASSERT_EQ(a.fileLoad(cyclicFile), 0);
+	CSRGraph g;
+	buildCSR(a, g);
+	std::vector<Offset> order, cycle;
+
+	// every vertex is on or after the cycle through Boston
+	EXPECT_FALSE(topologicalOrder(g, order));
+	EXPECT_TRUE(order.empty());
+	ASSERT_TRUE(findCycle(g, cycle));
+	ASSERT_GE(cycle.size(), 2);
+	for(size_t i = 0; i < cycle.size(); ++i) {
+		EXPECT_NE(a.getWeight(cycle[i], cycle[(i + 1) % cycle.size()]), NWT);
+	}
+
+	// a self loop is a cycle of its own
+	WeightedDigraph b;
+	b.addVertex("Boston");
+	b.addVertex("Hartford");
+	b.setEdge("Boston", "Hartford", 1);
+	b.setEdge("Hartford", "Hartford", 1);
+	buildCSR(b, g);
+	ASSERT_TRUE(findCycle(g, cycle));
+	ASSERT_EQ(cycle.size(), 1);
+	EXPECT_EQ(b.getKey(cycle[0]), "Hartford");
+}
+
+TEST(DAGTest, ShortestPath) {
+	WeightedDigraph a;
+	ASSERT_EQ(a.fileLoad(dagFile), 0);
+	CSRGraph g;
+	buildCSR(a, g);
+	std::vector<Offset> order;
+	ASSERT_TRUE(topologicalOrder(g, order));
+	DagPaths d;
+	Path p;
+
+	// Fetch -> Configure -> Docs -> Package (7) beats the negative edge
+	// out of Compile (10)
+	dagShortestPaths(g, order, a.getOffset("Fetch"), d);
+	ASSERT_TRUE(dagPath(d, a.getOffset("Package"), p));
+	EXPECT_EQ(p.cost, 7);
+	ASSERT_EQ(p.vertices.size(), 4);
+	EXPECT_EQ(a.getKey(p.vertices[2]), "Docs");
+
+	// Compile -> Package is cheaper than nothing
+	dagShortestPaths(g, order, a.getOffset("Compile"), d);
+	ASSERT_TRUE(dagPath(d, a.getOffset("Package"), p));
+	EXPECT_EQ(p.cost, -2);
+
+	// nothing leads back to Fetch
+	EXPECT_FALSE(dagPath(d, a.getOffset("Fetch"), p));
+}
+
+TEST(DAGTest, LongestPath) {
+	WeightedDigraph a;
+	ASSERT_EQ(a.fileLoad(dagFile), 0);
+	CSRGraph g;
+	buildCSR(a, g);
+	std::vector<Offset> order;
+	ASSERT_TRUE(topologicalOrder(g, order));
+	DagPaths d;
+	Path p;
+	std::vector<Key> k;
+
+	// the critical path visits every vertex but Docs
+	dagLongestPaths(g, order, a.getOffset("Fetch"), d);
+	ASSERT_TRUE(dagPath(d, a.getOffset("Package"), p));
+	EXPECT_EQ(p.cost, 23);
+	pathKeys(a, p, k);
+	ASSERT_EQ(k.size(), 6);
+	EXPECT_EQ(k[1], "Patch");
+	EXPECT_EQ(k[4], "Test");
+}
+
+TEST(DAGTest, Levels) {
+	// random edges from lower to higher offsets always form a DAG
+	std::mt19937 rng(7);
+	std::vector<Offset> src, dst;
+	for(size_t i = 0; i < 4 * RANDOM_VERTICES; ++i) {
+		Offset u = rng() % RANDOM_VERTICES, v = rng() % RANDOM_VERTICES;
+		if(u != v) {
+			src.push_back(std::min(u, v));
+			dst.push_back(std::max(u, v));
+		}
+	}
+	CSRGraph g;
+	buildCSR(RANDOM_VERTICES, src, dst, std::vector<Weight>(), g);
+
+	// the order does not depend on the thread count
+	std::vector<Offset> serial, parallel;
+	setParallelThreads(1);
+	ASSERT_TRUE(topologicalOrder(g, serial));
+	setParallelThreads(4);
+	ASSERT_TRUE(topologicalOrder(g, parallel));
+	setParallelThreads(0);
+	EXPECT_EQ(serial.size(), RANDOM_VERTICES);
+	EXPECT_TRUE(respectsEdges(g, serial));
+	EXPECT_EQ(serial, parallel);
+
+	// chaining the order and closing it from the last vertex back to the
+	// first makes every vertex part of a single cycle
+	for(size_t i = 0; i + 1 < serial.size(); ++i) {
+		src.push_back(serial[i]);
+		dst.push_back(serial[i+1]);
+	}
+	src.push_back(serial.back());
+	dst.push_back(serial.front());
+	buildCSR(RANDOM_VERTICES, src, dst, std::vector<Weight>(), g);
+	std::vector<Offset> cycle;
+	EXPECT_FALSE(topologicalOrder(g, parallel));
+	EXPECT_TRUE(parallel.empty());
+	ASSERT_TRUE(findCycle(g, cycle));
+	for(size_t i = 0; i < cycle.size(); ++i) {
+		Offset v = cycle[i], w = cycle[(i + 1) % cycle.size()];
+		EXPECT_TRUE(std::binary_search(g.targets.begin() + g.offsets[v],
+				g.targets.begin() + g.offsets[v+1], w));
+	}
+}
+
+int main(int argc, char** argv) {
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
@@ -0,0 +1,207 @@
+#include <iostream>
+#include <algorithm>
+#include <cstdio>
+
+#include "Graph.h"
+#include "CSR.h"
+#include "Extract.h"
+#include "Parallel.h"
+#include "testGraphs.h"
+#include "gtest/gtest.h"
+
+#define RANDOM_VERTICES 20000
+
+const std::string subgraphFile = "subgraph.graph";
+
+/*
+ * ExtractTest
+ *
+ * Performs the following tests on subgraph extraction.
+ *     -KHop
+ *     -Filter
+ *     -Induce
+ *     -Threads
+ *     -Write
+ */
+
+static void loadCSR(WeightedDigraph& g, CSRGraph& c) {
+	ASSERT_EQ(g.fileLoad(goodFile), 0);
+	buildCSR(g, c);
+}
+
+/*
+ * The keys of a set of offsets, sorted.
+ */
+static std::vector<Key> keysOf(const WeightedDigraph& g,
+		const std::vector<Offset>& v) {
+	std::vector<Key> k;
+	for(size_t i = 0; i < v.size(); ++i) {
+		k.push_back(g.getKey(v[i]));
+	}
+	std::sort(k.begin(), k.end());
+	return k;
+}
+
+/*
+ * Checks that every edge of a subgraph is an edge of the snapshot it was
+ * extracted from, with the same weight. Random snapshots may repeat an edge.
+ */
+static void expectEdgesOf(const CSRGraph& c, const Subgraph& s) {
+	for(Offset v = 0; v < s.csr.getVertexCount(); ++v) {
+		Offset from = s.origin[v];
+		for(size_t e = s.csr.offsets[v]; e < s.csr.offsets[v+1]; ++e) {
+			ASSERT_LT(s.csr.targets[e], s.origin.size());
+			Offset to = s.origin[s.csr.targets[e]];
+			auto first = c.targets.begin() + c.offsets[from];
+			auto last = c.targets.begin() + c.offsets[from+1];
+			auto range = std::equal_range(first, last, to);
+			bool found = false;
+			for(auto it = range.first; it != range.second; ++it) {
+				found |= c.weights[it - c.targets.begin()] == s.csr.weights[e];
+			}
+			EXPECT_TRUE(found);
+		}
+	}
+}
+
+TEST(ExtractTest, KHop) {
+	WeightedDigraph g;
+	CSRGraph c;
+	loadCSR(g, c);
+	Offset boston = g.getOffset("Boston");
+	std::vector<Offset> r;
+
+	kHop(c, boston, 0, EdgeFilter(), r);
+	EXPECT_EQ(keysOf(g, r), std::vector<Key>({"Boston"}));
+	kHop(c, boston, 1, EdgeFilter(), r);
+	EXPECT_EQ(keysOf(g, r),
+			std::vector<Key>({"Boston", "Los Angeles", "New York"}));
+	kHop(c, boston, 2, EdgeFilter(), r);
+	EXPECT_EQ(keysOf(g, r), std::vector<Key>({"Boston", "Hartford",
+			"Houston", "Los Angeles", "Miami", "New York"}));
+	kHop(c, boston, 3, EdgeFilter(), r);
+	EXPECT_EQ(r.size(), 7);
+	EXPECT_TRUE(std::is_sorted(r.begin(), r.end()));
+
+	// nothing leaves Hartford
+	kHop(c, g.getOffset("Hartford"), 5, EdgeFilter(), r);
+	EXPECT_EQ(keysOf(g, r), std::vector<Key>({"Hartford"}));
+}
+
+TEST(ExtractTest, Filter) {
+	WeightedDigraph g;
+	CSRGraph c;
+	loadCSR(g, c);
+	std::vector<Offset> r;
+	EdgeFilter f;
+
+	// Boston --> Los Angeles[4] is followed, Los Angeles --> Miami[29] is not
+	f.minWeight = 1;
+	f.maxWeight = 10;
+	kHop(c, g.getOffset("Boston"), 5, f, r);
+	EXPECT_EQ(keysOf(g, r), std::vector<Key>({"Boston", "Los Angeles"}));
+
+	f.minWeight = 10;
+	f.maxWeight = 20;
+	kHop(c, g.getOffset("Boston"), 5, f, r);
+	EXPECT_EQ(keysOf(g, r), std::vector<Key>({"Boston", "Hartford",
+			"Miami", "New York"}));
+
+	f.minWeight = 30;
+	f.maxWeight = 40;
+	kHop(c, g.getOffset("Boston"), 5, f, r);
+	EXPECT_EQ(r.size(), 1);
+}
+
+TEST(ExtractTest, Induce) {
+	WeightedDigraph g;
+	CSRGraph c;
+	Subgraph s;
+	loadCSR(g, c);
+
+	extractKHop(c, g.getOffset("Boston"), 1, EdgeFilter(), s);
+	ASSERT_EQ(s.csr.getVertexCount(), 3);
+	EXPECT_EQ(s.csr.getEdgeCount(), 2);
+	EXPECT_TRUE(std::is_sorted(s.origin.begin(), s.origin.end()));
+
+	// every vertex of the full graph induces a copy of it
+	std::vector<Offset> all;
+	for(Offset v = 0; v < c.getVertexCount(); ++v) {
+		all.push_back(c.getVertexCount() - 1 - v);
+	}
+	induceSubgraph(c, all, EdgeFilter(), s);
+	EXPECT_EQ(s.csr.offsets, c.offsets);
+	EXPECT_EQ(s.csr.targets, c.targets);
+	EXPECT_EQ(s.csr.weights, c.weights);
+
+	// a filter drops edges without dropping vertices
+	EdgeFilter f;
+	f.maxWeight = 10;
+	std::vector<Offset> some;
+	some.push_back(g.getOffset("Miami"));
+	some.push_back(g.getOffset("Boston"));
+	some.push_back(g.getOffset("San Francisco"));
+	induceSubgraph(c, some, f, s);
+	ASSERT_EQ(s.csr.getVertexCount(), 3);
+	EXPECT_EQ(s.csr.getEdgeCount(), 2);
+	for(Offset v = 0; v < 3; ++v) {
+		for(size_t e = s.csr.offsets[v]; e < s.csr.offsets[v+1]; ++e) {
+			EXPECT_EQ(s.csr.weights[e], g.getWeight(s.origin[v],
+					s.origin[s.csr.targets[e]]));
+		}
+	}
+}
+
+TEST(ExtractTest, Threads) {
+	CSRGraph c;
+	Subgraph one, many;
+	EdgeFilter f;
+	f.maxWeight = 80;
+	randomCSR(c, RANDOM_VERTICES, RANDOM_VERTICES * 4, 11, 0, 99);
+
+	setParallelThreads(1);
+	extractKHop(c, 0, 8, f, one);
+	setParallelThreads(4);
+	extractKHop(c, 0, 8, f, many);
+	setParallelThreads(0);
+	EXPECT_GT(one.origin.size(), 1000);
+	EXPECT_EQ(one.origin, many.origin);
+	EXPECT_EQ(one.csr.offsets, many.csr.offsets);
+	EXPECT_EQ(one.csr.targets, many.csr.targets);
+	EXPECT_EQ(one.csr.weights, many.csr.weights);
+
+	// every edge kept is an edge of the snapshot that meets the filter,
+	// whether renumbered through a table or, for a few hops, a search
+	for(unsigned k = 2; k <= 8; k += 6) {
+		extractKHop(c, 0, k, f, many);
+		expectEdgesOf(c, many);
+		for(size_t e = 0; e < many.csr.getEdgeCount(); ++e) {
+			EXPECT_LE(many.csr.weights[e], 80);
+		}
+	}
+}
+
+TEST(ExtractTest, Write) {
+	WeightedDigraph g, h;
+	CSRGraph c;
+	Subgraph s;
+	loadCSR(g, c);
+
+	extractKHop(c, g.getOffset("New York"), 1, EdgeFilter(), s);
+	ASSERT_EQ(writeSubgraph(g, s, subgraphFile), 0);
+	ASSERT_EQ(h.fileLoad(subgraphFile), 0);
+	ASSERT_EQ(h.getVertexCount(), 4);
+	EXPECT_EQ(h.getWeight(h.getOffset("New York"), h.getOffset("Miami")), 10);
+	EXPECT_EQ(h.getWeight(h.getOffset("New York"), h.getOffset("Houston")), 28);
+	EXPECT_EQ(h.getWeight(h.getOffset("New York"), h.getOffset("Hartford")), 12);
+	EXPECT_EQ(h.getEdgeCount(), 3);
+
+	EXPECT_EQ(writeSubgraph(g, s, "subgraph.wumbo"), -2);
+	EXPECT_EQ(writeSubgraph(g, s, "missing/subgraph.graph"), -1);
+	std::remove(subgraphFile.c_str());
+}
+
+int main(int argc, char** argv) {
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
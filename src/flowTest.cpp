@@ -0,0 +1,222 @@
+#include <iostream>
+#include <random>
+#include <algorithm>
+#include <climits>
+
+#include "Graph.h"
+#include "CSR.h"
+#include "Flow.h"
+#include "Parallel.h"
+#include "testGraphs.h"
+#include "gtest/gtest.h"
+
+#define RANDOM_VERTICES 20000
+
+/*
+ * FlowTest
+ *
+ * Performs the following tests on the flow procedures.
+ *     -Sink
+ *     -Keys
+ *     -Reference
+ *     -Threads
+ *     -Capacities
+ */
+
+/*
+ * The Edmonds-Karp algorithm over a capacity matrix, to check the flow
+ * against.
+ */
+static long long edmondsKarp(const CSRGraph& g, Offset s, Offset t) {
+	Offset n = g.getVertexCount();
+	std::vector<std::vector<long long>> cap(n, std::vector<long long>(n, 0));
+	for(Offset v = 0; v < n; ++v) {
+		for(size_t e = g.offsets[v]; e < g.offsets[v+1]; ++e) {
+			if(g.targets[e] != v && g.weights[e] > 0)
+				cap[v][g.targets[e]] += g.weights[e];
+		}
+	}
+	long long total = 0;
+	while(true) {
+		std::vector<long> parent(n, -1);
+		std::vector<Offset> queue(1, s);
+		parent[s] = s;
+		for(size_t i = 0; i < queue.size() && parent[t] == -1; ++i) {
+			for(Offset w = 0; w < n; ++w) {
+				if(parent[w] == -1 && cap[queue[i]][w] > 0) {
+					parent[w] = queue[i];
+					queue.push_back(w);
+				}
+			}
+		}
+		if(parent[t] == -1)
+			return total;
+		long long delta = LLONG_MAX;
+		for(Offset w = t; w != s; w = parent[w]) {
+			delta = std::min(delta, cap[parent[w]][w]);
+		}
+		for(Offset w = t; w != s; w = parent[w]) {
+			cap[parent[w]][w] -= delta;
+			cap[w][parent[w]] += delta;
+		}
+		total += delta;
+	}
+}
+
+/*
+ * Checks that a cut separates the source from the sink, holds every edge
+ * crossing it, and has the capacity of the flow.
+ */
+static void expectCut(const CSRGraph& g, Offset s, Offset t, const MinCut& cut) {
+	std::vector<bool> side(g.getVertexCount(), false);
+	for(size_t i = 0; i < cut.sourceSide.size(); ++i) {
+		side[cut.sourceSide[i]] = true;
+	}
+	ASSERT_TRUE(side[s]);
+	ASSERT_FALSE(side[t]);
+	long long capacity = 0;
+	size_t crossing = 0;
+	for(Offset v = 0; v < g.getVertexCount(); ++v) {
+		for(size_t e = g.offsets[v]; e < g.offsets[v+1]; ++e) {
+			if(side[v] && !side[g.targets[e]] && g.weights[e] > 0) {
+				capacity += g.weights[e];
+				++crossing;
+			}
+		}
+	}
+	EXPECT_EQ(crossing, cut.edges.size());
+	EXPECT_EQ(capacity, cut.flow);
+	for(size_t i = 0; i < cut.edges.size(); ++i) {
+		EXPECT_TRUE(side[cut.edges[i].from]);
+		EXPECT_FALSE(side[cut.edges[i].to]);
+	}
+}
+
+TEST(FlowTest, Sink) {
+	WeightedDigraph g;
+	CSRGraph c;
+	MinCut cut;
+	FlowOptions o;
+	ASSERT_EQ(g.fileLoad(goodFile), 0);
+	buildCSR(g, c);
+	Offset boston = g.getOffset("Boston");
+
+	// only New York leads to Hartford
+	EXPECT_EQ(maxFlow(c, boston, g.getOffset("Hartford"), o, cut), 12);
+	EXPECT_EQ(cut.sourceSide.size(), 6);
+	ASSERT_EQ(cut.edges.size(), 1);
+	EXPECT_EQ(g.getKey(cut.edges[0].from), "New York");
+	EXPECT_EQ(cut.edges[0].capacity, 12);
+	expectCut(c, boston, g.getOffset("Hartford"), cut);
+
+	// everything leaving Boston reaches Houston, through San Francisco and
+	// New York when it goes by Los Angeles; Hartford reaches nothing, so it
+	// is on the source side too
+	EXPECT_EQ(maxFlow(c, boston, g.getOffset("Houston"), o, cut), 23);
+	ASSERT_EQ(cut.sourceSide.size(), 2);
+	EXPECT_EQ(g.getKey(cut.sourceSide[0]), "Boston");
+	EXPECT_EQ(g.getKey(cut.sourceSide[1]), "Hartford");
+	EXPECT_EQ(cut.edges.size(), 2);
+	expectCut(c, boston, g.getOffset("Houston"), cut);
+
+	// nothing leaves Hartford
+	EXPECT_EQ(maxFlow(c, g.getOffset("Hartford"), boston, o, cut), 0);
+	EXPECT_EQ(cut.edges.size(), 0);
+	expectCut(c, g.getOffset("Hartford"), boston, cut);
+
+	EXPECT_EQ(maxFlow(c, boston, boston, o, cut), 0);
+	EXPECT_EQ(cut.sourceSide.size(), 0);
+}
+
+TEST(FlowTest, Keys) {
+	WeightedDigraph g;
+	KeyCut cut;
+	FlowOptions o;
+	ASSERT_EQ(g.fileLoad(goodFile), 0);
+
+	ASSERT_EQ(maxFlow(g, "Boston", "Houston", o, cut), 0);
+	EXPECT_EQ(cut.flow, 23);
+	ASSERT_EQ(cut.sourceSide.size(), 2);
+	EXPECT_EQ(cut.sourceSide[0], "Boston");
+	EXPECT_EQ(cut.sourceSide[1], "Hartford");
+	ASSERT_EQ(cut.edges.size(), 2);
+	for(size_t i = 0; i < cut.edges.size(); ++i) {
+		Weight w;
+		EXPECT_EQ(cut.edges[i].from, "Boston");
+		ASSERT_TRUE(g.getWeight(cut.edges[i].from, cut.edges[i].to, w));
+		EXPECT_EQ(w, cut.edges[i].capacity);
+	}
+
+	EXPECT_EQ(maxFlow(g, "Boston", "Denver", o, cut), -1);
+	EXPECT_EQ(maxFlow(g, "Denver", "Boston", o, cut), -1);
+	EXPECT_EQ(maxFlow(g, "Boston", "Boston", o, cut), -2);
+}
+
+TEST(FlowTest, Reference) {
+	CSRGraph c;
+	MinCut cut;
+	FlowOptions o;
+	for(unsigned seed = 1; seed <= 40; ++seed) {
+		std::mt19937 rng(seed);
+		Offset n = 10 + rng() % 60;
+		randomCSR(c, n, n * (1 + rng() % 6), seed, -20, 100);
+		Offset s = rng() % n;
+		Offset t = (s + 1 + rng() % (n - 1)) % n;
+		EXPECT_EQ(maxFlow(c, s, t, o, cut), edmondsKarp(c, s, t));
+		expectCut(c, s, t, cut);
+	}
+}
+
+TEST(FlowTest, Threads) {
+	CSRGraph c;
+	MinCut one, many;
+	FlowOptions serial, parallel;
+	parallel.parallel = true;
+	for(unsigned seed = 1; seed <= 3; ++seed) {
+		randomCSR(c, RANDOM_VERTICES, RANDOM_VERTICES * (seed + 2), seed, -20, 100);
+		setParallelThreads(1);
+		maxFlow(c, 0, RANDOM_VERTICES - 1, serial, one);
+		setParallelThreads(4);
+		maxFlow(c, 0, RANDOM_VERTICES - 1, parallel, many);
+		setParallelThreads(0);
+
+		// the vertices unable to reach the sink are the same for every
+		// maximum flow
+		EXPECT_GT(one.flow, 0);
+		EXPECT_EQ(one.flow, many.flow);
+		EXPECT_EQ(one.sourceSide, many.sourceSide);
+		expectCut(c, 0, RANDOM_VERTICES - 1, many);
+	}
+}
+
+TEST(FlowTest, Capacities) {
+	WeightedDigraph g;
+	KeyCut cut;
+	FlowOptions o;
+	ASSERT_EQ(g.fileLoad(goodFile), 0);
+
+	// a negative capacity is no edge at all, and an edge back to itself
+	// carries nothing
+	ASSERT_EQ(g.setEdge("New York", "Hartford", -12), 1);
+	ASSERT_EQ(g.setEdge("New York", "New York", 50), 0);
+	ASSERT_EQ(maxFlow(g, "Boston", "Hartford", o, cut), 0);
+	EXPECT_EQ(cut.flow, 0);
+	EXPECT_EQ(cut.sourceSide.size(), 6);
+	EXPECT_EQ(cut.edges.size(), 0);
+
+	// flows past the largest Weight add up; San Francisco passes on only
+	// what reaches it from Los Angeles
+	ASSERT_EQ(g.setEdge("New York", "Hartford", SHRT_MAX), 1);
+	ASSERT_TRUE(g.addVertex("Denver"));
+	ASSERT_EQ(g.setEdge("Boston", "Denver", SHRT_MAX), 0);
+	ASSERT_EQ(g.setEdge("Denver", "New York", SHRT_MAX), 0);
+	ASSERT_EQ(maxFlow(g, "Boston", "Hartford", o, cut), 0);
+	EXPECT_EQ(cut.flow, SHRT_MAX);
+	ASSERT_EQ(maxFlow(g, "Boston", "New York", o, cut), 0);
+	EXPECT_EQ(cut.flow, (long long)SHRT_MAX + 19 + 4);
+}
+
+int main(int argc, char** argv) {
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
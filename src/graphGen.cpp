@@ -0,0 +1,426 @@
+#include "Graph.h"
+#include <iostream>
+#include <vector>
+#include <string>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <random>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <stdint.h>
+#include <unistd.h>
+
+/*
+ * Synthetic graph generator.
+ *
+ * Streams a generated graph straight to disk without ever holding it in
+ * memory. Rows (a vertex and its outgoing edges) are generated in chunks by a
+ * pool of threads and written in order by the main thread; at most two chunks
+ * per thread are in flight at any time, so memory stays bounded no matter the
+ * size of the output. Every chunk draws from its own generator seeded from
+ * the seed and the chunk number, so the output depends only on the options
+ * and not on the number of threads.
+ *
+ * usage: graphGen [-m model] [-n vertices] [-d degree] [-w min,max]
+ *                 [-k prefix] [-z width] [-s seed] [-t threads] [-c rows]
+ *                 [-r a,b,c] [-g gamma] <output_file>
+ *
+ *    -m, rmat (default), er, grid, or powerlaw
+ *    -n, number of vertices (default 1024); rmat rounds up to a power of 2
+ *    -d, average out-degree (default 8); grid uses it as the percentage of
+ *        lattice links kept, out of 100 (default 90 when unset)
+ *    -w, inclusive weight range (default 1,100); must lie within
+ *        [SHRT_MIN+1, SHRT_MAX] since SHRT_MIN is reserved for NWT
+ *    -k, vertex key prefix (default "v"); keys are <prefix><index>
+ *    -z, zero pad vertex indices to this width (default 0)
+ *    -s, random seed (default 1)
+ *    -t, generator threads (default: hardware concurrency)
+ *    -c, rows per chunk (default 4096)
+ *    -r, rmat quadrant probabilities a,b,c (default .57,.19,.19; d = 1-a-b-c)
+ *    -g, powerlaw degree exponent (default 2.1)
+ *
+ * Models:
+ *    rmat      R-MAT/Kronecker. Each row's expected degree and its targets are
+ *              drawn from the recursive quadrant probabilities conditioned on
+ *              the row, which makes the model row-streamable.
+ *    er        Erdos-Renyi G(n,p) with p = degree/n.
+ *    grid      Road-like 2D lattice: each cell links to its 4 neighbors in
+ *              both directions with the given probability, plus a rare
+ *              diagonal shortcut.
+ *    powerlaw  Chung-Lu with expected degrees following a power law of the
+ *              given exponent; targets are drawn by inverting the degree CDF
+ *              in closed form, so no per-vertex tables are kept.
+ *
+ * Output format is chosen by extension:
+ *    .graph    the text format read by WeightedDigraph::fileLoad
+ *    .edges    binary edge list: "QGEDGES1", uint64 vertex count, uint64 edge
+ *              count, then one record per edge of uint32 source, uint32
+ *              target and int16 weight, all little-endian and unpadded.
+ *              Vertex i has key <prefix><index> as in the text format.
+ */
+
+const std::string edgesExt(".edges");
+const char edgesMagic[8] = {'Q','G','E','D','G','E','S','1'};
+
+const std::string genUsage("usage: graphGen [-m rmat|er|grid|powerlaw] [-n vertices] [-d degree] [-w min,max] [-k prefix] [-z width] [-s seed] [-t threads] [-c rows] [-r a,b,c] [-g gamma] <output_file>");
+
+enum Model { RMAT, ER, GRID, POWERLAW };
+
+struct Options {
+	Model model;
+	uint64_t vertices;
+	double degree;
+	bool degreeSet;
+	int wmin;
+	int wmax;
+	std::string prefix;
+	unsigned width;
+	uint64_t seed;
+	unsigned threads;
+	uint64_t chunkRows;
+	double a, b, c;
+	double gamma;
+	bool binary;
+};
+
+/*
+ * A chunk of generated rows, in the output format.
+ */
+struct Chunk {
+	bool ready;
+	std::string data;
+	uint64_t edges;
+};
+
+/////////////////////////////////////////////////////////////////////////////
+// AUXILIARY FUNCTIONS                                                     //
+/////////////////////////////////////////////////////////////////////////////
+
+/*
+ * Mixes the seed and chunk number into an independent generator seed.
+ */
+static uint64_t mixSeed(uint64_t seed, uint64_t chunk) {
+	uint64_t z = seed + 0x9E3779B97F4A7C15ULL * (chunk + 1);
+	z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+	z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+	return z ^ (z >> 31);
+}
+
+static void appendNumber(std::string& out, long long v, unsigned width = 0) {
+	char buf[32];
+	char* p = buf + sizeof(buf);
+	unsigned long long u = v < 0 ? -(unsigned long long)v : v;
+	do {
+		*--p = '0' + u % 10;
+		u /= 10;
+	} while(u);
+	while(buf + sizeof(buf) - p < (long)width && p > buf + 1)
+		*--p = '0';
+	if(v < 0)
+		*--p = '-';
+	out.append(p, buf + sizeof(buf) - p);
+}
+
+static void appendKey(std::string& out, const Options& opt, uint64_t v) {
+	out += opt.prefix;
+	appendNumber(out, v, opt.width);
+}
+
+static void appendRaw(std::string& out, uint64_t v, int bytes) {
+	for(int i = 0; i < bytes; ++i) {
+		out += (char)((v >> (8 * i)) & 0xFF);
+	}
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// MODELS                                                                  //
+/////////////////////////////////////////////////////////////////////////////
+
+/*
+ * Generates the targets of row u, unsorted and possibly with duplicates.
+ */
+static void rowTargets(const Options& opt, uint64_t u, std::mt19937_64& rng,
+		std::vector<uint64_t>& t) {
+	std::uniform_real_distribution<double> unit(0.0, 1.0);
+	uint64_t n = opt.vertices;
+	if(opt.model == ER) {
+		std::binomial_distribution<uint64_t> deg(n, std::min(1.0, opt.degree / n));
+		std::uniform_int_distribution<uint64_t> pick(0, n - 1);
+		for(uint64_t k = deg(rng); k > 0; --k) {
+			t.push_back(pick(rng));
+		}
+	}
+	else if(opt.model == RMAT) {
+		// probability mass of row u, and the target bit odds given each row bit
+		double d = 1.0 - opt.a - opt.b - opt.c;
+		double mass = 1.0;
+		int scale = 0;
+		while((1ULL << scale) < n) {
+			mass *= (u >> scale & 1) ? (opt.c + d) : (opt.a + opt.b);
+			++scale;
+		}
+		// each target bit is decided by a 16 bit slice of a random word
+		uint32_t one[2] = {
+			(uint32_t)(65536 * opt.b / (opt.a + opt.b)),
+			(uint32_t)(65536 * d / (opt.c + d))};
+		std::poisson_distribution<uint64_t> deg(opt.degree * n * mass);
+		for(uint64_t k = deg(rng); k > 0; --k) {
+			uint64_t v = 0;
+			uint64_t bits = 0;
+			for(int bit = 0; bit < scale; ++bit) {
+				if(bit % 4 == 0)
+					bits = rng();
+				if((bits & 0xFFFF) < one[u >> bit & 1])
+					v |= 1ULL << bit;
+				bits >>= 16;
+			}
+			t.push_back(v);
+		}
+	}
+	else if(opt.model == GRID) {
+		uint64_t cols = (uint64_t)std::sqrt((double)n);
+		if(cols == 0)
+			cols = 1;
+		uint64_t r = u / cols;
+		uint64_t c = u % cols;
+		double keep = (opt.degreeSet ? opt.degree : 90.0) / 100.0;
+		if(c > 0 && unit(rng) < keep)
+			t.push_back(u - 1);
+		if(c + 1 < cols && u + 1 < n && unit(rng) < keep)
+			t.push_back(u + 1);
+		if(r > 0 && unit(rng) < keep)
+			t.push_back(u - cols);
+		if(u + cols < n && unit(rng) < keep)
+			t.push_back(u + cols);
+		if(c + 1 < cols && u + cols + 1 < n && unit(rng) < 0.01)
+			t.push_back(u + cols + 1);
+	}
+	else {
+		// expected degree of vertex i is proportional to (i+1)^-alpha
+		double alpha = 1.0 / (opt.gamma - 1.0);
+		double norm = (alpha == 1.0) ? std::log(n + 1.0) :
+			(std::pow(n + 1.0, 1.0 - alpha) - 1.0) / (1.0 - alpha);
+		double expected = opt.degree * n * std::pow(u + 1.0, -alpha) / norm;
+		std::poisson_distribution<uint64_t> deg(expected);
+		for(uint64_t k = deg(rng); k > 0; --k) {
+			double x = unit(rng) * norm;
+			double i = (alpha == 1.0) ? std::exp(x) :
+				std::pow(1.0 + x * (1.0 - alpha), 1.0 / (1.0 - alpha));
+			t.push_back(std::min<uint64_t>(n - 1, (uint64_t)i - 1));
+		}
+	}
+}
+
+/*
+ * Generates rows [first, last) into a chunk in the output format.
+ */
+static void generateChunk(const Options& opt, uint64_t chunk, uint64_t first,
+		uint64_t last, Chunk& out) {
+	std::mt19937_64 rng(mixSeed(opt.seed, chunk));
+	std::uniform_int_distribution<int> wt(opt.wmin, opt.wmax);
+	std::vector<uint64_t> t;
+	out.data.clear();
+	out.edges = 0;
+	for(uint64_t u = first; u < last; ++u) {
+		t.clear();
+		rowTargets(opt, u, rng, t);
+		std::sort(t.begin(), t.end());
+		t.erase(std::unique(t.begin(), t.end()), t.end());
+		out.edges += t.size();
+		if(opt.binary) {
+			for(size_t i = 0; i < t.size(); ++i) {
+				appendRaw(out.data, u, 4);
+				appendRaw(out.data, t[i], 4);
+				appendRaw(out.data, (uint16_t)(int16_t)wt(rng), 2);
+			}
+		}
+		else {
+			appendKey(out.data, opt, u);
+			out.data += " | ";
+			for(size_t i = 0; i < t.size(); ++i) {
+				appendKey(out.data, opt, t[i]);
+				out.data += '[';
+				appendNumber(out.data, wt(rng));
+				out.data += "] ";
+			}
+			out.data += '\n';
+		}
+	}
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// MAIN                                                                    //
+/////////////////////////////////////////////////////////////////////////////
+
+static bool parseTriple(const char* arg, double& a, double& b, double& c) {
+	return std::sscanf(arg, "%lf,%lf,%lf", &a, &b, &c) == 3;
+}
+
+int main(int argc, char** argv) {
+	Options opt;
+	opt.model = RMAT;
+	opt.vertices = 1024;
+	opt.degree = 8;
+	opt.degreeSet = false;
+	opt.wmin = 1;
+	opt.wmax = 100;
+	opt.prefix = "v";
+	opt.width = 0;
+	opt.seed = 1;
+	opt.threads = std::max(1u, std::thread::hardware_concurrency());
+	opt.chunkRows = 4096;
+	opt.a = 0.57;
+	opt.b = 0.19;
+	opt.c = 0.19;
+	opt.gamma = 2.1;
+
+	int ch;
+	bool ok = true;
+	while((ch = getopt(argc, argv, "m:n:d:w:k:z:s:t:c:r:g:")) != -1) {
+		std::string arg(optarg ? optarg : "");
+		switch(ch) {
+			case 'm':
+				if(arg == "rmat") opt.model = RMAT;
+				else if(arg == "er") opt.model = ER;
+				else if(arg == "grid") opt.model = GRID;
+				else if(arg == "powerlaw") opt.model = POWERLAW;
+				else ok = false;
+				break;
+			case 'n': opt.vertices = std::strtoull(optarg, NULL, 10); break;
+			case 'd': opt.degree = std::atof(optarg); opt.degreeSet = true; break;
+			case 'w':
+				ok = std::sscanf(optarg, "%d,%d", &opt.wmin, &opt.wmax) == 2;
+				break;
+			case 'k': opt.prefix = arg; break;
+			case 'z': opt.width = std::atoi(optarg); break;
+			case 's': opt.seed = std::strtoull(optarg, NULL, 10); break;
+			case 't': opt.threads = std::atoi(optarg); break;
+			case 'c': opt.chunkRows = std::strtoull(optarg, NULL, 10); break;
+			case 'r': ok = parseTriple(optarg, opt.a, opt.b, opt.c); break;
+			case 'g': opt.gamma = std::atof(optarg); break;
+			default: ok = false;
+		}
+	}
+	if(!ok || argc - optind != 1 || opt.vertices == 0 || opt.threads == 0 ||
+			opt.chunkRows == 0 || opt.degree < 0 || opt.gamma <= 1.0 ||
+			opt.a + opt.b + opt.c >= 1.0 || opt.a <= 0 || opt.b < 0 || opt.c < 0 ||
+			opt.vertices > UINT_MAX) {
+		std::cerr << genUsage << std::endl;
+		return 1;
+	}
+	if(opt.wmin <= NWT || opt.wmax > SHRT_MAX || opt.wmin > opt.wmax) {
+		std::cerr << "Weight range must lie within [" << NWT + 1 << ", "
+			<< SHRT_MAX << "]" << std::endl;
+		return 1;
+	}
+	std::string file(argv[optind]);
+	if(file.size() > edgesExt.size() &&
+			file.compare(file.size() - edgesExt.size(), edgesExt.size(), edgesExt) == 0)
+		opt.binary = true;
+	else if(file.size() > graphExt.size() &&
+			file.compare(file.size() - graphExt.size(), graphExt.size(), graphExt) == 0)
+		opt.binary = false;
+	else {
+		std::cerr << "Output file must have a \"" << graphExt << "\" or \""
+			<< edgesExt << "\" extension: " << file << std::endl;
+		return 1;
+	}
+	if(opt.model == RMAT) {
+		uint64_t n = 1;
+		while(n < opt.vertices) n <<= 1;
+		opt.vertices = n;
+	}
+
+	FILE* out = std::fopen(file.c_str(), "wb");
+	if(!out) {
+		std::cerr << "Unable to open " << file << std::endl;
+		return 1;
+	}
+	std::setvbuf(out, NULL, _IOFBF, 1 << 20);
+	if(opt.binary) {
+		std::string header(edgesMagic, sizeof(edgesMagic));
+		appendRaw(header, opt.vertices, 8);
+		appendRaw(header, 0, 8);
+		std::fwrite(header.data(), 1, header.size(), out);
+	}
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	uint64_t chunks = (opt.vertices + opt.chunkRows - 1) / opt.chunkRows;
+	uint64_t window = 2 * opt.threads;
+	std::vector<Chunk> slots(window);
+	std::mutex m;
+	std::condition_variable cv;
+	uint64_t written = 0;
+	std::atomic<uint64_t> next(0);
+
+	std::vector<std::thread> pool;
+	for(unsigned i = 0; i < opt.threads; ++i) {
+		pool.push_back(std::thread([&]{
+			Chunk local;
+			while(true) {
+				uint64_t k = next++;
+				if(k >= chunks)
+					return;
+				uint64_t first = k * opt.chunkRows;
+				generateChunk(opt, k, first,
+						std::min(opt.vertices, first + opt.chunkRows), local);
+				std::unique_lock<std::mutex> guard(m);
+				cv.wait(guard, [&]{ return k < written + window; });
+				slots[k % window].data.swap(local.data);
+				slots[k % window].edges = local.edges;
+				slots[k % window].ready = true;
+				cv.notify_all();
+			}
+		}));
+	}
+
+	uint64_t edges = 0;
+	uint64_t bytes = 0;
+	std::string data;
+	while(written < chunks) {
+		uint64_t e;
+		{
+			std::unique_lock<std::mutex> guard(m);
+			Chunk& slot = slots[written % window];
+			cv.wait(guard, [&]{ return slot.ready; });
+			data.swap(slot.data);
+			e = slot.edges;
+			slot.ready = false;
+		}
+		if(std::fwrite(data.data(), 1, data.size(), out) != data.size()) {
+			std::cerr << "Unable to write " << file << std::endl;
+			std::exit(1);
+		}
+		edges += e;
+		bytes += data.size();
+		std::lock_guard<std::mutex> guard(m);
+		++written;
+		cv.notify_all();
+	}
+	for(size_t i = 0; i < pool.size(); ++i) {
+		pool[i].join();
+	}
+	if(opt.binary) {
+		std::string count;
+		appendRaw(count, edges, 8);
+		std::fseek(out, sizeof(edgesMagic) + 8, SEEK_SET);
+		std::fwrite(count.data(), 1, count.size(), out);
+	}
+	if(std::fclose(out) != 0) {
+		std::cerr << "Unable to write " << file << std::endl;
+		return 1;
+	}
+	double secs = std::chrono::duration<double>(
+			std::chrono::steady_clock::now() - start).count();
+	std::cerr << "vertices: " << opt.vertices << std::endl
+		<< "edges:    " << edges << std::endl
+		<< "bytes:    " << bytes << std::endl
+		<< "seconds:  " << secs << std::endl;
+	return 0;
+}
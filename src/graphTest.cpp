@@ -1,4 +1,8 @@
 #include <iostream>
+#include <fstream>
+#include <cstdio>
+#include <algorithm>
+#include <unistd.h>
 
 #include "Graph.h"
 #include "gtest/gtest.h"
@@ -12,6 +16,8 @@ const std::string goodFile = "../graphFiles/test.graph";
 const std::string nonExist = "nonExist.graph";
 const std::string badExtension1 = "../graphFiles/noExtension";
 const std::string badExtension2 = "../graphFiles/badExtension.wumbo";
+const std::string wideFile = "../graphFiles/aggregate.graph";
+const std::string dagFile = "../graphFiles/dag.graph";
 
 /*
  * GraphTest
@@ -23,6 +29,13 @@ const std::string badExtension2 = "../graphFiles/badExtension.wumbo";
  *     -NeighborValidity
  *     -EmptyGraphOps
  *     -FileLoad
+ *     -MemoryCompact
+ *     -WeightTypes
+ *     -Snapshot
+ *     -LazyLoad
+ *     -LazyMalformed
+ *     -Predecessors
+ *     -Degrees
  */
 TEST(GraphTest, VertexOps) {
 	WeightedDigraph a;
@@ -415,6 +428,409 @@ TEST(GraphTest, FileLoad) {
 	EXPECT_TRUE(hart_nbrs.empty());
 }
 
+TEST(GraphTest, MemoryCompact) {
+	WeightedDigraph a;
+	std::vector<MemComponent> m;
+	Key longKey(64, 'x');
+	for(int i = 0; i < 100; ++i) {
+		a.addVertex(longKey + std::to_string(i));
+	}
+	a.setEdge(longKey + "0", longKey + "99", 5);
+
+	// every component reports its storage, including heap-held keys
+	a.memoryUsage(m);
+	ASSERT_EQ(m.size(), 5);
+	size_t live = 0;
+	for(size_t i = 0; i < m.size(); ++i) {
+		EXPECT_GT(m[i].live, 0);
+		live += m[i].live;
+	}
+	EXPECT_GE(m[2].live, 100 * (sizeof(Key) + longKey.size()));
+
+	// removing most vertices leaves slack that compact releases
+	for(int i = 1; i < 99; ++i) {
+		ASSERT_TRUE(a.removeVertex(longKey + std::to_string(i)));
+	}
+	m.clear();
+	a.memoryUsage(m);
+	size_t slack = 0;
+	for(size_t i = 0; i < m.size(); ++i) {
+		slack += m[i].slack;
+	}
+	EXPECT_GT(slack, 0);
+	EXPECT_GT(a.compact(), 0);
+	m.clear();
+	a.memoryUsage(m);
+	EXPECT_EQ(m[0].slack, 0);
+	EXPECT_EQ(m[1].slack, 0);
+	EXPECT_EQ(m[2].slack, 0);
+
+	// contents are unchanged
+	Weight w;
+	EXPECT_TRUE(a.getWeight(longKey + "0", longKey + "99", w));
+	EXPECT_EQ(w, 5);
+}
+
+TEST(GraphTest, WeightTypes) {
+	WeightType t;
+
+	// the narrowest type that holds every weight in the file
+	ASSERT_EQ(scanWeightType(goodFile, t), SUCCESS);
+	EXPECT_EQ(t, WEIGHT_UINT8);
+	ASSERT_EQ(scanWeightType(dagFile, t), SUCCESS);
+	EXPECT_EQ(t, WEIGHT_INT16);
+	ASSERT_EQ(scanWeightType(wideFile, t), SUCCESS);
+	EXPECT_EQ(t, WEIGHT_INT32);
+	EXPECT_EQ(scanWeightType(nonExist, t), FAILN1);
+	EXPECT_EQ(scanWeightType(badExtension2, t), FAILN2);
+
+	// weights that do not fit are skipped, and the rest are loaded
+	WeightedDigraph a;
+	Weight w;
+	ASSERT_EQ(a.fileLoad(wideFile), -3);
+	EXPECT_EQ(a.getVertexCount(), 4);
+	EXPECT_FALSE(a.isEdge("Ingest", "Clean"));
+	EXPECT_TRUE(a.getWeight("Ingest", "Archive", w));
+	EXPECT_EQ(w, 12);
+
+	BasicWeightedDigraph<int32_t> b;
+	int32_t lw;
+	ASSERT_EQ(b.fileLoad(wideFile), SUCCESS);
+	EXPECT_TRUE(b.getWeight("Clean", "Report", lw));
+	EXPECT_EQ(lw, 250000);
+	EXPECT_TRUE(b.getWeight("Report", "Ingest", lw));
+	EXPECT_EQ(lw, -40000);
+
+	// narrow and unweighted graphs hold the same edges as the default
+	BasicWeightedDigraph<uint8_t> c;
+	BasicWeightedDigraph<bool> d;
+	ASSERT_EQ(a.fileLoad(goodFile), SUCCESS);
+	ASSERT_EQ(c.fileLoad(goodFile), SUCCESS);
+	ASSERT_EQ(d.fileLoad(goodFile), SUCCESS);
+	ASSERT_EQ(c.getVertexCount(), a.getVertexCount());
+	for(Offset i = 0; i < a.getVertexCount(); ++i) {
+		std::vector<Offset> n1, n2, n3;
+		a.getNeighbors(i, n1);
+		c.getNeighbors(i, n2);
+		d.getNeighbors(i, n3);
+		EXPECT_EQ(n1, n2);
+		EXPECT_EQ(n1, n3);
+		for(size_t j = 0; j < n1.size(); ++j) {
+			EXPECT_EQ(a.getWeight(i, n1[j]), c.getWeight(i, n1[j]));
+		}
+	}
+	std::vector<MemComponent> m1, m2;
+	a.memoryUsage(m1);
+	c.memoryUsage(m2);
+	EXPECT_EQ(m2[0].live * 2, m1[0].live);
+
+	// 8-bit weights round trip as numbers
+	uint8_t uw;
+	ASSERT_EQ(c.fileWrite("weightTypes.graph"), SUCCESS);
+	ASSERT_EQ(c.fileLoad("weightTypes.graph"), SUCCESS);
+	EXPECT_TRUE(c.getWeight("Los Angeles", "Miami", uw));
+	EXPECT_EQ(uw, 29);
+	std::remove("weightTypes.graph");
+
+	// float weights, and unparseable weights rejected by every type
+	float fw;
+	EXPECT_TRUE(WeightTraits<float>::parse(" 2.5 ", fw));
+	EXPECT_EQ(fw, 2.5f);
+	EXPECT_FALSE(WeightTraits<float>::parse("nan", fw));
+	EXPECT_FALSE(WeightTraits<int16_t>::parse("12x", w));
+	EXPECT_FALSE(WeightTraits<uint8_t>::parse("255", uw));
+	EXPECT_FALSE(WeightTraits<int16_t>::parse("-32768", w));
+}
+
+TEST(GraphTest, Snapshot) {
+	const std::string snapFile = "graphTest" + snapshotExt;
+	WeightedDigraph a, b;
+	ASSERT_EQ(a.fileLoad(goodFile), SUCCESS);
+	ASSERT_TRUE(a.removeVertex("Hartford"));
+	ASSERT_EQ(a.setEdge("Boston", "Miami", -7), SUCCESS);
+
+	// offsets, keys and weights survive, free slots included
+	ASSERT_EQ(a.snapshotWrite(snapFile), SUCCESS);
+	ASSERT_EQ(b.snapshotLoad(snapFile), SUCCESS);
+	ASSERT_EQ(b.getVertexCount(), a.getVertexCount());
+	for(Offset i = 0; i < a.getVertexCount(); ++i) {
+		EXPECT_EQ(b.getKey(i), a.getKey(i));
+		EXPECT_EQ(b.getOffset(a.getKey(i)), (int)i);
+		std::vector<Offset> n1, n2;
+		a.getNeighbors(i, n1);
+		b.getNeighbors(i, n2);
+		EXPECT_EQ(n1, n2);
+		for(size_t j = 0; j < n1.size(); ++j) {
+			EXPECT_EQ(a.getWeight(i, n1[j]), b.getWeight(i, n1[j]));
+		}
+	}
+	ASSERT_TRUE(b.addVertex("Denver"));
+	EXPECT_EQ(b.setEdge("Denver", "Boston", 3), SUCCESS);
+
+	// packed unweighted rows round trip too
+	BasicWeightedDigraph<bool> c, d;
+	ASSERT_EQ(c.fileLoad(goodFile), SUCCESS);
+	ASSERT_EQ(c.snapshotWrite(snapFile), SUCCESS);
+	ASSERT_EQ(d.snapshotLoad(snapFile), SUCCESS);
+	for(Offset i = 0; i < c.getVertexCount(); ++i) {
+		std::vector<Offset> n1, n2;
+		c.getNeighbors(i, n1);
+		d.getNeighbors(i, n2);
+		EXPECT_EQ(n1, n2);
+	}
+
+	// a snapshot of another weight type, or a truncated one, is refused
+	EXPECT_EQ(b.snapshotLoad(snapFile), -3);
+	EXPECT_EQ(b.getVertexCount(), 0);
+	ASSERT_EQ(a.snapshotWrite(snapFile), SUCCESS);
+	FILE* f = std::fopen(snapFile.c_str(), "r+");
+	ASSERT_TRUE(f != NULL);
+	std::fseek(f, 0, SEEK_END);
+	long size = std::ftell(f);
+	std::fclose(f);
+	ASSERT_EQ(truncate(snapFile.c_str(), size - 3), 0);
+	EXPECT_EQ(b.snapshotLoad(snapFile), -3);
+	EXPECT_EQ(b.getVertexCount(), 0);
+	EXPECT_EQ(b.snapshotLoad(goodFile), FAILN2);
+	EXPECT_EQ(b.snapshotLoad(nonExist + snapshotExt), FAILN1);
+	EXPECT_EQ(a.snapshotWrite(goodFile), FAILN2);
+	std::remove(snapFile.c_str());
+}
+
+TEST(GraphTest, LazyLoad) {
+	WeightedDigraph a, b;
+	ASSERT_EQ(a.fileLoad(goodFile), SUCCESS);
+	ASSERT_EQ(b.lazyLoad(goodFile), SUCCESS);
+	ASSERT_EQ(b.getVertexCount(), a.getVertexCount());
+	EXPECT_EQ(b.getPendingCount(), a.getVertexCount() - 1);
+
+	// each access parses the edges of one vertex
+	Weight w;
+	EXPECT_TRUE(b.getWeight("Boston", "Los Angeles", w));
+	EXPECT_EQ(w, 4);
+	EXPECT_EQ(b.getPendingCount(), a.getVertexCount() - 2);
+	EXPECT_TRUE(b.isEdge("Miami", "San Francisco"));
+	EXPECT_EQ(b.setEdge("New York", "Miami", 3), 1);
+	EXPECT_EQ(b.removeEdge("Houston", "Los Angeles"), SUCCESS);
+	EXPECT_EQ(b.getPendingCount(), a.getVertexCount() - 5);
+	ASSERT_EQ(a.setEdge("New York", "Miami", 3), 1);
+	ASSERT_EQ(a.removeEdge("Houston", "Los Angeles"), SUCCESS);
+
+	// copies parse their own edges
+	WeightedDigraph c(b);
+	ASSERT_TRUE(c.addVertex("Denver"));
+	EXPECT_EQ(c.setEdge("Denver", "Boston", 1), SUCCESS);
+	std::vector<Offset> n1, n2;
+	for(Offset i = 0; i < a.getVertexCount(); ++i) {
+		n1.clear();
+		n2.clear();
+		a.getNeighbors(i, n1);
+		c.getNeighbors(i, n2);
+		EXPECT_EQ(n1, n2);
+		for(size_t j = 0; j < n1.size(); ++j) {
+			EXPECT_EQ(a.getWeight(i, n1[j]), c.getWeight(i, n1[j]));
+		}
+	}
+	EXPECT_EQ(c.getPendingCount(), 0);
+	EXPECT_EQ(b.getPendingCount(), a.getVertexCount() - 5);
+
+	// removing a vertex parses every edge first
+	ASSERT_TRUE(b.removeVertex("Miami"));
+	ASSERT_TRUE(a.removeVertex("Miami"));
+	EXPECT_EQ(b.getPendingCount(), 0);
+	for(Offset i = 0; i < a.getVertexCount(); ++i) {
+		n1.clear();
+		n2.clear();
+		a.getNeighbors(i, n1);
+		b.getNeighbors(i, n2);
+		EXPECT_EQ(n1, n2);
+	}
+
+	// skipped weights are counted as they are parsed
+	ASSERT_EQ(b.lazyLoad(wideFile), SUCCESS);
+	std::vector<MemComponent> m;
+	b.memoryUsage(m);
+	ASSERT_EQ(m.size(), 6);
+	EXPECT_GT(m[5].live, 0);
+	EXPECT_GT(b.materialize(), 0);
+	EXPECT_EQ(b.getPendingCount(), 0);
+	EXPECT_FALSE(b.isEdge("Ingest", "Clean"));
+	EXPECT_TRUE(b.getWeight("Ingest", "Archive", w));
+	EXPECT_EQ(w, 12);
+	m.clear();
+	b.memoryUsage(m);
+	EXPECT_EQ(m.size(), 5);
+
+	EXPECT_EQ(b.lazyLoad(nonExist), FAILN1);
+	EXPECT_EQ(b.lazyLoad(badExtension2), FAILN2);
+}
+
+TEST(GraphTest, LazyMalformed) {
+	const std::string malformedFile = "graphTestMalformed.graph";
+	std::ofstream out(malformedFile);
+	out << "Boston | Miami[3]\nMiami |\nBoston[2]\nHouston x[y]\n";
+	out.close();
+
+	// a line without a '|' is read as both key and edge list, however the
+	// file is loaded
+	WeightedDigraph a, b;
+	ASSERT_EQ(a.fileLoad(malformedFile), -3);
+	ASSERT_EQ(b.lazyLoad(malformedFile), SUCCESS);
+	EXPECT_EQ(b.materialize(), 1);
+	ASSERT_EQ(b.getVertexCount(), a.getVertexCount());
+	EXPECT_EQ(b.getEdgeCount(), a.getEdgeCount());
+	for(Offset i = 0; i < a.getVertexCount(); ++i) {
+		EXPECT_EQ(b.getKey(i), a.getKey(i));
+		for(Offset j = 0; j < a.getVertexCount(); ++j) {
+			EXPECT_EQ(b.getWeight(i, j), a.getWeight(i, j));
+		}
+	}
+	Weight w;
+	EXPECT_TRUE(b.getWeight("Boston[2]", "Boston", w));
+	EXPECT_EQ(w, 2);
+	std::remove(malformedFile.c_str());
+}
+
+/*
+ * Checks the reverse index of a against a column walk of its matrix.
+ */
+static void expectPredecessors(const WeightedDigraph& a) {
+	WeightedDigraph b(a);
+	b.setReverseIndex(false);
+	for(Offset i = 0; i < a.getVertexCount(); ++i) {
+		std::vector<Offset> p1, p2;
+		a.getPredecessors(i, p1);
+		b.getPredecessors(i, p2);
+		EXPECT_EQ(p1, p2);
+	}
+}
+
+TEST(GraphTest, Predecessors) {
+	WeightedDigraph a;
+	EXPECT_FALSE(a.hasReverseIndex());
+	ASSERT_EQ(a.fileLoad(goodFile), SUCCESS);
+	std::vector<Key> k;
+	ASSERT_TRUE(a.getPredecessors("Miami", k));
+	std::sort(k.begin(), k.end());
+	EXPECT_EQ(k, std::vector<Key>({"Los Angeles", "New York"}));
+	EXPECT_FALSE(a.getPredecessors("Denver", k));
+
+	// built in bulk, then kept up to date by every edit
+	a.setReverseIndex(true);
+	EXPECT_TRUE(a.hasReverseIndex());
+	expectPredecessors(a);
+	ASSERT_TRUE(a.addVertex("Denver"));
+	ASSERT_EQ(a.setEdge("Denver", "Miami", 2), SUCCESS);
+	ASSERT_EQ(a.setEdge("Miami", "Denver", 2), SUCCESS);
+	ASSERT_EQ(a.removeEdge("New York", "Miami"), SUCCESS);
+	expectPredecessors(a);
+	ASSERT_TRUE(a.removeVertex("Boston"));
+	expectPredecessors(a);
+	std::vector<Offset> order;
+	for(Offset i = a.getVertexCount(); i > 0; --i) {
+		order.push_back(i - 1);
+	}
+	ASSERT_EQ(a.permute(order), SUCCESS);
+	expectPredecessors(a);
+	std::vector<MemComponent> m;
+	a.memoryUsage(m);
+	ASSERT_EQ(m.size(), 6);
+	EXPECT_EQ(m[5].name, "reverse index");
+
+	// and by every kind of load
+	ASSERT_EQ(a.fileLoad(goodFile), SUCCESS);
+	expectPredecessors(a);
+	ASSERT_EQ(a.lazyLoad(goodFile), SUCCESS);
+	std::vector<Offset> p;
+	a.getPredecessors(a.getOffset("Boston"), p);
+	EXPECT_EQ(p.size(), 2);
+	EXPECT_EQ(a.getPendingCount(), 0);
+	expectPredecessors(a);
+	const std::string snapFile = "graphTest" + snapshotExt;
+	ASSERT_EQ(a.snapshotWrite(snapFile), SUCCESS);
+	a.clear();
+	EXPECT_TRUE(a.hasReverseIndex());
+	ASSERT_EQ(a.snapshotLoad(snapFile), SUCCESS);
+	expectPredecessors(a);
+	std::remove(snapFile.c_str());
+
+	a.setReverseIndex(false);
+	m.clear();
+	a.memoryUsage(m);
+	EXPECT_EQ(m.size(), 5);
+}
+
+/*
+ * Checks the degree counters of a against a count of its edges.
+ */
+static void expectDegrees(const WeightedDigraph& a) {
+	std::vector<Offset> in(a.getVertexCount(), 0);
+	std::vector<Offset> outHist, inHist;
+	size_t edges = 0;
+	for(Offset i = 0; i < a.getVertexCount(); ++i) {
+		std::vector<Offset> n;
+		a.getNeighbors(i, n);
+		EXPECT_EQ(a.getOutDegree(i), n.size());
+		edges += n.size();
+		for(size_t j = 0; j < n.size(); ++j) {
+			++in[n[j]];
+		}
+		if(n.size() >= outHist.size())
+			outHist.resize(n.size() + 1, 0);
+		++outHist[n.size()];
+	}
+	for(Offset i = 0; i < a.getVertexCount(); ++i) {
+		EXPECT_EQ(a.getInDegree(i), in[i]);
+		if(in[i] >= inHist.size())
+			inHist.resize(in[i] + 1, 0);
+		++inHist[in[i]];
+	}
+	EXPECT_EQ(a.getEdgeCount(), edges);
+	EXPECT_EQ(a.getDegreeHistogram(false), outHist);
+	EXPECT_EQ(a.getDegreeHistogram(true), inHist);
+}
+
+TEST(GraphTest, Degrees) {
+	WeightedDigraph a;
+	expectDegrees(a);
+	EXPECT_TRUE(a.getDegreeHistogram(false).empty());
+	ASSERT_EQ(a.fileLoad(goodFile), SUCCESS);
+	EXPECT_EQ(a.getEdgeCount(), 12);
+	EXPECT_EQ(a.getOutDegree(a.getOffset("New York")), 3);
+	EXPECT_EQ(a.getInDegree(a.getOffset("Boston")), 2);
+	EXPECT_EQ(a.getDegreeHistogram(false), std::vector<Offset>({1, 2, 2, 2}));
+	expectDegrees(a);
+
+	// every edit keeps them exact, self connections included
+	ASSERT_EQ(a.setEdge("Boston", "Miami", 1), SUCCESS);
+	ASSERT_EQ(a.setEdge("Boston", "Miami", 2), 1);
+	ASSERT_EQ(a.setEdge("Miami", "Miami", 2), SUCCESS);
+	ASSERT_EQ(a.removeEdge("New York", "Hartford"), SUCCESS);
+	ASSERT_TRUE(a.addVertex("Denver"));
+	expectDegrees(a);
+	ASSERT_TRUE(a.removeVertex("Miami"));
+	expectDegrees(a);
+	std::vector<Offset> order;
+	for(Offset i = a.getVertexCount(); i > 0; --i) {
+		order.push_back(i - 1);
+	}
+	ASSERT_EQ(a.permute(order), SUCCESS);
+	expectDegrees(a);
+
+	// and every kind of load rebuilds them
+	ASSERT_EQ(a.lazyLoad(goodFile), SUCCESS);
+	EXPECT_EQ(a.getOutDegree(a.getOffset("New York")), 3);
+	EXPECT_EQ(a.getEdgeCount(), 12);
+	expectDegrees(a);
+	const std::string snapFile = "graphTest" + snapshotExt;
+	ASSERT_EQ(a.snapshotWrite(snapFile), SUCCESS);
+	ASSERT_EQ(a.snapshotLoad(snapFile), SUCCESS);
+	expectDegrees(a);
+	std::remove(snapFile.c_str());
+	a.clear();
+	expectDegrees(a);
+}
+
 int main(int argc, char** argv) {
 	::testing::InitGoogleTest(&argc, argv);
 	return RUN_ALL_TESTS();
@@ -0,0 +1,180 @@
+#include <iostream>
+#include <fstream>
+#include <random>
+#include <cstdio>
+
+#include "Graph.h"
+#include "CSR.h"
+#include "Hops.h"
+#include "Parallel.h"
+#include "testGraphs.h"
+#include "gtest/gtest.h"
+
+#define RANDOM_VERTICES 2000
+
+const std::string queryFile = "hopsTestQueries.txt";
+
+/*
+ * HopsTest
+ *
+ * Performs the following tests on the hop procedures.
+ *     -TestGraph
+ *     -Reference
+ *     -MaxHops
+ *     -Threads
+ *     -ReadQueries
+ */
+
+/*
+ * Random queries over few enough sources that many share one, with some
+ * repeated outright.
+ */
+static void randomQueries(std::vector<HopQuery>& q, Offset n, size_t count,
+		Offset sources, unsigned seed) {
+	std::mt19937 rng(seed);
+	q.clear();
+	for(size_t i = 0; i < count; ++i) {
+		HopQuery h = {(Offset)(rng() % sources * (n / sources)),
+			(Offset)(rng() % n)};
+		q.push_back(h);
+		if(i % 10 == 0)
+			q.push_back(h);
+	}
+}
+
+/*
+ * The answers to queries from one breadth-first search per query, to check
+ * against.
+ */
+static std::vector<Offset> reference(const CSRGraph& g,
+		const std::vector<HopQuery>& q, Offset maxHops) {
+	std::vector<Offset> hops;
+	for(size_t i = 0; i < q.size(); ++i) {
+		std::vector<Offset> dist(g.getVertexCount(), unreachedHops);
+		std::vector<Offset> queue(1, q[i].source);
+		dist[q[i].source] = 0;
+		for(size_t j = 0; j < queue.size(); ++j) {
+			Offset v = queue[j];
+			for(size_t e = g.offsets[v]; e < g.offsets[v+1]; ++e) {
+				if(dist[g.targets[e]] == unreachedHops && dist[v] < maxHops) {
+					dist[g.targets[e]] = dist[v] + 1;
+					queue.push_back(g.targets[e]);
+				}
+			}
+		}
+		hops.push_back(dist[q[i].target]);
+	}
+	return hops;
+}
+
+TEST(HopsTest, TestGraph) {
+	WeightedDigraph a;
+	CSRGraph c;
+	std::vector<Offset> hops;
+	ASSERT_EQ(a.fileLoad(goodFile), 0);
+	buildCSR(a, c);
+	Offset boston = a.getOffset("Boston");
+	Offset hartford = a.getOffset("Hartford");
+	Offset houston = a.getOffset("Houston");
+	std::vector<HopQuery> q = {{boston, hartford}, {hartford, boston},
+		{boston, boston}, {houston, boston}, {boston, houston}};
+	hopDistances(c, q, HopOptions(), hops);
+	ASSERT_EQ(hops.size(), 5);
+	EXPECT_EQ(hops[0], 2);
+	EXPECT_EQ(hops[1], unreachedHops);
+	EXPECT_EQ(hops[2], 0);
+
+	// Houston -> Los Angeles -> Miami -> Boston
+	EXPECT_EQ(hops[3], 3);
+	EXPECT_EQ(hops[4], 2);
+}
+
+TEST(HopsTest, Reference) {
+	CSRGraph c;
+	std::vector<HopQuery> q;
+	std::vector<Offset> hops;
+	HopOptions o;
+
+	// sparse enough to leave some targets unreached, and more sources than
+	// the widest batch
+	randomCSR(c, RANDOM_VERTICES, RANDOM_VERTICES * 2, 1);
+	randomQueries(q, RANDOM_VERTICES, 3000, 1000, 2);
+	std::vector<Offset> expected = reference(c, q, unreachedHops);
+	unsigned batches[] = {1, 63, 64, 100, 256, 512, 4096};
+	for(unsigned b : batches) {
+		o.batch = b;
+		hopDistances(c, q, o, hops);
+		EXPECT_EQ(hops, expected) << "batch " << b;
+	}
+
+	hopDistances(c, std::vector<HopQuery>(), o, hops);
+	EXPECT_TRUE(hops.empty());
+}
+
+TEST(HopsTest, MaxHops) {
+	CSRGraph c;
+	std::vector<HopQuery> q;
+	std::vector<Offset> hops;
+	HopOptions o;
+	randomCSR(c, RANDOM_VERTICES, RANDOM_VERTICES * 3, 3);
+	randomQueries(q, RANDOM_VERTICES, 2000, 300, 4);
+	for(Offset k = 0; k < 4; ++k) {
+		o.maxHops = k;
+		hopDistances(c, q, o, hops);
+		std::vector<Offset> expected = reference(c, q, k);
+		EXPECT_EQ(hops, expected) << "max hops " << k;
+		for(size_t i = 0; i < hops.size(); ++i) {
+			EXPECT_TRUE(hops[i] <= k || hops[i] == unreachedHops);
+		}
+	}
+}
+
+TEST(HopsTest, Threads) {
+	CSRGraph c;
+	std::vector<HopQuery> q;
+	std::vector<Offset> one, many;
+	HopOptions o;
+	randomCSR(c, RANDOM_VERTICES * 5, RANDOM_VERTICES * 20, 5);
+	randomQueries(q, RANDOM_VERTICES * 5, 1000, 500, 6);
+	o.batch = 512;
+	setParallelThreads(1);
+	hopDistances(c, q, o, one);
+	setParallelThreads(4);
+	hopDistances(c, q, o, many);
+	setParallelThreads(0);
+	EXPECT_EQ(one, many);
+	EXPECT_EQ(one, reference(c, q, unreachedHops));
+}
+
+TEST(HopsTest, ReadQueries) {
+	WeightedDigraph a;
+	std::vector<HopQuery> q;
+	ASSERT_EQ(a.fileLoad(goodFile), 0);
+
+	std::ofstream out(queryFile);
+	out << "Boston,Hartford\n\n  New York , Houston\r\nHartford,Hartford\n";
+	out.close();
+	ASSERT_EQ(readHopQueries(a, queryFile, q), 0);
+	ASSERT_EQ(q.size(), 3);
+	EXPECT_EQ(q[0].source, a.getOffset("Boston"));
+	EXPECT_EQ(q[0].target, a.getOffset("Hartford"));
+	EXPECT_EQ(q[1].source, a.getOffset("New York"));
+	EXPECT_EQ(q[1].target, a.getOffset("Houston"));
+	EXPECT_EQ(q[2].source, q[2].target);
+
+	out.open(queryFile);
+	out << "Boston,Hartford\nBoston,Denver\n";
+	out.close();
+	EXPECT_EQ(readHopQueries(a, queryFile, q), -2);
+	out.open(queryFile);
+	out << "Boston Hartford\n";
+	out.close();
+	EXPECT_EQ(readHopQueries(a, queryFile, q), -2);
+	std::remove(queryFile.c_str());
+	EXPECT_EQ(readHopQueries(a, queryFile, q), -1);
+}
+
+int main(int argc, char** argv) {
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
@@ -0,0 +1,277 @@
+#include <iostream>
+#include <fstream>
+#include <iterator>
+#include <cstdio>
+
+#include "Graph.h"
+#include "Journal.h"
+#include "gtest/gtest.h"
+
+const std::string goodFile = "../graphFiles/test.graph";
+const std::string baseFile = "journalTest.graph";
+const std::string walFile = baseFile + journalExt;
+
+/*
+ * JournalTest
+ *
+ * Performs the following tests on write-ahead journals.
+ *     -Replay
+ *     -Checkpoint
+ *     -TornRecord
+ *     -StaleJournal
+ *     -Errors
+ *     -WideWeights
+ */
+
+static std::string slurp(const std::string& file) {
+	std::ifstream in(file, std::ios::binary);
+	return std::string(std::istreambuf_iterator<char>(in),
+			std::istreambuf_iterator<char>());
+}
+
+/*
+ * Starts every test from a copy of test.graph with no journal.
+ */
+static void freshBase() {
+	std::ofstream out(baseFile, std::ios::binary);
+	out << slurp(goodFile);
+	out.close();
+	std::remove(walFile.c_str());
+}
+
+static void cleanUp() {
+	std::remove(baseFile.c_str());
+	std::remove(walFile.c_str());
+}
+
+/*
+ * Checks that two graphs hold the same vertices and edges, whatever their
+ * offsets.
+ */
+static void expectSameGraph(const WeightedDigraph& a, const WeightedDigraph& b) {
+	ASSERT_EQ(a.getVertexCount(), b.getVertexCount());
+	std::vector<Offset> n;
+	for(Offset v = 0; v < a.getVertexCount(); ++v) {
+		const Key& k = a.getKey(v);
+		ASSERT_NE(b.getOffset(k), -1);
+		n.clear();
+		a.getNeighbors(v, n);
+		std::vector<Key> bn;
+		ASSERT_TRUE(b.getNeighbors(k, bn));
+		ASSERT_EQ(bn.size(), n.size());
+		for(size_t i = 0; i < n.size(); ++i) {
+			EXPECT_EQ(b.getWeight(b.getOffset(k), b.getOffset(a.getKey(n[i]))),
+					a.getWeight(v, n[i]));
+		}
+	}
+}
+
+/*
+ * Applies a few edits to g, logging each.
+ */
+static void edit(WeightedDigraph& g, Journal& j) {
+	ASSERT_TRUE(g.addVertex("Atlanta"));
+	j.logAddVertex("Atlanta");
+	ASSERT_EQ(g.setEdge("Atlanta", "Boston", 7), 0);
+	j.logSetEdge("Atlanta", "Boston", 7);
+	ASSERT_EQ(g.setEdge("Boston", "New York", -3), 1);
+	j.logSetEdge("Boston", "New York", -3);
+	ASSERT_EQ(g.removeEdge("Miami", "Boston"), 0);
+	j.logRemoveEdge("Miami", "Boston");
+	ASSERT_TRUE(g.removeVertex("Hartford"));
+	j.logRemoveVertex("Hartford");
+}
+
+TEST(JournalTest, Replay) {
+	freshBase();
+	WeightedDigraph a, b;
+	Journal j;
+	size_t replayed;
+	ASSERT_EQ(loadJournaled(baseFile, a, replayed), 0);
+	EXPECT_EQ(replayed, 0);
+	ASSERT_EQ(j.open(baseFile, SYNC_ALWAYS), 0);
+	edit(a, j);
+
+	// nothing reaches the journal before a commit
+	ASSERT_EQ(loadJournaled(baseFile, b, replayed), 0);
+	EXPECT_EQ(replayed, 0);
+	ASSERT_EQ(j.commit(), 0);
+	EXPECT_EQ(j.getRecordCount(), 5);
+	ASSERT_EQ(loadJournaled(baseFile, b, replayed), 0);
+	EXPECT_EQ(replayed, 5);
+	expectSameGraph(a, b);
+
+	// the base is untouched, and the journal grows with the edit alone
+	EXPECT_EQ(slurp(baseFile), slurp(goodFile));
+	size_t before = j.getByteCount();
+	ASSERT_EQ(a.setEdge("Atlanta", "Miami", 2), 0);
+	j.logSetEdge("Atlanta", "Miami", 2);
+	ASSERT_EQ(j.commit(), 0);
+	EXPECT_LT(j.getByteCount() - before, 32);
+
+	// reopening appends to the same journal
+	j.close();
+	ASSERT_EQ(j.open(baseFile, SYNC_NEVER), 0);
+	EXPECT_EQ(j.getRecordCount(), 6);
+	ASSERT_EQ(a.removeEdge("Atlanta", "Miami"), 0);
+	j.logRemoveEdge("Atlanta", "Miami");
+	j.close();
+	ASSERT_EQ(loadJournaled(baseFile, b, replayed), 0);
+	EXPECT_EQ(replayed, 7);
+	expectSameGraph(a, b);
+	cleanUp();
+}
+
+TEST(JournalTest, Checkpoint) {
+	freshBase();
+	WeightedDigraph a, b;
+	Journal j;
+	size_t replayed;
+	ASSERT_EQ(loadJournaled(baseFile, a, replayed), 0);
+	ASSERT_EQ(j.open(baseFile, SYNC_INTERVAL), 0);
+	size_t empty = j.getByteCount();
+	edit(a, j);
+	EXPECT_FALSE(j.needsCheckpoint());
+
+	// the edits move into the base and the journal starts over
+	ASSERT_EQ(j.checkpoint(a), 0);
+	EXPECT_EQ(j.getRecordCount(), 0);
+	EXPECT_EQ(j.getByteCount(), empty);
+	EXPECT_EQ(slurp(walFile).size(), empty);
+	ASSERT_EQ(b.fileLoad(baseFile), 0);
+	expectSameGraph(a, b);
+	ASSERT_EQ(loadJournaled(baseFile, b, replayed), 0);
+	EXPECT_EQ(replayed, 0);
+
+	// edits after the checkpoint are journaled against the new base
+	ASSERT_TRUE(a.addVertex("Denver"));
+	j.logAddVertex("Denver");
+	ASSERT_EQ(j.commit(), 0);
+	ASSERT_EQ(loadJournaled(baseFile, b, replayed), 0);
+	EXPECT_EQ(replayed, 1);
+	expectSameGraph(a, b);
+
+	// a journal larger than its base is due for a checkpoint
+	Key big(4096, 'x');
+	for(int i = 0; i < 300; ++i) {
+		j.logAddVertex(big);
+		j.logRemoveVertex(big);
+	}
+	EXPECT_TRUE(j.needsCheckpoint());
+	j.close();
+	cleanUp();
+}
+
+TEST(JournalTest, TornRecord) {
+	freshBase();
+	WeightedDigraph a, b;
+	Journal j;
+	size_t replayed;
+	ASSERT_EQ(loadJournaled(baseFile, a, replayed), 0);
+	ASSERT_EQ(j.open(baseFile, SYNC_ALWAYS), 0);
+	edit(a, j);
+	j.close();
+
+	// a crash mid-append leaves part of a record behind
+	std::string wal = slurp(walFile);
+	{
+		std::ofstream out(walFile, std::ios::binary | std::ios::app);
+		out << wal.substr(wal.size() - 20, 11);
+	}
+	ASSERT_EQ(loadJournaled(baseFile, b, replayed), 0);
+	EXPECT_EQ(replayed, 5);
+	expectSameGraph(a, b);
+
+	// reopening cuts it off, so later records follow the intact ones
+	ASSERT_EQ(j.open(baseFile, SYNC_ALWAYS), 0);
+	EXPECT_EQ(j.getByteCount(), wal.size());
+	ASSERT_TRUE(a.addVertex("Denver"));
+	j.logAddVertex("Denver");
+	j.close();
+	ASSERT_EQ(loadJournaled(baseFile, b, replayed), 0);
+	EXPECT_EQ(replayed, 6);
+	expectSameGraph(a, b);
+
+	// a corrupt record ends replay
+	wal = slurp(walFile);
+	wal[wal.size() - 3] ^= 1;
+	{
+		std::ofstream out(walFile, std::ios::binary);
+		out << wal;
+	}
+	ASSERT_EQ(loadJournaled(baseFile, b, replayed), 0);
+	EXPECT_EQ(replayed, 5);
+	cleanUp();
+}
+
+TEST(JournalTest, StaleJournal) {
+	freshBase();
+	WeightedDigraph a, b;
+	Journal j;
+	size_t replayed;
+	ASSERT_EQ(loadJournaled(baseFile, a, replayed), 0);
+	ASSERT_EQ(j.open(baseFile, SYNC_ALWAYS), 0);
+	edit(a, j);
+	j.close();
+
+	// a checkpoint that crashed after replacing the base leaves the old
+	// journal, which must not be replayed twice
+	ASSERT_EQ(a.fileWrite(baseFile), 0);
+	ASSERT_EQ(loadJournaled(baseFile, b, replayed), 0);
+	EXPECT_EQ(replayed, 0);
+	expectSameGraph(a, b);
+
+	// and opening replaces it
+	ASSERT_EQ(j.open(baseFile, SYNC_ALWAYS), 0);
+	EXPECT_EQ(j.getRecordCount(), 0);
+	j.close();
+	cleanUp();
+}
+
+TEST(JournalTest, Errors) {
+	SyncPolicy p;
+	EXPECT_EQ(parseSyncPolicy("always", p), 0);
+	EXPECT_EQ(p, SYNC_ALWAYS);
+	EXPECT_EQ(parseSyncPolicy("interval", p), 0);
+	EXPECT_EQ(p, SYNC_INTERVAL);
+	EXPECT_EQ(parseSyncPolicy("never", p), 0);
+	EXPECT_EQ(p, SYNC_NEVER);
+	EXPECT_EQ(parseSyncPolicy("sometimes", p), -1);
+
+	Journal j;
+	WeightedDigraph a;
+	size_t replayed;
+	EXPECT_EQ(j.open("../graphFiles/badExtension.wumbo", SYNC_ALWAYS), -2);
+	EXPECT_EQ(j.open("missing.graph", SYNC_ALWAYS), -1);
+	EXPECT_FALSE(j.isOpen());
+	EXPECT_EQ(j.commit(), 0);
+	EXPECT_EQ(j.checkpoint(a), -1);
+	EXPECT_EQ(loadJournaled("missing.graph", a, replayed), -1);
+	EXPECT_EQ(loadJournaled("../graphFiles/badExtension.wumbo", a, replayed), -2);
+	EXPECT_EQ(replayed, 0);
+}
+
+TEST(JournalTest, WideWeights) {
+	WeightedDigraph a;
+	size_t replayed;
+
+	// weights of aggregate.graph overflow Weight, so it would lose edges
+	ASSERT_EQ(loadJournaled(goodFile, a, replayed), 0);
+	EXPECT_EQ(loadJournaled("../graphFiles/aggregate.graph", a, replayed), -4);
+	EXPECT_EQ(a.getVertexCount(), 0);
+
+	// malformed weights are still skipped
+	std::ofstream out(baseFile);
+	out << "Boston | New York[19] Miami[far]\nNew York |\nMiami |\n";
+	out.close();
+	std::remove(walFile.c_str());
+	EXPECT_EQ(loadJournaled(baseFile, a, replayed), -3);
+	EXPECT_EQ(a.getVertexCount(), 3);
+	EXPECT_EQ(a.getEdgeCount(), 1);
+	cleanUp();
+}
+
+int main(int argc, char** argv) {
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
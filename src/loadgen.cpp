@@ -0,0 +1,221 @@
+#include "server.h"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <thread>
+#include <random>
+#include <chrono>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+/*
+ * Local load generator for the query daemon.
+ *
+ * Opens a number of connections to the daemon, and on each one sends batches
+ * of pipelined requests drawn from the vertex keys of a .graph file. The
+ * latency of a request is measured from the moment its batch is sent until
+ * its response arrives. Reports throughput and latency percentiles once every
+ * connection has finished.
+ *
+ * usage: loadgen [-c connections] [-n requests] [-d depth] [-w write%]
+ *                [-p path%] [-s seed] <socket_path> <graph_file>
+ *
+ *    -c, number of concurrent connections (default 4)
+ *    -n, number of requests sent on each connection (default 100000)
+ *    -d, number of requests pipelined per batch (default 16)
+ *    -w, percentage of requests that are setEdge writes (default 0)
+ *    -p, percentage of requests that are bfs path queries (default 1)
+ *    -s, random seed (default 1)
+ *
+ * The remaining requests are split evenly between edge lookups and neighbor
+ * queries.
+ */
+
+typedef std::chrono::steady_clock Clock;
+
+struct Options {
+	unsigned connections;
+	unsigned long requests;
+	unsigned depth;
+	unsigned writePct;
+	unsigned pathPct;
+	unsigned seed;
+};
+
+const std::string loadgenUsage("usage: loadgen [-c connections] [-n requests] [-d depth] [-w write%] [-p path%] [-s seed] <socket_path> <graph_file>");
+
+/*
+ * Reads the vertex keys of a .graph file without building the graph.
+ */
+static bool readKeys(const std::string& file, std::vector<Key>& keys) {
+	std::ifstream inFile(file);
+	if(!inFile.is_open())
+		return false;
+	std::string line;
+	while(std::getline(inFile, line)) {
+		Key k = trim(line.substr(0, line.find_first_of('|')));
+		if(!k.empty())
+			keys.push_back(k);
+	}
+	return !keys.empty();
+}
+
+static int connectTo(const std::string& path) {
+	struct sockaddr_un addr;
+	std::memset(&addr, 0, sizeof(addr));
+	addr.sun_family = AF_UNIX;
+	std::strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+	int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+	if(fd == -1)
+		return -1;
+	if(connect(fd, (struct sockaddr*)&addr, sizeof(addr)) == -1) {
+		close(fd);
+		return -1;
+	}
+	return fd;
+}
+
+/*
+ * Drives a single connection, recording the latency of every request in
+ * nanoseconds.
+ *
+ * @return false if the connection failed
+ */
+static bool drive(const std::string& path, const std::vector<Key>& keys,
+		const Options& opt, unsigned id, std::vector<long long>& lat) {
+	int fd = connectTo(path);
+	if(fd == -1)
+		return false;
+	std::mt19937 rng(opt.seed * 7919 + id);
+	std::uniform_int_distribution<size_t> pick(0, keys.size() - 1);
+	std::uniform_int_distribution<unsigned> pct(0, 99);
+	std::uniform_int_distribution<int> weight(1, 100);
+	std::string batch;
+	std::string in;
+	char buf[65536];
+	unsigned long sent = 0;
+	while(sent < opt.requests) {
+		unsigned n = std::min<unsigned long>(opt.depth, opt.requests - sent);
+		batch.clear();
+		for(unsigned i = 0; i < n; ++i) {
+			unsigned r = pct(rng);
+			const Key& k1 = keys[pick(rng)];
+			const Key& k2 = keys[pick(rng)];
+			if(r < opt.writePct)
+				batch += std::string(1, setEdgeReq) + fieldSep + k1 + fieldSep + k2 +
+					fieldSep + std::to_string(weight(rng));
+			else if(r < opt.writePct + opt.pathPct)
+				batch += std::string(1, pathReq) + fieldSep + bfsAlgo + fieldSep +
+					k1 + fieldSep + k2;
+			else if(r % 2)
+				batch += std::string(1, edgeReq) + fieldSep + k1 + fieldSep + k2;
+			else
+				batch += std::string(1, neighborReq) + fieldSep + k1;
+			batch += recordSep;
+		}
+		Clock::time_point start = Clock::now();
+		size_t off = 0;
+		while(off < batch.size()) {
+			ssize_t w = write(fd, batch.data() + off, batch.size() - off);
+			if(w == -1 && errno != EINTR) {
+				close(fd);
+				return false;
+			}
+			if(w > 0)
+				off += w;
+		}
+		unsigned received = 0;
+		while(received < n) {
+			size_t pos;
+			while(received < n && (pos = in.find(recordSep)) != std::string::npos) {
+				in.erase(0, pos + 1);
+				lat.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(
+						Clock::now() - start).count());
+				++received;
+			}
+			if(received == n)
+				break;
+			ssize_t r = read(fd, buf, sizeof(buf));
+			if(r == 0 || (r == -1 && errno != EINTR)) {
+				close(fd);
+				return false;
+			}
+			if(r > 0)
+				in.append(buf, r);
+		}
+		sent += n;
+	}
+	close(fd);
+	return true;
+}
+
+int main(int argc, char** argv) {
+	Options opt = {4, 100000, 16, 0, 1, 1};
+	int c;
+	while((c = getopt(argc, argv, "c:n:d:w:p:s:")) != -1) {
+		switch(c) {
+			case 'c': opt.connections = std::atoi(optarg); break;
+			case 'n': opt.requests = std::atol(optarg); break;
+			case 'd': opt.depth = std::atoi(optarg); break;
+			case 'w': opt.writePct = std::atoi(optarg); break;
+			case 'p': opt.pathPct = std::atoi(optarg); break;
+			case 's': opt.seed = std::atoi(optarg); break;
+			default:
+				std::cerr << loadgenUsage << std::endl;
+				return 1;
+		}
+	}
+	if(argc - optind != 2 || opt.connections == 0 || opt.depth == 0 ||
+			opt.writePct + opt.pathPct > 100) {
+		std::cerr << loadgenUsage << std::endl;
+		return 1;
+	}
+	std::string path(argv[optind]);
+	std::vector<Key> keys;
+	if(!readKeys(argv[optind+1], keys)) {
+		std::cerr << "Unable to read vertex keys: " << argv[optind+1] << std::endl;
+		return 1;
+	}
+
+	std::vector<std::vector<long long>> lat(opt.connections);
+	std::vector<char> ok(opt.connections, 0);
+	std::vector<std::thread> threads;
+	Clock::time_point start = Clock::now();
+	for(unsigned i = 0; i < opt.connections; ++i) {
+		lat[i].reserve(opt.requests);
+		threads.push_back(std::thread([&, i]{
+			ok[i] = drive(path, keys, opt, i, lat[i]);
+		}));
+	}
+	for(size_t i = 0; i < threads.size(); ++i) {
+		threads[i].join();
+	}
+	double secs = std::chrono::duration<double>(Clock::now() - start).count();
+
+	std::vector<long long> all;
+	for(unsigned i = 0; i < opt.connections; ++i) {
+		if(!ok[i])
+			std::cerr << "Connection " << i << " failed" << std::endl;
+		all.insert(all.end(), lat[i].begin(), lat[i].end());
+	}
+	if(all.empty())
+		return 1;
+	std::sort(all.begin(), all.end());
+	auto pctl = [&](double p) {
+		return all[std::min<size_t>(all.size() - 1, p * all.size())] / 1000.0;
+	};
+	std::cout << "requests:    " << all.size() << std::endl
+		<< "seconds:     " << secs << std::endl
+		<< "throughput:  " << (long long)(all.size() / secs) << " req/s" << std::endl
+		<< "latency p50: " << pctl(0.50) << " us" << std::endl
+		<< "latency p90: " << pctl(0.90) << " us" << std::endl
+		<< "latency p99: " << pctl(0.99) << " us" << std::endl
+		<< "latency max: " << all.back() / 1000.0 << " us" << std::endl;
+	return 0;
+}
@@ -0,0 +1,232 @@
+#include <iostream>
+#include <fstream>
+#include <iterator>
+#include <random>
+#include <cstdio>
+
+#include "Graph.h"
+#include "CSR.h"
+#include "Search.h"
+#include "Mapped.h"
+#include "gtest/gtest.h"
+
+#define RANDOM_VERTICES 20000
+
+const std::string goodFile = "../graphFiles/test.graph";
+const std::string mappedFile = "mappedTest.mgraph";
+const std::string convertedFile = "mappedConverted.mgraph";
+
+/*
+ * MappedTest
+ *
+ * Performs the following tests on memory-mapped graphs.
+ *     -Queries
+ *     -Convert
+ *     -Search
+ *     -Errors
+ *     -RandomGraph
+ */
+
+/*
+ * Reads a whole file into a string.
+ */
+static std::string slurp(const std::string& file) {
+	std::ifstream in(file, std::ios::binary);
+	return std::string(std::istreambuf_iterator<char>(in),
+			std::istreambuf_iterator<char>());
+}
+
+/*
+ * Checks that every key, row and weight of m matches g.
+ */
+static void expectSameGraph(const WeightedDigraph& g, const MappedGraph& m) {
+	ASSERT_EQ(m.getVertexCount(), g.getVertexCount());
+	std::vector<Offset> a, b;
+	size_t edges = 0;
+	for(Offset v = 0; v < g.getVertexCount(); ++v) {
+		ASSERT_EQ(m.getKey(v), g.getKey(v));
+		ASSERT_EQ(m.getOffset(g.getKey(v)), (int)v);
+		a.clear();
+		b.clear();
+		g.getNeighbors(v, a);
+		m.getNeighbors(v, b);
+		ASSERT_EQ(a, b);
+		edges += a.size();
+		for(size_t i = 0; i < a.size(); ++i) {
+			ASSERT_EQ(m.getWeight(v, a[i]), g.getWeight(v, a[i]));
+		}
+	}
+	EXPECT_EQ(m.getEdgeCount(), edges);
+}
+
+TEST(MappedTest, Queries) {
+	WeightedDigraph a;
+	ASSERT_EQ(a.fileLoad(goodFile), 0);
+	ASSERT_EQ(writeMapped(a, mappedFile), 0);
+	MappedGraph m;
+	ASSERT_EQ(m.open(mappedFile), 0);
+	expectSameGraph(a, m);
+
+	// queries by key behave as they do on the loaded graph
+	std::vector<Key> n;
+	Weight w;
+	EXPECT_TRUE(m.getNeighbors("Hartford", n));
+	EXPECT_TRUE(n.empty());
+	EXPECT_FALSE(m.getNeighbors("Atlanta", n));
+	EXPECT_TRUE(m.getWeight("Boston", "New York", w));
+	EXPECT_EQ(w, 19);
+	EXPECT_FALSE(m.getWeight("New York", "Boston", w));
+	EXPECT_FALSE(m.isEdge("Boston", "Atlanta"));
+	EXPECT_TRUE(m.isEdge("Houston", "Los Angeles"));
+	EXPECT_EQ(m.getOffset("Atlanta"), -1);
+
+	// only the key index is resident
+	std::vector<MemComponent> mem;
+	m.memoryUsage(mem);
+	ASSERT_EQ(mem.size(), 2);
+	EXPECT_EQ(mem[1].live, slurp(mappedFile).size());
+
+	m.close();
+	EXPECT_TRUE(m.isEmpty());
+	EXPECT_EQ(m.getOffset("Boston"), -1);
+	std::remove(mappedFile.c_str());
+}
+
+TEST(MappedTest, Convert) {
+	// streaming conversion writes the same file as loading and writing
+	WeightedDigraph a;
+	ASSERT_EQ(a.fileLoad(goodFile), 0);
+	ASSERT_EQ(writeMapped(a, mappedFile), 0);
+	ASSERT_EQ(convertToMapped(goodFile, convertedFile), 0);
+	EXPECT_EQ(slurp(mappedFile), slurp(convertedFile));
+
+	// including the edges fileLoad skips
+	WeightedDigraph b;
+	ASSERT_EQ(b.fileLoad("../graphFiles/aggregate.graph"), -3);
+	ASSERT_EQ(writeMapped(b, mappedFile), 0);
+	ASSERT_EQ(convertToMapped("../graphFiles/aggregate.graph", convertedFile), 0);
+	EXPECT_EQ(slurp(mappedFile), slurp(convertedFile));
+	MappedGraph m;
+	ASSERT_EQ(m.open(convertedFile), 0);
+	expectSameGraph(b, m);
+	std::remove(mappedFile.c_str());
+	std::remove(convertedFile.c_str());
+}
+
+TEST(MappedTest, Search) {
+	WeightedDigraph a;
+	ASSERT_EQ(a.fileLoad(goodFile), 0);
+	ASSERT_EQ(writeMapped(a, mappedFile), 0);
+	MappedGraph m;
+	ASSERT_EQ(m.open(mappedFile), 0);
+	Path p, q;
+	std::vector<Key> k;
+	for(Offset s = 0; s < a.getVertexCount(); ++s) {
+		for(Offset t = 0; t < a.getVertexCount(); ++t) {
+			bool found = bfs(a, s, t, p);
+			ASSERT_EQ(bfs(m, s, t, q), found);
+			if(found) {
+				EXPECT_EQ(p.vertices, q.vertices);
+			}
+			ASSERT_EQ(ucs(a, s, t, p), found);
+			ASSERT_EQ(ucs(m, s, t, q), found);
+			if(found) {
+				EXPECT_EQ(p.cost, q.cost);
+			}
+			ASSERT_EQ(iddfs(m, s, t, q), found);
+		}
+	}
+
+	// Boston -> New York -> Miami -> San Francisco costs 38
+	ASSERT_TRUE(ucs(m, m.getOffset("Boston"), m.getOffset("San Francisco"), p));
+	EXPECT_EQ(p.cost, 38);
+	pathKeys(m, p, k);
+	ASSERT_EQ(k.size(), 4);
+	EXPECT_EQ(k[1], "New York");
+	std::remove(mappedFile.c_str());
+}
+
+TEST(MappedTest, Errors) {
+	WeightedDigraph a;
+	MappedGraph m;
+	ASSERT_EQ(a.fileLoad(goodFile), 0);
+	EXPECT_EQ(writeMapped(a, "mappedTest.graph"), -2);
+	EXPECT_EQ(writeMapped(a, "noDirectory/mappedTest.mgraph"), -1);
+	EXPECT_EQ(convertToMapped(goodFile, "mappedTest.graph"), -2);
+	EXPECT_EQ(convertToMapped("../graphFiles/badExtension.wumbo", mappedFile), -2);
+	EXPECT_EQ(convertToMapped("missing.graph", mappedFile), -1);
+	EXPECT_EQ(m.open("missing.mgraph"), -1);
+	EXPECT_EQ(m.open(goodFile), -2);
+
+	// a .graph file renamed is not a mapped graph
+	{
+		std::ofstream out(mappedFile);
+		out << slurp(goodFile);
+	}
+	EXPECT_EQ(m.open(mappedFile), -3);
+
+	// nor is a mapped graph cut short
+	ASSERT_EQ(writeMapped(a, mappedFile), 0);
+	std::string bytes = slurp(mappedFile);
+	{
+		std::ofstream out(mappedFile, std::ios::binary);
+		out << bytes.substr(0, bytes.size() - 1);
+	}
+	EXPECT_EQ(m.open(mappedFile), -3);
+	EXPECT_TRUE(m.isEmpty());
+
+	// duplicate keys cannot be numbered
+	{
+		std::ofstream out("mappedDuplicate.graph");
+		out << "A | B [1]\nB | A [2]\nA | B [3]\n";
+	}
+	EXPECT_EQ(convertToMapped("mappedDuplicate.graph", mappedFile), -3);
+	std::remove("mappedDuplicate.graph");
+	std::remove(mappedFile.c_str());
+}
+
+TEST(MappedTest, RandomGraph) {
+	std::mt19937 rng(5);
+	std::vector<Offset> src, dst;
+	std::vector<Weight> w;
+	for(size_t i = 0; i < RANDOM_VERTICES * 6; ++i) {
+		src.push_back(rng() % RANDOM_VERTICES);
+		dst.push_back(rng() % RANDOM_VERTICES);
+		w.push_back(1 + rng() % 100);
+	}
+	CSRGraph c;
+	std::vector<Key> keys;
+	buildCSR(RANDOM_VERTICES, src, dst, w, c);
+	for(Offset v = 0; v < RANDOM_VERTICES; ++v) {
+		keys.push_back("v" + std::to_string(v));
+	}
+	ASSERT_EQ(writeMapped(c, keys, mappedFile), 0);
+	MappedGraph m;
+	ASSERT_EQ(m.open(mappedFile), 0);
+	ASSERT_EQ(m.getEdgeCount(), c.getEdgeCount());
+	std::vector<Offset> n;
+	for(Offset v = 0; v < RANDOM_VERTICES; ++v) {
+		ASSERT_EQ(m.getOffset(keys[v]), (int)v);
+		n.clear();
+		m.getNeighbors(v, n);
+		ASSERT_EQ(n.size(), c.getDegree(v));
+		for(size_t i = 0; i < n.size(); ++i) {
+			ASSERT_EQ(n[i], c.targets[c.offsets[v] + i]);
+
+			// of duplicate edges, the first is found
+			if(i == 0 || n[i-1] != n[i]) {
+				ASSERT_EQ(m.getWeight(v, n[i]), c.weights[c.offsets[v] + i]);
+			}
+		}
+	}
+
+	// reopening replaces the graph
+	ASSERT_EQ(m.open(mappedFile), 0);
+	EXPECT_EQ(m.getVertexCount(), RANDOM_VERTICES);
+	std::remove(mappedFile.c_str());
+}
+
+int main(int argc, char** argv) {
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
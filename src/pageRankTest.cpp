@@ -0,0 +1,245 @@
+#include <iostream>
+#include <fstream>
+#include <random>
+#include <cmath>
+
+#include "Graph.h"
+#include "CSR.h"
+#include "PageRank.h"
+#include "Parallel.h"
+#include "gtest/gtest.h"
+
+#define RANDOM_VERTICES 20000
+
+const std::string goodFile = "../graphFiles/test.graph";
+const std::string rankFile = "rankTest.txt";
+
+/*
+ * PageRankTest
+ *
+ * Performs the following tests on the ranking procedures.
+ *     -Cycle
+ *     -Reference
+ *     -Threads
+ *     -Personalized
+ *     -Local
+ *     -Write
+ */
+
+/*
+ * Graph should look as follows after loading from test.graph.
+ *
+ * Boston --> New York[19], Los Angeles[4]
+ * New York --> Miami[10], Houston[28], Hartford[12]
+ * Miami --> Boston[4], San Francisco[9]
+ * San Francisco --> Boston[20], New York[6], Houston[1]
+ * Los Angeles --> Miami[29]
+ * Houston --> Los Angeles[13]
+ * Hartford
+ */
+
+/*
+ * Straightforward power iteration with a jump back to the seed, or to a
+ * random vertex if seed is -1, to check the ranking procedures against.
+ */
+static void referenceRank(const CSRGraph& g, bool weighted, long seed,
+		std::vector<double>& rank) {
+	Offset n = g.getVertexCount();
+	std::vector<double> jump(n, seed < 0 ? 1.0 / n : 0);
+	if(seed >= 0)
+		jump[seed] = 1;
+	rank = jump;
+	for(int it = 0; it < 1000; ++it) {
+		std::vector<double> next(n, 0);
+		for(Offset u = 0; u < n; ++u) {
+			double total = 0;
+			for(size_t e = g.offsets[u]; e < g.offsets[u+1]; ++e) {
+				total += weighted ? std::max<Weight>(g.weights[e], 0) : 1;
+			}
+			if(total == 0) {
+				for(Offset v = 0; v < n; ++v) {
+					next[v] += 0.85 * rank[u] * jump[v];
+				}
+				continue;
+			}
+			for(size_t e = g.offsets[u]; e < g.offsets[u+1]; ++e) {
+				double w = weighted ? std::max<Weight>(g.weights[e], 0) : 1;
+				next[g.targets[e]] += 0.85 * rank[u] * w / total;
+			}
+		}
+		for(Offset v = 0; v < n; ++v) {
+			next[v] += 0.15 * jump[v];
+		}
+		rank = next;
+	}
+}
+
+TEST(PageRankTest, Cycle) {
+	std::vector<Offset> src, dst;
+	for(Offset v = 0; v < 10; ++v) {
+		src.push_back(v);
+		dst.push_back((v + 1) % 10);
+	}
+	CSRGraph g;
+	buildCSR(10, src, dst, std::vector<Weight>(), g);
+	RankOptions o;
+	std::vector<double> rank;
+
+	// every vertex of a cycle is alike, so nothing changes
+	EXPECT_EQ(pageRank(g, o, rank), 1);
+	for(Offset v = 0; v < 10; ++v) {
+		EXPECT_NEAR(rank[v], 0.1, 1e-12);
+	}
+}
+
+TEST(PageRankTest, Reference) {
+	WeightedDigraph a;
+	ASSERT_EQ(a.fileLoad(goodFile), 0);
+	CSRGraph g;
+	buildCSR(a, g);
+	RankOptions o;
+	o.tolerance = 1e-12;
+	std::vector<double> rank, expected;
+
+	// Hartford is dangling, yet ranks still sum to 1
+	for(int weighted = 0; weighted < 2; ++weighted) {
+		o.weighted = weighted;
+		pageRank(g, o, rank);
+		referenceRank(g, weighted, -1, expected);
+		double total = 0;
+		for(Offset v = 0; v < g.getVertexCount(); ++v) {
+			EXPECT_NEAR(rank[v], expected[v], 1e-9);
+			total += rank[v];
+		}
+		EXPECT_NEAR(total, 1, 1e-9);
+	}
+}
+
+TEST(PageRankTest, Threads) {
+	std::mt19937 rng(3);
+	std::vector<Offset> src, dst;
+	std::vector<Weight> w;
+	for(size_t i = 0; i < 5 * RANDOM_VERTICES; ++i) {
+		src.push_back(rng() % RANDOM_VERTICES);
+		dst.push_back(rng() % RANDOM_VERTICES);
+		w.push_back(rng() % 100);
+	}
+	CSRGraph g;
+	buildCSR(RANDOM_VERTICES, src, dst, w, g);
+	RankOptions o;
+	o.weighted = true;
+
+	// results do not depend on the number of threads
+	std::vector<double> serial, parallel;
+	setParallelThreads(1);
+	unsigned it1 = pageRank(g, o, serial);
+	setParallelThreads(4);
+	unsigned it4 = pageRank(g, o, parallel);
+	setParallelThreads(0);
+	EXPECT_EQ(it1, it4);
+	EXPECT_LT(it1, o.maxIterations);
+	EXPECT_EQ(serial, parallel);
+}
+
+TEST(PageRankTest, Personalized) {
+	WeightedDigraph a;
+	ASSERT_EQ(a.fileLoad(goodFile), 0);
+	CSRGraph g;
+	buildCSR(a, g);
+	RankOptions o;
+	o.tolerance = 1e-9;
+	std::vector<Score> rank;
+	std::vector<double> expected;
+
+	Offset seed = a.getOffset("Houston");
+	for(int weighted = 0; weighted < 2; ++weighted) {
+		o.weighted = weighted;
+		personalizedPageRank(g, seed, o, rank);
+		referenceRank(g, weighted, seed, expected);
+		double total = 0;
+		for(size_t i = 0; i < rank.size(); ++i) {
+			EXPECT_NEAR(rank[i].second, expected[rank[i].first], 1e-6);
+			total += rank[i].second;
+
+			// every jump lands on the seed
+			if(rank[i].first == seed) {
+				EXPECT_GE(rank[i].second, 1 - o.damping);
+			}
+		}
+		EXPECT_NEAR(total, 1, 1e-6);
+	}
+
+	// pushing until no residual is left would never end
+	o.weighted = false;
+	referenceRank(g, false, seed, expected);
+	double tolerances[] = {0, -1};
+	for(double t : tolerances) {
+		o.tolerance = t;
+		personalizedPageRank(g, seed, o, rank);
+		ASSERT_EQ(rank.size(), g.getVertexCount());
+		for(size_t i = 0; i < rank.size(); ++i) {
+			EXPECT_NEAR(rank[i].second, expected[rank[i].first], 1e-9);
+		}
+	}
+}
+
+TEST(PageRankTest, Local) {
+	// a small cycle far away from a large graph it has no edges to
+	std::vector<Offset> src, dst;
+	for(Offset v = 0; v < RANDOM_VERTICES; ++v) {
+		src.push_back(v);
+		dst.push_back((v + 1) % RANDOM_VERTICES);
+	}
+	for(Offset v = 0; v < 3; ++v) {
+		src.push_back(RANDOM_VERTICES + v);
+		dst.push_back(RANDOM_VERTICES + (v + 1) % 3);
+	}
+	CSRGraph g;
+	buildCSR(RANDOM_VERTICES + 3, src, dst, std::vector<Weight>(), g);
+	RankOptions o;
+	std::vector<Score> rank;
+
+	personalizedPageRank(g, RANDOM_VERTICES, o, rank);
+	ASSERT_EQ(rank.size(), 3);
+	sortRanks(rank);
+	EXPECT_EQ(rank[0].first, RANDOM_VERTICES);
+	EXPECT_GT(rank[0].second, rank[1].second);
+	EXPECT_GT(rank[1].second, rank[2].second);
+}
+
+TEST(PageRankTest, Write) {
+	WeightedDigraph a;
+	ASSERT_EQ(a.fileLoad(goodFile), 0);
+	CSRGraph g;
+	buildCSR(a, g);
+	RankOptions o;
+	std::vector<double> rank;
+	std::vector<Score> s;
+	pageRank(g, o, rank);
+	sortRanks(rank, s);
+	ASSERT_EQ(writeRanks(a, s, rankFile), 0);
+
+	// one line per vertex, highest rank first
+	std::ifstream in(rankFile);
+	std::string line;
+	double last = 1;
+	size_t lines = 0;
+	while(std::getline(in, line)) {
+		size_t tab = line.find('\t');
+		ASSERT_NE(tab, std::string::npos);
+		EXPECT_GE(a.getOffset(line.substr(0, tab)), 0);
+		double r = std::stod(line.substr(tab + 1));
+		EXPECT_LE(r, last);
+		last = r;
+		++lines;
+	}
+	EXPECT_EQ(lines, a.getVertexCount());
+	std::remove(rankFile.c_str());
+
+	EXPECT_EQ(writeRanks(a, s, "../noSuchDirectory/ranks.txt"), -1);
+}
+
+int main(int argc, char** argv) {
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
@@ -0,0 +1,195 @@
+#include "server.h"
+#include "Search.h"
+#include <sstream>
+#include <vector>
+#include <cerrno>
+#include <climits>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/socket.h>
+
+#define READ_CHUNK 65536        // bytes read from a socket per read call
+#define READ_TURN (1 << 20)     // bytes read from a connection per dispatch,
+                                // so one busy client cannot starve others
+#define MAX_PENDING (64 << 20)  // largest unterminated request tolerated
+
+/////////////////////////////////////////////////////////////////////////////
+// AUXILIARY FUNCTIONS                                                     //
+/////////////////////////////////////////////////////////////////////////////
+
+/*
+ * Splits a request line into its tab separated fields.
+ */
+static void splitFields(const std::string& req, std::vector<std::string>& f) {
+	size_t start = 0;
+	size_t end;
+	while((end = req.find(fieldSep, start)) != std::string::npos) {
+		f.push_back(req.substr(start, end - start));
+		start = end + 1;
+	}
+	f.push_back(req.substr(start));
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// CONNECTION I/O                                                          //
+/////////////////////////////////////////////////////////////////////////////
+
+bool readAvailable(int fd, std::string& in) {
+	char buf[READ_CHUNK];
+	size_t total = 0;
+	while(total < READ_TURN) {
+		ssize_t n = read(fd, buf, sizeof(buf));
+		if(n > 0) {
+			in.append(buf, n);
+			total += n;
+		}
+		else if(n == 0)
+			return false;
+		else if(errno == EINTR)
+			continue;
+		else
+			return errno == EAGAIN || errno == EWOULDBLOCK;
+	}
+	return in.size() <= MAX_PENDING;
+}
+
+bool flushResponses(int fd, std::string& out, int timeout) {
+	size_t sent = 0;
+	while(sent < out.size()) {
+		ssize_t n = send(fd, out.data() + sent, out.size() - sent, MSG_NOSIGNAL);
+		if(n >= 0)
+			sent += n;
+		else if(errno == EAGAIN || errno == EWOULDBLOCK) {
+			// a client that stops reading must not hold the thread forever
+			struct pollfd p = {fd, POLLOUT, 0};
+			int r = poll(&p, 1, timeout);
+			if(r == 0 || (r == -1 && errno != EINTR))
+				return false;
+		}
+		else if(errno != EINTR)
+			return false;
+	}
+	out.clear();
+	return true;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// REQUEST HANDLING                                                        //
+/////////////////////////////////////////////////////////////////////////////
+
+bool isWriteRequest(const std::string& req) {
+	if(req.empty())
+		return false;
+	switch(req[0]) {
+		case addVertexReq:
+		case removeVertexReq:
+		case setEdgeReq:
+		case removeEdgeReq:
+		case writeReq:
+			return true;
+		default:
+			return false;
+	}
+}
+
+void serveRead(const WeightedDigraph& g, const std::string& req,
+		std::string& out) {
+	std::vector<std::string> f;
+	splitFields(req, f);
+	std::ostringstream res;
+	if(f[0].size() != 1)
+		res << badRequest;
+	else if(f[0][0] == edgeReq && f.size() == 3) {
+		int p1 = g.getOffset(f[1]);
+		int p2 = g.getOffset(f[2]);
+		if(p1 == -1 || p2 == -1)
+			res << -1;
+		else if(g.getWeight(p1, p2) == NWT)
+			res << 0;
+		else
+			res << 1 << fieldSep << g.getWeight(p1, p2);
+	}
+	else if(f[0][0] == neighborReq && f.size() == 2) {
+		int p = g.getOffset(f[1]);
+		if(p == -1)
+			res << -1;
+		else {
+			std::vector<Offset> nbrs;
+			g.getNeighbors((Offset)p, nbrs);
+			res << 1;
+			for(size_t i = 0; i < nbrs.size(); ++i) {
+				res << fieldSep << g.getKey(nbrs[i]);
+			}
+		}
+	}
+	else if(f[0][0] == pathReq && f.size() == 4 && (f[1] == bfsAlgo ||
+			f[1] == ucsAlgo || f[1] == iddfsAlgo)) {
+		int p1 = g.getOffset(f[2]);
+		int p2 = g.getOffset(f[3]);
+		Path p;
+		if(p1 == -1 || p2 == -1)
+			res << -1;
+		else if(!(f[1] == bfsAlgo ? bfs(g, p1, p2, p) : f[1] == ucsAlgo ?
+				ucs(g, p1, p2, p) : iddfs(g, p1, p2, p)))
+			res << 0;
+		else {
+			res << 1 << fieldSep << p.cost;
+			for(size_t i = 0; i < p.vertices.size(); ++i) {
+				res << fieldSep << g.getKey(p.vertices[i]);
+			}
+		}
+	}
+	else
+		res << badRequest;
+	out += res.str();
+	out += recordSep;
+}
+
+void serveWrite(WeightedDigraph& g, const std::string& file,
+		const std::string& req, std::string& out, Journal* j) {
+	std::vector<std::string> f;
+	splitFields(req, f);
+	std::ostringstream res;
+	if(f[0].size() != 1)
+		res << badRequest;
+	else if(f[0][0] == addVertexReq && f.size() == 2 && !f[1].empty()) {
+		bool added = g.addVertex(f[1]);
+		if(added && j != NULL)
+			j->logAddVertex(f[1]);
+		res << added;
+	}
+	else if(f[0][0] == removeVertexReq && f.size() == 2) {
+		bool removed = g.removeVertex(f[1]);
+		if(removed && j != NULL)
+			j->logRemoveVertex(f[1]);
+		res << removed;
+	}
+	else if(f[0][0] == setEdgeReq && f.size() == 4) {
+		try {
+			int w = std::stoi(f[3]);
+			if(w <= NWT || w > SHRT_MAX)
+				res << badRequest;
+			else {
+				int set = g.setEdge(f[1], f[2], w);
+				if(set != -1 && j != NULL)
+					j->logSetEdge(f[1], f[2], w);
+				res << set;
+			}
+		}
+		catch(std::exception&) {
+			res << badRequest;
+		}
+	}
+	else if(f[0][0] == removeEdgeReq && f.size() == 3) {
+		int removed = g.removeEdge(f[1], f[2]);
+		if(removed == 0 && j != NULL)
+			j->logRemoveEdge(f[1], f[2]);
+		res << removed;
+	}
+	else if(f[0][0] == writeReq && f.size() == 1)
+		res << (j != NULL ? j->checkpoint(g) : g.fileWrite(file));
+	else
+		res << badRequest;
+	out += res.str();
+	out += recordSep;
+}
@@ -0,0 +1,223 @@
+#include <iostream>
+#include <random>
+#include <algorithm>
+#include <cstdio>
+
+#include "Graph.h"
+#include "CSR.h"
+#include "Reorder.h"
+#include "gtest/gtest.h"
+
+#define PATH_LENGTH 1000
+#define GRID_SIDE 30
+#define RANDOM_VERTICES 20000
+
+const std::string goodFile = "../graphFiles/test.graph";
+const std::string reorderedFile = "reordered.graph";
+
+/*
+ * ReorderTest
+ *
+ * Performs the following tests on vertex reordering.
+ *     -Permutation
+ *     -DegreeOrder
+ *     -Bandwidth
+ *     -PermuteSnapshot
+ *     -PermuteGraph
+ */
+
+/*
+ * Relabels the vertices of an edge list by a random permutation, hiding
+ * whatever locality it had, and builds its snapshot.
+ */
+static void shuffledCSR(Offset n, std::vector<Offset> src,
+		std::vector<Offset> dst, unsigned seed, CSRGraph& c) {
+	std::vector<Offset> label(n);
+	for(Offset v = 0; v < n; ++v) {
+		label[v] = v;
+	}
+	std::shuffle(label.begin(), label.end(), std::mt19937(seed));
+	std::vector<Weight> w;
+	for(size_t i = 0; i < src.size(); ++i) {
+		src[i] = label[src[i]];
+		dst[i] = label[dst[i]];
+		w.push_back(i % 100);
+	}
+	buildCSR(n, src, dst, w, c);
+}
+
+static void randomCSR(CSRGraph& c) {
+	std::mt19937 rng(5);
+	std::vector<Offset> src, dst;
+
+	// the last tenth of the vertices stay isolated
+	for(size_t i = 0; i < RANDOM_VERTICES * 4; ++i) {
+		src.push_back(rng() % (RANDOM_VERTICES * 9 / 10));
+		dst.push_back(rng() % (RANDOM_VERTICES * 9 / 10));
+	}
+	shuffledCSR(RANDOM_VERTICES, src, dst, 1, c);
+}
+
+static bool isPermutation(const std::vector<Offset>& order, Offset n) {
+	std::vector<Offset> sorted(order);
+	std::sort(sorted.begin(), sorted.end());
+	for(Offset v = 0; v < sorted.size(); ++v) {
+		if(sorted[v] != v)
+			return false;
+	}
+	return sorted.size() == n;
+}
+
+TEST(ReorderTest, Permutation) {
+	CSRGraph c;
+	std::vector<Offset> order;
+	randomCSR(c);
+	Ordering all[] = {ORDER_DEGREE, ORDER_BFS, ORDER_RCM};
+	for(size_t i = 0; i < 3; ++i) {
+		computeOrdering(c, all[i], order);
+		EXPECT_TRUE(isPermutation(order, c.getVertexCount()));
+	}
+
+	Ordering o;
+	EXPECT_EQ(parseOrdering("rcm", o), 0);
+	EXPECT_EQ(o, ORDER_RCM);
+	EXPECT_EQ(parseOrdering("bfs", o), 0);
+	EXPECT_EQ(o, ORDER_BFS);
+	EXPECT_EQ(parseOrdering("degree", o), 0);
+	EXPECT_EQ(o, ORDER_DEGREE);
+	EXPECT_EQ(parseOrdering("gorder", o), -1);
+}
+
+TEST(ReorderTest, DegreeOrder) {
+	CSRGraph c;
+	CSRGraph t;
+	std::vector<Offset> order;
+	randomCSR(c);
+	transposeCSR(c, t);
+	computeOrdering(c, ORDER_DEGREE, order);
+	for(size_t i = 1; i < order.size(); ++i) {
+		EXPECT_GE(c.getDegree(order[i-1]) + t.getDegree(order[i-1]),
+				c.getDegree(order[i]) + t.getDegree(order[i]));
+	}
+}
+
+TEST(ReorderTest, Bandwidth) {
+	CSRGraph c;
+	CSRGraph p;
+	std::vector<Offset> order;
+	std::vector<Offset> src, dst;
+
+	// a path is laid out end to end
+	for(Offset v = 0; v + 1 < PATH_LENGTH; ++v) {
+		src.push_back(v);
+		dst.push_back(v + 1);
+	}
+	shuffledCSR(PATH_LENGTH, src, dst, 2, c);
+	EXPECT_GT(bandwidth(c), PATH_LENGTH / 2);
+	computeOrdering(c, ORDER_RCM, order);
+	permuteCSR(c, order, p);
+	EXPECT_EQ(bandwidth(p), 1);
+
+	// a grid is laid out about one row at a time
+	src.clear();
+	dst.clear();
+	for(Offset r = 0; r < GRID_SIDE; ++r) {
+		for(Offset k = 0; k < GRID_SIDE; ++k) {
+			Offset v = r * GRID_SIDE + k;
+			if(k + 1 < GRID_SIDE) {
+				src.push_back(v);
+				dst.push_back(v + 1);
+			}
+			if(r + 1 < GRID_SIDE) {
+				src.push_back(v);
+				dst.push_back(v + GRID_SIDE);
+			}
+		}
+	}
+	shuffledCSR(GRID_SIDE * GRID_SIDE, src, dst, 3, c);
+	computeOrdering(c, ORDER_RCM, order);
+	permuteCSR(c, order, p);
+	EXPECT_LE(bandwidth(p), 2 * GRID_SIDE);
+	computeOrdering(c, ORDER_BFS, order);
+	permuteCSR(c, order, p);
+	EXPECT_LE(bandwidth(p), 3 * GRID_SIDE);
+}
+
+TEST(ReorderTest, PermuteSnapshot) {
+	CSRGraph c;
+	CSRGraph p;
+	std::vector<Offset> order;
+	randomCSR(c);
+	computeOrdering(c, ORDER_RCM, order);
+	permuteCSR(c, order, p);
+	ASSERT_EQ(p.getVertexCount(), c.getVertexCount());
+	ASSERT_EQ(p.getEdgeCount(), c.getEdgeCount());
+
+	// row i of the copy is row order[i] relabeled, in ascending order
+	std::vector<Offset> rank(order.size());
+	for(Offset i = 0; i < order.size(); ++i) {
+		rank[order[i]] = i;
+	}
+	for(Offset i = 0; i < p.getVertexCount(); ++i) {
+		Offset v = order[i];
+		ASSERT_EQ(p.getDegree(i), c.getDegree(v));
+		std::vector<std::pair<Offset, Weight>> expect;
+		for(size_t e = c.offsets[v]; e < c.offsets[v+1]; ++e) {
+			expect.push_back(std::make_pair(rank[c.targets[e]], c.weights[e]));
+		}
+		std::sort(expect.begin(), expect.end());
+		for(size_t k = 0; k < expect.size(); ++k) {
+			EXPECT_EQ(p.targets[p.offsets[i] + k], expect[k].first);
+			EXPECT_EQ(p.weights[p.offsets[i] + k], expect[k].second);
+		}
+	}
+}
+
+TEST(ReorderTest, PermuteGraph) {
+	WeightedDigraph a;
+	WeightedDigraph b;
+	ASSERT_EQ(a.fileLoad(goodFile), 0);
+	ASSERT_EQ(b.fileLoad(goodFile), 0);
+	Offset n = a.getVertexCount();
+
+	// orders that are not permutations are rejected
+	std::vector<Offset> order(n);
+	for(Offset i = 0; i < n; ++i) {
+		order[i] = n - 1 - i;
+	}
+	EXPECT_EQ(a.permute(std::vector<Offset>(order.begin(), order.end() - 1)), -1);
+	order[0] = order[1];
+	EXPECT_EQ(a.permute(order), -1);
+	order[0] = n - 1;
+	ASSERT_EQ(a.permute(order), 0);
+	EXPECT_EQ(a.getKey(0), b.getKey(n - 1));
+
+	// keys, edges and weights survive every ordering
+	Ordering all[] = {ORDER_DEGREE, ORDER_BFS, ORDER_RCM};
+	for(size_t o = 0; o < 3; ++o) {
+		reorderGraph(a, all[o]);
+		ASSERT_EQ(a.getVertexCount(), n);
+		for(Offset i = 0; i < n; ++i) {
+			const Key& k = b.getKey(i);
+			ASSERT_NE(a.getOffset(k), -1);
+			EXPECT_EQ(a.getKey(a.getOffset(k)), k);
+			for(Offset j = 0; j < n; ++j) {
+				EXPECT_EQ(a.getWeight(a.getOffset(k), a.getOffset(b.getKey(j))),
+						b.getWeight(i, j));
+			}
+		}
+	}
+
+	// writing the graph persists the order
+	ASSERT_EQ(a.fileWrite(reorderedFile), 0);
+	ASSERT_EQ(b.fileLoad(reorderedFile), 0);
+	for(Offset i = 0; i < n; ++i) {
+		EXPECT_EQ(b.getKey(i), a.getKey(i));
+	}
+	std::remove(reorderedFile.c_str());
+}
+
+int main(int argc, char** argv) {
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
@@ -0,0 +1,85 @@
+#include <iostream>
+#include <fstream>
+#include <iterator>
+#include <cstdio>
+#include <unistd.h>
+
+#include "Graph.h"
+#include "Save.h"
+#include "gtest/gtest.h"
+
+const std::string goodFile = "../graphFiles/test.graph";
+const std::string saveFile = "saveTest.graph";
+const std::string tmpFile = "saveTest.save.graph";
+
+/*
+ * SaveTest
+ *
+ * Performs the following tests on background saves.
+ *     -PointInTime
+ *     -Errors
+ */
+
+static std::string slurp(const std::string& file) {
+	std::ifstream in(file, std::ios::binary);
+	return std::string(std::istreambuf_iterator<char>(in),
+			std::istreambuf_iterator<char>());
+}
+
+TEST(SaveTest, PointInTime) {
+	WeightedDigraph g;
+	BackgroundSave s;
+	ASSERT_EQ(g.fileLoad(goodFile), 0);
+	EXPECT_EQ(s.getState(), SAVE_IDLE);
+	EXPECT_FALSE(s.poll());
+	ASSERT_EQ(g.fileWrite(saveFile), 0);
+	std::string before = slurp(saveFile);
+
+	// edits made once the save has started are not part of it
+	ASSERT_EQ(s.start(g, saveFile), 0);
+	EXPECT_EQ(s.getState(), SAVE_RUNNING);
+	EXPECT_EQ(s.getFile(), saveFile);
+	ASSERT_TRUE(g.addVertex("Denver"));
+	ASSERT_EQ(g.setEdge("Denver", "Boston", 3), 0);
+	EXPECT_EQ(s.start(g, saveFile), -4);
+	EXPECT_EQ(s.wait(), SAVE_DONE);
+	EXPECT_FALSE(s.poll());
+	EXPECT_EQ(slurp(saveFile), before);
+	EXPECT_GE(s.getSeconds(), 0);
+
+	// polling reports completion once
+	ASSERT_EQ(s.start(g, saveFile), 0);
+	bool finished = false;
+	for(int i = 0; i < 10000 && !finished; ++i) {
+		finished = s.poll();
+		if(!finished)
+			usleep(1000);
+	}
+	ASSERT_TRUE(finished);
+	EXPECT_FALSE(s.poll());
+	EXPECT_EQ(s.getState(), SAVE_DONE);
+	WeightedDigraph h;
+	ASSERT_EQ(h.fileLoad(saveFile), 0);
+	EXPECT_TRUE(h.isEdge("Denver", "Boston"));
+	EXPECT_EQ(slurp(tmpFile), "");
+	std::remove(saveFile.c_str());
+}
+
+TEST(SaveTest, Errors) {
+	WeightedDigraph g;
+	BackgroundSave s;
+	ASSERT_EQ(g.fileLoad(goodFile), 0);
+	EXPECT_EQ(s.start(g, "saveTest.wumbo"), -2);
+	EXPECT_EQ(s.getState(), SAVE_IDLE);
+
+	// a save that cannot be written leaves nothing behind
+	ASSERT_EQ(s.start(g, "missing/saveTest.graph"), 0);
+	EXPECT_EQ(s.wait(), SAVE_FAILED);
+	EXPECT_EQ(s.getFile(), "missing/saveTest.graph");
+	EXPECT_EQ(s.wait(), SAVE_FAILED);
+}
+
+int main(int argc, char** argv) {
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
@@ -0,0 +1,306 @@
+#include <iostream>
+#include <fstream>
+#include <random>
+#include <cstdio>
+
+#include "Graph.h"
+#include "CSR.h"
+#include "SCC.h"
+#include "Parallel.h"
+#include "gtest/gtest.h"
+
+#define CHAIN 2000000     // long enough to overflow a recursive search
+#define RANDOM_VERTICES 100000
+#define LAZY_VERTICES 2000
+
+const std::string goodFile = "../graphFiles/test.graph";
+const std::string lazyFile = "sccTestLazy.graph";
+
+/*
+ * SCCTest
+ *
+ * Performs the following tests on strongly connected components.
+ *     -TestGraph
+ *     -LongCycle
+ *     -LongPath
+ *     -Agreement
+ *     -WeakTestGraph
+ *     -WeakReference
+ *     -WeakThreads
+ *     -Largest
+ *     -LazySnapshot
+ */
+
+/*
+ * Graph should look as follows after loading from test.graph.
+ *
+ * Boston --> New York[19], Los Angeles[4]
+ * New York --> Miami[10], Houston[28], Hartford[12]
+ * Miami --> Boston[4], San Francisco[9]
+ * San Francisco --> Boston[20], New York[6], Houston[1]
+ * Los Angeles --> Miami[29]
+ * Houston --> Los Angeles[13]
+ * Hartford
+ */
+
+/*
+ * Builds a random graph of n vertices made of small planted cycles joined by
+ * random edges, which gives a mix of large, small and singleton components.
+ */
+static void randomGraph(Offset n, size_t edges, unsigned seed, CSRGraph& c) {
+	std::mt19937 rng(seed);
+	std::vector<Offset> src, dst;
+	for(Offset v = 0; v + 1 < n; v += 2) {
+		src.push_back(v);
+		dst.push_back(v + 1);
+		src.push_back(v + 1);
+		dst.push_back(v);
+	}
+	for(size_t i = 0; i < edges; ++i) {
+		src.push_back(rng() % n);
+		dst.push_back(rng() % n);
+	}
+	buildCSR(n, src, dst, std::vector<Weight>(), c);
+}
+
+/*
+ * Weakly connected components by breadth-first search over edges either
+ * way, from every unreached vertex in ascending order, to check against.
+ */
+static void weakReference(const CSRGraph& g, Components& c) {
+	CSRGraph t;
+	transposeCSR(g, t);
+	Offset n = g.getVertexCount();
+	const Offset unseen = n;
+	c.component.assign(n, unseen);
+	c.count = 0;
+	for(Offset s = 0; s < n; ++s) {
+		if(c.component[s] != unseen)
+			continue;
+		std::vector<Offset> queue(1, s);
+		c.component[s] = c.count;
+		for(size_t i = 0; i < queue.size(); ++i) {
+			const CSRGraph* sides[] = {&g, &t};
+			for(const CSRGraph* h : sides) {
+				Offset v = queue[i];
+				for(size_t e = h->offsets[v]; e < h->offsets[v+1]; ++e) {
+					if(c.component[h->targets[e]] == unseen) {
+						c.component[h->targets[e]] = c.count;
+						queue.push_back(h->targets[e]);
+					}
+				}
+			}
+		}
+		++c.count;
+	}
+}
+
+TEST(SCCTest, TestGraph) {
+	WeightedDigraph a;
+	ASSERT_EQ(a.fileLoad(goodFile), 0);
+	Components c;
+	CSRGraph dag;
+	stronglyConnected(a, c, dag);
+
+	// everything but Hartford can reach everything else
+	ASSERT_EQ(c.count, 2);
+	Offset big = c.component[a.getOffset("Boston")];
+	Offset hartford = c.component[a.getOffset("Hartford")];
+	EXPECT_NE(big, hartford);
+	const char* keys[] = {"New York", "Miami", "San Francisco", "Los Angeles",
+			"Houston"};
+	for(size_t i = 0; i < 5; ++i) {
+		EXPECT_EQ(c.component[a.getOffset(keys[i])], big);
+	}
+
+	// the condensation is the single New York -> Hartford edge
+	ASSERT_EQ(dag.getVertexCount(), 2);
+	ASSERT_EQ(dag.getEdgeCount(), 1);
+	ASSERT_EQ(dag.getDegree(big), 1);
+	EXPECT_EQ(dag.targets[dag.offsets[big]], hartford);
+	EXPECT_EQ(dag.weights[dag.offsets[big]], 12);
+}
+
+TEST(SCCTest, LongCycle) {
+	std::vector<Offset> src(CHAIN), dst(CHAIN);
+	for(Offset v = 0; v < CHAIN; ++v) {
+		src[v] = v;
+		dst[v] = (v + 1) % CHAIN;
+	}
+	CSRGraph g;
+	buildCSR(CHAIN, src, dst, std::vector<Weight>(), g);
+	Components c;
+	sccTarjan(g, c);
+	EXPECT_EQ(c.count, 1);
+	sccParallel(g, c);
+	EXPECT_EQ(c.count, 1);
+}
+
+TEST(SCCTest, LongPath) {
+	std::vector<Offset> src(CHAIN - 1), dst(CHAIN - 1);
+	for(Offset v = 0; v + 1 < CHAIN; ++v) {
+		src[v] = v;
+		dst[v] = v + 1;
+	}
+	CSRGraph g, dag;
+	buildCSR(CHAIN, src, dst, std::vector<Weight>(), g);
+	Components c;
+	sccTarjan(g, c);
+	EXPECT_EQ(c.count, CHAIN);
+	EXPECT_EQ(c.component[CHAIN - 1], CHAIN - 1);
+	sccParallel(g, c);
+	EXPECT_EQ(c.count, CHAIN);
+	EXPECT_EQ(c.component[CHAIN - 1], CHAIN - 1);
+	condense(g, c, dag);
+	EXPECT_EQ(dag.getEdgeCount(), CHAIN - 1);
+}
+
+TEST(SCCTest, Agreement) {
+	setParallelThreads(4);
+	size_t densities[] = {RANDOM_VERTICES / 2, RANDOM_VERTICES,
+			2 * RANDOM_VERTICES};
+	for(unsigned i = 0; i < 3; ++i) {
+		CSRGraph g, dag;
+		randomGraph(RANDOM_VERTICES, densities[i], i, g);
+		Components serial, parallel;
+		sccTarjan(g, serial);
+		sccParallel(g, parallel);
+		EXPECT_EQ(serial.count, parallel.count);
+		EXPECT_EQ(serial.component, parallel.component);
+
+		// the condensation has no cycles, so it is its own condensation
+		Components again;
+		condense(g, serial, dag);
+		sccTarjan(dag, again);
+		EXPECT_EQ(again.count, serial.count);
+	}
+	setParallelThreads(0);
+}
+
+TEST(SCCTest, WeakTestGraph) {
+	WeightedDigraph a;
+	ASSERT_EQ(a.fileLoad(goodFile), 0);
+	Components c;
+
+	// Hartford has no out-edges but is still reached from New York
+	weaklyConnected(a, c);
+	EXPECT_EQ(c.count, 1);
+
+	ASSERT_TRUE(a.addVertex("Denver"));
+	ASSERT_EQ(a.removeEdge("New York", "Hartford"), 0);
+	weaklyConnected(a, c);
+	ASSERT_EQ(c.count, 3);
+	EXPECT_EQ(c.component[a.getOffset("Boston")], 0);
+	EXPECT_NE(c.component[a.getOffset("Hartford")],
+			c.component[a.getOffset("Denver")]);
+	EXPECT_NE(c.component[a.getOffset("Hartford")], 0);
+	EXPECT_NE(c.component[a.getOffset("Denver")], 0);
+}
+
+TEST(SCCTest, WeakReference) {
+	// sparse graphs leave many components, denser ones a giant
+	size_t densities[] = {RANDOM_VERTICES / 4, RANDOM_VERTICES / 2,
+			2 * RANDOM_VERTICES};
+	for(unsigned i = 0; i < 3; ++i) {
+		CSRGraph g;
+		randomGraph(RANDOM_VERTICES, densities[i], i, g);
+		Components expected, c;
+		weakReference(g, expected);
+		wccAfforest(g, c);
+		EXPECT_EQ(c.count, expected.count);
+		EXPECT_EQ(c.component, expected.component);
+	}
+
+	// a star whose center has no out-edges is found only through the
+	// edges into it
+	std::vector<Offset> src, dst;
+	for(Offset v = 1; v < 1000; ++v) {
+		src.push_back(v);
+		dst.push_back(0);
+	}
+	CSRGraph star;
+	Components c;
+	buildCSR(1001, src, dst, std::vector<Weight>(), star);
+	wccAfforest(star, c);
+	EXPECT_EQ(c.count, 2);
+	EXPECT_EQ(c.component[999], 0);
+	EXPECT_EQ(c.component[1000], 1);
+}
+
+TEST(SCCTest, WeakThreads) {
+	CSRGraph g;
+	Components one, many;
+	randomGraph(RANDOM_VERTICES, RANDOM_VERTICES / 2, 7, g);
+	setParallelThreads(1);
+	wccAfforest(g, one);
+	setParallelThreads(4);
+	wccAfforest(g, many);
+	setParallelThreads(0);
+	EXPECT_EQ(one.count, many.count);
+	EXPECT_EQ(one.component, many.component);
+}
+
+TEST(SCCTest, Largest) {
+	// 0 -> 1, and 2 -> 3 <- 4, with 5 on its own
+	std::vector<Offset> src = {0, 2, 4}, dst = {1, 3, 3};
+	CSRGraph g;
+	Components c;
+	buildCSR(6, src, dst, std::vector<Weight>(), g);
+	wccAfforest(g, c);
+	ASSERT_EQ(c.count, 3);
+	std::vector<Offset> sizes;
+	componentSizes(c, sizes);
+	EXPECT_EQ(sizes, std::vector<Offset>({2, 3, 1}));
+	EXPECT_EQ(largestComponent(c), 1);
+
+	Subgraph s;
+	extractComponent(g, c, largestComponent(c), s);
+	EXPECT_EQ(s.origin, std::vector<Offset>({2, 3, 4}));
+	EXPECT_EQ(s.csr.getEdgeCount(), 2);
+
+	// ties go to the lowest id
+	Components empty;
+	empty.count = 0;
+	EXPECT_EQ(largestComponent(empty), 0);
+	src.push_back(5);
+	dst.push_back(0);
+	buildCSR(6, src, dst, std::vector<Weight>(), g);
+	wccAfforest(g, c);
+	EXPECT_EQ(c.count, 2);
+	EXPECT_EQ(largestComponent(c), 0);
+}
+
+TEST(SCCTest, LazySnapshot) {
+	std::mt19937 rng(9);
+	std::ofstream out(lazyFile);
+	for(Offset v = 0; v < LAZY_VERTICES; ++v) {
+		out << "v" << v << " |";
+		for(int i = 0; i < 8; ++i) {
+			out << " v" << rng() % LAZY_VERTICES << "[" << rng() % 100 + 1 << "]";
+		}
+		out << "\n";
+	}
+	out.close();
+
+	// rows of a lazily loaded graph are parsed as they are first read, so
+	// scanning them from several threads must parse them all first
+	WeightedDigraph a, b;
+	CSRGraph eager, lazy;
+	ASSERT_EQ(a.fileLoad(lazyFile), 0);
+	ASSERT_EQ(b.lazyLoad(lazyFile), 0);
+	setParallelThreads(4);
+	buildCSR(a, eager);
+	buildCSR(b, lazy);
+	setParallelThreads(0);
+	EXPECT_EQ(b.getPendingCount(), 0);
+	EXPECT_EQ(b.getEdgeCount(), a.getEdgeCount());
+	EXPECT_EQ(lazy.offsets, eager.offsets);
+	EXPECT_EQ(lazy.targets, eager.targets);
+	EXPECT_EQ(lazy.weights, eager.weights);
+	std::remove(lazyFile.c_str());
+}
+
+int main(int argc, char** argv) {
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
@@ -0,0 +1,106 @@
+#include <iostream>
+
+#include "Graph.h"
+#include "Search.h"
+#include "gtest/gtest.h"
+
+const std::string goodFile = "../graphFiles/test.graph";
+
+/*
+ * SearchTest
+ *
+ * Performs the following tests on the uninformed searching procedures.
+ *     -LeastHops
+ *     -LowestCost
+ *     -DepthLimit
+ *     -NoPath
+ */
+
+/*
+ * Graph should look as follows after loading from test.graph.
+ *
+ * Boston --> New York[19], Los Angeles[4]
+ * New York --> Miami[10], Houston[28], Hartford[12]
+ * Miami --> Boston[4], San Francisco[9]
+ * San Francisco --> Boston[20], New York[6], Houston[1]
+ * Los Angeles --> Miami[29]
+ * Houston --> Los Angeles[13]
+ * Hartford
+ */
+
+TEST(SearchTest, LeastHops) {
+	WeightedDigraph a;
+	ASSERT_EQ(a.fileLoad(goodFile), 0);
+	Path p;
+	std::vector<Key> k;
+
+	// Boston -> New York -> Hartford is the only 2 hop path
+	ASSERT_TRUE(bfs(a, a.getOffset("Boston"), a.getOffset("Hartford"), p));
+	pathKeys(a, p, k);
+	ASSERT_EQ(k.size(), 3);
+	EXPECT_EQ(k[0], "Boston");
+	EXPECT_EQ(k[1], "New York");
+	EXPECT_EQ(k[2], "Hartford");
+	EXPECT_EQ(p.cost, 31);
+
+	ASSERT_TRUE(iddfs(a, a.getOffset("Boston"), a.getOffset("Hartford"), p));
+	EXPECT_EQ(p.vertices.size(), 3);
+	EXPECT_EQ(p.cost, 31);
+
+	// trivial path
+	ASSERT_TRUE(bfs(a, a.getOffset("Miami"), a.getOffset("Miami"), p));
+	EXPECT_EQ(p.vertices.size(), 1);
+	EXPECT_EQ(p.cost, 0);
+}
+
+TEST(SearchTest, LowestCost) {
+	WeightedDigraph a;
+	ASSERT_EQ(a.fileLoad(goodFile), 0);
+	Path p;
+	std::vector<Key> k;
+
+	// Miami -> San Francisco -> Houston (10) beats Miami -> Boston -> New
+	// York -> Houston (51)
+	ASSERT_TRUE(ucs(a, a.getOffset("Miami"), a.getOffset("Houston"), p));
+	pathKeys(a, p, k);
+	ASSERT_EQ(k.size(), 3);
+	EXPECT_EQ(k[1], "San Francisco");
+	EXPECT_EQ(p.cost, 10);
+
+	// Boston -> New York -> Miami (29) beats Boston -> Los Angeles -> Miami
+	// (33), even though both take 2 hops
+	ASSERT_TRUE(ucs(a, a.getOffset("Boston"), a.getOffset("Miami"), p));
+	EXPECT_EQ(p.cost, 29);
+}
+
+TEST(SearchTest, DepthLimit) {
+	WeightedDigraph a;
+	ASSERT_EQ(a.fileLoad(goodFile), 0);
+	Path p;
+
+	// Houston needs 3 hops to reach San Francisco
+	EXPECT_FALSE(dfs(a, a.getOffset("Houston"), a.getOffset("San Francisco"), 2, p));
+	ASSERT_TRUE(dfs(a, a.getOffset("Houston"), a.getOffset("San Francisco"), 3, p));
+	EXPECT_EQ(p.vertices.size(), 4);
+	EXPECT_EQ(p.cost, 51);
+	ASSERT_TRUE(dfs(a, a.getOffset("Houston"), a.getOffset("San Francisco"), 7, p));
+	EXPECT_EQ(p.vertices.front(), a.getOffset("Houston"));
+	EXPECT_EQ(p.vertices.back(), a.getOffset("San Francisco"));
+}
+
+TEST(SearchTest, NoPath) {
+	WeightedDigraph a;
+	ASSERT_EQ(a.fileLoad(goodFile), 0);
+	Path p;
+
+	// Hartford has no outgoing edges
+	EXPECT_FALSE(bfs(a, a.getOffset("Hartford"), a.getOffset("Boston"), p));
+	EXPECT_FALSE(ucs(a, a.getOffset("Hartford"), a.getOffset("Boston"), p));
+	EXPECT_FALSE(dfs(a, a.getOffset("Hartford"), a.getOffset("Boston"), 7, p));
+	EXPECT_FALSE(iddfs(a, a.getOffset("Hartford"), a.getOffset("Boston"), p));
+}
+
+int main(int argc, char** argv) {
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
@@ -0,0 +1,385 @@
+#include "server.h"
+#include <iostream>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <future>
+#include <atomic>
+#include <stdexcept>
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+#include <csignal>
+#include <pthread.h>
+#include <poll.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+/////////////////////////////////////////////////////////////////////////////
+// SERVER STRUCTURES AND VARIABLES                                         //
+/////////////////////////////////////////////////////////////////////////////
+
+#define SEND_TIMEOUT 5000       // milliseconds a client may leave its
+                                // responses unread before it is dropped
+
+/*
+ * A client connection. At any moment a connection is owned by exactly one of
+ * the poller (idle), the ready queue, or a worker, so its buffers need no
+ * locking and its responses stay in request order.
+ */
+struct Connection {
+	int fd;
+	std::string in;
+	std::string out;
+};
+
+/*
+ * A write request handed from a worker to the single writer thread.
+ */
+struct WriteJob {
+	std::string req;
+	std::promise<std::string> result;
+};
+
+static WeightedDigraph graph;
+static std::string graphFile;
+static Journal journal;
+static pthread_rwlock_t graphLock;
+
+static std::mutex readyMutex;
+static std::condition_variable readyCv;
+static std::deque<Connection*> ready;
+
+static std::mutex rearmMutex;
+static std::vector<Connection*> rearm;
+
+static std::mutex writeMutex;
+static std::condition_variable writeCv;
+static std::deque<WriteJob*> writes;
+
+static std::mutex checkpointMutex;
+static std::condition_variable checkpointCv;
+static bool checkpointDue = false;
+
+static int wakePipe[2];
+static std::atomic<bool> running(true);
+static std::atomic<bool> writerRunning(true);
+static std::atomic<unsigned long long> served(0);
+
+/////////////////////////////////////////////////////////////////////////////
+// AUXILIARY FUNCTIONS                                                     //
+/////////////////////////////////////////////////////////////////////////////
+
+/*
+ * Wakes the poller so that it picks up rearmed connections or shuts down.
+ */
+static void wakePoller() {
+	char c = 0;
+	while(write(wakePipe[1], &c, 1) == -1 && errno == EINTR);
+}
+
+static void onSignal(int) {
+	running = false;
+	wakePoller();
+}
+
+/*
+ * Serves every complete request buffered on a connection. Consecutive reads
+ * share a single acquisition of the shared lock; writes are handed to the
+ * writer thread and awaited so that responses keep request order.
+ */
+static void serveBatch(Connection* c) {
+	size_t start = 0;
+	size_t end;
+	bool locked = false;
+	while((end = c->in.find(recordSep, start)) != std::string::npos) {
+		std::string req = c->in.substr(start, end - start);
+		if(!req.empty() && req[req.size()-1] == '\r')
+			req.erase(req.size()-1);
+		start = end + 1;
+		if(isWriteRequest(req)) {
+			if(locked) {
+				pthread_rwlock_unlock(&graphLock);
+				locked = false;
+			}
+			WriteJob job;
+			job.req = req;
+			std::future<std::string> result = job.result.get_future();
+			{
+				std::lock_guard<std::mutex> guard(writeMutex);
+				writes.push_back(&job);
+			}
+			writeCv.notify_one();
+			c->out += result.get();
+		}
+		else {
+			if(!locked) {
+				pthread_rwlock_rdlock(&graphLock);
+				locked = true;
+			}
+			serveRead(graph, req, c->out);
+		}
+		++served;
+	}
+	if(locked)
+		pthread_rwlock_unlock(&graphLock);
+	c->in.erase(0, start);
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// THREADS                                                                 //
+/////////////////////////////////////////////////////////////////////////////
+
+/*
+ * Worker thread. Takes readable connections off the ready queue, serves the
+ * requests pipelined on them, and returns them to the poller.
+ */
+static void worker() {
+	while(true) {
+		Connection* c;
+		{
+			std::unique_lock<std::mutex> guard(readyMutex);
+			readyCv.wait(guard, []{ return !ready.empty() || !running; });
+			if(ready.empty())
+				return;
+			c = ready.front();
+			ready.pop_front();
+		}
+		bool open = readAvailable(c->fd, c->in);
+		serveBatch(c);
+		if(!flushResponses(c->fd, c->out, SEND_TIMEOUT))
+			open = false;
+		if(open) {
+			{
+				std::lock_guard<std::mutex> guard(rearmMutex);
+				rearm.push_back(c);
+			}
+			wakePoller();
+		}
+		else {
+			close(c->fd);
+			delete c;
+		}
+	}
+}
+
+/*
+ * Writer thread. Applies every queued write under one acquisition of the
+ * exclusive lock, so writes are serialized and grouped under load.
+ */
+static void writer() {
+	std::deque<WriteJob*> batch;
+	while(true) {
+		{
+			std::unique_lock<std::mutex> guard(writeMutex);
+			writeCv.wait(guard, []{ return !writes.empty() || !writerRunning; });
+			if(writes.empty())
+				return;
+			batch.swap(writes);
+		}
+		std::vector<std::string> out(batch.size());
+		bool due = false;
+		pthread_rwlock_wrlock(&graphLock);
+		for(size_t i = 0; i < batch.size(); ++i) {
+			serveWrite(graph, graphFile, batch[i]->req, out[i],
+					journal.isOpen() ? &journal : NULL);
+		}
+
+		// one commit, and at most one flush, covers the whole batch
+		if(journal.commit() != 0)
+			std::cerr << failJournal << graphFile << journalExt << std::endl;
+		due = journal.needsCheckpoint();
+		pthread_rwlock_unlock(&graphLock);
+		for(size_t i = 0; i < batch.size(); ++i) {
+			batch[i]->result.set_value(out[i]);
+		}
+		batch.clear();
+		if(due) {
+			std::lock_guard<std::mutex> guard(checkpointMutex);
+			checkpointDue = true;
+			checkpointCv.notify_one();
+		}
+	}
+}
+
+/*
+ * Checkpointer thread. Folds the journal into a new graph file when the
+ * writer finds it due. Holds the shared lock throughout, so writes wait for
+ * the checkpoint but reads are not held up by it.
+ */
+static void checkpointer() {
+	while(true) {
+		{
+			std::unique_lock<std::mutex> guard(checkpointMutex);
+			checkpointCv.wait(guard, []{ return checkpointDue || !writerRunning; });
+			if(!checkpointDue)
+				return;
+			checkpointDue = false;
+		}
+		pthread_rwlock_rdlock(&graphLock);
+		if(journal.needsCheckpoint())
+			journal.checkpoint(graph);
+		pthread_rwlock_unlock(&graphLock);
+	}
+}
+
+/*
+ * Poller, run on the main thread. Accepts new clients and dispatches idle
+ * connections to the workers once they become readable.
+ */
+static void poller(int listenFd) {
+	std::vector<Connection*> idle;
+	std::vector<struct pollfd> fds;
+	while(running) {
+		fds.clear();
+		fds.push_back({listenFd, POLLIN, 0});
+		fds.push_back({wakePipe[0], POLLIN, 0});
+		for(size_t i = 0; i < idle.size(); ++i) {
+			fds.push_back({idle[i]->fd, POLLIN, 0});
+		}
+		if(poll(fds.data(), fds.size(), -1) == -1) {
+			if(errno == EINTR)
+				continue;
+			break;
+		}
+		std::vector<Connection*> stillIdle;
+		for(size_t i = 0; i < idle.size(); ++i) {
+			if(fds[i+2].revents) {
+				std::lock_guard<std::mutex> guard(readyMutex);
+				ready.push_back(idle[i]);
+				readyCv.notify_one();
+			}
+			else
+				stillIdle.push_back(idle[i]);
+		}
+		idle.swap(stillIdle);
+		if(fds[1].revents) {
+			char buf[256];
+			while(read(wakePipe[0], buf, sizeof(buf)) > 0);
+			std::lock_guard<std::mutex> guard(rearmMutex);
+			idle.insert(idle.end(), rearm.begin(), rearm.end());
+			rearm.clear();
+		}
+		if(fds[0].revents) {
+			int fd;
+			while((fd = accept(listenFd, NULL, NULL)) != -1) {
+				fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+				Connection* c = new Connection;
+				c->fd = fd;
+				idle.push_back(c);
+			}
+		}
+	}
+	for(size_t i = 0; i < idle.size(); ++i) {
+		close(idle[i]->fd);
+		delete idle[i];
+	}
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// MAIN                                                                    //
+/////////////////////////////////////////////////////////////////////////////
+
+int main(int argc, char** argv) {
+	if(argc < 3 || argc > 5) {
+		std::cerr << serverUsage << std::endl;
+		return 1;
+	}
+	graphFile = argv[1];
+	std::string sockPath(argv[2]);
+	unsigned workers = std::thread::hardware_concurrency();
+	if(argc >= 4)
+		workers = std::atoi(argv[3]);
+	if(workers == 0)
+		workers = 1;
+	SyncPolicy policy;
+	if(argc == 5 && parseSyncPolicy(argv[4], policy) != 0) {
+		std::cerr << serverUsage << std::endl;
+		return 1;
+	}
+
+	size_t replayed;
+	if(loadJournaled(graphFile, graph, replayed) != 0) {
+		std::cerr << failServerLoad << graphFile << std::endl;
+		return 1;
+	}
+	if(argc == 5 && journal.open(graphFile, policy) != 0) {
+		std::cerr << failJournal << graphFile << journalExt << std::endl;
+		return 1;
+	}
+
+	struct sockaddr_un addr;
+	std::memset(&addr, 0, sizeof(addr));
+	addr.sun_family = AF_UNIX;
+	if(sockPath.size() >= sizeof(addr.sun_path)) {
+		std::cerr << failSocket << sockPath << std::endl;
+		return 1;
+	}
+	std::strcpy(addr.sun_path, sockPath.c_str());
+	unlink(sockPath.c_str());
+	int listenFd = socket(AF_UNIX, SOCK_STREAM, 0);
+	if(listenFd == -1 || bind(listenFd, (struct sockaddr*)&addr,
+			sizeof(addr)) == -1 || listen(listenFd, SOMAXCONN) == -1) {
+		std::cerr << failSocket << sockPath << ": " << std::strerror(errno)
+			<< std::endl;
+		return 1;
+	}
+	fcntl(listenFd, F_SETFL, fcntl(listenFd, F_GETFL) | O_NONBLOCK);
+
+	if(pipe(wakePipe) == -1)
+		return 1;
+	fcntl(wakePipe[0], F_SETFL, fcntl(wakePipe[0], F_GETFL) | O_NONBLOCK);
+	fcntl(wakePipe[1], F_SETFL, fcntl(wakePipe[1], F_GETFL) | O_NONBLOCK);
+
+	pthread_rwlockattr_t attr;
+	pthread_rwlockattr_init(&attr);
+#ifdef __GLIBC__
+	// keep a steady stream of readers from starving the writer
+	pthread_rwlockattr_setkind_np(&attr,
+			PTHREAD_RWLOCK_PREFER_WRITER_NONRECURSIVE_NP);
+#endif
+	pthread_rwlock_init(&graphLock, &attr);
+
+	std::signal(SIGINT, onSignal);
+	std::signal(SIGTERM, onSignal);
+	std::signal(SIGPIPE, SIG_IGN);
+
+	std::vector<std::thread> pool;
+	for(unsigned i = 0; i < workers; ++i) {
+		pool.push_back(std::thread(worker));
+	}
+	std::thread writeThread(writer);
+	std::thread checkpointThread(checkpointer);
+	std::cout << serverReady << sockPath << " (" << graph.getVertexCount()
+		<< " vertices, " << workers << " workers)" << std::endl;
+
+	poller(listenFd);
+
+	running = false;
+	readyCv.notify_all();
+	for(size_t i = 0; i < pool.size(); ++i) {
+		pool[i].join();
+	}
+	writerRunning = false;
+	writeCv.notify_all();
+	writeThread.join();
+	{
+		std::lock_guard<std::mutex> guard(checkpointMutex);
+		checkpointCv.notify_all();
+	}
+	checkpointThread.join();
+	journal.close();
+	for(size_t i = 0; i < rearm.size(); ++i) {
+		close(rearm[i]->fd);
+		delete rearm[i];
+	}
+	close(listenFd);
+	unlink(sockPath.c_str());
+	pthread_rwlock_destroy(&graphLock);
+	std::cout << serverDone << served << std::endl;
+	return 0;
+}
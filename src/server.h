@@ -0,0 +1,138 @@
+#pragma once
+
+#include "Graph.h"
+#include "Journal.h"
+#include <string>
+
+/////////////////////////////////////////////////////////////////////////////
+// PROTOCOL                                                                //
+/////////////////////////////////////////////////////////////////////////////
+
+/*
+ * The query daemon speaks a line protocol over a Unix domain socket. Each
+ * request and each response is a single line terminated by '\n', whose
+ * fields are separated by '\t' (vertex keys may contain spaces). A client may
+ * pipeline any number of requests before reading responses; responses are
+ * always returned in request order.
+ *
+ * The first field of every response is a status code. Unless noted, the codes
+ * are the return values of the matching WeightedDigraph function.
+ *
+ *    ---> E <vertex 1> <vertex 2>
+ *       Edge lookup. Responds "1 <weight>" if the edge exists, "0" if it does
+ *       not, and "-1" if either vertex does not exist.
+ *
+ *    ---> N <vertex>
+ *       Neighbor query. Responds "1 <neighbor 1> <neighbor 2> ..." or "-1"
+ *       if the vertex does not exist.
+ *
+ *    ---> P <bfs|ucs|iddfs> <vertex 1> <vertex 2>
+ *       Path query. Responds "1 <cost> <vertex 1> ... <vertex 2>", "0" if no
+ *       path exists, and "-1" if either vertex does not exist.
+ *
+ *    ---> V <vertex>               (write) addVertex, responds "1" or "0"
+ *    ---> X <vertex>               (write) removeVertex, responds "1" or "0"
+ *    ---> S <vertex 1> <vertex 2> <weight>
+ *                                  (write) setEdge
+ *    ---> R <vertex 1> <vertex 2>  (write) removeEdge
+ *    ---> W                        (write) fileWrite to the file served, or
+ *                                  a checkpoint of its journal
+ *
+ * Given a sync policy, the server journals every write (see Journal.h). The
+ * writes the writer thread applies together are committed together, before
+ * any of them is answered, and the journal is checkpointed in the background
+ * once it outgrows the graph file.
+ *
+ * Malformed requests are answered with "?".
+ */
+
+const char fieldSep = '\t';
+const char recordSep = '\n';
+
+const char edgeReq = 'E';
+const char neighborReq = 'N';
+const char pathReq = 'P';
+const char addVertexReq = 'V';
+const char removeVertexReq = 'X';
+const char setEdgeReq = 'S';
+const char removeEdgeReq = 'R';
+const char writeReq = 'W';
+
+const std::string badRequest("?");
+
+const std::string bfsAlgo("bfs");
+const std::string ucsAlgo("ucs");
+const std::string iddfsAlgo("iddfs");
+
+// Server Messages
+const std::string serverUsage("usage: server <graph_file> <socket_path> [workers] [always|interval|never]");
+const std::string failServerLoad("Unable to load graph: ");
+const std::string failSocket("Unable to listen on socket: ");
+const std::string serverReady("Serving graph on ");
+const std::string failJournal("Unable to append writes to the journal: ");
+const std::string serverDone("Served requests: ");
+
+/////////////////////////////////////////////////////////////////////////////
+// SERVER FUNCTIONS                                                        //
+/////////////////////////////////////////////////////////////////////////////
+
+/*
+ * Determines whether a request mutates the graph, and must therefore be
+ * handed to the single writer rather than served by a reader.
+ *
+ * @param req, the request line without its terminator
+ *
+ * @return true if the request is a write
+ */
+bool isWriteRequest(const std::string& req);
+
+/*
+ * Serves a single read request against the graph and appends the response
+ * line, including its terminator, to out. The caller must hold at least a
+ * shared lock on the graph.
+ *
+ * @param g, the graph to query
+ * @param req, the request line without its terminator
+ * @param out, the response buffer appended to by reference
+ */
+void serveRead(const WeightedDigraph& g, const std::string& req,
+		std::string& out);
+
+/*
+ * Applies a single write request to the graph and appends the response line,
+ * including its terminator, to out. The caller must hold the exclusive lock
+ * on the graph.
+ *
+ * @param g, the graph to modify
+ * @param file, the file the graph was loaded from, used by W requests
+ * @param req, the request line without its terminator
+ * @param out, the response buffer appended to by reference
+ * @param j, the journal successful writes are logged to, or NULL; the caller
+ * commits it
+ */
+void serveWrite(WeightedDigraph& g, const std::string& file,
+		const std::string& req, std::string& out, Journal* j = NULL);
+
+/*
+ * Reads whatever a client has sent on a nonblocking socket, up to a fixed
+ * share per call so one busy client cannot starve others.
+ *
+ * @param fd, the client socket
+ * @param in, the buffer appended to by reference
+ *
+ * @return false if the client has hung up, the connection failed or the
+ * client sent too large a request
+ */
+bool readAvailable(int fd, std::string& in);
+
+/*
+ * Writes every buffered response back to a client and clears the buffer.
+ *
+ * @param fd, the client socket
+ * @param out, the responses to write
+ * @param timeout, the milliseconds to wait for the client to accept more
+ * before giving up
+ *
+ * @return false if the connection failed or the client stopped reading
+ */
+bool flushResponses(int fd, std::string& out, int timeout);
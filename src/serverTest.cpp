@@ -0,0 +1,181 @@
+#include <iostream>
+#include <cstdio>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/socket.h>
+
+#include "Graph.h"
+#include "server.h"
+#include "gtest/gtest.h"
+
+const std::string goodFile = "../graphFiles/test.graph";
+const std::string writeFile = "serverTest.graph";
+
+/*
+ * ServerTest
+ *
+ * Performs the following tests on the query daemon's request handling.
+ *     -ReadRequests
+ *     -WriteRequests
+ *     -Malformed
+ *     -StalledClient
+ *     -HangUp
+ */
+
+/*
+ * Graph should look as follows after loading from test.graph.
+ *
+ * Boston --> New York[19], Los Angeles[4]
+ * New York --> Miami[10], Houston[28], Hartford[12]
+ * Miami --> Boston[4], San Francisco[9]
+ * San Francisco --> Boston[20], New York[6], Houston[1]
+ * Los Angeles --> Miami[29]
+ * Houston --> Los Angeles[13]
+ * Hartford
+ */
+
+/*
+ * Sends pipelined requests from the client end of a socket pair, serves them
+ * at the other end as the daemon's workers do and reads back the responses.
+ */
+static std::string roundTrip(WeightedDigraph& g,
+		const std::string& requests) {
+	int fds[2];
+	EXPECT_EQ(socketpair(AF_UNIX, SOCK_STREAM, 0, fds), 0);
+	fcntl(fds[1], F_SETFL, O_NONBLOCK);
+	EXPECT_EQ(write(fds[0], requests.data(), requests.size()),
+			(ssize_t)requests.size());
+
+	std::string in, out;
+	EXPECT_TRUE(readAvailable(fds[1], in));
+	EXPECT_EQ(in, requests);
+	size_t start = 0;
+	size_t end;
+	while((end = in.find(recordSep, start)) != std::string::npos) {
+		std::string req = in.substr(start, end - start);
+		if(isWriteRequest(req))
+			serveWrite(g, writeFile, req, out);
+		else
+			serveRead(g, req, out);
+		start = end + 1;
+	}
+	EXPECT_TRUE(flushResponses(fds[1], out, 1000));
+	EXPECT_TRUE(out.empty());
+	close(fds[1]);
+
+	std::string res;
+	char buf[4096];
+	ssize_t n;
+	while((n = read(fds[0], buf, sizeof(buf))) > 0) {
+		res.append(buf, n);
+	}
+	close(fds[0]);
+	return res;
+}
+
+TEST(ServerTest, ReadRequests) {
+	WeightedDigraph a;
+	ASSERT_EQ(a.fileLoad(goodFile), 0);
+	std::string res = roundTrip(a,
+			"E\tBoston\tNew York\n"
+			"E\tHartford\tBoston\n"
+			"E\tBoston\tDenver\n"
+			"N\tSan Francisco\n"
+			"N\tHartford\n"
+			"N\tDenver\n"
+			"P\tbfs\tBoston\tHartford\n"
+			"P\tucs\tHartford\tBoston\n"
+			"P\tiddfs\tDenver\tBoston\n");
+	EXPECT_EQ(res,
+			"1\t19\n"
+			"0\n"
+			"-1\n"
+			"1\tBoston\tNew York\tHouston\n"
+			"1\n"
+			"-1\n"
+			"1\t31\tBoston\tNew York\tHartford\n"
+			"0\n"
+			"-1\n");
+}
+
+TEST(ServerTest, WriteRequests) {
+	WeightedDigraph a, b;
+	ASSERT_EQ(a.fileLoad(goodFile), 0);
+	EXPECT_TRUE(isWriteRequest("V\tDenver"));
+	EXPECT_TRUE(isWriteRequest("W"));
+	EXPECT_FALSE(isWriteRequest("E\tBoston\tMiami"));
+	EXPECT_FALSE(isWriteRequest(""));
+
+	std::string res = roundTrip(a,
+			"V\tDenver\n"
+			"V\tDenver\n"
+			"S\tDenver\tBoston\t7\n"
+			"S\tDenver\tChicago\t7\n"
+			"E\tDenver\tBoston\n"
+			"R\tBoston\tNew York\n"
+			"X\tHartford\n"
+			"X\tHartford\n"
+			"W\n");
+	EXPECT_EQ(res, "1\n0\n0\n-1\n1\t7\n0\n1\n0\n0\n");
+	EXPECT_EQ(a.getWeight(a.getOffset("Denver"), a.getOffset("Boston")), 7);
+	EXPECT_EQ(a.getWeight(a.getOffset("Boston"), a.getOffset("New York")), NWT);
+	EXPECT_EQ(a.getOffset("Hartford"), -1);
+
+	ASSERT_EQ(b.fileLoad(writeFile), 0);
+	EXPECT_EQ(b.getWeight(b.getOffset("Denver"), b.getOffset("Boston")), 7);
+	EXPECT_EQ(b.getOffset("Hartford"), -1);
+	std::remove(writeFile.c_str());
+}
+
+TEST(ServerTest, Malformed) {
+	WeightedDigraph a;
+	ASSERT_EQ(a.fileLoad(goodFile), 0);
+	std::string res = roundTrip(a,
+			"\n"
+			"EE\tBoston\tMiami\n"
+			"E\tBoston\n"
+			"P\tdfs\tBoston\tMiami\n"
+			"Q\tBoston\n"
+			"S\tBoston\tMiami\tfar\n"
+			"S\tBoston\tMiami\t40000\n"
+			"V\t\n");
+	EXPECT_EQ(res, "?\n?\n?\n?\n?\n?\n?\n?\n");
+	EXPECT_EQ(a.getWeight(a.getOffset("Boston"), a.getOffset("Miami")), NWT);
+}
+
+TEST(ServerTest, StalledClient) {
+	int fds[2];
+	ASSERT_EQ(socketpair(AF_UNIX, SOCK_STREAM, 0, fds), 0);
+	fcntl(fds[1], F_SETFL, O_NONBLOCK);
+	int size = 4096;
+	setsockopt(fds[1], SOL_SOCKET, SO_SNDBUF, &size, sizeof(size));
+
+	// the client never reads, so the responses cannot all be sent
+	std::string out(8 << 20, 'x');
+	EXPECT_FALSE(flushResponses(fds[1], out, 100));
+	close(fds[0]);
+	close(fds[1]);
+}
+
+TEST(ServerTest, HangUp) {
+	int fds[2];
+	std::string in;
+	ASSERT_EQ(socketpair(AF_UNIX, SOCK_STREAM, 0, fds), 0);
+	fcntl(fds[1], F_SETFL, O_NONBLOCK);
+
+	// nothing sent yet
+	EXPECT_TRUE(readAvailable(fds[1], in));
+	EXPECT_TRUE(in.empty());
+
+	ASSERT_EQ(write(fds[0], "N\tBoston\n", 9), 9);
+	close(fds[0]);
+	EXPECT_FALSE(readAvailable(fds[1], in));
+	EXPECT_EQ(in, "N\tBoston\n");
+	close(fds[1]);
+}
+
+int main(int argc, char** argv) {
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
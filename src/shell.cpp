@@ -1,13 +1,33 @@
 #include "shell.h"
+#include "Stats.h"
+#include "DAG.h"
+#include "SCC.h"
+#include "PageRank.h"
+#include "Reorder.h"
+#include "Journal.h"
+#include "Workspace.h"
+#include "Save.h"
+#include "Extract.h"
 #include <fstream>
+#include <algorithm>
 #include <iostream>
 #include <cstdlib>
+#include <cstdio>
+#include <iomanip>
 #include <stdexcept>
 
+static Workspace workspace;
+static WeightedDigraph* graph;  // the current graph, held by workspace
+static std::string current;     // name of the current graph in workspace
+static Journal journal;
+static BackgroundSave save;
+static std::string graphName;   // file the graph was loaded from or written to
+static std::string savedGraph;  // graph renamed once the running save is done
+static std::stringstream tokenizer;
+static std::string token;
+static std::string line;
+
 int main() {
-	WeightedDigraph graph;
-	std::stringstream tokenizer;
-	std::string token;
   mainShell();
   return 0;
 }
@@ -16,6 +36,7 @@ void mainShell() {
 	bool exitShell = false;
 	std::cout << welcomeMessage << std::endl;
 	while(!exitShell) {
+		pollSave();
 		std::cout << mainMessage << std::endl;
     std::cout << prompt;
     std::getline(std::cin, line);
@@ -27,8 +48,30 @@ void mainShell() {
         cmd.arg = token;
         if(tokenizer >> token)
         	std::cout << invalidCmd << std::endl << std::endl;
-        else if(cmd.op == loadCmd){
-          switch(graph.fileLoad(graphLoc + cmd.arg)) {
+        else if(cmd.op == loadCmd || cmd.op == lazyCmd) {
+          size_t replayed;
+          std::string name = cmd.arg.substr(0, cmd.arg.rfind('.'));
+
+          // a graph held under the same name is replaced only by a load
+          // that succeeds
+          WeightedDigraph* loaded = workspace.create(loadingName);
+          int status = loadJournaled(graphLoc + cmd.arg, *loaded, replayed,
+              cmd.op == lazyCmd);
+          if(status == 0 || status == -3) {
+            if(workspace.close(name))
+              std::cout << std::endl << replaceMessage << name;
+            workspace.rename(loadingName, name);
+            current = name;
+            graphName = graphLoc + cmd.arg;
+            workspace.setFile(current, graphName);
+            workspace.pin(current);
+            graph = workspace.get(current);
+            if(replayed > 0)
+              std::cout << std::endl << replayMessage << replayed;
+          }
+          else
+            workspace.close(loadingName);
+          switch(status) {
             case -1:
               std::cout << failLoad << failLoad_n1 << cmd.arg
 								<< std::endl << std::endl;;
@@ -37,6 +80,14 @@ void mainShell() {
               std::cout << failLoad << failLoad_n2 << cmd.arg
 								<< std::endl << std::endl;
             	break;
+            case -4:
+              std::cout << failLoad << failLoad_n4 << cmd.arg
+								<< std::endl << std::endl;
+            	break;
+            case -3:
+              std::cout << partialLoad << cmd.arg << std::endl << std::endl;
+              liveShell();
+              break;
             case 0:
               std::cout << goodLoad << cmd.arg << std::endl << std::endl;
               liveShell();
@@ -57,7 +108,12 @@ void mainShell() {
 				std::cout << std::endl;
 			}
       else if(cmd.op == newCmd) {
-				graph.clear();
+				current = untitledName;
+				for(int i = 2; workspace.contains(current); ++i)
+					current = untitledName + std::to_string(i);
+				graph = workspace.create(current);
+				workspace.pin(current);
+				graphName.clear();
 				std::cout << std::endl;
         liveShell();
       }
@@ -82,10 +138,16 @@ void liveShell() {
         if(tokenizer >> token) {
 					cmd.arg = token;
 					if(cmd.op == writeCmd) {
-						if(graph.isEmpty())
+						if(graph->isEmpty())
 							std::cout << emptyWrite << std::endl;
+						else if(journal.isOpen() && graphLoc + cmd.arg == graphName) {
+							if(journal.checkpoint(*graph) == 0)
+								std::cout << goodWrite << cmd.arg << std::endl;
+							else
+								std::cout << failWrite << failWrite_n1 << cmd.arg << std::endl;
+						}
 						else {
-							switch(graph.fileWrite(graphLoc + cmd.arg)) {
+							switch(save.start(*graph, graphLoc + cmd.arg)) {
 								case -1:
 									std::cout << failWrite << failWrite_n1 <<
 									cmd.arg << std::endl;							
@@ -94,8 +156,12 @@ void liveShell() {
 									std::cout << failWrite << failWrite_n2 <<
 									cmd.arg << std::endl;
 									break;
+								case -4:
+									std::cout << saveBusy << save.getFile() << std::endl;
+									break;
 								case 0:
-									std::cout << goodWrite << cmd.arg << std::endl;	
+									std::cout << saveStarted << cmd.arg << std::endl;	
+									savedGraph = journal.isOpen() ? "" : current;
 							}
 						}
 					}
@@ -104,10 +170,12 @@ void liveShell() {
 						line = line.substr(line.find_first_of(addCmd)+3);
 						tokenizeString(tokens, line, ',');
 						for(size_t i = 0; i < tokens.size(); ++i) {
-							if(!graph.addVertex(tokens[i]))
+							if(!graph->addVertex(tokens[i]))
 								std::cout << failAddVertex << tokens[i] << std::endl;
-							else
+							else {
+								journal.logAddVertex(tokens[i]);
 								std::cout << successVertexAdd << tokens[i] << std::endl;
+							}
 						}
 						std::cout << std::endl;
 					}
@@ -116,10 +184,12 @@ void liveShell() {
 						line = line.substr(line.find_first_of(removeCmd)+6);
 						tokenizeString(tokens, line, ',');
 						for(size_t i = 0; i < tokens.size(); ++i) {
-							if(!graph.removeVertex(tokens[i]))
+							if(!graph->removeVertex(tokens[i]))
 								std::cout << failRemoveVertex << tokens[i] << std::endl;
-							else
+							else {
+								journal.logRemoveVertex(tokens[i]);
 								std::cout << successVertexRemove << tokens[i] << std::endl;
+							}
 						}
 						std::cout << std::endl;
 					}
@@ -132,21 +202,23 @@ void liveShell() {
 						else {
 							try {
 						  	Weight t = std::stoi(tokens[2]);
-						  	switch(graph.setEdge(tokens[0],tokens[1],t)) {
+						  	switch(graph->setEdge(tokens[0],tokens[1],t)) {
 							  	case -1:
 								  	std::cout << failVertexExist << tokens[0] << 
 										", or " << tokens[1] << std::endl << std::endl;
 								  	break;
 							  	case 1:
+								  	journal.logSetEdge(tokens[0], tokens[1], t);
 								  	std::cout << overwriteEdge << tokens[0] << ", "
 										<< tokens[1] << "[" << t << "]" << std::endl << std::endl;
 								  	break;
 							  	case 0:
+								  	journal.logSetEdge(tokens[0], tokens[1], t);
 								  	std::cout << successEdge << tokens[0] << ", " 
 										<< tokens[1] << "[" << t << "]" << std::endl << std::endl;
 						  	}
 							} 
-							catch(std::exception) {
+							catch(std::exception&) {
 								std::cout << invalidCmd << std::endl << std::endl;
 							}
 						}
@@ -158,7 +230,7 @@ void liveShell() {
 						if(tokens.size() != 2)
 							std::cout << invalidCmd << std::endl << std::endl;
 						else {
-							switch(graph.removeEdge(tokens[0],tokens[1])) {
+							switch(graph->removeEdge(tokens[0],tokens[1])) {
 								case -1:
 									std::cout << failVertexExist << tokens[0] <<
 								  ", or " << tokens[1] << std::endl << std::endl;
@@ -168,11 +240,121 @@ void liveShell() {
 								  << tokens[1] << std::endl << std::endl;
 									break;
 								case 0:
+									journal.logRemoveEdge(tokens[0], tokens[1]);
 									std::cout << successRemove << tokens[0] << ", "
 								  << tokens[1] << std::endl << std::endl;
 							}
 						}
 					}
+					else if(cmd.op == statsCmd) {
+						if(cmd.arg == onArg) {
+							setStatsEnabled(true);
+							std::cout << statsOnMessage << std::endl << std::endl;
+						}
+						else if(cmd.arg == offArg) {
+							setStatsEnabled(false);
+							std::cout << statsOffMessage << std::endl << std::endl;
+						}
+						else if(cmd.arg == resetArg) {
+							resetStats();
+							std::cout << statsResetMessage << std::endl << std::endl;
+						}
+						else if(writeStats(cmd.arg) == 0)
+							std::cout << goodWrite << cmd.arg << std::endl << std::endl;
+						else
+							std::cout << failWrite << failWrite_n1 << cmd.arg
+								<< std::endl << std::endl;
+					}
+					else if(cmd.op == journalCmd) {
+						SyncPolicy p;
+						if(cmd.arg == offArg) {
+							journal.close();
+							std::cout << journalOffMessage << std::endl << std::endl;
+						}
+						else if(parseSyncPolicy(cmd.arg, p) != 0)
+							std::cout << invalidCmd << std::endl << std::endl;
+						else if(graphName.empty())
+							std::cout << journalUnnamed << std::endl << std::endl;
+						else if(journal.open(graphName, p) != 0 ||
+								journal.checkpoint(*graph) != 0) {
+							journal.close();
+							std::cout << failWrite_n1 << graphName << journalExt
+								<< std::endl << std::endl;
+						}
+						else {
+							// the journaled file stays the graph's, whatever a save
+							// still running writes
+							if(savedGraph == current)
+								savedGraph.clear();
+							std::cout << journalOnMessage << graphName << journalExt
+								<< std::endl << std::endl;
+						}
+					}
+					else if(cmd.op == degreeCmd) {
+						Key k = trim(line.substr(line.find(degreeCmd) + degreeCmd.size()));
+						int p = graph->getOffset(k);
+						if(p == -1)
+							std::cout << failVertexExist << k << std::endl << std::endl;
+						else
+							std::cout << k << ": " << outDegreeMessage << graph->getOutDegree(p)
+								<< ", " << inDegreeMessage << graph->getInDegree(p)
+								<< std::endl << std::endl;
+					}
+					else if(cmd.op == useCmd) {
+						WeightedDigraph* g = cmd.arg == current ? graph :
+							workspace.get(cmd.arg);
+						if(g == NULL)
+							std::cout << failGraphExist << cmd.arg << std::endl << std::endl;
+						else {
+							if(cmd.arg != current && journal.isOpen()) {
+								journal.close();
+								std::cout << journalOffMessage << std::endl;
+							}
+							graph = g;
+							current = cmd.arg;
+							workspace.pin(current);
+							graphName = workspace.getFile(current);
+							std::cout << useMessage << current << std::endl << std::endl;
+						}
+					}
+					else if(cmd.op == closeCmd) {
+						if(cmd.arg == current)
+							std::cout << failCloseCurrent << std::endl << std::endl;
+						else if(!workspace.close(cmd.arg))
+							std::cout << failGraphExist << cmd.arg << std::endl << std::endl;
+						else
+							std::cout << closeMessage << cmd.arg << std::endl << std::endl;
+					}
+					else if(cmd.op == copyCmd) {
+						if(workspace.copy(current, cmd.arg) == NULL)
+							std::cout << failCopy << cmd.arg << std::endl << std::endl;
+						else
+							std::cout << copyMessage << cmd.arg << std::endl << std::endl;
+					}
+					else if(cmd.op == budgetCmd) {
+						try {
+							workspace.setBudget((size_t)std::stoul(cmd.arg) << 20);
+							std::cout << budgetMessage << formatBytes(workspace.getBudget())
+								<< std::endl << std::endl;
+						}
+						catch(std::exception&) {
+							std::cout << invalidCmd << std::endl << std::endl;
+						}
+					}
+					else if(cmd.op == reorderCmd) {
+						Ordering o;
+						CSRGraph c;
+						if(parseOrdering(cmd.arg, o) != 0)
+							std::cout << invalidCmd << std::endl << std::endl;
+						else {
+							buildCSR(*graph, c);
+							Offset before = bandwidth(c);
+							reorderGraph(*graph, o);
+							buildCSR(*graph, c);
+							std::cout << reorderMessage << before << " -> "
+								<< bandwidth(c) << std::endl << std::endl;
+						}
+					}
 					else
 				  	std::cout << invalidCmd << std::endl << std::endl;
       	}
@@ -182,19 +364,95 @@ void liveShell() {
 				else if(cmd.op == helpCmd)
           std::cout << helpMessage_live << std::endl << std::endl;
 				else if(cmd.op == adjCmd) {
-					graph.printAdjList();
+					graph->printAdjList();
 					std::cout << std::endl;
 				}
 				else if(cmd.op == matrixCmd) {
-					graph.printAdjMatrix();	
+					graph->printAdjMatrix();	
+					std::cout << std::endl;
+				}
+				else if(cmd.op == memCmd) {
+					std::vector<MemComponent> m;
+					graph->memoryUsage(m);
+					MemComponent total = {"total", 0, 0};
+					std::cout << std::left << std::setw(16) << "component" << std::right
+						<< std::setw(12) << "live" << std::setw(12) << "slack"
+						<< std::setw(12) << "total" << std::endl;
+					m.push_back(total);
+					for(size_t i = 0; i < m.size(); ++i) {
+						if(i + 1 < m.size()) {
+							m.back().live += m[i].live;
+							m.back().slack += m[i].slack;
+						}
+						std::cout << std::left << std::setw(16) << m[i].name << std::right
+							<< std::setw(12) << formatBytes(m[i].live)
+							<< std::setw(12) << formatBytes(m[i].slack)
+							<< std::setw(12) << formatBytes(m[i].live + m[i].slack)
+							<< std::endl;
+					}
+					std::cout << std::endl;
+				}
+				else if(cmd.op == graphsCmd) {
+					std::vector<GraphInfo> g;
+					workspace.list(g);
+					std::cout << std::left << std::setw(2) << "" << std::setw(20) << "graph"
+						<< std::setw(10) << "state" << std::right << std::setw(12) << "memory"
+						<< "  file" << std::endl;
+					for(size_t i = 0; i < g.size(); ++i) {
+						std::cout << std::left << std::setw(2) << (g[i].name == current ? "*" : "")
+							<< std::setw(20) << g[i].name
+							<< std::setw(10) << (g[i].resident ? "resident" : "evicted")
+							<< std::right << std::setw(12) << formatBytes(g[i].bytes)
+							<< "  " << g[i].file << std::endl;
+					}
+					std::cout << budgetMessage << formatBytes(workspace.getBudget())
+						<< std::endl << std::endl;
+				}
+				else if(cmd.op == degreeCmd) {
+					const std::vector<Offset>& out = graph->getDegreeHistogram(false);
+					const std::vector<Offset>& in = graph->getDegreeHistogram(true);
+					std::cout << vertexCountMessage << graph->getVertexCount() << ", "
+						<< edgeCountMessage << graph->getEdgeCount() << std::endl;
+					std::cout << std::setw(8) << "degree" << std::setw(12) << "out"
+						<< std::setw(12) << "in" << std::endl;
+					for(size_t d = 0; d < std::max(out.size(), in.size()); ++d) {
+						Offset o = d < out.size() ? out[d] : 0;
+						Offset i = d < in.size() ? in[d] : 0;
+						if(o > 0 || i > 0)
+							std::cout << std::setw(8) << d << std::setw(12) << o
+								<< std::setw(12) << i << std::endl;
+					}
+					std::cout << std::endl;
+				}
+				else if(cmd.op == saveCmd) {
+					printSave();
+					std::cout << std::endl;
+				}
+				else if(cmd.op == materializeCmd) {
+					Offset pending = graph->getPendingCount();
+					size_t skipped = graph->materialize();
+					std::cout << materializeMessage << pending << std::endl;
+					if(skipped > 0)
+						std::cout << partialLoad << skipped << std::endl;
+					std::cout << std::endl;
+				}
+				else if(cmd.op == compactCmd) {
+					std::cout << compactMessage << formatBytes(graph->compact())
+						<< std::endl << std::endl;
+				}
+				else if(cmd.op == statsCmd) {
+					if(!statsEnabled())
+						std::cout << statsOffMessage << std::endl;
+					printStats();
 					std::cout << std::endl;
 				}
 				else if(cmd.op == algoCmd) {
-					std::cout << "Algos shell" << std::endl;
-					// algorithmShell();
+					std::cout << std::endl;
+					algorithmShell();
 				}
 				else if(cmd.op == quitCmd) {
 					std::cout << std::endl;
+					journal.close();
 					exitShell = true;
 				}
 				else
@@ -202,9 +460,337 @@ void liveShell() {
       }
 			else
         std::cout << invalidCmd << std::endl << std::endl;
+
+			// every command's edits are committed together
+			if(journal.commit() != 0)
+				std::cout << journalFailMessage << std::endl << std::endl;
+			else if(journal.needsCheckpoint())
+				journal.checkpoint(*graph);
+
+			pollSave();
+
+			// keeps the current graph most recently used, evicting others if
+			// it has grown past the budget
+			graph = workspace.get(current);
     } 
 }
 
+void algorithmShell() {
+	bool exitShell = false;
+	CSRGraph csr;
+	buildCSR(*graph, csr);
+	while(!exitShell) {
+		std::cout << algoMessage << std::endl;
+		std::cout << prompt;
+		std::getline(std::cin, line);
+		clearBuffer(tokenizer);
+		tokenizer.str(line);
+		if(tokenizer >> token) {
+			cmd.op = token;
+			if(tokenizer >> token) {
+				std::vector<std::string> tokens;
+				cmd.arg = token;
+				line = line.substr(line.find(cmd.op) + cmd.op.size());
+				tokenizeString(tokens, line, ',');
+				size_t args = cmd.op == dfsCmd ? 3 : 2;
+				int s1 = tokens.size() == args ? graph->getOffset(tokens[0]) : -1;
+				int s2 = tokens.size() == args ? graph->getOffset(tokens[1]) : -1;
+				Path p;
+				if(cmd.op == pagerankCmd) {
+					std::vector<double> rank;
+					std::vector<Score> s;
+					pageRank(csr, RankOptions(), rank);
+					sortRanks(rank, s);
+					if(writeRanks(*graph, s, cmd.arg) == 0)
+						std::cout << goodWrite << cmd.arg << std::endl << std::endl;
+					else
+						std::cout << failWrite << failWrite_n1 << cmd.arg
+							<< std::endl << std::endl;
+				}
+				else if(cmd.op == pprCmd) {
+					int seed = graph->getOffset(tokens[0]);
+					std::vector<Score> s;
+					if(tokens.size() > 2)
+						std::cout << invalidCmd << std::endl << std::endl;
+					else if(seed == -1)
+						std::cout << failVertexExist << tokens[0] << std::endl << std::endl;
+					else {
+						personalizedPageRank(csr, seed, RankOptions(), s);
+						sortRanks(s);
+						if(tokens.size() == 1)
+							printRanks(s);
+						else if(writeRanks(*graph, s, tokens[1]) == 0)
+							std::cout << goodWrite << tokens[1] << std::endl << std::endl;
+						else
+							std::cout << failWrite << failWrite_n1 << tokens[1]
+								<< std::endl << std::endl;
+					}
+				}
+				else if(cmd.op == khopCmd) {
+					int seed = graph->getOffset(tokens[0]);
+					bool toFile = tokens.size() == 3 || tokens.size() == 5;
+					EdgeFilter f;
+					Subgraph sub;
+					unsigned hops = 0;
+					try {
+						if(tokens.size() < 2 || tokens.size() > 5)
+							throw std::invalid_argument(cmd.op);
+						hops = std::stoul(tokens[1]);
+						if(tokens.size() >= 4) {
+							f.minWeight = std::stoi(tokens[2]);
+							f.maxWeight = std::stoi(tokens[3]);
+						}
+					}
+					catch(std::exception&) {
+						seed = -2;
+					}
+					if(seed == -2)
+						std::cout << invalidCmd << std::endl << std::endl;
+					else if(seed == -1)
+						std::cout << failVertexExist << tokens[0] << std::endl << std::endl;
+					else {
+						extractKHop(csr, seed, hops, f, sub);
+						const std::string& file = tokens.back();
+						int written = toFile ? writeSubgraph(*graph, sub, file) : 1;
+						if(!toFile) {
+							std::cout << khopMessage << sub.origin.size() << std::endl;
+							for(size_t i = 0; i < sub.origin.size(); ++i) {
+								std::cout << (i ? ", " : "") << graph->getKey(sub.origin[i]);
+							}
+							std::cout << std::endl << edgeCountMessage
+								<< sub.csr.getEdgeCount() << std::endl << std::endl;
+						}
+						else if(written == 0)
+							std::cout << goodWrite << file << std::endl << std::endl;
+						else
+							std::cout << failWrite << (written == -2 ? failWrite_n2 :
+								failWrite_n1) << file << std::endl << std::endl;
+					}
+				}
+				else if(cmd.op == arborescenceCmd) {
+					int root = graph->getOffset(tokens[0]);
+					SpanningTree t;
+					if(tokens.size() != 1)
+						std::cout << invalidCmd << std::endl << std::endl;
+					else if(root == -1)
+						std::cout << failVertexExist << tokens[0] << std::endl << std::endl;
+					else {
+						bool spanning = minimumArborescence(csr, root, t);
+						std::cout << arborescenceMessage << t.weight << std::endl;
+						printSpanning(t, " --> ");
+						if(!spanning)
+							std::cout << unreachedMessage << graph->getVertexCount() -
+								t.edges.size() - 1 << std::endl;
+						std::cout << std::endl;
+					}
+				}
+				else if(cmd.op == maxflowCmd) {
+					FlowOptions o;
+					MinCut cut;
+					o.parallel = true;
+					if(tokens.size() != args)
+						std::cout << invalidCmd << std::endl << std::endl;
+					else if(s1 == -1 || s2 == -1)
+						std::cout << failVertexExist << tokens[0] << ", or " << tokens[1]
+							<< std::endl << std::endl;
+					else if(s1 == s2)
+						std::cout << invalidCmd << std::endl << std::endl;
+					else {
+						maxFlow(csr, s1, s2, o, cut);
+						std::cout << flowMessage << cut.flow << std::endl << sourceSideMessage;
+						for(size_t i = 0; i < cut.sourceSide.size(); ++i) {
+							std::cout << (i ? ", " : "") << graph->getKey(cut.sourceSide[i]);
+						}
+						std::cout << std::endl << cutMessage << std::endl;
+						for(size_t i = 0; i < cut.edges.size(); ++i) {
+							const FlowEdge& e = cut.edges[i];
+							std::cout << graph->getKey(e.from) << " --> " << graph->getKey(e.to)
+								<< "[" << e.capacity << "]" << std::endl;
+						}
+						std::cout << std::endl;
+					}
+				}
+				else if(cmd.op == trianglesCmd) {
+					TriangleOptions o;
+					TriangleCount t;
+					if(tokens.size() != 1 || tokens[0] != directedArg)
+						std::cout << invalidCmd << std::endl << std::endl;
+					else {
+						o.directed = true;
+						countTriangles(csr, o, t);
+						printTriangles(t);
+					}
+				}
+				else if(cmd.op == betweennessCmd) {
+					BetweennessOptions o;
+					Betweenness b;
+					std::vector<Score> s;
+					bool valid = tokens.size() <= 2;
+					for(size_t i = 0; valid && i < tokens.size(); ++i) {
+						if(tokens[i] == weightedArg && i == 0)
+							o.weighted = true;
+						else if(i + 1 != tokens.size())
+							valid = false;
+						else {
+							try {
+								o.samples = std::stoul(tokens[i]);
+							}
+							catch(std::exception&) {
+								valid = false;
+							}
+						}
+					}
+					if(!valid)
+						std::cout << invalidCmd << std::endl << std::endl;
+					else {
+						betweenness(csr, o, b);
+						if(b.error > 0)
+							std::cout << samplesMessage << b.sources << std::endl
+								<< errorMessage << b.error << std::endl;
+						sortRanks(b.score, s);
+						printRanks(s);
+					}
+				}
+				else if(cmd.op == hopsCmd) {
+					std::vector<HopQuery> q;
+					std::vector<Offset> hops;
+					int status = readHopQueries(*graph, cmd.arg, q);
+					if(status != 0)
+						std::cout << (status == -1 ? failQueries_n1 : failQueries_n2)
+							<< cmd.arg << std::endl << std::endl;
+					else {
+						hopDistances(csr, q, HopOptions(), hops);
+						for(size_t i = 0; i < q.size(); ++i) {
+							std::cout << graph->getKey(q[i].source) << " -> "
+								<< graph->getKey(q[i].target) << ": ";
+							if(hops[i] == unreachedHops)
+								std::cout << unreachableMessage << std::endl;
+							else
+								std::cout << hops[i] << std::endl;
+						}
+						std::cout << std::endl;
+					}
+				}
+				else if(cmd.op == wccCmd) {
+					Components c;
+					Subgraph sub;
+					wccAfforest(csr, c);
+					extractComponent(csr, c, largestComponent(c), sub);
+					int written = writeSubgraph(*graph, sub, cmd.arg);
+					if(written == 0)
+						std::cout << goodWrite << cmd.arg << std::endl << std::endl;
+					else
+						std::cout << failWrite << (written == -2 ? failWrite_n2 :
+							failWrite_n1) << cmd.arg << std::endl << std::endl;
+				}
+				else if(cmd.op != bfsCmd && cmd.op != ucsCmd && cmd.op != dfsCmd &&
+						cmd.op != iddfsCmd && cmd.op != dagspCmd && cmd.op != daglpCmd)
+					std::cout << invalidCmd << std::endl << std::endl;
+				else if(tokens.size() != args)
+					std::cout << invalidCmd << std::endl << std::endl;
+				else if(s1 == -1 || s2 == -1)
+					std::cout << failVertexExist << tokens[0] << ", or " << tokens[1]
+						<< std::endl << std::endl;
+				else if(cmd.op == bfsCmd)
+					printPath(bfs(*graph, s1, s2, p), p, tokens[0], tokens[1]);
+				else if(cmd.op == ucsCmd)
+					printPath(ucs(*graph, s1, s2, p), p, tokens[0], tokens[1]);
+				else if(cmd.op == iddfsCmd)
+					printPath(iddfs(*graph, s1, s2, p), p, tokens[0], tokens[1]);
+				else if(cmd.op == dfsCmd) {
+					try {
+						Offset depth = std::stoul(tokens[2]);
+						printPath(dfs(*graph, s1, s2, depth, p), p, tokens[0], tokens[1]);
+					}
+					catch(std::exception&) {
+						std::cout << invalidCmd << std::endl << std::endl;
+					}
+				}
+				else {
+					std::vector<Offset> order;
+					DagPaths d;
+					if(!topologicalOrder(csr, order))
+						printCycle(csr);
+					else {
+						if(cmd.op == dagspCmd)
+							dagShortestPaths(csr, order, s1, d);
+						else
+							dagLongestPaths(csr, order, s1, d);
+						printPath(dagPath(d, s2, p), p, tokens[0], tokens[1]);
+					}
+				}
+			}
+			else if(cmd.op == clearCmd)
+				std::system("clear");
+			else if(cmd.op == helpCmd)
+				std::cout << helpMessage_algo << std::endl << std::endl;
+			else if(cmd.op == topoCmd) {
+				std::vector<Offset> order;
+				if(!topologicalOrder(csr, order))
+					printCycle(csr);
+				else {
+					std::cout << topoMessage;
+					for(size_t i = 0; i < order.size(); ++i) {
+						std::cout << (i ? ", " : "") << graph->getKey(order[i]);
+					}
+					std::cout << std::endl << std::endl;
+				}
+			}
+			else if(cmd.op == pagerankCmd) {
+				std::vector<double> rank;
+				std::vector<Score> s;
+				pageRank(csr, RankOptions(), rank);
+				sortRanks(rank, s);
+				printRanks(s);
+			}
+			else if(cmd.op == mstCmd) {
+				SpanningTree t;
+				minimumSpanningForest(csr, t);
+				std::cout << mstMessage << t.weight << std::endl;
+				printSpanning(t, " -- ");
+				std::cout << std::endl;
+			}
+			else if(cmd.op == trianglesCmd) {
+				TriangleCount t;
+				countTriangles(csr, TriangleOptions(), t);
+				printTriangles(t);
+			}
+			else if(cmd.op == betweennessCmd) {
+				Betweenness b;
+				std::vector<Score> s;
+				betweenness(csr, BetweennessOptions(), b);
+				sortRanks(b.score, s);
+				printRanks(s);
+			}
+			else if(cmd.op == sccCmd) {
+				Components c;
+				CSRGraph dag;
+				stronglyConnected(*graph, c, dag);
+				printComponents(c, sccMessage);
+				std::cout << condensationMessage << dag.getEdgeCount() << std::endl
+					<< std::endl;
+			}
+			else if(cmd.op == wccCmd) {
+				Components c;
+				std::vector<Offset> sizes;
+				wccAfforest(csr, c);
+				componentSizes(c, sizes);
+				printComponents(c, wccMessage);
+				std::cout << largestMessage << (sizes.empty() ? 0 :
+					sizes[largestComponent(c)]) << std::endl << std::endl;
+			}
+			else if(cmd.op == quitCmd) {
+				std::cout << std::endl;
+				exitShell = true;
+			}
+			else
+				std::cout << invalidCmd << std::endl << std::endl;
+		}
+		else
+			std::cout << invalidCmd << std::endl << std::endl;
+	}
+}
+
 void clearBuffer(std::stringstream& buf) {
   buf.str(std::string());
   buf.clear();
@@ -229,3 +815,111 @@ void tokenizeString(std::vector<std::string>& tokens, std::string& str,
 	}
 	tokens.push_back(str.substr(start,str.size()-start));
 }
+
+std::string formatBytes(size_t bytes) {
+	const char* units[] = {"B", "KiB", "MiB", "GiB"};
+	double v = bytes;
+	int u = 0;
+	while(v >= 1024 && u < 3) {
+		v /= 1024;
+		++u;
+	}
+	char buf[32];
+	std::snprintf(buf, sizeof(buf), u ? "%.1f %s" : "%.0f %s", v, units[u]);
+	return buf;
+}
+
+void printSave() {
+	switch(save.getState()) {
+		case SAVE_IDLE:
+			std::cout << saveIdle << std::endl;
+			break;
+		case SAVE_RUNNING:
+			std::cout << saveRunning << save.getFile();
+			break;
+		case SAVE_DONE:
+			std::cout << saveDone << save.getFile();
+			break;
+		case SAVE_FAILED:
+			std::cout << saveFailed << save.getFile();
+	}
+	if(save.getState() != SAVE_IDLE)
+		std::cout << " (" << std::fixed << std::setprecision(2)
+			<< save.getSeconds() << " s)" << std::defaultfloat << std::endl;
+}
+
+void pollSave() {
+	if(!save.poll())
+		return;
+	printSave();
+	if(save.getState() == SAVE_DONE && workspace.contains(savedGraph)) {
+		workspace.setFile(savedGraph, save.getFile());
+		if(savedGraph == current)
+			graphName = save.getFile();
+	}
+	savedGraph.clear();
+}
+
+void printPath(bool found, const Path& p, const Key& k1, const Key& k2) {
+	if(!found) {
+		std::cout << pathNotFound << k1 << " to " << k2 << "." << std::endl
+			<< std::endl;
+		return;
+	}
+	std::cout << pathFound << k1 << " to " << k2 << "." << std::endl;
+	std::cout << pathCost << p.cost << std::endl;
+	std::cout << graph->getKey(p.vertices[0]);
+	for(size_t i = 1; i < p.vertices.size(); ++i) {
+		std::cout << " --[" << graph->getWeight(p.vertices[i-1], p.vertices[i])
+			<< "]--> " << graph->getKey(p.vertices[i]);
+	}
+	std::cout << std::endl << std::endl;
+}
+
+void printCycle(const CSRGraph& g) {
+	std::vector<Offset> cycle;
+	findCycle(g, cycle);
+	std::cout << cycleFound;
+	for(size_t i = 0; i < cycle.size(); ++i) {
+		std::cout << graph->getKey(cycle[i]) << " --> ";
+	}
+	std::cout << graph->getKey(cycle[0]) << std::endl << std::endl;
+}
+
+void printSpanning(const SpanningTree& t, const std::string& arrow) {
+	for(size_t i = 0; i < t.edges.size(); ++i) {
+		const SpanningEdge& e = t.edges[i];
+		std::cout << graph->getKey(e.from) << arrow << graph->getKey(e.to) << "["
+			<< e.weight << "]" << std::endl;
+	}
+}
+
+void printComponents(const Components& c, const std::string& message) {
+	std::vector<std::vector<Offset>> members(c.count);
+	for(Offset v = 0; v < c.component.size(); ++v) {
+		members[c.component[v]].push_back(v);
+	}
+	std::cout << message << c.count << std::endl;
+	for(Offset i = 0; i < c.count; ++i) {
+		std::cout << i << ": ";
+		for(size_t j = 0; j < members[i].size(); ++j) {
+			std::cout << (j ? ", " : "") << graph->getKey(members[i][j]);
+		}
+		std::cout << std::endl;
+	}
+}
+
+void printTriangles(const TriangleCount& t) {
+	std::cout << trianglesMessage << t.total << std::endl << globalClusteringMessage
+		<< t.globalClustering << std::endl << averageClusteringMessage
+		<< t.averageClustering << std::endl << std::endl;
+}
+
+void printRanks(const std::vector<Score>& s) {
+	std::cout << rankMessage << std::endl;
+	for(size_t i = 0; i < s.size() && i < SHOWN_RANKS; ++i) {
+		std::cout << std::setw(4) << i + 1 << ". " << graph->getKey(s[i].first)
+			<< " " << s[i].second << std::endl;
+	}
+	std::cout << std::endl;
+}
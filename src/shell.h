@@ -1,6 +1,15 @@
 #pragma once
 
 #include "Graph.h"
+#include "Search.h"
+#include "CSR.h"
+#include "PageRank.h"
+#include "Spanning.h"
+#include "Flow.h"
+#include "Triangles.h"
+#include "Centrality.h"
+#include "SCC.h"
+#include "Hops.h"
 #include <string>
 #include <sstream>
 
@@ -19,10 +28,13 @@ const std::string helpCmd("help");
 const std::string newCmd("new");
 const std::string listCmd("list");
 const std::string loadCmd("load");
+const std::string lazyCmd("lazy");
 const std::string clearCmd("clear");
 const std::string quitCmd("quit");
 
 const std::string writeCmd("write");
+const std::string saveCmd("save");
+const std::string degreeCmd("degree");
 const std::string adjCmd("adj");
 const std::string matrixCmd("matrix");
 const std::string addCmd("add");
@@ -30,11 +42,48 @@ const std::string removeCmd("remove");
 const std::string edgeCmd("edge");
 const std::string nedgeCmd("nedge");
 const std::string algoCmd("algo"); 
+const std::string statsCmd("stats");
+const std::string memCmd("mem");
+const std::string compactCmd("compact");
+const std::string materializeCmd("materialize");
+const std::string reorderCmd("reorder");
+const std::string journalCmd("journal");
+const std::string onArg("on");
+const std::string offArg("off");
+const std::string resetArg("reset");
+const std::string graphsCmd("graphs");
+const std::string useCmd("use");
+const std::string closeCmd("close");
+const std::string copyCmd("copy");
+const std::string budgetCmd("budget");
+
+const std::string bfsCmd("bfs");
+const std::string ucsCmd("ucs");
+const std::string dfsCmd("dfs");
+const std::string iddfsCmd("iddfs");
+const std::string topoCmd("topo");
+const std::string dagspCmd("dagsp");
+const std::string daglpCmd("daglp");
+const std::string sccCmd("scc");
+const std::string wccCmd("wcc");
+const std::string hopsCmd("hops");
+const std::string pagerankCmd("pagerank");
+const std::string pprCmd("ppr");
+const std::string khopCmd("khop");
+const std::string mstCmd("mst");
+const std::string arborescenceCmd("arborescence");
+const std::string maxflowCmd("maxflow");
+const std::string trianglesCmd("triangles");
+const std::string directedArg("directed");
+const std::string betweennessCmd("betweenness");
+const std::string weightedArg("weighted");
+
+#define SHOWN_RANKS 10  // vertices listed by the ranking commands
 
 // General Main Shell Messages
 const std::string welcomeMessage("QuickGraph - a simple graph creation software\nAuthor: Nikhil Kumar 2017");
 const std::string invalidCmd("\nPlease enter a valid command.");
-const std::string helpMessage_main("\nCommands available:\n\nlist -- display graphs files on disk that can be loaded into main memory\nload <graph_file> -- load a graph stored on disk into main memory (extension MUST be .graph)\nnew -- enter a live graph creation shell in which graph structures can be created on the fly, and written to disk\nquit -- exit the graph shell");
+const std::string helpMessage_main("\nCommands available:\n\nlist -- display graphs files on disk that can be loaded into main memory\nload <graph_file> -- load a graph stored on disk into main memory (extension MUST be .graph), adding it to the graphs held under its name without the extension\nlazy <graph_file> -- load a graph as above, reading only its vertices up front and each vertex's edges when first used\nnew -- enter a live graph creation shell in which graph structures can be created on the fly, and written to disk\nquit -- exit the graph shell");
 const std::string mainMessage("Main Menu\nType \"help\" to see all available commands.");
 
 // Load Graph Messages
@@ -42,16 +91,29 @@ const std::string graphLoc("../graphFiles/");
 const std::string failLoad("\nPlease re-type filename. Type \"list\" to see available files on disk.");
 const std::string failLoad_n1("\nUnable to open ");
 const std::string failLoad_n2("\nFile does not contain \".graph\" extension: ");
+const std::string failLoad_n4("\nFile has weights outside [-32767, 32767], which would be lost: ");
+const std::string untitledName("untitled");
+const std::string loadingName(" loading");  // held while loading; file names
+                                            // cannot contain spaces
+const std::string replaceMessage("Discarded the graph previously held as: ");
 const std::string goodLoad("\nFile has been loaded properly: ");
+const std::string replayMessage("Journaled edits replayed: ");
+const std::string partialLoad("\nSkipped edges with malformed weights or weights outside [-32767, 32767]: ");
 
 // Live Graph Messages
 const std::string liveMessage("Live Graph Creation Environment\nType \"help\" to see all available commands.");
 const std::string emptyWrite("Graph contains no vertices. Unable to write empty file to disk.");
 const std::string goodWrite("File has been wrtten properly: ");
 const std::string failWrite("Please re-type filename.");
+const std::string saveStarted("Saving in the background: ");
+const std::string saveBusy("Wait for the save in progress to finish: ");
+const std::string saveIdle("No graph is being saved.");
+const std::string saveRunning("Saving ");
+const std::string saveDone("File has been written properly: ");
+const std::string saveFailed("Unable to write ");
 const std::string failWrite_n1("\nUnable to open ");
 const std::string failWrite_n2("File does not contain \".graph\" extension: ");
-const std::string helpMessage_live("Commands available:\n\nwrite <graph name> -- writes graph in main memory to the disk (\".graph\" extension required), and will overwrite any existing file with the same name\nadj -- displays graph as an adjacency list\nmatrix -- displays graph as an adjacency matrix\nadd <vertex 1>,<vertex 2>,... -- inserts named vertices into the graph\nremove <vertex 1>,<vertex 2>,... -- removes named vertices from the graph\nedge <vertex 1>,<vertex 2>,<weight> -- creates edge from vertex 1 to vertex 2 using weight specified (overwrites any existing edge from vertex 1 to vertex 2)\nnedge <vertex 1>,<vertex 2> -- removes edge from vertex 1 to vertex 2\nalgo -- enters graph algorithm interface\nquit -- go back to main shell");
+const std::string helpMessage_live("Commands available:\n\nwrite <graph name> -- writes graph in main memory to the disk (\".graph\" extension required) in the background while editing continues, and will replace any existing file with the same name once complete\ndegree -- displays the number of vertices and edges, and how many vertices have each out-degree and in-degree\ndegree <vertex> -- displays the out-degree and in-degree of a vertex\nsave -- displays whether the last write is still being saved in the background, and its outcome\nadj -- displays graph as an adjacency list\nmatrix -- displays graph as an adjacency matrix\nadd <vertex 1>,<vertex 2>,... -- inserts named vertices into the graph\nremove <vertex 1>,<vertex 2>,... -- removes named vertices from the graph\nedge <vertex 1>,<vertex 2>,<weight> -- creates edge from vertex 1 to vertex 2 using weight specified (overwrites any existing edge from vertex 1 to vertex 2)\nnedge <vertex 1>,<vertex 2> -- removes edge from vertex 1 to vertex 2\nmem -- displays memory used by the graph, split into live and slack bytes\ncompact -- releases slack memory held by the graph back to the allocator\nmaterialize -- reads every edge not yet read from a graph loaded with \"lazy\"\nreorder rcm|degree|bfs -- renumbers the vertices so that related vertices are stored together (write the graph to keep the order)\njournal always|interval|never -- saves every edit by appending it to a journal next to the graph file, flushing it to disk on every command, every second, or when the system chooses; writing the graph to its own file folds the journal into it\njournal off -- stops journaling edits\ngraphs -- lists the graphs held, the memory each uses, and whether it is resident or evicted to disk\nuse <graph> -- switches to another graph held\nclose <graph> -- discards another graph held\ncopy <graph> -- copies the current graph to a new graph of that name\nbudget <MiB> -- sets the memory the graphs held may use; the least recently used graphs beyond it are evicted to disk and loaded back when used\nstats -- displays per-operation call counts and latencies\nstats on|off -- starts or stops recording operation statistics\nstats reset -- discards recorded operation statistics\nstats <file> -- writes recorded operation statistics to a JSON file\nalgo -- enters graph algorithm interface\nquit -- go back to main shell");
 const std::string failAddVertex("Vertex could not be added: ");
 const std::string failRemoveVertex("Vertex could not be removed: ");
 const std::string failVertexExist("A vertex does not exist: ");
@@ -61,6 +123,56 @@ const std::string failEdgeExist("An edge between the following could not be foun
 const std::string successRemove("Edge removed: ");
 const std::string successVertexAdd("Vertex was added: ");
 const std::string successVertexRemove("Vertex was removed: ");
+const std::string statsOnMessage("Recording operation statistics.");
+const std::string statsOffMessage("Operation statistics are not being recorded. Type \"stats on\" to start.");
+const std::string statsResetMessage("Operation statistics have been reset.");
+const std::string materializeMessage("Vertices whose edges were read: ");
+const std::string vertexCountMessage("vertices: ");
+const std::string edgeCountMessage("edges: ");
+const std::string outDegreeMessage("out-degree ");
+const std::string inDegreeMessage("in-degree ");
+const std::string compactMessage("Bytes released: ");
+const std::string reorderMessage("Vertices renumbered, bandwidth: ");
+const std::string journalOnMessage("Journaling edits to ");
+const std::string journalOffMessage("Journaling stopped. Edits are saved by writing the graph.");
+const std::string journalUnnamed("Write the graph to a file before journaling its edits.");
+const std::string useMessage("Current graph: ");
+const std::string closeMessage("Graph closed: ");
+const std::string copyMessage("Graph copied to: ");
+const std::string budgetMessage("Memory budget: ");
+const std::string failGraphExist("No such graph, or it could not be loaded: ");
+const std::string failCloseCurrent("The current graph cannot be closed. Switch to another graph first.");
+const std::string failCopy("A graph of that name already exists: ");
+const std::string journalFailMessage("Unable to append edits to the journal; they are kept in memory.");
+
+// Algorithm Shell Messages
+const std::string algoMessage("Graph Algorithm Environment\nType \"help\" to see all available commands.");
+const std::string helpMessage_algo("Commands available:\n\nbfs <vertex 1>,<vertex 2> -- finds the path from vertex 1 to vertex 2 with the fewest hops\nucs <vertex 1>,<vertex 2> -- finds the path from vertex 1 to vertex 2 with the lowest cost\ndfs <vertex 1>,<vertex 2>,<depth-limit> -- finds a path from vertex 1 to vertex 2 of at most depth-limit hops\niddfs <vertex 1>,<vertex 2> -- finds the path from vertex 1 to vertex 2 with the fewest hops by iterative deepening\nhops <file> -- displays the fewest hops between every pair of vertices listed in a file, one <vertex 1>,<vertex 2> per line\ntopo -- displays the vertices in topological order, or a cycle if the graph has one\ndagsp <vertex 1>,<vertex 2> -- finds the lowest cost path from vertex 1 to vertex 2 in an acyclic graph (negative weights allowed)\ndaglp <vertex 1>,<vertex 2> -- finds the highest cost path from vertex 1 to vertex 2 in an acyclic graph (negative weights allowed)\nscc -- displays the strongly connected components of the graph\nwcc -- displays the weakly connected components of the graph, with edge directions ignored\nwcc <file> -- writes the largest weakly connected component and the edges within it to a .graph file\npagerank -- displays the vertices with the highest PageRank\npagerank <file> -- writes the PageRank of every vertex to a file, highest first\nppr <vertex> -- displays the vertices with the highest PageRank personalized to a vertex\nppr <vertex>,<file> -- writes the personalized PageRank of every vertex reached to a file, highest first\nkhop <vertex>,<hops>[,<min weight>,<max weight>] -- displays the vertices within hops edges of a vertex, following only edges with weights in the range given, and the number of edges between them\nkhop <vertex>,<hops>[,<min weight>,<max weight>],<file> -- writes the subgraph of those vertices and the edges between them to a .graph file\nmst -- displays a minimum spanning forest of the graph with edge directions ignored, and its total weight\narborescence <vertex> -- displays the lightest set of edges giving every vertex reachable from a vertex a single path from it, and its total weight\nmaxflow <vertex 1>,<vertex 2> -- finds the maximum flow from vertex 1 to vertex 2 with edge weights as capacities, and the vertices and edges of a minimum cut between them\ntriangles -- displays the number of triangles in the graph with edge directions ignored, and its global and average clustering coefficients\ntriangles directed -- displays the same, counting a triangle once for every choice of one edge on each of its sides\nbetweenness -- displays the vertices on the largest share of shortest paths between other vertices\nbetweenness [weighted][,<samples>] -- displays the same, with path lengths as total weights if weighted, estimated from a random sample of sources if a number of samples is given\nquit -- go back to live shell");
+const std::string pathFound("Path found from ");
+const std::string pathNotFound("Could not find path from ");
+const std::string pathCost("Path Cost: ");
+const std::string cycleFound("Graph is not acyclic. Cycle found: ");
+const std::string topoMessage("Topological order: ");
+const std::string sccMessage("Strongly connected components: ");
+const std::string wccMessage("Weakly connected components: ");
+const std::string largestMessage("Largest component: ");
+const std::string condensationMessage("Edges between components: ");
+const std::string rankMessage("Highest ranked vertices:");
+const std::string khopMessage("Vertices reached: ");
+const std::string mstMessage("Minimum spanning forest weight: ");
+const std::string arborescenceMessage("Minimum spanning arborescence weight: ");
+const std::string unreachedMessage("Vertices not reachable from the root: ");
+const std::string flowMessage("Maximum flow: ");
+const std::string sourceSideMessage("Source side of a minimum cut: ");
+const std::string cutMessage("Edges crossing the cut:");
+const std::string trianglesMessage("Triangles: ");
+const std::string globalClusteringMessage("Global clustering coefficient: ");
+const std::string averageClusteringMessage("Average clustering coefficient: ");
+const std::string samplesMessage("Sources sampled: ");
+const std::string errorMessage("Error bound at 95% confidence: ");
+const std::string unreachableMessage("unreachable");
+const std::string failQueries_n1("Unable to open ");
+const std::string failQueries_n2("Every line must name two vertices as <vertex 1>,<vertex 2>: ");
 
 /////////////////////////////////////////////////////////////////////////////
 // AUXILIARY FUNCTIONS                                                     //
@@ -84,6 +196,95 @@ void clearBuffer(std::stringstream& buf);
 void tokenizeString(std::vector<std::string>& tokens, std::string& str, 
 		char delim);
 
+/*
+ * Formats a byte count for display using binary units (B, KiB, MiB, GiB).
+ *
+ * @param bytes, the byte count
+ * @return the formatted byte count
+ */
+std::string formatBytes(size_t bytes);
+
+/*
+ * Prints the state of the last background save in the following form:
+ *
+ * Saving <file> (<seconds> s)
+ */
+void printSave();
+
+/*
+ * Reports a background save that has finished since the last call, if any.
+ * A successful save names the file the saved graph is associated with, so
+ * that a failed one leaves it associated with the file it came from.
+ */
+void pollSave();
+
+/*
+ * Prints the outcome of a path search between two vertices in the form
+ * described for the algorithm shell.
+ *
+ * @param found, whether a path was found
+ * @param p, the path, if found
+ * @param k1, key of the source vertex
+ * @param k2, key of the destination vertex
+ */
+void printPath(bool found, const Path& p, const Key& k1, const Key& k2);
+
+/*
+ * Prints a cycle of the graph in the following form:
+ *
+ * Graph is not acyclic. Cycle found: <vertex 1> --> ... --> <vertex 1>
+ *
+ * @param g, the snapshot of the graph, which must not be acyclic
+ */
+void printCycle(const CSRGraph& g);
+
+/*
+ * Prints the highest ranked vertices in the following form:
+ *
+ * Highest ranked vertices:
+ *    1. <vertex> <rank>
+ *    ...
+ *
+ * @param s, the scores, highest first
+ */
+void printRanks(const std::vector<Score>& s);
+
+/*
+ * Prints the edges of a spanning forest or arborescence, one per line, in
+ * the following form:
+ *
+ * <vertex 1><arrow><vertex 2>[<weight>]
+ *
+ * @param t, the forest or arborescence
+ * @param arrow, the separator printed between the ends of every edge
+ */
+void printSpanning(const SpanningTree& t, const std::string& arrow);
+
+/*
+ * Prints the number of components of a graph and the keys of the vertices
+ * of each, in the following form:
+ *
+ * <message><count>
+ * 0: <vertex>, <vertex>, ...
+ * ...
+ *
+ * @param c, the components
+ * @param message, the heading printed before the count
+ */
+void printComponents(const Components& c, const std::string& message);
+
+/*
+ * Prints the triangle count of a graph and its clustering coefficients in
+ * the following form:
+ *
+ * Triangles: <count>
+ * Global clustering coefficient: <coefficient>
+ * Average clustering coefficient: <coefficient>
+ *
+ * @param t, the counts
+ */
+void printTriangles(const TriangleCount& t);
+
 /////////////////////////////////////////////////////////////////////////////
 // MAIN FUNCTIONS                                                          //
 /////////////////////////////////////////////////////////////////////////////
@@ -113,7 +314,17 @@ void tokenizeString(std::vector<std::string>& tokens, std::string& str,
  *         Loads a graph from the disk to memory for user usage. Can still
  *         modify this graph's vertices and connections, access graph
  *         information, and perform graph algorithms. In addition, the updated
- *         version can be written to the disk.
+ *         version can be written to the disk. Graphs loaded earlier stay
+ *         held, and can be switched to from the live shell; loading a file
+ *         again replaces the graph held under its name, edits not written
+ *         included, once the file has loaded without error. Files with weights
+ *         outside [-32767, 32767] are refused, since saving would drop them.
+ *
+ *      ---> lazy <graph name>
+ *         Loads a graph as load does, but reads only its vertices up front.
+ *         The edges of each vertex are read from the file the first time
+ *         they are used, so that the first queries on a large file need not
+ *         wait for all of it to be parsed.
  *
  *      ---> quit
  *         Exits the shell environemnt, and terminates the running instance of
@@ -139,6 +350,26 @@ void mainShell();
  *         Writes the graph created by the user to the disk. If file does not
  *         already exist, a new file will be created and saved. All Graph files
  *         are located in the "graphFiles" directory with the extension ".graph".
+ *         The graph is written in the background as it was when the command
+ *         was given, and editing continues meanwhile; its completion is
+ *         reported after the next command. The file is replaced only once
+ *         the whole graph has been written, and becomes the graph's file,
+ *         used by journal, only then. Writing a journaled graph to its
+ *         own file checkpoints the journal instead, before returning.
+ *
+ *      ---> degree [<vertex>]
+ *         With no argument, displays the number of vertices and edges, and
+ *         the number of vertices of each out-degree and in-degree:
+ *
+ *         <degree> <vertices of that out-degree> <of that in-degree>
+ *         ...
+ *
+ *         Given a vertex, displays its out-degree and in-degree. Both are
+ *         kept up to date by every edit, so neither scans the graph.
+ *
+ *      ---> save
+ *         Displays whether the last write is still running, or whether it
+ *         succeeded, and how long it took.
  *
  *      ---> adj 
  *         Displays graph represented as an adjacency list in the following
@@ -194,6 +425,53 @@ void mainShell();
  *         edge will not be removed, and a precise error report will be given
  *         detailing the reason.
  *
+ *      ---> mem
+ *         Displays the memory used by the graph in the following form, where
+ *         live bytes hold data in use and slack bytes are allocated capacity
+ *         beyond it:
+ *
+ *         <component> <live> <slack> <total>
+ *         ...
+ *         total <live> <slack> <total>
+ *
+ *      ---> compact
+ *         Releases slack memory held by the graph back to the allocator, such
+ *         as the capacity left behind after removing many vertices.
+ *
+ *      ---> graphs
+ *         Lists the graphs held in memory at once, loaded or created since
+ *         the shell started, marking the current one, in the following form:
+ *
+ *         * <graph> resident|evicted <memory> <file>
+ *         ...
+ *
+ *      ---> use <graph>
+ *         Switches to another graph held. Journaling of the current graph is
+ *         stopped.
+ *
+ *      ---> close <graph>
+ *         Discards a graph held, other than the current one, without saving.
+ *
+ *      ---> copy <graph>
+ *         Copies the current graph to a new graph of the name given.
+ *
+ *      ---> budget <MiB>
+ *         Sets the memory the graphs held may use together. When they use
+ *         more, the least recently used are evicted to binary snapshots on
+ *         disk, and loaded back from them when next used. The current graph
+ *         is never evicted.
+ *
+ *      ---> materialize
+ *         Reads every edge not yet read from a graph loaded with lazy, and
+ *         reports any skipped due to their weights.
+ *
+ *      ---> stats [on|off|reset|<file>]
+ *         With no argument, displays a table of per-operation call counts,
+ *         cumulative time and latency percentiles for every operation
+ *         recorded. "on" and "off" start and stop recording, "reset"
+ *         discards what has been recorded, and any other argument is taken
+ *         as the name of a JSON file to export the statistics to.
+ *
  *      ---> algo
  *         Enters the algorithm shell. Here, the user can perform certain
  *         advanced operations on the graph, which are implemented using a
@@ -207,13 +485,17 @@ void mainShell();
  */
 void liveShell();
 
-/* THE FOLLOWING IS A LIST OF UNINFORMED SEARCHING PROCEDRUES
+/*
+ * Displays a shell environment for running graph algorithms on the graph
+ * built or loaded in the live shell. The graph cannot be modified here.
+ *
+ * THE FOLLOWING IS A LIST OF UNINFORMED SEARCHING PROCEDRUES
  *
  * 			 Paths are printed in the form:
  *
  *       Path found from <vertex 1> to <vertex 2>.
  * 			 Path Cost: <cost>
- *			 <vertex 1> [Weight]---> <vertex a> -->[Weight] ... <vertex 2>
+ *			 <vertex 1> --[weight]--> <vertex a> --[weight]--> ... <vertex 2>
  *
  *			 If no such path exists, the following is printed out:
  *
@@ -254,6 +536,105 @@ void liveShell();
  *       the path. This search does guarantee optimality. THe solution can be
  *       thought of the path with the least "hops" from vertex 1 to vertex 2.
  *
+ *    ---> hops <file>
+ *       Reads queries from a file, one <vertex 1>,<vertex 2> per line, and
+ *       displays the least number of "hops" from vertex 1 to vertex 2 for
+ *       each in the form below. Queries are answered together, hundreds of
+ *       breadth-first searches sharing every scan of a vertex's edges.
+ *
+ *       <vertex 1> -> <vertex 2>: <hops>|unreachable
+ *
+ * THE FOLLOWING IS A LIST OF STRUCTURAL PROCEDURES
+ *
+ *    ---> topo
+ *       Displays the vertices of the graph in topological order, so that
+ *       every edge leads from a vertex to one displayed after it. If the
+ *       graph is not acyclic, one of its cycles is displayed instead.
+ *
+ *    ---> dagsp <vertex 1>,<vertex 2>
+ *       Finds the path from vertex 1 to vertex 2 with the lowest cost in an
+ *       acyclic graph, in time linear in the size of the graph. Unlike ucs,
+ *       negative weights are handled. Paths are printed as above; if the
+ *       graph is not acyclic, one of its cycles is displayed instead.
+ *
+ *    ---> daglp <vertex 1>,<vertex 2>
+ *       Finds the path from vertex 1 to vertex 2 with the highest cost in an
+ *       acyclic graph, such as the critical path through a dependency graph
+ *       weighted by task durations. Printed as for dagsp.
+ *
+ *    ---> scc
+ *       Displays the strongly connected components of the graph, each the
+ *       largest set of vertices that can all reach one another, and the
+ *       number of edges between components.
+ *
+ *    ---> wcc [<file>]
+ *       Finds the weakly connected components of the graph, the sets of
+ *       vertices joined by edges followed either way. With no argument,
+ *       every component is displayed, along with the number of vertices in
+ *       the largest; otherwise the largest component and the edges within
+ *       it are written to the .graph file named.
+ *
+ *    ---> khop <vertex>,<hops>[,<min weight>,<max weight>][,<file>]
+ *       Finds the vertices within the given number of hops of a vertex,
+ *       following edge directions and, if a weight range is given, only
+ *       edges with weights inside it. With no file, the vertices reached and
+ *       the number of edges between them are displayed; otherwise the
+ *       subgraph they form is written to the .graph file named.
+ *
+ *    ---> mst
+ *       Finds a minimum spanning forest of the graph with edge directions
+ *       ignored, the lightest set of edges joining every vertex to the rest
+ *       of its weakly connected component, and displays its total weight
+ *       followed by its edges, one per line, in the form below.
+ *
+ *       <vertex 1> -- <vertex 2>[<weight>]
+ *
+ *    ---> arborescence <vertex>
+ *       Finds a minimum spanning arborescence rooted at a vertex, the
+ *       lightest set of edges giving every vertex reachable from the root a
+ *       single path from it, following edge directions. Displayed as for
+ *       mst, with edges as <vertex 1> --> <vertex 2>[<weight>], followed by
+ *       the number of vertices the root cannot reach, if any.
+ *
+ *    ---> maxflow <vertex 1>,<vertex 2>
+ *       Finds the maximum flow from vertex 1 to vertex 2, with the weight of
+ *       every edge as its capacity; edges with weights of 0 or less carry
+ *       none. Displays the flow, the vertices on the source side of a
+ *       minimum cut, and the edges crossing the cut with their capacities,
+ *       whose total is the flow.
+ *
+ *    ---> triangles [directed]
+ *       Counts the triangles of the graph with edge directions ignored, and
+ *       displays the count along with the global clustering coefficient, the
+ *       share of pairs of neighbors that are themselves joined, and the
+ *       average of every vertex's own. With directed, each triangle counts
+ *       once for every choice of one edge on each of its sides, so that one
+ *       of reciprocated edges counts 8 times, and the coefficients follow.
+ *
+ * THE FOLLOWING IS A LIST OF RANKING PROCEDURES
+ *
+ *    ---> pagerank [<file>]
+ *       Computes the PageRank of every vertex, the share of time a random
+ *       walk along the edges spends there when it jumps to a random vertex
+ *       15% of the time. With no argument, the 10 highest ranked vertices
+ *       are displayed; otherwise every vertex and its rank is written to
+ *       the file named, highest first, one per line.
+ *
+ *    ---> ppr <vertex>[,<file>]
+ *       Computes PageRank personalized to a vertex, in which the random walk
+ *       always jumps back to that vertex, so that the vertices ranked
+ *       highest are those most closely tied to it. Only the neighborhood of
+ *       the vertex is explored. Displayed or written as for pagerank.
+ *
+ *    ---> betweenness [weighted][,<samples>]
+ *       Computes the betweenness centrality of every vertex, the share of
+ *       the shortest paths between each pair of other vertices that pass
+ *       through it, summed over every pair, and displays the 10 highest. Paths are counted in edges, or in total
+ *       weight if weighted, when edges with weights of 0 or less are never
+ *       followed. Given a number of samples, the scores are estimated from
+ *       shortest paths leaving that many random sources, and the error bound
+ *       of each estimate at 95% confidence is displayed as well.
+ *
  * THE FOLLOWING IS A LIST OF BASIC SHELL COMMANDS
  *
  *		---> clear
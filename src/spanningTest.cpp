@@ -0,0 +1,287 @@
+#include <iostream>
+#include <random>
+#include <algorithm>
+#include <climits>
+
+#include "Graph.h"
+#include "CSR.h"
+#include "Spanning.h"
+#include "Parallel.h"
+#include "testGraphs.h"
+#include "gtest/gtest.h"
+
+#define RANDOM_VERTICES 20000
+
+/*
+ * SpanningTest
+ *
+ * Performs the following tests on the spanning procedures.
+ *     -Forest
+ *     -ForestReference
+ *     -Arborescence
+ *     -ArborescenceReference
+ *     -Unreachable
+ */
+
+static Offset findRoot(std::vector<Offset>& parent, Offset v) {
+	while(parent[v] != v) {
+		v = parent[v] = parent[parent[v]];
+	}
+	return v;
+}
+
+/*
+ * Kruskal's algorithm, to check the forest against.
+ */
+static long long kruskal(const CSRGraph& g) {
+	std::vector<std::pair<Weight, std::pair<Offset, Offset>>> edges;
+	for(Offset v = 0; v < g.getVertexCount(); ++v) {
+		for(size_t e = g.offsets[v]; e < g.offsets[v+1]; ++e) {
+			edges.push_back(std::make_pair(g.weights[e],
+					std::make_pair(v, g.targets[e])));
+		}
+	}
+	std::sort(edges.begin(), edges.end());
+	std::vector<Offset> parent(g.getVertexCount());
+	for(Offset v = 0; v < parent.size(); ++v) {
+		parent[v] = v;
+	}
+	long long total = 0;
+	for(size_t i = 0; i < edges.size(); ++i) {
+		Offset a = findRoot(parent, edges[i].second.first);
+		Offset b = findRoot(parent, edges[i].second.second);
+		if(a != b) {
+			parent[a] = b;
+			total += edges[i].first;
+		}
+	}
+	return total;
+}
+
+/*
+ * The O(VE) Chu-Liu/Edmonds algorithm, to check the arborescence against.
+ * Every vertex must be reachable from the root.
+ */
+static long long chuLiuEdmonds(const CSRGraph& g, Offset root) {
+	struct Edge { Offset from, to; long long w; };
+	std::vector<Edge> edges;
+	for(Offset v = 0; v < g.getVertexCount(); ++v) {
+		for(size_t e = g.offsets[v]; e < g.offsets[v+1]; ++e) {
+			Edge x = {v, g.targets[e], g.weights[e]};
+			edges.push_back(x);
+		}
+	}
+	Offset n = g.getVertexCount();
+	long long total = 0;
+	while(true) {
+		std::vector<long long> low(n, LLONG_MAX);
+		std::vector<Offset> pre(n);
+		for(size_t i = 0; i < edges.size(); ++i) {
+			const Edge& e = edges[i];
+			if(e.from != e.to && e.w < low[e.to]) {
+				low[e.to] = e.w;
+				pre[e.to] = e.from;
+			}
+		}
+		std::vector<long> id(n, -1), mark(n, -1);
+		Offset cycles = 0;
+		low[root] = 0;
+		for(Offset v = 0; v < n; ++v) {
+			total += low[v];
+			Offset u = v;
+			while(mark[u] != (long)v && id[u] == -1 && u != root) {
+				mark[u] = v;
+				u = pre[u];
+			}
+			if(u != root && id[u] == -1) {
+				for(Offset x = pre[u]; x != u; x = pre[x]) {
+					id[x] = cycles;
+				}
+				id[u] = cycles++;
+			}
+		}
+		if(cycles == 0)
+			return total;
+		for(Offset v = 0; v < n; ++v) {
+			if(id[v] == -1)
+				id[v] = cycles++;
+		}
+		std::vector<Edge> next;
+		for(size_t i = 0; i < edges.size(); ++i) {
+			Edge e = edges[i];
+			Offset to = e.to;
+			e.from = id[e.from];
+			e.to = id[e.to];
+			if(e.from != e.to) {
+				e.w -= low[to];
+				next.push_back(e);
+			}
+		}
+		edges.swap(next);
+		n = cycles;
+		root = id[root];
+	}
+}
+
+/*
+ * Checks that a forest has no cycle in the undirected view.
+ */
+static void expectAcyclic(Offset n, const SpanningTree& t) {
+	std::vector<Offset> parent(n);
+	for(Offset v = 0; v < n; ++v) {
+		parent[v] = v;
+	}
+	for(size_t i = 0; i < t.edges.size(); ++i) {
+		Offset a = findRoot(parent, t.edges[i].from);
+		Offset b = findRoot(parent, t.edges[i].to);
+		ASSERT_NE(a, b);
+		parent[a] = b;
+	}
+}
+
+/*
+ * Checks that every vertex but the root has one in-edge, and that following
+ * in-edges back from any vertex leads to the root.
+ */
+static void expectArborescence(Offset n, Offset root, const SpanningTree& t) {
+	std::vector<long> parent(n, -1);
+	for(size_t i = 0; i < t.edges.size(); ++i) {
+		ASSERT_NE(t.edges[i].to, root);
+		ASSERT_EQ(parent[t.edges[i].to], -1);
+		parent[t.edges[i].to] = t.edges[i].from;
+	}
+	for(Offset v = 0; v < n; ++v) {
+		if(v == root || parent[v] == -1)
+			continue;
+		Offset u = v;
+		for(Offset hops = 0; u != root; ++hops) {
+			ASSERT_LT(hops, n);
+			ASSERT_NE(parent[u], -1);
+			u = parent[u];
+		}
+	}
+}
+
+TEST(SpanningTest, Forest) {
+	WeightedDigraph g;
+	CSRGraph c;
+	SpanningTree t;
+	ASSERT_EQ(g.fileLoad(goodFile), 0);
+	buildCSR(g, c);
+
+	// San Francisco - Houston, Boston - Los Angeles, Miami - Boston,
+	// San Francisco - New York, Miami - San Francisco, New York - Hartford
+	minimumSpanningForest(c, t);
+	EXPECT_EQ(t.edges.size(), 6);
+	EXPECT_EQ(t.weight, 36);
+	expectAcyclic(c.getVertexCount(), t);
+	for(size_t i = 0; i < t.edges.size(); ++i) {
+		EXPECT_EQ(g.getWeight(t.edges[i].from, t.edges[i].to), t.edges[i].weight);
+	}
+
+	// an isolated vertex is a tree of its own
+	ASSERT_TRUE(g.addVertex("Denver"));
+	buildCSR(g, c);
+	minimumSpanningForest(c, t);
+	EXPECT_EQ(t.edges.size(), 6);
+}
+
+TEST(SpanningTest, ForestReference) {
+	CSRGraph c;
+	SpanningTree one, many;
+	for(unsigned seed = 1; seed <= 3; ++seed) {
+		// sparse enough to leave several components
+		randomCSR(c, RANDOM_VERTICES, RANDOM_VERTICES * seed / 2, seed, -100, 100);
+		setParallelThreads(1);
+		minimumSpanningForest(c, one);
+		setParallelThreads(4);
+		minimumSpanningForest(c, many);
+		setParallelThreads(0);
+		EXPECT_EQ(one.weight, kruskal(c));
+		ASSERT_EQ(one.edges.size(), many.edges.size());
+		for(size_t i = 0; i < one.edges.size(); ++i) {
+			EXPECT_EQ(one.edges[i].from, many.edges[i].from);
+			EXPECT_EQ(one.edges[i].to, many.edges[i].to);
+		}
+		expectAcyclic(c.getVertexCount(), many);
+	}
+}
+
+TEST(SpanningTest, Arborescence) {
+	WeightedDigraph g;
+	CSRGraph c;
+	SpanningTree t;
+	ASSERT_EQ(g.fileLoad(goodFile), 0);
+	buildCSR(g, c);
+
+	// the lightest in-edges of New York, Miami and San Francisco form a
+	// cycle, which is broken by entering New York from Boston instead
+	ASSERT_TRUE(minimumArborescence(c, g.getOffset("Boston"), t));
+	EXPECT_EQ(t.edges.size(), 6);
+	EXPECT_EQ(t.weight, 55);
+	expectArborescence(c.getVertexCount(), g.getOffset("Boston"), t);
+	for(size_t i = 0; i < t.edges.size(); ++i) {
+		EXPECT_EQ(g.getWeight(t.edges[i].from, t.edges[i].to), t.edges[i].weight);
+		if(g.getKey(t.edges[i].to) == "New York") {
+			EXPECT_EQ(g.getKey(t.edges[i].from), "Boston");
+		}
+	}
+}
+
+TEST(SpanningTest, ArborescenceReference) {
+	CSRGraph c;
+	SpanningTree t;
+	for(unsigned seed = 1; seed <= 20; ++seed) {
+		// a path from the root through every vertex keeps them reachable
+		std::mt19937 rng(seed);
+		Offset n = 30 + rng() % 50;
+		Offset root = rng() % n;
+		std::vector<Offset> src, dst;
+		std::vector<Weight> w;
+		for(Offset v = 1; v < n; ++v) {
+			src.push_back((root + v - 1) % n);
+			dst.push_back((root + v) % n);
+			w.push_back(100);
+		}
+		for(size_t i = 0; i < n * 4; ++i) {
+			src.push_back(rng() % n);
+			dst.push_back(rng() % n);
+			w.push_back((Weight)(rng() % 201) - 100);
+		}
+		buildCSR(n, src, dst, w, c);
+		ASSERT_TRUE(minimumArborescence(c, root, t));
+		EXPECT_EQ(t.edges.size(), n - 1);
+		EXPECT_EQ(t.weight, chuLiuEdmonds(c, root));
+		expectArborescence(n, root, t);
+	}
+}
+
+TEST(SpanningTest, Unreachable) {
+	WeightedDigraph g;
+	CSRGraph c;
+	SpanningTree t;
+	ASSERT_EQ(g.fileLoad(goodFile), 0);
+	buildCSR(g, c);
+
+	// nothing leaves Hartford
+	EXPECT_FALSE(minimumArborescence(c, g.getOffset("Hartford"), t));
+	EXPECT_EQ(t.edges.size(), 0);
+	EXPECT_EQ(t.weight, 0);
+
+	// Houston reaches Los Angeles, Miami, Boston, San Francisco, New York and
+	// then Hartford, so a new vertex is all it misses
+	ASSERT_TRUE(g.addVertex("Denver"));
+	ASSERT_EQ(g.setEdge("Denver", "Boston", 1), 0);
+	buildCSR(g, c);
+	EXPECT_FALSE(minimumArborescence(c, g.getOffset("Houston"), t));
+	EXPECT_EQ(t.edges.size(), 6);
+	expectArborescence(c.getVertexCount(), g.getOffset("Houston"), t);
+	for(size_t i = 0; i < t.edges.size(); ++i) {
+		EXPECT_NE(g.getKey(t.edges[i].from), "Denver");
+	}
+}
+
+int main(int argc, char** argv) {
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
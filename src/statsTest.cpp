@@ -0,0 +1,114 @@
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include "Graph.h"
+#include "Stats.h"
+#include "gtest/gtest.h"
+
+#define THREADS 4
+#define SAMPLES 1000
+
+/*
+ * StatsTest
+ *
+ * Performs the following tests on the operation instrumentation.
+ *     -Buckets
+ *     -Disabled
+ *     -GraphOps
+ *     -ThreadSums
+ */
+
+TEST(StatsTest, Buckets) {
+	// small latencies are exact
+	for(uint64_t ns = 0; ns < 32; ++ns) {
+		EXPECT_EQ(statBucketMax(statBucket(ns)), ns);
+	}
+
+	// larger latencies land in a bucket no more than 1/16th wide
+	uint64_t samples[] = {32, 33, 100, 1000, 65535, 65536, 123456789,
+			(uint64_t)-1};
+	for(size_t i = 0; i < sizeof(samples) / sizeof(samples[0]); ++i) {
+		unsigned b = statBucket(samples[i]);
+		ASSERT_LT(b, STAT_BUCKETS);
+		EXPECT_GE(statBucketMax(b), samples[i]);
+		EXPECT_LE(statBucketMax(b) - samples[i], samples[i] / 16);
+		EXPECT_LT(statBucketMax(b - 1), samples[i]);
+	}
+}
+
+TEST(StatsTest, Disabled) {
+	WeightedDigraph a;
+	StatSummary s;
+	setStatsEnabled(false);
+	resetStats();
+
+	// nothing is recorded while disabled
+	a.addVertex("Boston");
+	a.addVertex("Hartford");
+	getStats(STAT_ADD_VERTEX, s);
+	EXPECT_EQ(s.count, 0);
+}
+
+TEST(StatsTest, GraphOps) {
+	WeightedDigraph a;
+	StatSummary s;
+	std::vector<Key> n;
+	setStatsEnabled(true);
+	resetStats();
+
+	a.addVertex("Boston");
+	a.addVertex("Hartford");
+	a.addVertex("Boston");
+	a.setEdge("Boston","Hartford",4);
+	a.getNeighbors("Boston",n);
+	setStatsEnabled(false);
+
+	getStats(STAT_ADD_VERTEX, s);
+	EXPECT_EQ(s.count, 3);
+	EXPECT_LE(s.p50Ns, s.maxNs);
+	getStats(STAT_SET_EDGE, s);
+	EXPECT_EQ(s.count, 1);
+	getStats(STAT_GET_NEIGHBORS, s);
+	EXPECT_EQ(s.count, 1);
+	getStats(STAT_REMOVE_EDGE, s);
+	EXPECT_EQ(s.count, 0);
+
+	// reset discards what was recorded
+	resetStats();
+	getStats(STAT_ADD_VERTEX, s);
+	EXPECT_EQ(s.count, 0);
+}
+
+TEST(StatsTest, ThreadSums) {
+	StatSummary s;
+	setStatsEnabled(true);
+	resetStats();
+
+	// samples from threads that have exited are kept
+	std::vector<std::thread> threads;
+	for(int t = 0; t < THREADS; ++t) {
+		threads.push_back(std::thread([]{
+			for(int i = 0; i < SAMPLES; ++i) {
+				recordStat(STAT_BFS, 100);
+			}
+		}));
+	}
+	for(size_t t = 0; t < threads.size(); ++t) {
+		threads[t].join();
+	}
+	recordStat(STAT_BFS, 100000);
+	setStatsEnabled(false);
+
+	getStats(STAT_BFS, s);
+	EXPECT_EQ(s.count, THREADS * SAMPLES + 1);
+	EXPECT_EQ(s.totalNs, THREADS * SAMPLES * 100 + 100000);
+	EXPECT_GE(s.p99Ns, 100);
+	EXPECT_LT(s.p99Ns, 200);
+	EXPECT_GE(s.maxNs, 100000);
+}
+
+int main(int argc, char** argv) {
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
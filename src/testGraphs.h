@@ -0,0 +1,52 @@
+#pragma once
+
+#include "Graph.h"
+#include "CSR.h"
+#include <random>
+#include <string>
+#include <vector>
+
+/////////////////////////////////////////////////////////////////////////////
+// TEST GRAPHS                                                             //
+/////////////////////////////////////////////////////////////////////////////
+
+const std::string goodFile = "../graphFiles/test.graph";
+
+/*
+ * Graph should look as follows after loading from test.graph.
+ *
+ * Boston --> New York[19], Los Angeles[4]
+ * New York --> Miami[10], Houston[28], Hartford[12]
+ * Miami --> Boston[4], San Francisco[9]
+ * San Francisco --> Boston[20], New York[6], Houston[1]
+ * Los Angeles --> Miami[29]
+ * Houston --> Los Angeles[13]
+ * Hartford
+ */
+
+/*
+ * Builds a snapshot of edges between vertices drawn at random, self loops
+ * and duplicates included, with weights drawn from [minWeight, maxWeight].
+ * Left at 1, the weights are not drawn at all.
+ *
+ * @param c, the snapshot returned by reference
+ * @param n, the number of vertices
+ * @param edges, the number of edges
+ * @param seed, the seed of the draws
+ * @param minWeight, the lightest weight drawn
+ * @param maxWeight, the heaviest weight drawn
+ */
+inline void randomCSR(CSRGraph& c, Offset n, size_t edges, unsigned seed,
+		Weight minWeight = 1, Weight maxWeight = 1) {
+	std::mt19937 rng(seed);
+	std::vector<Offset> src, dst;
+	std::vector<Weight> w;
+	bool weighted = minWeight != 1 || maxWeight != 1;
+	for(size_t i = 0; i < edges; ++i) {
+		src.push_back(rng() % n);
+		dst.push_back(rng() % n);
+		if(weighted)
+			w.push_back(minWeight + (Weight)(rng() % (maxWeight - minWeight + 1)));
+	}
+	buildCSR(n, src, dst, w, c);
+}
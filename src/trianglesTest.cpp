@@ -0,0 +1,198 @@
+#include <iostream>
+#include <random>
+#include <algorithm>
+
+#include "Graph.h"
+#include "CSR.h"
+#include "Triangles.h"
+#include "Parallel.h"
+#include "testGraphs.h"
+#include "gtest/gtest.h"
+
+#define RANDOM_VERTICES 20000
+
+/*
+ * TrianglesTest
+ *
+ * Performs the following tests on the triangle procedures.
+ *     -Undirected
+ *     -Directed
+ *     -Complete
+ *     -Reference
+ *     -Threads
+ */
+
+/*
+ * Checks the counts against every triple of vertices, over a matrix of the
+ * number of directions each pair is joined in.
+ */
+static void expectReference(const CSRGraph& g, bool directed,
+		const TriangleCount& t) {
+	Offset n = g.getVertexCount();
+	std::vector<std::vector<int>> m(n, std::vector<int>(n, 0));
+	for(Offset v = 0; v < n; ++v) {
+		for(size_t e = g.offsets[v]; e < g.offsets[v+1]; ++e) {
+			Offset w = g.targets[e];
+			if(w != v && (m[v][w] & 1) == 0) {
+				m[v][w] += 1;
+				m[w][v] += 2;
+			}
+		}
+	}
+	std::vector<unsigned long long> at(n, 0);
+	unsigned long long total = 0;
+	for(Offset a = 0; a < n; ++a) {
+		for(Offset b = a + 1; b < n; ++b) {
+			for(Offset c = b + 1; c < n; ++c) {
+				if(m[a][b] && m[b][c] && m[a][c]) {
+					// 1 and 2 are one direction, 3 both
+					unsigned long long p = directed ? (1 + (m[a][b] == 3)) *
+						(1 + (m[b][c] == 3)) * (1 + (m[a][c] == 3)) : 1;
+					at[a] += p;
+					at[b] += p;
+					at[c] += p;
+					total += p;
+				}
+			}
+		}
+	}
+	EXPECT_EQ(t.total, total);
+	ASSERT_EQ(t.triangles.size(), n);
+	for(Offset v = 0; v < n; ++v) {
+		double k = 0, both = 0;
+		for(Offset w = 0; w < n; ++w) {
+			k += m[v][w] != 0;
+			both += m[v][w] == 3;
+		}
+		double pairs = directed ? (k + both) * (k + both - 1) - 2 * both :
+			k * (k - 1) / 2;
+		EXPECT_EQ(t.triangles[v], at[v]);
+		EXPECT_DOUBLE_EQ(t.clustering[v], pairs > 0 ? at[v] / pairs : 0);
+	}
+}
+
+TEST(TrianglesTest, Undirected) {
+	WeightedDigraph g;
+	CSRGraph c;
+	TriangleCount t;
+	ASSERT_EQ(g.fileLoad(goodFile), 0);
+	buildCSR(g, c);
+
+	// Boston, New York and Miami; Boston, New York and San Francisco;
+	// Boston, Miami and San Francisco; Boston, Los Angeles and Miami;
+	// New York, Miami and San Francisco; New York, San Francisco and Houston
+	countTriangles(c, TriangleOptions(), t);
+	EXPECT_EQ(t.total, 6);
+	EXPECT_EQ(t.triangles[g.getOffset("Boston")], 4);
+	EXPECT_EQ(t.triangles[g.getOffset("Hartford")], 0);
+	EXPECT_DOUBLE_EQ(t.clustering[g.getOffset("Boston")], 4.0 / 6);
+	EXPECT_DOUBLE_EQ(t.clustering[g.getOffset("Hartford")], 0);
+
+	// 18 triangles at a corner over 6 + 10 + 6 + 6 + 3 + 3 + 0 pairs
+	EXPECT_DOUBLE_EQ(t.globalClustering, 18.0 / 34);
+	expectReference(c, false, t);
+}
+
+TEST(TrianglesTest, Directed) {
+	WeightedDigraph g;
+	CSRGraph c;
+	TriangleCount t;
+	TriangleOptions o;
+	o.directed = true;
+	ASSERT_EQ(g.fileLoad(goodFile), 0);
+	buildCSR(g, c);
+
+	// no pair is joined both ways, so every triangle counts once
+	countTriangles(c, o, t);
+	EXPECT_EQ(t.total, 6);
+	EXPECT_DOUBLE_EQ(t.clustering[g.getOffset("Boston")], 4.0 / 12);
+	expectReference(c, true, t);
+
+	// joining Miami back to New York doubles the two triangles on that side
+	ASSERT_EQ(g.setEdge("Miami", "New York", 3), 0);
+	buildCSR(g, c);
+	countTriangles(c, o, t);
+	EXPECT_EQ(t.total, 8);
+	EXPECT_EQ(t.triangles[g.getOffset("Boston")], 5);
+	EXPECT_DOUBLE_EQ(t.clustering[g.getOffset("Boston")], 5.0 / 12);
+	expectReference(c, true, t);
+}
+
+TEST(TrianglesTest, Complete) {
+	CSRGraph c;
+	TriangleCount t;
+	TriangleOptions o;
+	std::vector<Offset> src, dst;
+	Offset n = 40;
+	for(Offset v = 0; v < n; ++v) {
+		for(Offset w = 0; w < n; ++w) {
+			src.push_back(v);
+			dst.push_back(w);
+		}
+	}
+	buildCSR(n, src, dst, std::vector<Weight>(), c);
+
+	countTriangles(c, o, t);
+	EXPECT_EQ(t.total, n * (n - 1) * (n - 2) / 6);
+	EXPECT_DOUBLE_EQ(t.globalClustering, 1);
+	EXPECT_DOUBLE_EQ(t.averageClustering, 1);
+
+	o.directed = true;
+	countTriangles(c, o, t);
+	EXPECT_EQ(t.total, 8 * n * (n - 1) * (n - 2) / 6);
+	EXPECT_DOUBLE_EQ(t.globalClustering, 1);
+	EXPECT_DOUBLE_EQ(t.averageClustering, 1);
+}
+
+TEST(TrianglesTest, Reference) {
+	CSRGraph c;
+	TriangleCount t;
+	TriangleOptions o;
+	for(unsigned seed = 1; seed <= 20; ++seed) {
+		// dense enough for rows long enough to compare in blocks, with
+		// repeated edges and self loops
+		std::mt19937 rng(seed);
+		Offset n = 20 + rng() % 80;
+		randomCSR(c, n, n * (2 + rng() % 20), seed);
+		o.directed = false;
+		countTriangles(c, o, t);
+		expectReference(c, false, t);
+		o.directed = true;
+		countTriangles(c, o, t);
+		expectReference(c, true, t);
+	}
+}
+
+TEST(TrianglesTest, Threads) {
+	CSRGraph c;
+	TriangleCount one, many;
+	TriangleOptions o;
+	o.directed = true;
+
+	// a hub joined to a tenth of the vertices skews the work
+	std::mt19937 rng(7);
+	std::vector<Offset> src, dst;
+	for(size_t i = 0; i < RANDOM_VERTICES * 8; ++i) {
+		src.push_back(rng() % RANDOM_VERTICES);
+		dst.push_back(rng() % RANDOM_VERTICES);
+	}
+	for(Offset v = 0; v < RANDOM_VERTICES; v += 10) {
+		src.push_back(0);
+		dst.push_back(v);
+	}
+	buildCSR(RANDOM_VERTICES, src, dst, std::vector<Weight>(), c);
+	setParallelThreads(1);
+	countTriangles(c, o, one);
+	setParallelThreads(4);
+	countTriangles(c, o, many);
+	setParallelThreads(0);
+	EXPECT_GT(one.total, 0);
+	EXPECT_EQ(one.total, many.total);
+	EXPECT_EQ(one.triangles, many.triangles);
+	EXPECT_DOUBLE_EQ(one.globalClustering, many.globalClustering);
+}
+
+int main(int argc, char** argv) {
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
@@ -0,0 +1,207 @@
+#include <iostream>
+#include <cstdio>
+
+#include "Graph.h"
+#include "Workspace.h"
+#include "gtest/gtest.h"
+
+const std::string goodFile = "../graphFiles/test.graph";
+
+/*
+ * WorkspaceTest
+ *
+ * Performs the following tests on workspaces of graphs.
+ *     -Names
+ *     -Eviction
+ *     -Copy
+ *     -Close
+ *     -Pinned
+ */
+
+static size_t graphBytes(const WeightedDigraph& g) {
+	std::vector<MemComponent> m;
+	size_t bytes = 0;
+	g.memoryUsage(m);
+	for(size_t i = 0; i < m.size(); ++i) {
+		bytes += m[i].live + m[i].slack;
+	}
+	return bytes;
+}
+
+static bool isResident(const Workspace& w, const std::string& name) {
+	std::vector<GraphInfo> g;
+	w.list(g);
+	for(size_t i = 0; i < g.size(); ++i) {
+		if(g[i].name == name)
+			return g[i].resident;
+	}
+	return false;
+}
+
+TEST(WorkspaceTest, Names) {
+	Workspace w;
+	WeightedDigraph* a = w.create("a");
+	ASSERT_TRUE(a != NULL);
+	EXPECT_TRUE(w.create("a") == NULL);
+	ASSERT_TRUE(w.create("b") != NULL);
+	EXPECT_EQ(w.get("a"), a);
+	EXPECT_TRUE(w.get("c") == NULL);
+	EXPECT_TRUE(w.contains("b"));
+	EXPECT_FALSE(w.contains("c"));
+
+	w.setFile("a", goodFile);
+	EXPECT_EQ(w.getFile("a"), goodFile);
+	EXPECT_EQ(w.getFile("b"), "");
+
+	std::vector<GraphInfo> g;
+	w.list(g);
+	ASSERT_EQ(g.size(), 2);
+	EXPECT_EQ(g[0].name, "a");
+	EXPECT_EQ(g[0].file, goodFile);
+	EXPECT_EQ(g[1].name, "b");
+	EXPECT_TRUE(g[0].resident && g[1].resident);
+}
+
+TEST(WorkspaceTest, Eviction) {
+	Workspace w;
+	const char* names[] = {"a", "b", "c"};
+	size_t bytes = 0;
+	for(int i = 0; i < 3; ++i) {
+		WeightedDigraph* g = w.create(names[i]);
+		ASSERT_EQ(g->fileLoad(goodFile), 0);
+		ASSERT_TRUE(g->addVertex(names[i]));
+		bytes = graphBytes(*g);
+	}
+	EXPECT_EQ(w.rebalance(), 3 * bytes);
+
+	// room for two: the least recently used goes
+	w.setBudget(2 * bytes);
+	EXPECT_FALSE(isResident(w, "a"));
+	EXPECT_TRUE(isResident(w, "b"));
+	EXPECT_TRUE(isResident(w, "c"));
+
+	// using a graph brings it back, evicting the next least recently used
+	WeightedDigraph* a = w.get("a");
+	ASSERT_TRUE(a != NULL);
+	EXPECT_TRUE(isResident(w, "a"));
+	EXPECT_FALSE(isResident(w, "b"));
+	EXPECT_TRUE(a->isEdge("Boston", "New York"));
+	EXPECT_EQ(a->getOffset("a"), (int)a->getVertexCount() - 1);
+	EXPECT_EQ(a->getOffset("b"), -1);
+
+	// the graph in use stays, however small the budget
+	w.setBudget(0);
+	EXPECT_TRUE(isResident(w, "a"));
+	EXPECT_FALSE(isResident(w, "c"));
+	WeightedDigraph* b = w.get("b");
+	ASSERT_TRUE(b != NULL);
+	EXPECT_TRUE(b->isEdge("Boston", "New York"));
+	EXPECT_NE(b->getOffset("b"), -1);
+	EXPECT_FALSE(isResident(w, "a"));
+
+	// edits made before eviction are kept
+	ASSERT_TRUE(b->removeVertex("Boston"));
+	ASSERT_TRUE(w.get("c") != NULL);
+	b = w.get("b");
+	EXPECT_EQ(b->getOffset("Boston"), -1);
+}
+
+TEST(WorkspaceTest, Copy) {
+	Workspace w;
+	WeightedDigraph* a = w.create("a");
+	ASSERT_EQ(a->fileLoad(goodFile), 0);
+	EXPECT_TRUE(w.copy("missing", "b") == NULL);
+	EXPECT_TRUE(w.copy("a", "a") == NULL);
+
+	// a copy is independent of its source
+	WeightedDigraph* b = w.copy("a", "b");
+	ASSERT_TRUE(b != NULL);
+	ASSERT_TRUE(b->removeVertex("Boston"));
+	a = w.get("a");
+	EXPECT_NE(a->getOffset("Boston"), -1);
+	EXPECT_EQ(w.get("b")->getOffset("Boston"), -1);
+
+	// an evicted graph can be copied
+	w.setBudget(0);
+	EXPECT_FALSE(isResident(w, "a"));
+	WeightedDigraph* c = w.copy("a", "c");
+	ASSERT_TRUE(c != NULL);
+	EXPECT_NE(c->getOffset("Boston"), -1);
+}
+
+TEST(WorkspaceTest, Close) {
+	Workspace w(0);
+	ASSERT_EQ(w.create("a")->fileLoad(goodFile), 0);
+	ASSERT_EQ(w.create("b")->fileLoad(goodFile), 0);
+	w.rebalance();
+	EXPECT_FALSE(isResident(w, "a"));
+
+	// closing evicted and resident graphs alike
+	EXPECT_TRUE(w.close("a"));
+	EXPECT_FALSE(w.close("a"));
+	EXPECT_TRUE(w.get("a") == NULL);
+	EXPECT_TRUE(w.close("b"));
+	std::vector<GraphInfo> g;
+	w.list(g);
+	EXPECT_TRUE(g.empty());
+
+	// names may be reused
+	ASSERT_TRUE(w.create("a") != NULL);
+	EXPECT_EQ(w.get("a")->getVertexCount(), 0);
+
+	// renaming evicted graphs alike, into names no graph holds
+	ASSERT_EQ(w.create("b")->fileLoad(goodFile), 0);
+	w.rebalance();
+	EXPECT_FALSE(isResident(w, "a"));
+	EXPECT_FALSE(w.rename("a", "b"));
+	EXPECT_FALSE(w.rename("c", "d"));
+	EXPECT_TRUE(w.close("b"));
+	EXPECT_TRUE(w.rename("a", "b"));
+	EXPECT_FALSE(w.contains("a"));
+	ASSERT_TRUE(w.get("b") != NULL);
+	EXPECT_EQ(w.get("b")->getVertexCount(), 0);
+}
+
+TEST(WorkspaceTest, Pinned) {
+	Workspace w;
+	WeightedDigraph* a = w.create("a");
+	ASSERT_EQ(a->fileLoad(goodFile), 0);
+	w.pin("a");
+
+	// copying makes the copy most recently used, but the pinned graph the
+	// shell is editing stays put however small the budget
+	WeightedDigraph* b = w.copy("a", "b");
+	ASSERT_TRUE(b != NULL);
+	w.setBudget(0);
+	EXPECT_TRUE(isResident(w, "a"));
+	EXPECT_TRUE(isResident(w, "b"));
+	ASSERT_TRUE(w.copy("a", "c") != NULL);
+	EXPECT_TRUE(isResident(w, "a"));
+	EXPECT_FALSE(isResident(w, "b"));
+	EXPECT_TRUE(a->isEdge("Boston", "New York"));
+	ASSERT_TRUE(a->addVertex("Denver"));
+
+	// pinning another releases it
+	w.pin("c");
+	EXPECT_EQ(w.get("b")->getOffset("Denver"), -1);
+	EXPECT_FALSE(isResident(w, "a"));
+	EXPECT_TRUE(isResident(w, "c"));
+	EXPECT_NE(w.get("a")->getOffset("Denver"), -1);
+
+	// closing the pinned graph leaves none pinned
+	ASSERT_TRUE(w.close("c"));
+	ASSERT_TRUE(w.create("c") != NULL);
+	w.get("a");
+	EXPECT_FALSE(isResident(w, "c"));
+
+	// and renaming it keeps it pinned
+	w.pin("a");
+	ASSERT_TRUE(w.rename("a", "d"));
+	w.get("c");
+	EXPECT_TRUE(isResident(w, "d"));
+}
+
+int main(int argc, char** argv) {
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}